@@ -0,0 +1,123 @@
+#include <stdbool.h>
+
+#include "rcv/nl_crc24q.h"
+
+/*
+ * The tables hold the CRC left-aligned in a 32-bit register (low byte always zero),
+ * so 4 message bytes can be folded into the register at once.
+ * s_nl_crc24q_table[k][b] is the remainder of byte b followed by k zero bytes.
+ */
+static uint32_t s_nl_crc24q_table[8][256];
+static bool     s_nl_crc24q_ready = false;
+
+static inline uint32_t nl_crc24q_load_be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24U) | ((uint32_t)p[1] << 16U) | ((uint32_t)p[2] << 8U) | (uint32_t)p[3];
+}
+
+static int nl_crc24q_selftest(void) {
+    static const size_t lengths[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 15, 16, 17, 31, 64, 65, 127, 200, 247};
+
+    uint8_t  buf[256];
+    uint32_t seed = 0x2545F491UL;
+
+    for (size_t i = 0; i < sizeof(buf); i++) {
+        seed   = seed * 1664525UL + 1013904223UL;
+        buf[i] = seed >> 24U;
+    }
+
+    for (size_t offset = 0; offset < 8; offset++) {
+        for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+            if (nl_crc24q(&buf[offset], lengths[i]) != nl_crc24q_bitwise(&buf[offset], lengths[i])) {
+                return -1;
+            }
+        }
+    }
+
+    /* Check value of "123456789" */
+    if (nl_crc24q((const uint8_t *)"123456789", 9) != 0xCDE703UL) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int nl_crc24q_init(void) {
+    if (s_nl_crc24q_ready) {
+        return 0;
+    }
+
+    for (uint32_t b = 0; b < 256; b++) {
+        uint32_t crc = b << 24U;
+
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80000000UL) ? ((crc << 1U) ^ (NL_CRC24Q_POLY << 8U)) : (crc << 1U);
+        }
+
+        s_nl_crc24q_table[0][b] = crc;
+    }
+
+    for (uint32_t b = 0; b < 256; b++) {
+        for (uint8_t k = 1; k < 8; k++) {
+            const uint32_t prev = s_nl_crc24q_table[k - 1][b];
+
+            s_nl_crc24q_table[k][b] = (prev << 8U) ^ s_nl_crc24q_table[0][prev >> 24U];
+        }
+    }
+
+    s_nl_crc24q_ready = true;
+
+    if (nl_crc24q_selftest() != 0) {
+        s_nl_crc24q_ready = false;
+        return -1;
+    }
+
+    return 0;
+}
+
+uint32_t nl_crc24q(const uint8_t *data, size_t len) {
+    if (!s_nl_crc24q_ready) {
+        return nl_crc24q_bitwise(data, len);
+    }
+
+    uint32_t crc = 0U;
+
+    while (len >= 8) {
+        crc ^= nl_crc24q_load_be32(data);
+
+        const uint32_t next = nl_crc24q_load_be32(&data[4]);
+
+        crc = s_nl_crc24q_table[7][crc >> 24U] ^ s_nl_crc24q_table[6][(crc >> 16U) & 0xFFU] ^
+              s_nl_crc24q_table[5][(crc >> 8U) & 0xFFU] ^ s_nl_crc24q_table[4][crc & 0xFFU] ^
+              s_nl_crc24q_table[3][next >> 24U] ^ s_nl_crc24q_table[2][(next >> 16U) & 0xFFU] ^
+              s_nl_crc24q_table[1][(next >> 8U) & 0xFFU] ^ s_nl_crc24q_table[0][next & 0xFFU];
+
+        data += 8;
+        len -= 8;
+    }
+
+    while (len > 0) {
+        crc = (crc << 8U) ^ s_nl_crc24q_table[0][(crc >> 24U) ^ *data];
+
+        data++;
+        len--;
+    }
+
+    return crc >> 8U;
+}
+
+uint32_t nl_crc24q_bitwise(const uint8_t *data, size_t len) {
+    uint32_t crc = 0U;
+
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint32_t)data[i] << 16U;
+
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc <<= 1U;
+            if (crc & 0x1000000UL) {
+                crc ^= NL_CRC24Q_POLY;
+            }
+        }
+    }
+
+    return crc & 0xFFFFFFUL;
+}
@@ -0,0 +1,22 @@
+#ifndef NL_CRC24Q_H
+#define NL_CRC24Q_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define NL_CRC24Q_POLY (0x1864CFBUL)
+
+/**
+ * Build the slicing-by-8 tables and verify them against the bitwise reference.
+ * Until this succeeds nl_crc24q() falls back to the bitwise implementation.
+ * Returns 0 on success, -1 if the self-test failed.
+ */
+int nl_crc24q_init(void);
+
+/* CRC-24Q (RTCM3 / Qualcomm), table driven, 8 bytes per iteration. */
+uint32_t nl_crc24q(const uint8_t *data, size_t len);
+
+/* Bit-at-a-time reference implementation. */
+uint32_t nl_crc24q_bitwise(const uint8_t *data, size_t len);
+
+#endif  // NL_CRC24Q_H
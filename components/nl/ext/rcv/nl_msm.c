@@ -0,0 +1,416 @@
+#include <string.h>
+
+#include "rcv/nl_crc24q.h"
+#include "rcv/nl_msm.h"
+
+#define NL_MSM_HEADER_BITS (12 + 61 + 64 + 32) /* Up to, not including, the cell mask */
+
+/* Invalid-value markers, the most negative value of each signed field */
+#define NL_MSM4_PR_INVALID   (-(1L << 14))
+#define NL_MSM4_CP_INVALID   (-(1L << 21))
+#define NL_MSM7_PR_INVALID   (-(1L << 19))
+#define NL_MSM7_CP_INVALID   (-(1L << 23))
+#define NL_MSM7_RATE_INVALID (-(1L << 14))
+#define NL_MSM7_SAT_RATE_INV (-(1L << 13))
+
+static uint32_t nl_msm_getbitu(const uint8_t *buf, size_t pos, uint8_t len) {
+    uint32_t val = 0;
+
+    for (size_t i = pos; i < pos + len; i++) {
+        val = (val << 1U) | ((buf[i >> 3U] >> (7U - (i & 7U))) & 1U);
+    }
+
+    return val;
+}
+
+static int32_t nl_msm_getbits(const uint8_t *buf, size_t pos, uint8_t len) {
+    const uint32_t val = nl_msm_getbitu(buf, pos, len);
+
+    if (len == 0 || len >= 32 || !(val & (1UL << (len - 1U)))) return (int32_t)val;
+
+    return (int32_t)(val | (~0UL << len));
+}
+
+static void nl_msm_setbitu(uint8_t *buf, size_t pos, uint8_t len, uint32_t val) {
+    for (size_t i = pos; i < pos + len; i++) {
+        const uint8_t mask = 1U << (7U - (i & 7U));
+        const bool    bit  = (val >> (len - 1U - (i - pos))) & 1U;
+
+        if (bit) {
+            buf[i >> 3U] |= mask;
+        } else {
+            buf[i >> 3U] &= ~mask;
+        }
+    }
+}
+
+static void nl_msm_setbits(uint8_t *buf, size_t pos, uint8_t len, int32_t val) {
+    nl_msm_setbitu(buf, pos, len, (uint32_t)val & ((len >= 32) ? ~0UL : ((1UL << len) - 1U)));
+}
+
+/* Keep a rounded value off the invalid marker and inside the field */
+static int32_t nl_msm_clamp(int32_t val, uint8_t len) {
+    const int32_t max = (int32_t)((1UL << (len - 1U)) - 1U);
+
+    if (val > max) return max;
+    if (val < -max) return -max;
+
+    return val;
+}
+
+/* DF407 extended lock time indicator to minimum lock time, ms */
+static uint32_t nl_msm_lock7_to_ms(uint32_t ind) {
+    if (ind < 64) return ind;
+    if (ind > 704) return 67108864UL;
+
+    const uint32_t k = ind / 32U - 1U;
+
+    return (1UL << k) * (ind - 32U * k);
+}
+
+/* Minimum lock time to the largest DF407 indicator not exceeding it */
+static uint32_t nl_msm_ms_to_lock7(uint32_t ms) {
+    if (ms < 64) return ms;
+    if (ms >= 67108864UL) return 704;
+
+    uint32_t k = 1;
+    while ((64UL << k) <= ms) k++;
+
+    return ms / (1UL << k) + 32U * k;
+}
+
+/* DF402 lock time indicator: 0 below 32 ms, then n for at least 2^(n + 4) ms */
+static uint32_t nl_msm_lock4_to_ms(uint32_t ind) {
+    return (ind == 0) ? 0 : (1UL << (ind + 4U));
+}
+
+static uint32_t nl_msm_ms_to_lock4(uint32_t ms) {
+    uint32_t ind = 0;
+
+    while (ind < 15 && ms >= (1UL << (ind + 5U))) ind++;
+
+    return ind;
+}
+
+uint8_t nl_msm_type(uint16_t message) {
+    if (message < 1071 || message > 1137) return 0;
+    if (message % 10 == 0 || message % 10 > 7) return 0;
+
+    return message % 10;
+}
+
+/* header[0] holds DF003 (12 bits) and the upper 20 epoch bits, header[1] the lower 10 epoch bits, then DF393 */
+uint16_t nl_msm_station(const nl_msm_t *msm) {
+    return msm->header[0] >> 20U;
+}
+
+uint32_t nl_msm_epoch(const nl_msm_t *msm) {
+    return ((msm->header[0] & 0xFFFFFUL) << 10U) | (msm->header[1] >> 19U);
+}
+
+bool nl_msm_multiple(const nl_msm_t *msm) {
+    return (msm->header[1] >> 18U) & 1U;
+}
+
+int nl_msm_decode(nl_msm_t *msm, const uint8_t *frame, size_t len) {
+    if (len < 6 || frame[0] != 0xD3) return -2;
+
+    const size_t   payload_len = ((frame[1] & 0x03U) << 8U) | frame[2];
+    const uint8_t *p           = &frame[3];
+    const size_t   bits        = payload_len * 8U;
+
+    if (payload_len + 6 > len || bits < NL_MSM_HEADER_BITS) return -2;
+
+    msm->type     = nl_msm_getbitu(p, 0, 12);
+    msm->msm_type = nl_msm_type(msm->type);
+
+    if (msm->msm_type != 4 && msm->msm_type != 7) return -1;
+
+    msm->header[0] = nl_msm_getbitu(p, 12, 32);
+    msm->header[1] = nl_msm_getbitu(p, 44, 29);
+
+    size_t pos = 73;
+
+    /* ---- Satellite and signal masks ---- */
+    msm->nsat = 0;
+    for (uint8_t i = 0; i < 64; i++) {
+        if (nl_msm_getbitu(p, pos++, 1)) msm->sat_id[msm->nsat++] = i + 1;
+    }
+
+    msm->nsig = 0;
+    for (uint8_t i = 0; i < 32; i++) {
+        if (nl_msm_getbitu(p, pos++, 1)) msm->sig_id[msm->nsig++] = i + 1;
+    }
+
+    if ((size_t)msm->nsat * msm->nsig > NL_MSM_MAX_CELLS) return -2;
+    if (pos + (size_t)msm->nsat * msm->nsig > bits) return -2;
+
+    msm->ncell = 0;
+    for (uint8_t i = 0; i < msm->nsat; i++) {
+        for (uint8_t j = 0; j < msm->nsig; j++) {
+            msm->cell[i][j] = nl_msm_getbitu(p, pos++, 1);
+            msm->ncell += msm->cell[i][j];
+        }
+    }
+
+    const bool   is7   = msm->msm_type == 7;
+    const size_t nsat  = msm->nsat;
+    const size_t ncell = msm->ncell;
+    const size_t need  = (is7 ? 36U : 18U) * nsat + (is7 ? 80U : 48U) * ncell;
+
+    if (pos + need > bits) return -2;
+
+    /* ---- Satellite data ---- */
+    for (size_t i = 0; i < nsat; i++, pos += 8) msm->rough_ms[i] = nl_msm_getbitu(p, pos, 8);
+
+    for (size_t i = 0; i < nsat; i++) {
+        msm->ext_info[i] = is7 ? nl_msm_getbitu(p, pos, 4) : 0;
+        pos += is7 ? 4 : 0;
+    }
+
+    for (size_t i = 0; i < nsat; i++, pos += 10) msm->rough_mod[i] = nl_msm_getbitu(p, pos, 10);
+
+    for (size_t i = 0; i < nsat; i++) {
+        if (!is7) {
+            msm->rough_rate[i] = NL_MSM_INVALID;
+            continue;
+        }
+
+        const int32_t v    = nl_msm_getbits(p, pos, 14);
+        msm->rough_rate[i] = (v == NL_MSM7_SAT_RATE_INV) ? NL_MSM_INVALID : v;
+        pos += 14;
+    }
+
+    /* ---- Signal data, converted to MSM7 resolution ---- */
+    for (size_t i = 0; i < ncell; i++) {
+        const int32_t v = nl_msm_getbits(p, pos, is7 ? 20 : 15);
+
+        if (is7) {
+            msm->fine_pr[i] = (v == NL_MSM7_PR_INVALID) ? NL_MSM_INVALID : v;
+        } else {
+            msm->fine_pr[i] = (v == NL_MSM4_PR_INVALID) ? NL_MSM_INVALID : v * 32;
+        }
+
+        pos += is7 ? 20 : 15;
+    }
+
+    for (size_t i = 0; i < ncell; i++) {
+        const int32_t v = nl_msm_getbits(p, pos, is7 ? 24 : 22);
+
+        if (is7) {
+            msm->fine_cp[i] = (v == NL_MSM7_CP_INVALID) ? NL_MSM_INVALID : v;
+        } else {
+            msm->fine_cp[i] = (v == NL_MSM4_CP_INVALID) ? NL_MSM_INVALID : v * 4;
+        }
+
+        pos += is7 ? 24 : 22;
+    }
+
+    for (size_t i = 0; i < ncell; i++) {
+        const uint32_t v = nl_msm_getbitu(p, pos, is7 ? 10 : 4);
+
+        msm->lock_ms[i] = is7 ? nl_msm_lock7_to_ms(v) : nl_msm_lock4_to_ms(v);
+        pos += is7 ? 10 : 4;
+    }
+
+    for (size_t i = 0; i < ncell; i++, pos += 1) msm->half_cycle[i] = nl_msm_getbitu(p, pos, 1);
+
+    for (size_t i = 0; i < ncell; i++) {
+        const uint32_t v = nl_msm_getbitu(p, pos, is7 ? 10 : 6);
+
+        msm->cnr[i] = is7 ? v : v * 16U;
+        pos += is7 ? 10 : 6;
+    }
+
+    for (size_t i = 0; i < ncell; i++) {
+        if (!is7) {
+            msm->fine_rate[i] = NL_MSM_INVALID;
+            continue;
+        }
+
+        const int32_t v   = nl_msm_getbits(p, pos, 15);
+        msm->fine_rate[i] = (v == NL_MSM7_RATE_INVALID) ? NL_MSM_INVALID : v;
+        pos += 15;
+    }
+
+    return 0;
+}
+
+void nl_msm_prune(nl_msm_t *msm, uint64_t sat_mask, uint32_t sig_mask) {
+    bool    keep_sig[NL_MSM_MAX_SIGS] = {false};
+    uint8_t nsat                      = 0;
+    uint8_t ncell                     = 0;
+    uint8_t cell                      = 0;
+
+    /* ---- Satellites and cells, compacted in place ---- */
+    for (uint8_t i = 0; i < msm->nsat; i++) {
+        const bool sat_kept = (sat_mask >> (msm->sat_id[i] - 1U)) & 1U;
+        bool       any      = false;
+
+        for (uint8_t j = 0; j < msm->nsig; j++) {
+            if (!msm->cell[i][j]) continue;
+
+            const bool kept = sat_kept && ((sig_mask >> (msm->sig_id[j] - 1U)) & 1U);
+
+            if (kept) {
+                msm->fine_pr[ncell]    = msm->fine_pr[cell];
+                msm->fine_cp[ncell]    = msm->fine_cp[cell];
+                msm->lock_ms[ncell]    = msm->lock_ms[cell];
+                msm->half_cycle[ncell] = msm->half_cycle[cell];
+                msm->cnr[ncell]        = msm->cnr[cell];
+                msm->fine_rate[ncell]  = msm->fine_rate[cell];
+                ncell++;
+
+                keep_sig[j] = true;
+                any         = true;
+            }
+
+            msm->cell[i][j] = kept;
+            cell++;
+        }
+
+        if (!any) continue;
+
+        msm->sat_id[nsat]     = msm->sat_id[i];
+        msm->rough_ms[nsat]   = msm->rough_ms[i];
+        msm->ext_info[nsat]   = msm->ext_info[i];
+        msm->rough_mod[nsat]  = msm->rough_mod[i];
+        msm->rough_rate[nsat] = msm->rough_rate[i];
+        memcpy(msm->cell[nsat], msm->cell[i], sizeof(msm->cell[0]));
+        nsat++;
+    }
+
+    /* ---- Signals left without any cell ---- */
+    uint8_t nsig = 0;
+
+    for (uint8_t j = 0; j < msm->nsig; j++) {
+        if (!keep_sig[j]) continue;
+
+        for (uint8_t i = 0; i < nsat; i++) msm->cell[i][nsig] = msm->cell[i][j];
+
+        msm->sig_id[nsig++] = msm->sig_id[j];
+    }
+
+    msm->nsat  = nsat;
+    msm->nsig  = nsig;
+    msm->ncell = ncell;
+}
+
+int nl_msm_encode(const nl_msm_t *msm, uint8_t msm_type, uint8_t *out, size_t out_size) {
+    if (msm_type != 4 && msm_type != 7) return -1;
+    if (msm_type == 7 && msm->msm_type != 7) return -1;
+
+    const bool   is7  = msm_type == 7;
+    const size_t bits = NL_MSM_HEADER_BITS + (size_t)msm->nsat * msm->nsig + (is7 ? 36U : 18U) * msm->nsat +
+                        (is7 ? 80U : 48U) * msm->ncell;
+    const size_t payload_len = (bits + 7U) / 8U;
+
+    if (payload_len > 1023 || payload_len + 6 > out_size) return -1;
+
+    memset(out, 0U, payload_len + 6);
+
+    out[0] = 0xD3;
+    out[1] = (payload_len >> 8U) & 0x03U;
+    out[2] = payload_len & 0xFFU;
+
+    uint8_t *p   = &out[3];
+    size_t   pos = 0;
+
+    /* ---- Header ---- */
+    nl_msm_setbitu(p, pos, 12, (msm->type / 10U) * 10U + msm_type);
+    nl_msm_setbitu(p, pos + 12, 32, msm->header[0]);
+    nl_msm_setbitu(p, pos + 44, 29, msm->header[1]);
+    pos += 73;
+
+    for (uint8_t i = 0; i < msm->nsat; i++) nl_msm_setbitu(p, pos + msm->sat_id[i] - 1U, 1, 1);
+    pos += 64;
+
+    for (uint8_t j = 0; j < msm->nsig; j++) nl_msm_setbitu(p, pos + msm->sig_id[j] - 1U, 1, 1);
+    pos += 32;
+
+    for (uint8_t i = 0; i < msm->nsat; i++) {
+        for (uint8_t j = 0; j < msm->nsig; j++) nl_msm_setbitu(p, pos++, 1, msm->cell[i][j]);
+    }
+
+    /* ---- Satellite data ---- */
+    for (uint8_t i = 0; i < msm->nsat; i++, pos += 8) nl_msm_setbitu(p, pos, 8, msm->rough_ms[i]);
+
+    if (is7) {
+        for (uint8_t i = 0; i < msm->nsat; i++, pos += 4) nl_msm_setbitu(p, pos, 4, msm->ext_info[i]);
+    }
+
+    for (uint8_t i = 0; i < msm->nsat; i++, pos += 10) nl_msm_setbitu(p, pos, 10, msm->rough_mod[i]);
+
+    if (is7) {
+        for (uint8_t i = 0; i < msm->nsat; i++, pos += 14) {
+            const int32_t v = msm->rough_rate[i];
+            nl_msm_setbits(p, pos, 14, (v == NL_MSM_INVALID) ? NL_MSM7_SAT_RATE_INV : v);
+        }
+    }
+
+    /* ---- Signal data ---- */
+    for (uint8_t i = 0; i < msm->ncell; i++) {
+        const int32_t v = msm->fine_pr[i];
+
+        if (is7) {
+            nl_msm_setbits(p, pos, 20, (v == NL_MSM_INVALID) ? NL_MSM7_PR_INVALID : v);
+        } else {
+            /* Round to nearest, 2^-29 to 2^-24 ms */
+            nl_msm_setbits(p, pos, 15, (v == NL_MSM_INVALID) ? NL_MSM4_PR_INVALID : nl_msm_clamp((v + 16) >> 5, 15));
+        }
+
+        pos += is7 ? 20 : 15;
+    }
+
+    for (uint8_t i = 0; i < msm->ncell; i++) {
+        const int32_t v = msm->fine_cp[i];
+
+        if (is7) {
+            nl_msm_setbits(p, pos, 24, (v == NL_MSM_INVALID) ? NL_MSM7_CP_INVALID : v);
+        } else {
+            /* 2^-31 to 2^-29 ms */
+            nl_msm_setbits(p, pos, 22, (v == NL_MSM_INVALID) ? NL_MSM4_CP_INVALID : nl_msm_clamp((v + 2) >> 2, 22));
+        }
+
+        pos += is7 ? 24 : 22;
+    }
+
+    for (uint8_t i = 0; i < msm->ncell; i++) {
+        if (is7) {
+            nl_msm_setbitu(p, pos, 10, nl_msm_ms_to_lock7(msm->lock_ms[i]));
+        } else {
+            nl_msm_setbitu(p, pos, 4, nl_msm_ms_to_lock4(msm->lock_ms[i]));
+        }
+
+        pos += is7 ? 10 : 4;
+    }
+
+    for (uint8_t i = 0; i < msm->ncell; i++, pos += 1) nl_msm_setbitu(p, pos, 1, msm->half_cycle[i]);
+
+    for (uint8_t i = 0; i < msm->ncell; i++) {
+        if (is7) {
+            nl_msm_setbitu(p, pos, 10, msm->cnr[i]);
+        } else {
+            const uint32_t cnr = (msm->cnr[i] + 8U) / 16U;
+            nl_msm_setbitu(p, pos, 6, (cnr > 63U) ? 63U : cnr);
+        }
+
+        pos += is7 ? 10 : 6;
+    }
+
+    if (is7) {
+        for (uint8_t i = 0; i < msm->ncell; i++, pos += 15) {
+            const int32_t v = msm->fine_rate[i];
+            nl_msm_setbits(p, pos, 15, (v == NL_MSM_INVALID) ? NL_MSM7_RATE_INVALID : v);
+        }
+    }
+
+    /* ---- CRC ---- */
+    const uint32_t crc = nl_crc24q(out, payload_len + 3);
+
+    out[payload_len + 3] = (crc >> 16U) & 0xFFU;
+    out[payload_len + 4] = (crc >> 8U) & 0xFFU;
+    out[payload_len + 5] = crc & 0xFFU;
+
+    return (int)(payload_len + 6);
+}
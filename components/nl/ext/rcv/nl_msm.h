@@ -0,0 +1,74 @@
+#ifndef NL_MSM_H
+#define NL_MSM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define NL_MSM_MAX_SATS    (64)
+#define NL_MSM_MAX_SIGS    (32)
+#define NL_MSM_MAX_CELLS   (64)
+#define NL_MSM_MAX_FRAME   (3 + 1023 + 3)
+#define NL_MSM_INVALID     INT32_MIN /* Field not available, encoded as the type's invalid value */
+#define NL_MSM_ROUGH_EMPTY (255U)    /* DF397 value of a satellite without a range */
+
+/**
+ * One decoded MSM4 or MSM7 message, every observable held at MSM7 resolution.
+ * Satellites and signals are identified by their 1-based mask position (DF394/DF395), cells are stored
+ * satellite-major like on the wire.
+ */
+typedef struct {
+    uint16_t type;      /* Message number, e.g. 1077 */
+    uint8_t  msm_type;  /* 4 or 7, the resolution the observables were decoded from */
+    uint32_t header[2]; /* Station ID to smoothing interval (DF003-DF418), 32 + 29 bits kept verbatim */
+
+    uint8_t nsat;
+    uint8_t nsig;
+    uint8_t sat_id[NL_MSM_MAX_SATS];
+    uint8_t sig_id[NL_MSM_MAX_SIGS];
+    bool    cell[NL_MSM_MAX_SATS][NL_MSM_MAX_SIGS];
+
+    /* Satellite data */
+    uint8_t  rough_ms[NL_MSM_MAX_SATS];   /* DF397 */
+    uint8_t  ext_info[NL_MSM_MAX_SATS];   /* MSM7 only, 0 otherwise */
+    uint16_t rough_mod[NL_MSM_MAX_SATS];  /* DF398, 2^-10 ms */
+    int32_t  rough_rate[NL_MSM_MAX_SATS]; /* DF399, m/s; NL_MSM_INVALID if absent */
+
+    /* Signal data, ncell entries */
+    uint8_t  ncell;
+    int32_t  fine_pr[NL_MSM_MAX_CELLS];   /* 2^-29 ms */
+    int32_t  fine_cp[NL_MSM_MAX_CELLS];   /* 2^-31 ms */
+    uint32_t lock_ms[NL_MSM_MAX_CELLS];   /* Minimum lock time */
+    uint8_t  half_cycle[NL_MSM_MAX_CELLS];
+    uint16_t cnr[NL_MSM_MAX_CELLS];       /* 2^-4 dB-Hz */
+    int32_t  fine_rate[NL_MSM_MAX_CELLS]; /* 0.0001 m/s; NL_MSM_INVALID if absent */
+} nl_msm_t;
+
+/* MSM type (1-7) of a message number, 0 if it is not an MSM message. */
+uint8_t nl_msm_type(uint16_t message);
+
+/* Header fields of a decoded message */
+uint16_t nl_msm_station(const nl_msm_t *msm);
+uint32_t nl_msm_epoch(const nl_msm_t *msm); /* 30-bit epoch time, GLONASS: day of week (3 bits) and ms of day */
+bool     nl_msm_multiple(const nl_msm_t *msm);
+
+/**
+ * Decode a complete RTCM3 frame (preamble to CRC, CRC not checked).
+ * Returns 0 on success, -1 if it is not MSM4 or MSM7, -2 if malformed.
+ */
+int nl_msm_decode(nl_msm_t *msm, const uint8_t *frame, size_t len);
+
+/**
+ * Keep only the satellites in sat_mask and the signals in sig_mask (bit n - 1 for ID n).
+ * Rows and columns left without any cell are removed as well.
+ */
+void nl_msm_prune(nl_msm_t *msm, uint64_t sat_mask, uint32_t sig_mask);
+
+/**
+ * Encode as MSM4 or MSM7 (msm_type 4 or 7) into a complete frame with CRC.
+ * MSM7 can only be produced from MSM7 input. Returns the frame length, -1 on invalid arguments or if out is too
+ * small.
+ */
+int nl_msm_encode(const nl_msm_t *msm, uint8_t msm_type, uint8_t *out, size_t out_size);
+
+#endif  // NL_MSM_H
@@ -0,0 +1,267 @@
+#include <string.h>
+
+#include "rcv/nl_nmea_index.h"
+
+static int nl_nmea_hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+
+    return -1;
+}
+
+static uint8_t nl_nmea_checksum(const uint8_t *data, size_t len) {
+    uint32_t acc = 0U;
+
+    while (len >= 4) {
+        uint32_t word;
+        memcpy(&word, data, sizeof(word));
+
+        acc ^= word;
+
+        data += 4;
+        len -= 4;
+    }
+
+    uint8_t sum = (acc ^ (acc >> 8U) ^ (acc >> 16U) ^ (acc >> 24U)) & 0xFFU;
+
+    while (len > 0) {
+        sum ^= *data;
+
+        data++;
+        len--;
+    }
+
+    return sum;
+}
+
+static int nl_nmea_parse_uint(const char *str, size_t len, uint32_t *val) {
+    uint32_t v = 0U;
+
+    if (len == 0) return -1;
+
+    for (size_t i = 0; i < len; i++) {
+        if (str[i] < '0' || str[i] > '9') return -1;
+
+        v = v * 10U + (str[i] - '0');
+    }
+
+    *val = v;
+
+    return 0;
+}
+
+int nl_nmea_index_build(nl_nmea_index_t *idx, const uint8_t *buf, size_t len) {
+    /* Shortest valid sentence: "$A*hh" */
+    if (len < 5 || buf[0] != '$') return -1;
+
+    while (len > 0 && (buf[len - 1] == '\n' || buf[len - 1] == '\r')) {
+        len--;
+    }
+
+    idx->buf      = (const char *)buf;
+    idx->len      = len;
+    idx->count    = 0;
+    idx->start[0] = 1;
+
+    size_t star = 0;
+
+    for (size_t i = 1; i < len; i++) {
+        if (buf[i] == ',') {
+            if (idx->count >= NL_NMEA_MAX_FIELDS - 1) return -1;
+
+            idx->start[++idx->count] = i + 1;
+        } else if (buf[i] == '*') {
+            star = i;
+            break;
+        }
+    }
+
+    /* Exactly two hex digits after '*' */
+    if (star == 0 || star + 3 != len) return -1;
+
+    idx->start[++idx->count] = star + 1;
+
+    const int hi = nl_nmea_hex_value(buf[star + 1]);
+    const int lo = nl_nmea_hex_value(buf[star + 2]);
+    if (hi < 0 || lo < 0) return -1;
+
+    if (nl_nmea_checksum(&buf[1], star - 1) != ((hi << 4U) | lo)) return -2;
+
+    return 0;
+}
+
+void nl_nmea_index_rebase(nl_nmea_index_t *idx, const char *buf) {
+    idx->buf = buf;
+}
+
+bool nl_nmea_is(const nl_nmea_index_t *idx, const char *formatter) {
+    const char  *addr;
+    const size_t addr_len = nl_nmea_field(idx, 0, &addr);
+    const size_t fmt_len  = strlen(formatter);
+
+    if (addr_len != fmt_len + 2) return false;
+
+    return memcmp(&addr[2], formatter, fmt_len) == 0;
+}
+
+size_t nl_nmea_field(const nl_nmea_index_t *idx, uint8_t n, const char **str) {
+    if (n >= idx->count) return 0;
+
+    *str = &idx->buf[idx->start[n]];
+
+    return idx->start[n + 1] - 1 - idx->start[n];
+}
+
+int nl_nmea_field_char(const nl_nmea_index_t *idx, uint8_t n, char *val) {
+    const char *str;
+    if (nl_nmea_field(idx, n, &str) != 1) return -1;
+
+    *val = str[0];
+
+    return 0;
+}
+
+int nl_nmea_field_int(const nl_nmea_index_t *idx, uint8_t n, int32_t *val) {
+    const char *str;
+    size_t      len = nl_nmea_field(idx, n, &str);
+    bool        neg = false;
+
+    if (len > 0 && (str[0] == '-' || str[0] == '+')) {
+        neg = (str[0] == '-');
+
+        str++;
+        len--;
+    }
+
+    uint32_t v;
+    if (nl_nmea_parse_uint(str, len, &v) != 0) return -1;
+
+    *val = neg ? -(int32_t)v : (int32_t)v;
+
+    return 0;
+}
+
+int nl_nmea_field_double(const nl_nmea_index_t *idx, uint8_t n, double *val) {
+    const char *str;
+    size_t      len = nl_nmea_field(idx, n, &str);
+    bool        neg = false;
+
+    if (len > 0 && (str[0] == '-' || str[0] == '+')) {
+        neg = (str[0] == '-');
+
+        str++;
+        len--;
+    }
+
+    if (len == 0) return -1;
+
+    double   v       = 0.0;
+    double   scale   = 1.0;
+    bool     decimal = false;
+    uint32_t digits  = 0;
+
+    for (size_t i = 0; i < len; i++) {
+        if (str[i] == '.' && !decimal) {
+            decimal = true;
+            continue;
+        }
+
+        if (str[i] < '0' || str[i] > '9') return -1;
+
+        v = v * 10.0 + (str[i] - '0');
+        digits++;
+
+        if (decimal) scale *= 10.0;
+    }
+
+    if (digits == 0) return -1;
+
+    *val = neg ? -(v / scale) : (v / scale);
+
+    return 0;
+}
+
+int nl_nmea_field_latlon(const nl_nmea_index_t *idx, uint8_t n, double *deg) {
+    double value;
+    char   hemisphere;
+
+    if (nl_nmea_field_double(idx, n, &value) != 0) return -1;
+    if (nl_nmea_field_char(idx, n + 1, &hemisphere) != 0) return -1;
+
+    /* (d)ddmm.mmmm */
+    const double degrees = (double)(int32_t)(value / 100.0);
+    double       result  = degrees + (value - degrees * 100.0) / 60.0;
+
+    switch (hemisphere) {
+        case 'N':
+        case 'E':
+            break;
+        case 'S':
+        case 'W':
+            result = -result;
+            break;
+        default:
+            return -1;
+    }
+
+    *deg = result;
+
+    return 0;
+}
+
+int nl_nmea_field_time(const nl_nmea_index_t *idx, uint8_t n, nl_nmea_time_t *time) {
+    const char  *str;
+    const size_t len = nl_nmea_field(idx, n, &str);
+
+    /* hhmmss[.s...] */
+    if (len < 6) return -1;
+
+    uint32_t hh, mm, ss;
+    if (nl_nmea_parse_uint(&str[0], 2, &hh) != 0) return -1;
+    if (nl_nmea_parse_uint(&str[2], 2, &mm) != 0) return -1;
+    if (nl_nmea_parse_uint(&str[4], 2, &ss) != 0) return -1;
+
+    uint32_t ms = 0U;
+
+    if (len > 6) {
+        if (str[6] != '.') return -1;
+
+        uint32_t scale = 100U;
+        for (size_t i = 7; i < len && scale > 0; i++) {
+            if (str[i] < '0' || str[i] > '9') return -1;
+
+            ms += (str[i] - '0') * scale;
+            scale /= 10U;
+        }
+    }
+
+    if (hh > 23 || mm > 59 || ss > 60) return -1;
+
+    time->hour        = hh;
+    time->minute      = mm;
+    time->second      = ss;
+    time->millisecond = ms;
+
+    return 0;
+}
+
+int nl_nmea_field_date(const nl_nmea_index_t *idx, uint8_t n, nl_nmea_date_t *date) {
+    const char *str;
+
+    /* ddmmyy */
+    if (nl_nmea_field(idx, n, &str) != 6) return -1;
+
+    uint32_t dd, mm, yy;
+    if (nl_nmea_parse_uint(&str[0], 2, &dd) != 0) return -1;
+    if (nl_nmea_parse_uint(&str[2], 2, &mm) != 0) return -1;
+    if (nl_nmea_parse_uint(&str[4], 2, &yy) != 0) return -1;
+
+    if (dd == 0 || dd > 31 || mm == 0 || mm > 12) return -1;
+
+    date->day   = dd;
+    date->month = mm;
+    date->year  = 2000U + yy;
+
+    return 0;
+}
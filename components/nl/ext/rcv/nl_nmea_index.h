@@ -0,0 +1,58 @@
+#ifndef NL_NMEA_INDEX_H
+#define NL_NMEA_INDEX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define NL_NMEA_MAX_FIELDS (40)
+
+/**
+ * Comma-offset index over one NMEA sentence.
+ * Field 0 is the address ("GPGGA", "PAIR001"...), field i spans
+ * [start[i], start[i + 1] - 1). Nothing is decoded until a field accessor is called.
+ */
+typedef struct {
+    const char *buf; /* Sentence, starting at '$' */
+    uint16_t    len;
+    uint8_t     count;
+    uint16_t    start[NL_NMEA_MAX_FIELDS + 1];
+} nl_nmea_index_t;
+
+typedef struct {
+    uint8_t  hour;
+    uint8_t  minute;
+    uint8_t  second;
+    uint16_t millisecond;
+} nl_nmea_time_t;
+
+typedef struct {
+    uint16_t year;
+    uint8_t  month;
+    uint8_t  day;
+} nl_nmea_date_t;
+
+/**
+ * Index a sentence and verify its checksum.
+ * Returns 0 on success, -1 if malformed, -2 on checksum mismatch.
+ */
+int nl_nmea_index_build(nl_nmea_index_t *idx, const uint8_t *buf, size_t len);
+
+/* Rebase an index onto a copy of the sentence it was built from. */
+void nl_nmea_index_rebase(nl_nmea_index_t *idx, const char *buf);
+
+/* Compare the sentence formatter (address without talker), e.g. "GGA". */
+bool nl_nmea_is(const nl_nmea_index_t *idx, const char *formatter);
+
+/* Raw field access, returns the field length; 0 if the field is empty or missing. */
+size_t nl_nmea_field(const nl_nmea_index_t *idx, uint8_t n, const char **str);
+
+/* Decoding accessors, return 0 on success and -1 if the field is empty, missing or invalid. */
+int nl_nmea_field_char(const nl_nmea_index_t *idx, uint8_t n, char *val);
+int nl_nmea_field_int(const nl_nmea_index_t *idx, uint8_t n, int32_t *val);
+int nl_nmea_field_double(const nl_nmea_index_t *idx, uint8_t n, double *val);
+int nl_nmea_field_latlon(const nl_nmea_index_t *idx, uint8_t n, double *deg); /* Value in n, hemisphere in n + 1 */
+int nl_nmea_field_time(const nl_nmea_index_t *idx, uint8_t n, nl_nmea_time_t *time);
+int nl_nmea_field_date(const nl_nmea_index_t *idx, uint8_t n, nl_nmea_date_t *date);
+
+#endif  // NL_NMEA_INDEX_H
@@ -0,0 +1,59 @@
+#include <string.h>
+
+#include "rcv/nl_rawlog.h"
+
+static const uint8_t NL_RAWLOG_MAGIC[4] = {'N', 'L', 'R', 'W'};
+
+void nl_rawlog_file_header(uint8_t out[NL_RAWLOG_FILE_HEADER]) {
+    memset(out, 0U, NL_RAWLOG_FILE_HEADER);
+    memcpy(out, NL_RAWLOG_MAGIC, sizeof(NL_RAWLOG_MAGIC));
+
+    out[4] = NL_RAWLOG_VERSION;
+}
+
+void nl_rawlog_record_header(uint8_t out[NL_RAWLOG_RECORD_HEADER], uint32_t delta_us, uint16_t len, uint8_t flags) {
+    out[0] = delta_us;
+    out[1] = delta_us >> 8U;
+    out[2] = delta_us >> 16U;
+    out[3] = delta_us >> 24U;
+    out[4] = len;
+    out[5] = len >> 8U;
+    out[6] = flags;
+}
+
+int nl_rawlog_reader_open(nl_rawlog_reader_t *reader, FILE *fp) {
+    uint8_t header[NL_RAWLOG_FILE_HEADER];
+
+    memset(reader, 0U, sizeof(nl_rawlog_reader_t));
+
+    if (fread(header, 1, sizeof(header), fp) != sizeof(header)) return -1;
+    if (memcmp(header, NL_RAWLOG_MAGIC, sizeof(NL_RAWLOG_MAGIC)) != 0) return -1;
+    if (header[4] != NL_RAWLOG_VERSION) return -1;
+
+    reader->fp = fp;
+
+    return 0;
+}
+
+int nl_rawlog_reader_next(nl_rawlog_reader_t *reader, uint8_t *buf, uint8_t *flags) {
+    uint8_t header[NL_RAWLOG_RECORD_HEADER];
+
+    const size_t got = fread(header, 1, sizeof(header), reader->fp);
+    if (got == 0) return -1;
+    if (got != sizeof(header)) return -2;
+
+    const uint32_t delta_us = (uint32_t)header[0] | ((uint32_t)header[1] << 8U) | ((uint32_t)header[2] << 16U) |
+                              ((uint32_t)header[3] << 24U);
+    const uint16_t len      = (uint16_t)(header[4] | (header[5] << 8U));
+
+    if (len > NL_RAWLOG_CHUNK_MAX) return -2;
+    if (len > 0 && fread(buf, 1, len, reader->fp) != len) return -2;
+
+    /* The first record starts the timeline */
+    reader->time_us += (reader->records > 0) ? delta_us : 0;
+    reader->records++;
+
+    *flags = header[6];
+
+    return len;
+}
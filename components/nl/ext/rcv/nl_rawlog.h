@@ -0,0 +1,43 @@
+#ifndef NL_RAWLOG_H
+#define NL_RAWLOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Raw receiver stream recording: an 8-byte file header ("NLRW", version, 3 reserved bytes) followed by records of
+ * a 7-byte little-endian header (delta time in us since the previous record, payload length, flags) and the payload
+ * bytes exactly as they came off the receiver port. Only stdio is used, recordings replay the same on target and
+ * on a host.
+ */
+
+#define NL_RAWLOG_VERSION       (1)
+#define NL_RAWLOG_FILE_HEADER   (8)
+#define NL_RAWLOG_RECORD_HEADER (7)
+#define NL_RAWLOG_CHUNK_MAX     (1024) /* Largest payload of one record, writers split longer chunks */
+
+typedef enum {
+    NL_RAWLOG_IDLE = 1 << 0U, /* The port went idle after this record, payload may be empty */
+} nl_rawlog_flags_t;
+
+typedef struct {
+    FILE    *fp;
+    uint64_t time_us; /* Recording time of the last record read, relative to the first one */
+    uint32_t records;
+} nl_rawlog_reader_t;
+
+void nl_rawlog_file_header(uint8_t out[NL_RAWLOG_FILE_HEADER]);
+void nl_rawlog_record_header(uint8_t out[NL_RAWLOG_RECORD_HEADER], uint32_t delta_us, uint16_t len, uint8_t flags);
+
+/* Returns 0 on success, -1 if the stream does not start with a supported file header. */
+int nl_rawlog_reader_open(nl_rawlog_reader_t *reader, FILE *fp);
+
+/**
+ * Read the next record into buf, which must hold NL_RAWLOG_CHUNK_MAX bytes.
+ * Returns the payload length, -1 at the end of the recording, -2 on a truncated or corrupt record.
+ */
+int nl_rawlog_reader_next(nl_rawlog_reader_t *reader, uint8_t *buf, uint8_t *flags);
+
+#endif  // NL_RAWLOG_H
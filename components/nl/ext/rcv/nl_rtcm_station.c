@@ -0,0 +1,125 @@
+#include <math.h>
+#include <string.h>
+
+#include "rcv/nl_crc24q.h"
+#include "rcv/nl_rtcm_station.h"
+
+#define NL_RTCM_STATION_ARP_BITS   (152)       /* 1005 payload, 1006 adds the 16-bit height */
+#define NL_RTCM_STATION_ECEF_SCALE (10000.0)   /* DF025-DF027, 0.0001 m */
+#define NL_RTCM_STATION_ECEF_LIMIT (1LL << 37) /* 38-bit signed */
+#define NL_RTCM_STATION_HEIGHT_MAX (65535)     /* DF028, 0.0001 m */
+
+static void nl_rtcm_station_setbitu(uint8_t *buf, size_t pos, uint8_t len, uint64_t val) {
+    for (size_t i = pos; i < pos + len; i++) {
+        const uint8_t mask = 1U << (7U - (i & 7U));
+        const bool    bit  = (val >> (len - 1U - (i - pos))) & 1U;
+
+        if (bit) {
+            buf[i >> 3U] |= mask;
+        } else {
+            buf[i >> 3U] &= ~mask;
+        }
+    }
+}
+
+static void nl_rtcm_station_setbits(uint8_t *buf, size_t pos, uint8_t len, int64_t val) {
+    nl_rtcm_station_setbitu(buf, pos, len, (uint64_t)val & ((1ULL << len) - 1U));
+}
+
+/* Frame header and CRC around a payload already written at out + 3 */
+static int nl_rtcm_station_frame(uint8_t *out, size_t payload_len) {
+    out[0] = 0xD3;
+    out[1] = (payload_len >> 8U) & 0x03U;
+    out[2] = payload_len & 0xFFU;
+
+    const uint32_t crc = nl_crc24q(out, payload_len + 3);
+
+    out[payload_len + 3] = (crc >> 16U) & 0xFFU;
+    out[payload_len + 4] = (crc >> 8U) & 0xFFU;
+    out[payload_len + 5] = crc & 0xFFU;
+
+    return (int)(payload_len + 6);
+}
+
+/* Count-prefixed string (DF029/DF030 and alike), returns the new bit position */
+static size_t nl_rtcm_station_setstr(uint8_t *buf, size_t pos, const char *str) {
+    size_t len = (str != NULL) ? strlen(str) : 0;
+    if (len > NL_RTCM_STATION_DESC_MAX) len = NL_RTCM_STATION_DESC_MAX;
+
+    nl_rtcm_station_setbitu(buf, pos, 8, len);
+    pos += 8;
+
+    for (size_t i = 0; i < len; i++) {
+        nl_rtcm_station_setbitu(buf, pos, 8, (uint8_t)str[i]);
+        pos += 8;
+    }
+
+    return pos;
+}
+
+int nl_rtcm_arp_encode(const nl_rtcm_arp_t *arp, bool with_height, uint8_t *out, size_t out_size) {
+    const size_t bits        = NL_RTCM_STATION_ARP_BITS + (with_height ? 16U : 0U);
+    const size_t payload_len = bits / 8U;
+
+    if (payload_len + 6 > out_size) return -1;
+
+    int64_t ecef[3];
+    for (uint8_t i = 0; i < 3; i++) {
+        ecef[i] = llround(arp->ecef[i] * NL_RTCM_STATION_ECEF_SCALE);
+        if (ecef[i] <= -NL_RTCM_STATION_ECEF_LIMIT || ecef[i] >= NL_RTCM_STATION_ECEF_LIMIT) return -1;
+    }
+
+    long height = lround(arp->antenna_height * NL_RTCM_STATION_ECEF_SCALE);
+    if (height < 0) height = 0;
+    if (height > NL_RTCM_STATION_HEIGHT_MAX) height = NL_RTCM_STATION_HEIGHT_MAX;
+
+    memset(out, 0U, payload_len + 6);
+
+    uint8_t *p = &out[3];
+
+    nl_rtcm_station_setbitu(p, 0, 12, with_height ? 1006 : 1005);
+    nl_rtcm_station_setbitu(p, 12, 12, arp->station_id);
+    nl_rtcm_station_setbitu(p, 24, 6, arp->itrf_year);
+    nl_rtcm_station_setbitu(p, 30, 1, arp->gps);
+    nl_rtcm_station_setbitu(p, 31, 1, arp->glonass);
+    nl_rtcm_station_setbitu(p, 32, 1, arp->galileo);
+    nl_rtcm_station_setbitu(p, 33, 1, 0); /* DF141, physical reference station */
+    nl_rtcm_station_setbits(p, 34, 38, ecef[0]);
+    nl_rtcm_station_setbitu(p, 72, 1, 0); /* DF142, single receiver oscillator not claimed */
+    nl_rtcm_station_setbitu(p, 73, 1, 0); /* Reserved */
+    nl_rtcm_station_setbits(p, 74, 38, ecef[1]);
+    nl_rtcm_station_setbitu(p, 112, 2, 0); /* DF364, quarter cycle indicator not specified */
+    nl_rtcm_station_setbits(p, 114, 38, ecef[2]);
+
+    if (with_height) {
+        nl_rtcm_station_setbitu(p, 152, 16, (uint64_t)height);
+    }
+
+    return nl_rtcm_station_frame(out, payload_len);
+}
+
+int nl_rtcm_descriptor_encode(const nl_rtcm_descriptor_t *desc, uint8_t *out, size_t out_size) {
+    const char *strings[] = {desc->antenna_serial, desc->receiver, desc->receiver_firmware, desc->receiver_serial};
+
+    /* Worst case first, the exact length is only known once written */
+    if (out_size < NL_RTCM_STATION_1033_MAX) return -1;
+
+    memset(out, 0U, NL_RTCM_STATION_1033_MAX);
+
+    uint8_t *p   = &out[3];
+    size_t   pos = 0;
+
+    nl_rtcm_station_setbitu(p, pos, 12, 1033);
+    nl_rtcm_station_setbitu(p, pos + 12, 12, desc->station_id);
+    pos += 24;
+
+    pos = nl_rtcm_station_setstr(p, pos, desc->antenna);
+    nl_rtcm_station_setbitu(p, pos, 8, desc->antenna_setup_id);
+    pos += 8;
+
+    for (size_t i = 0; i < sizeof(strings) / sizeof(strings[0]); i++) {
+        pos = nl_rtcm_station_setstr(p, pos, strings[i]);
+    }
+
+    return nl_rtcm_station_frame(out, pos / 8U);
+}
@@ -0,0 +1,46 @@
+#ifndef NL_RTCM_STATION_H
+#define NL_RTCM_STATION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define NL_RTCM_STATION_DESC_MAX  (31)          /* Longest descriptor string of 1033 */
+#define NL_RTCM_STATION_1006_SIZE (3 + 21 + 3)  /* Complete 1006 frame, 1005 is 2 bytes shorter */
+#define NL_RTCM_STATION_1033_MAX  (3 + 164 + 3) /* Complete 1033 frame with every string at its maximum */
+
+/* Stationary antenna reference point, message 1005, or 1006 with the antenna height. */
+typedef struct {
+    uint16_t station_id;     /* DF003, 0-4095 */
+    uint8_t  itrf_year;      /* DF021, 0 if not specified */
+    bool     gps;            /* DF022-DF024, constellations the station provides */
+    bool     glonass;
+    bool     galileo;
+    double   ecef[3];        /* ARP in meters, 0.1 mm resolution on the wire */
+    double   antenna_height; /* DF028, meters above the marker, 1006 only */
+} nl_rtcm_arp_t;
+
+/* Antenna and receiver descriptors, message 1033. Strings longer than NL_RTCM_STATION_DESC_MAX are truncated. */
+typedef struct {
+    uint16_t    station_id;
+    const char *antenna;          /* IGS antenna name, e.g. "TRM59800.00     NONE" */
+    uint8_t     antenna_setup_id; /* 0 for the standard setup */
+    const char *antenna_serial;
+    const char *receiver;
+    const char *receiver_firmware;
+    const char *receiver_serial;
+} nl_rtcm_descriptor_t;
+
+/**
+ * Encode 1005, or 1006 when with_height is set, into a complete frame with CRC.
+ * Returns the frame length, -1 if a coordinate does not fit its field or out is too small.
+ */
+int nl_rtcm_arp_encode(const nl_rtcm_arp_t *arp, bool with_height, uint8_t *out, size_t out_size);
+
+/**
+ * Encode 1033 into a complete frame with CRC. NULL strings are sent empty.
+ * Returns the frame length, -1 if out is too small.
+ */
+int nl_rtcm_descriptor_encode(const nl_rtcm_descriptor_t *desc, uint8_t *out, size_t out_size);
+
+#endif  // NL_RTCM_STATION_H
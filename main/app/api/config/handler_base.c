@@ -0,0 +1,260 @@
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/* IDF */
+#include "esp_http_server.h"
+#include "esp_log.h"
+
+/* cJSON */
+#include "cJSON.h"
+
+/* App */
+#include "app/api/config/handler_base.h"
+#include "app/base_server.h"
+
+#define APP_HANDLER_BASE_MAXIMUM_PAYLOAD_SIZE 256
+
+/* Indexed by app_base_survey_state_t */
+static const char *s_app_handler_base_survey_states[] = {"idle", "running", "done", "failed"};
+
+static cJSON *app_api_config_handler_base_ecef(const double ecef[3]) {
+    cJSON *root = cJSON_CreateArray();
+    if (root == NULL) return NULL;
+
+    for (uint8_t i = 0; i < 3; i++) {
+        cJSON *item = cJSON_CreateNumber(ecef[i]);
+        if (item == NULL) {
+            cJSON_Delete(root);
+            return NULL;
+        }
+        cJSON_AddItemToArray(root, item);
+    }
+
+    return root;
+}
+
+static char *app_api_config_handler_base_serialize(const app_base_survey_status_t *status,
+                                                   const app_base_position_t      *position) {
+    char *ret = NULL;
+
+    cJSON *root = cJSON_CreateObject();
+    if (root == NULL) return NULL;
+
+    /* ---- Survey-in progress ---- */
+    cJSON *root_survey = cJSON_CreateObject();
+    if (root_survey == NULL) goto del_root_exit;
+    cJSON_AddItemToObject(root, "survey", root_survey);
+
+    cJSON *root_survey_state = cJSON_CreateString(s_app_handler_base_survey_states[status->state]);
+    if (root_survey_state == NULL) goto del_root_exit;
+    cJSON_AddItemToObject(root_survey, "state", root_survey_state);
+
+    cJSON *root_survey_samples = cJSON_CreateNumber(status->samples);
+    if (root_survey_samples == NULL) goto del_root_exit;
+    cJSON_AddItemToObject(root_survey, "samples", root_survey_samples);
+
+    cJSON *root_survey_elapsed = cJSON_CreateNumber(status->elapsed_s);
+    if (root_survey_elapsed == NULL) goto del_root_exit;
+    cJSON_AddItemToObject(root_survey, "elapsed_s", root_survey_elapsed);
+
+    cJSON *root_survey_accuracy =
+        (status->accuracy_mm != UINT32_MAX) ? cJSON_CreateNumber(status->accuracy_mm) : cJSON_CreateNull();
+    if (root_survey_accuracy == NULL) goto del_root_exit;
+    cJSON_AddItemToObject(root_survey, "accuracy_mm", root_survey_accuracy);
+
+    cJSON *root_survey_ecef = app_api_config_handler_base_ecef(status->ecef);
+    if (root_survey_ecef == NULL) goto del_root_exit;
+    cJSON_AddItemToObject(root_survey, "ecef", root_survey_ecef);
+
+    /* ---- Stored position ---- */
+    cJSON *root_position = cJSON_CreateObject();
+    if (root_position == NULL) goto del_root_exit;
+    cJSON_AddItemToObject(root, "position", root_position);
+
+    cJSON *root_position_valid = cJSON_CreateBool(position->valid);
+    if (root_position_valid == NULL) goto del_root_exit;
+    cJSON_AddItemToObject(root_position, "valid", root_position_valid);
+
+    if (position->valid) {
+        cJSON *root_position_ecef = app_api_config_handler_base_ecef(position->ecef);
+        if (root_position_ecef == NULL) goto del_root_exit;
+        cJSON_AddItemToObject(root_position, "ecef", root_position_ecef);
+
+        cJSON *root_position_accuracy = cJSON_CreateNumber(position->accuracy_mm);
+        if (root_position_accuracy == NULL) goto del_root_exit;
+        cJSON_AddItemToObject(root_position, "accuracy_mm", root_position_accuracy);
+
+        cJSON *root_position_samples = cJSON_CreateNumber(position->samples);
+        if (root_position_samples == NULL) goto del_root_exit;
+        cJSON_AddItemToObject(root_position, "samples", root_position_samples);
+    }
+
+    ret = cJSON_PrintUnformatted(root);
+
+del_root_exit:
+    cJSON_Delete(root);
+    return ret;
+}
+
+/* Whole number in min..max, anything else is a bad request */
+static bool app_api_config_handler_base_uint(const cJSON *item, uint32_t min, uint32_t max, uint32_t *value) {
+    if (!cJSON_IsNumber(item)) return false;
+
+    const double number = cJSON_GetNumberValue(item);
+    if (!(number >= (double)min && number <= (double)max) || number != (double)(uint32_t)number) return false;
+
+    *value = (uint32_t)number;
+
+    return true;
+}
+
+/**
+ * {"action": "start", "min_duration_s": 300, "max_duration_s": 0, "accuracy_mm": 2000} starts a survey-in, members
+ * left out take the defaults. {"action": "stop"} aborts it, {"ecef": [x, y, z]} stores a known position.
+ * Returns -1 for a malformed request or values out of range.
+ */
+static int app_api_config_handler_base_apply(const char *json) {
+    int ret = -1;
+
+    cJSON *j = cJSON_Parse(json);
+    if (j == NULL) {
+        return -1;
+    }
+
+    cJSON *root_ecef = cJSON_GetObjectItem(j, "ecef");
+    if (root_ecef != NULL) {
+        if (!cJSON_IsArray(root_ecef) || cJSON_GetArraySize(root_ecef) != 3) goto del_json_exit;
+
+        app_base_position_t position = {0};
+        for (uint8_t i = 0; i < 3; i++) {
+            cJSON *item = cJSON_GetArrayItem(root_ecef, i);
+            if (!cJSON_IsNumber(item)) goto del_json_exit;
+            position.ecef[i] = cJSON_GetNumberValue(item);
+        }
+
+        ret = app_base_server_position_set(&position);
+        goto del_json_exit;
+    }
+
+    cJSON *root_action = cJSON_GetObjectItem(j, "action");
+    if (!cJSON_IsString(root_action)) goto del_json_exit;
+
+    if (strcmp(cJSON_GetStringValue(root_action), "stop") == 0) {
+        app_base_server_survey_stop();
+        ret = 0;
+    } else if (strcmp(cJSON_GetStringValue(root_action), "start") == 0) {
+        app_base_survey_config_t config;
+        app_base_server_survey_config_init(&config);
+
+        cJSON *root_min_duration = cJSON_GetObjectItem(j, "min_duration_s");
+        if (root_min_duration != NULL) {
+            if (!app_api_config_handler_base_uint(root_min_duration, 1, APP_BASE_SURVEY_DURATION_MAX,
+                                                  &config.min_duration_s))
+                goto del_json_exit;
+        }
+
+        cJSON *root_max_duration = cJSON_GetObjectItem(j, "max_duration_s");
+        if (root_max_duration != NULL) {
+            if (!app_api_config_handler_base_uint(root_max_duration, 0, APP_BASE_SURVEY_DURATION_MAX,
+                                                  &config.max_duration_s))
+                goto del_json_exit;
+        }
+
+        cJSON *root_accuracy = cJSON_GetObjectItem(j, "accuracy_mm");
+        if (root_accuracy != NULL) {
+            if (!app_api_config_handler_base_uint(root_accuracy, 1, APP_BASE_SURVEY_ACCURACY_MAX, &config.accuracy_mm))
+                goto del_json_exit;
+        }
+
+        ret = app_base_server_survey_start(&config);
+    }
+
+del_json_exit:
+    cJSON_Delete(j);
+
+    return ret;
+}
+
+static esp_err_t app_api_config_handler_base_get(httpd_req_t *req) {
+    app_base_survey_status_t status;
+    app_base_position_t      position;
+
+    app_base_server_survey_status_get(&status);
+    if (app_base_server_position_get(&position) != 0) {
+        position.valid = false;
+    }
+
+    char *json = app_api_config_handler_base_serialize(&status, &position);
+    if (json == NULL) {
+        goto send_500;
+    }
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, json, HTTPD_RESP_USE_STRLEN);
+
+    cJSON_free(json);
+    return ESP_OK;
+
+send_500:
+    httpd_resp_set_status(req, "500 Internal Server Error");
+    httpd_resp_send(req, "{}", HTTPD_RESP_USE_STRLEN);
+
+    return ESP_FAIL;
+}
+
+static esp_err_t app_api_config_handler_base_post(httpd_req_t *req) {
+    size_t payload_size = req->content_len;
+    if (payload_size > APP_HANDLER_BASE_MAXIMUM_PAYLOAD_SIZE) {
+        payload_size = APP_HANDLER_BASE_MAXIMUM_PAYLOAD_SIZE;
+    }
+
+    char *payload = malloc(payload_size + 1);
+    if (payload == NULL) goto send_500;
+
+    int ret = httpd_req_recv(req, payload, payload_size);
+    if (ret < 0) goto free_buf_send_500;
+
+    payload[ret] = '\0';
+
+    ret = app_api_config_handler_base_apply(payload);
+    free(payload);
+
+    if (ret == -1) goto send_400;
+    if (ret != 0) goto send_500;
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, "{}", HTTPD_RESP_USE_STRLEN);
+
+    return ESP_OK;
+
+send_400:
+    httpd_resp_set_status(req, "400 Bad Request");
+    httpd_resp_send(req, "{}", HTTPD_RESP_USE_STRLEN);
+
+    return ESP_FAIL;
+
+free_buf_send_500:
+    free(payload);
+
+send_500:
+    httpd_resp_set_status(req, "500 Internal Server Error");
+    httpd_resp_send(req, "{}", HTTPD_RESP_USE_STRLEN);
+
+    return ESP_FAIL;
+}
+
+const httpd_uri_t app_api_config_handler_base_get_uri = {
+    .uri      = "/api/config/base",
+    .method   = HTTP_GET,
+    .handler  = app_api_config_handler_base_get,
+    .user_ctx = NULL,
+};
+
+const httpd_uri_t app_api_config_handler_base_post_uri = {
+    .uri      = "/api/config/base",
+    .method   = HTTP_POST,
+    .handler  = app_api_config_handler_base_post,
+    .user_ctx = NULL,
+};
@@ -0,0 +1,260 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/* IDF */
+#include "esp_http_server.h"
+#include "esp_log.h"
+
+/* cJSON */
+#include "cJSON.h"
+
+/* App */
+#include "app/api/config/handler_gnss.h"
+#include "app/gnss_server.h"
+
+#define APP_HANDLER_GNSS_MAXIMUM_PAYLOAD_SIZE 512
+
+/* JSON keys of the constellation object, indexed by app_gnss_constellation_t */
+static const char *s_app_handler_gnss_constellations[] = {
+    NULL, "gps", "glonass", "galileo", "beidou", "qzss", "navic",
+};
+
+static char *app_api_config_handler_gnss_serialize(const app_gnss_server_config_t *config) {
+    char *ret = NULL;
+
+    cJSON *root = cJSON_CreateObject();
+    if (root == NULL) return NULL;
+
+    cJSON *root_fix_interval = cJSON_CreateNumber(config->fix_interval_ms);
+    if (root_fix_interval == NULL) goto del_root_exit;
+    cJSON_AddItemToObject(root, "fix_interval_ms", root_fix_interval);
+
+    cJSON *root_constellations = cJSON_CreateObject();
+    if (root_constellations == NULL) goto del_root_exit;
+    cJSON_AddItemToObject(root, "constellations", root_constellations);
+
+    for (uint8_t i = APP_GNSS_CONSTELLATION_GPS; i <= APP_GNSS_CONSTELLATION_NAVIC; i++) {
+        cJSON *item = cJSON_CreateBool(config->constellations & APP_GNSS_CONSTELLATION_BIT(i));
+        if (item == NULL) goto del_root_exit;
+        cJSON_AddItemToObject(root_constellations, s_app_handler_gnss_constellations[i], item);
+    }
+
+    cJSON *root_nmea_rate = cJSON_CreateObject();
+    if (root_nmea_rate == NULL) goto del_root_exit;
+    cJSON_AddItemToObject(root, "nmea_rate", root_nmea_rate);
+
+    for (uint8_t i = 0; i < APP_GNSS_NMEA_COUNT; i++) {
+        cJSON *item = cJSON_CreateNumber(config->nmea_rate[i]);
+        if (item == NULL) goto del_root_exit;
+        cJSON_AddItemToObject(root_nmea_rate, app_gnss_server_nmea_name(i), item);
+    }
+
+    cJSON *root_rtcm = cJSON_CreateObject();
+    if (root_rtcm == NULL) goto del_root_exit;
+    cJSON_AddItemToObject(root, "rtcm", root_rtcm);
+
+    cJSON *root_rtcm_msm = cJSON_CreateNumber(config->rtcm_msm);
+    if (root_rtcm_msm == NULL) goto del_root_exit;
+    cJSON_AddItemToObject(root_rtcm, "msm", root_rtcm_msm);
+
+    cJSON *root_rtcm_station = cJSON_CreateBool(config->rtcm_station);
+    if (root_rtcm_station == NULL) goto del_root_exit;
+    cJSON_AddItemToObject(root_rtcm, "station", root_rtcm_station);
+
+    cJSON *root_rtcm_ephemeris = cJSON_CreateBool(config->rtcm_ephemeris);
+    if (root_rtcm_ephemeris == NULL) goto del_root_exit;
+    cJSON_AddItemToObject(root_rtcm, "ephemeris", root_rtcm_ephemeris);
+
+    ret = cJSON_PrintUnformatted(root);
+
+del_root_exit:
+    cJSON_Delete(root);
+    return ret;
+}
+
+/* JSON numbers are doubles: only whole numbers from 0 to max pass, so the narrowing cast cannot wrap or truncate. */
+static bool app_api_config_handler_gnss_uint(const cJSON *item, uint32_t max, uint32_t *value) {
+    if (!cJSON_IsNumber(item)) return false;
+
+    const double number = cJSON_GetNumberValue(item);
+    if (!(number >= 0.0 && number <= (double)max) || number != (double)(uint32_t)number) return false;
+
+    *value = (uint32_t)number;
+
+    return true;
+}
+
+/**
+ * Members missing from the request keep their current value, so a client can change a single sentence rate.
+ * Returns -1 for malformed JSON or a member of the wrong type or out of its field's range.
+ */
+static int app_api_config_handler_gnss_deserialize(const char *json, app_gnss_server_config_t *cfg) {
+    cJSON *j = cJSON_Parse(json);
+    if (j == NULL) {
+        return -1;
+    }
+
+    uint32_t value;
+
+    cJSON *root_fix_interval = cJSON_GetObjectItem(j, "fix_interval_ms");
+    if (root_fix_interval != NULL) {
+        if (!app_api_config_handler_gnss_uint(root_fix_interval, UINT16_MAX, &value)) goto del_json_exit;
+        cfg->fix_interval_ms = (uint16_t)value;
+    }
+
+    cJSON *root_constellations = cJSON_GetObjectItem(j, "constellations");
+    if (root_constellations != NULL) {
+        if (!cJSON_IsObject(root_constellations)) goto del_json_exit;
+
+        for (uint8_t i = APP_GNSS_CONSTELLATION_GPS; i <= APP_GNSS_CONSTELLATION_NAVIC; i++) {
+            cJSON *item = cJSON_GetObjectItem(root_constellations, s_app_handler_gnss_constellations[i]);
+            if (item == NULL) continue;
+            if (!cJSON_IsBool(item)) goto del_json_exit;
+
+            if (cJSON_IsTrue(item)) {
+                cfg->constellations |= APP_GNSS_CONSTELLATION_BIT(i);
+            } else {
+                cfg->constellations &= ~APP_GNSS_CONSTELLATION_BIT(i);
+            }
+        }
+    }
+
+    cJSON *root_nmea_rate = cJSON_GetObjectItem(j, "nmea_rate");
+    if (root_nmea_rate != NULL) {
+        if (!cJSON_IsObject(root_nmea_rate)) goto del_json_exit;
+
+        for (uint8_t i = 0; i < APP_GNSS_NMEA_COUNT; i++) {
+            cJSON *item = cJSON_GetObjectItem(root_nmea_rate, app_gnss_server_nmea_name(i));
+            if (item == NULL) continue;
+            if (!app_api_config_handler_gnss_uint(item, UINT8_MAX, &value)) goto del_json_exit;
+
+            cfg->nmea_rate[i] = (uint8_t)value;
+        }
+    }
+
+    cJSON *root_rtcm = cJSON_GetObjectItem(j, "rtcm");
+    if (root_rtcm != NULL) {
+        if (!cJSON_IsObject(root_rtcm)) goto del_json_exit;
+
+        cJSON *root_rtcm_msm = cJSON_GetObjectItem(root_rtcm, "msm");
+        if (root_rtcm_msm != NULL) {
+            if (!app_api_config_handler_gnss_uint(root_rtcm_msm, UINT8_MAX, &value)) goto del_json_exit;
+            cfg->rtcm_msm = (uint8_t)value;
+        }
+
+        cJSON *root_rtcm_station = cJSON_GetObjectItem(root_rtcm, "station");
+        if (root_rtcm_station != NULL) {
+            if (!cJSON_IsBool(root_rtcm_station)) goto del_json_exit;
+            cfg->rtcm_station = cJSON_IsTrue(root_rtcm_station);
+        }
+
+        cJSON *root_rtcm_ephemeris = cJSON_GetObjectItem(root_rtcm, "ephemeris");
+        if (root_rtcm_ephemeris != NULL) {
+            if (!cJSON_IsBool(root_rtcm_ephemeris)) goto del_json_exit;
+            cfg->rtcm_ephemeris = cJSON_IsTrue(root_rtcm_ephemeris);
+        }
+    }
+
+    cJSON_Delete(j);
+
+    return 0;
+
+del_json_exit:
+    cJSON_Delete(j);
+
+    return -1;
+}
+
+static esp_err_t app_api_config_handler_gnss_get(httpd_req_t *req) {
+    app_gnss_server_config_t gnss_config;
+
+    if (app_gnss_server_config_get(&gnss_config) != 0) {
+        goto send_500;
+    }
+
+    char *json = app_api_config_handler_gnss_serialize(&gnss_config);
+    if (json == NULL) {
+        goto send_500;
+    }
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, json, HTTPD_RESP_USE_STRLEN);
+
+    cJSON_free(json);
+    return ESP_OK;
+
+send_500:
+    httpd_resp_set_status(req, "500 Internal Server Error");
+    httpd_resp_send(req, "{}", HTTPD_RESP_USE_STRLEN);
+
+    return ESP_FAIL;
+}
+
+static esp_err_t app_api_config_handler_gnss_post(httpd_req_t *req) {
+    app_gnss_server_config_t gnss_config;
+
+    size_t payload_size = req->content_len;
+    if (payload_size > APP_HANDLER_GNSS_MAXIMUM_PAYLOAD_SIZE) {
+        payload_size = APP_HANDLER_GNSS_MAXIMUM_PAYLOAD_SIZE;
+    }
+
+    char *payload = malloc(payload_size + 1);
+    if (payload == NULL) goto send_500;
+
+    int ret = httpd_req_recv(req, payload, payload_size);
+    if (ret < 0) goto free_buf_send_500;
+
+    payload[ret] = '\0';
+
+    if (app_gnss_server_config_get(&gnss_config) != 0) {
+        app_gnss_server_config_init(&gnss_config);
+    }
+
+    ret = app_api_config_handler_gnss_deserialize(payload, &gnss_config);
+    free(payload);
+
+    if (ret != 0) goto send_400;
+
+    /* Applying waits for the module to acknowledge every command, -1 is a value out of range */
+    ret = app_gnss_server_config_set(&gnss_config);
+    if (ret == -1) goto send_400;
+    if (ret != 0) goto send_500;
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, "{}", HTTPD_RESP_USE_STRLEN);
+
+    return ESP_OK;
+
+send_400:
+    httpd_resp_set_status(req, "400 Bad Request");
+    httpd_resp_send(req, "{}", HTTPD_RESP_USE_STRLEN);
+
+    return ESP_FAIL;
+
+free_buf_send_500:
+    free(payload);
+
+send_500:
+    httpd_resp_set_status(req, "500 Internal Server Error");
+    httpd_resp_send(req, "{}", HTTPD_RESP_USE_STRLEN);
+
+    return ESP_FAIL;
+}
+
+const httpd_uri_t app_api_config_handler_gnss_get_uri = {
+    .uri      = "/api/config/gnss",
+    .method   = HTTP_GET,
+    .handler  = app_api_config_handler_gnss_get,
+    .user_ctx = NULL,
+};
+
+const httpd_uri_t app_api_config_handler_gnss_post_uri = {
+    .uri      = "/api/config/gnss",
+    .method   = HTTP_POST,
+    .handler  = app_api_config_handler_gnss_post,
+    .user_ctx = NULL,
+};
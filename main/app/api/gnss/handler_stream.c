@@ -1,90 +1,138 @@
-#include "freertos/FreeRTOS.h"
-#include "freertos/list.h"
-#include "freertos/task.h"
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
 
 /* IDF */
 #include "esp_http_server.h"
 #include "esp_log.h"
-
-/* cJSON */
-#include "cJSON.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 
 /* App */
 #include "app/api/gnss/handler_stream.h"
-
-typedef struct app_ws_client_s {
-    httpd_handle_t handle;
-} app_ws_client_t;
+#include "app/gnss_server.h"
+
+#define APP_WS_STREAM_QUEUE_MAX   (4)    /* Messages per client, two epochs of fix and satellites */
+#define APP_WS_STREAM_MESSAGE_MAX (2048) /* Satellites of a full sky */
+
+/* One JSON text frame, shared by every client it is queued for and freed by the last one. */
+typedef struct {
+    atomic_uint refs;
+    size_t      len;
+    char        data[];
+} app_ws_message_t;
+
+typedef struct {
+    int               fd;       /* Socket of the client, -1 if the slot is free */
+    app_ws_message_t *inflight; /* Handed to httpd, released by the completion callback */
+    app_ws_message_t *queue[APP_WS_STREAM_QUEUE_MAX];
+    uint8_t           queue_head;
+    uint8_t           queue_count;
+    uint32_t          dropped;
+} app_ws_session_t;
+
+typedef struct {
+    SemaphoreHandle_t    mutex; /* Sessions */
+    TaskHandle_t         sender_task;
+    httpd_handle_t       server;
+    app_gnss_cb_handle_t gnss_cb_handle; /* Only registered while clients are connected, httpd task only */
+
+    app_ws_session_t sessions[CONFIG_APP_API_GNSS_STREAM_MAX_CLIENTS];
+    uint8_t          session_count;
+
+    char buf[APP_WS_STREAM_MESSAGE_MAX]; /* Message under construction, GNSS callback task only */
+} app_ws_stream_state_t;
 
 static const char *LOG_TAG = "asuna_gstream";
 
-static List_t s_app_ws_client_list;
+static app_ws_stream_state_t s_app_ws_stream_state;
 
-static int app_ws_client_list_add(httpd_handle_t handle) {
-    ListItem_t *item = malloc(sizeof(ListItem_t));
-    if (item == NULL) {
-        return -1;
+static int               app_ws_stream_gnss_cb(void *handle, app_gnss_cb_type_t type, void *payload);
+static size_t            app_ws_stream_fix_format(char *buf, size_t size, const app_gnss_fix_t *fix);
+static size_t            app_ws_stream_sat_format(char *buf, size_t size, const app_gnss_sat_t *sat);
+static void              app_ws_stream_publish(app_ws_stream_state_t *state, const char *data, size_t len);
+static void              app_ws_stream_sender_task(void *parameters);
+static void              app_ws_stream_send_done(esp_err_t err, int socket, void *arg);
+static app_ws_session_t *app_ws_session_find(app_ws_stream_state_t *state, int fd);
+static void              app_ws_session_release(app_ws_session_t *session);
+static void              app_ws_message_release(app_ws_message_t *message);
+
+static int app_ws_session_add(httpd_req_t *req) {
+    app_ws_stream_state_t *state = &s_app_ws_stream_state;
+
+    const int fd = httpd_req_to_sockfd(req);
+
+    xSemaphoreTake(state->mutex, portMAX_DELAY);
+
+    app_ws_session_t *session = app_ws_session_find(state, fd);
+    if (session == NULL) {
+        session = app_ws_session_find(state, -1);
+
+        if (session != NULL) {
+            memset(session, 0U, sizeof(app_ws_session_t));
+            session->fd = fd;
+            state->session_count++;
+        }
     }
 
-    vListInitialiseItem(item);
+    state->server = req->handle;
+
+    xSemaphoreGive(state->mutex);
 
-    app_ws_client_t *client = malloc(sizeof(app_ws_client_t));
-    if (client == NULL) {
-        free(item);
+    if (session == NULL) {
+        ESP_LOGW(LOG_TAG, "No free stream slot, rejecting client, fd=%d", fd);
 
-        return -2;
+        return -1;
     }
 
-    client->handle = handle;
+    /* The callback only exists while someone watches, so idle streaming costs the parser nothing */
+    if (state->gnss_cb_handle == NULL) {
+        app_gnss_async_config_t async_config = APP_GNSS_ASYNC_CONFIG_DEFAULT();
 
-    item->xItemValue = (TickType_t)client;
+        async_config.queue_size = 8192;
+        async_config.task_name  = "asuna_gstream_cb";
 
-    vListInsert(&s_app_ws_client_list, item);
+        state->gnss_cb_handle = app_gnss_server_cb_register_async(APP_GNSS_CB_FIX | APP_GNSS_CB_SAT,
+                                                                  app_ws_stream_gnss_cb, state, &async_config);
+        if (state->gnss_cb_handle == NULL) {
+            ESP_LOGE(LOG_TAG, "Failed to register GNSS callback.");
+        }
+    }
 
-    ESP_LOGI(LOG_TAG, "New stream client connected, handle=%p", handle);
+    ESP_LOGI(LOG_TAG, "New stream client connected, fd=%d", fd);
 
     return 0;
 }
 
-static int app_ws_client_list_remove(httpd_handle_t handle) {
-    bool removed_item = false;
+static void app_ws_session_remove(int fd) {
+    app_ws_stream_state_t *state = &s_app_ws_stream_state;
 
-    ListItem_t       *item = listGET_HEAD_ENTRY(&s_app_ws_client_list);
-    const ListItem_t *end  = listGET_END_MARKER(&s_app_ws_client_list);
+    xSemaphoreTake(state->mutex, portMAX_DELAY);
 
-    while (item != NULL) {
-        if (item == end) {
-            break;
-        }
+    app_ws_session_t *session = (fd >= 0) ? app_ws_session_find(state, fd) : NULL;
+    if (session != NULL) {
+        ESP_LOGI(LOG_TAG, "Stream client left, fd=%d, %" PRIu32 " stale messages dropped", fd, session->dropped);
 
-        app_ws_client_t *client = (app_ws_client_t *)item->xItemValue;
+        app_ws_session_release(session);
+        state->session_count--;
+    }
 
-        if (client->handle == handle) {
-            listREMOVE_ITEM(item);
-            free(client);
-            free(item);
+    const bool idle = state->session_count == 0;
 
-            removed_item = true;
-            break;
-        }
+    xSemaphoreGive(state->mutex);
 
-        item = listGET_NEXT(item);
+    /* Outside the mutex: unregistering waits for a running callback, which may be waiting for the mutex */
+    if (idle && state->gnss_cb_handle != NULL) {
+        app_gnss_server_cb_unregister(state->gnss_cb_handle);
+        state->gnss_cb_handle = NULL;
     }
-
-    if (removed_item) {
-        ESP_LOGD(LOG_TAG, "Successfully removed stream client from list, handle=%p", handle);
-    } else {
-        ESP_LOGD(LOG_TAG, "No matching item removed from the list, handle=%p", handle);
-    }
-
-    return 0;
 }
 
 static esp_err_t app_api_gnss_handler_stream_transfer(httpd_req_t *req) {
     if (req->method == HTTP_GET) {
-        app_ws_client_list_add(req->handle);
-
-        return ESP_OK;
+        return (app_ws_session_add(req) == 0) ? ESP_OK : ESP_FAIL;
     }
 
     httpd_ws_frame_t ws_packet;
@@ -149,10 +197,22 @@ const httpd_uri_t app_api_gnss_handler_stream_ws_uri = {
 };
 
 int app_api_gnss_handler_stream_ws_init(void) {
-    vListInitialise(&s_app_ws_client_list);
+    app_ws_stream_state_t *state = &s_app_ws_stream_state;
+
+    for (size_t i = 0; i < CONFIG_APP_API_GNSS_STREAM_MAX_CLIENTS; i++) {
+        state->sessions[i].fd = -1;
+    }
 
-    /* TODO: Register GNSS event callback here to dispatch to all clients. */
-    /* Note: callbacks are running in the GNSS parser task. */
+    state->mutex = xSemaphoreCreateMutex();
+    if (state->mutex == NULL) {
+        ESP_LOGE(LOG_TAG, "Failed to create mutex.");
+        return -1;
+    }
+
+    if (xTaskCreate(app_ws_stream_sender_task, "asuna_gstream_tx", 3072, state, 3, &state->sender_task) != pdPASS) {
+        ESP_LOGE(LOG_TAG, "Failed to create sender task.");
+        return -1;
+    }
 
     return 0;
 }
@@ -166,8 +226,238 @@ int app_api_gnss_handler_stream_ws_onopen(httpd_handle_t handle, int fd) {
 int app_api_gnss_handler_stream_ws_onclose(httpd_handle_t handle, int fd) {
     ESP_LOGD(LOG_TAG, "Socket onClose(), fd=%d", fd);
 
-    /* Note: The handle may not belong to us. */
-    app_ws_client_list_remove(handle);
+    /* Called for every socket of the server, only stream clients have a session */
+    app_ws_session_remove(fd);
 
     return 0;
 }
+
+/**
+ * Runs in its own task behind the GNSS server's async queue, never in the parser. Each epoch is formatted once and
+ * shared by all clients.
+ */
+static int app_ws_stream_gnss_cb(void *handle, app_gnss_cb_type_t type, void *payload) {
+    app_ws_stream_state_t *state = handle;
+
+    size_t len = 0;
+
+    if (type == APP_GNSS_CB_FIX) {
+        len = app_ws_stream_fix_format(state->buf, sizeof(state->buf), payload);
+    } else if (type == APP_GNSS_CB_SAT) {
+        len = app_ws_stream_sat_format(state->buf, sizeof(state->buf), payload);
+    }
+
+    if (len > 0) {
+        app_ws_stream_publish(state, state->buf, len);
+    }
+
+    return 0;
+}
+
+/* {"type":"fix","time":"hh:mm:ss.sss",...}, groups without data in this epoch are left out. */
+static size_t app_ws_stream_fix_format(char *buf, size_t size, const app_gnss_fix_t *fix) {
+    int len = snprintf(buf, size,
+                       "{\"type\":\"fix\",\"time\":\"%02u:%02u:%02u.%03u\",\"lat\":%.9f,\"lon\":%.9f,\"alt\":%.3f,"
+                       "\"quality\":%u,\"sats_used\":%u",
+                       fix->time.hour, fix->time.minute, fix->time.second, fix->time.millisecond, fix->latitude,
+                       fix->longitude, fix->altitude, fix->quality, fix->sats_used);
+
+    if (fix->diff_age >= 0.0f) {
+        len += snprintf(&buf[len], size - len, ",\"diff_age\":%.1f,\"diff_station\":%u", fix->diff_age,
+                        fix->diff_station);
+    }
+
+    if (fix->flags & APP_GNSS_FIX_HAS_DOP) {
+        len += snprintf(&buf[len], size - len, ",\"fix_mode\":%u,\"pdop\":%.2f,\"hdop\":%.2f,\"vdop\":%.2f",
+                        fix->fix_mode, fix->pdop, fix->hdop, fix->vdop);
+    }
+
+    if (fix->flags & APP_GNSS_FIX_HAS_ERROR) {
+        len += snprintf(&buf[len], size - len, ",\"error\":[%.3f,%.3f,%.3f]", fix->lat_error, fix->lon_error,
+                        fix->alt_error);
+    }
+
+    if (fix->flags & APP_GNSS_FIX_HAS_VELOCITY) {
+        len += snprintf(&buf[len], size - len, ",\"speed\":%.2f,\"course\":%.1f", fix->speed, fix->course);
+    }
+
+    len += snprintf(&buf[len], size - len, "}");
+
+    return (len < size) ? len : 0;
+}
+
+/* {"type":"sat","time":"hh:mm:ss.sss","sats":[[constellation,prn,elevation|null,azimuth|null,cn0,used],...]} */
+static size_t app_ws_stream_sat_format(char *buf, size_t size, const app_gnss_sat_t *sat) {
+    int len = snprintf(buf, size, "{\"type\":\"sat\",\"time\":\"%02u:%02u:%02u.%03u\",\"sats\":[", sat->time.hour,
+                       sat->time.minute, sat->time.second, sat->time.millisecond);
+
+    for (uint8_t i = 0; i < sat->count && len < size; i++) {
+        const app_gnss_sat_info_t *info = &sat->sats[i];
+
+        char elevation[8] = "null";
+        char azimuth[8]   = "null";
+
+        if (info->elevation != -128) snprintf(elevation, sizeof(elevation), "%d", info->elevation);
+        if (info->azimuth != 0xFFFF) snprintf(azimuth, sizeof(azimuth), "%u", info->azimuth);
+
+        len += snprintf(&buf[len], size - len, "%s[%u,%u,%s,%s,%u,%u]", (i > 0) ? "," : "", info->constellation,
+                        info->prn, elevation, azimuth, info->cn0, info->used);
+    }
+
+    if (len < size) {
+        len += snprintf(&buf[len], size - len, "]}");
+    }
+
+    return (len < size) ? len : 0;
+}
+
+/**
+ * Queue a message for every client. A client that still has a full queue gets the oldest message replaced, a slow
+ * browser sees fewer epochs instead of older ones.
+ */
+static void app_ws_stream_publish(app_ws_stream_state_t *state, const char *data, size_t len) {
+    app_ws_message_t *message = malloc(sizeof(app_ws_message_t) + len);
+    if (message == NULL) {
+        return;
+    }
+
+    atomic_init(&message->refs, 1);
+    message->len = len;
+    memcpy(message->data, data, len);
+
+    xSemaphoreTake(state->mutex, portMAX_DELAY);
+
+    for (size_t i = 0; i < CONFIG_APP_API_GNSS_STREAM_MAX_CLIENTS; i++) {
+        app_ws_session_t *session = &state->sessions[i];
+
+        if (session->fd < 0) {
+            continue;
+        }
+
+        if (session->queue_count == APP_WS_STREAM_QUEUE_MAX) {
+            app_ws_message_release(session->queue[session->queue_head]);
+
+            session->queue_head = (session->queue_head + 1) % APP_WS_STREAM_QUEUE_MAX;
+            session->queue_count--;
+            session->dropped++;
+        }
+
+        atomic_fetch_add(&message->refs, 1);
+        session->queue[(session->queue_head + session->queue_count) % APP_WS_STREAM_QUEUE_MAX] = message;
+        session->queue_count++;
+    }
+
+    xSemaphoreGive(state->mutex);
+
+    app_ws_message_release(message);
+
+    xTaskNotifyGive(state->sender_task);
+}
+
+/**
+ * Hands the next message of every idle client to httpd. The frames are written by the httpd task, one in flight per
+ * client, so a client that stops reading only ever holds its own queue.
+ */
+static void app_ws_stream_sender_task(void *parameters) {
+    app_ws_stream_state_t *state = parameters;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        xSemaphoreTake(state->mutex, portMAX_DELAY);
+
+        for (size_t i = 0; i < CONFIG_APP_API_GNSS_STREAM_MAX_CLIENTS; i++) {
+            app_ws_session_t *session = &state->sessions[i];
+
+            if (session->fd < 0 || session->inflight != NULL || session->queue_count == 0) {
+                continue;
+            }
+
+            app_ws_message_t *message = session->queue[session->queue_head];
+
+            session->queue_head = (session->queue_head + 1) % APP_WS_STREAM_QUEUE_MAX;
+            session->queue_count--;
+            session->inflight = message;
+
+            httpd_ws_frame_t frame = {
+                .final   = true,
+                .type    = HTTPD_WS_TYPE_TEXT,
+                .payload = (uint8_t *)message->data,
+                .len     = message->len,
+            };
+
+            /* Only queues the work, the frame goes out from the httpd task */
+            if (httpd_ws_send_data_async(state->server, session->fd, &frame, app_ws_stream_send_done, message) !=
+                ESP_OK) {
+                session->inflight = NULL;
+                app_ws_message_release(message);
+            }
+        }
+
+        xSemaphoreGive(state->mutex);
+    }
+}
+
+/**
+ * Runs in the httpd task. The session may have been closed, or its fd reused by a new client, in the meantime: only a
+ * session still waiting for this very message is touched.
+ */
+static void app_ws_stream_send_done(esp_err_t err, int socket, void *arg) {
+    app_ws_stream_state_t *state   = &s_app_ws_stream_state;
+    app_ws_message_t      *message = arg;
+
+    xSemaphoreTake(state->mutex, portMAX_DELAY);
+
+    app_ws_session_t *session = app_ws_session_find(state, socket);
+    if (session != NULL && session->inflight == message) {
+        session->inflight = NULL;
+    } else {
+        session = NULL;
+    }
+
+    xSemaphoreGive(state->mutex);
+
+    app_ws_message_release(message);
+
+    if (session == NULL) {
+        return;
+    }
+
+    if (err != ESP_OK) {
+        ESP_LOGW(LOG_TAG, "Failed to send stream frame, closing client, fd=%d", socket);
+        httpd_sess_trigger_close(state->server, socket);
+        return;
+    }
+
+    xTaskNotifyGive(state->sender_task);
+}
+
+/* Called with the mutex held, fd -1 finds a free slot */
+static app_ws_session_t *app_ws_session_find(app_ws_stream_state_t *state, int fd) {
+    for (size_t i = 0; i < CONFIG_APP_API_GNSS_STREAM_MAX_CLIENTS; i++) {
+        if (state->sessions[i].fd == fd) {
+            return &state->sessions[i];
+        }
+    }
+
+    return NULL;
+}
+
+/* Called with the mutex held. A message in flight is released by its completion callback. */
+static void app_ws_session_release(app_ws_session_t *session) {
+    while (session->queue_count > 0) {
+        app_ws_message_release(session->queue[session->queue_head]);
+
+        session->queue_head = (session->queue_head + 1) % APP_WS_STREAM_QUEUE_MAX;
+        session->queue_count--;
+    }
+
+    session->fd       = -1;
+    session->inflight = NULL;
+}
+
+static void app_ws_message_release(app_ws_message_t *message) {
+    if (atomic_fetch_sub(&message->refs, 1) == 1) {
+        free(message);
+    }
+}
@@ -8,6 +8,8 @@
 #include "esp_log.h"
 
 /* App */
+#include "app/api/config/handler_base.h"
+#include "app/api/config/handler_gnss.h"
 #include "app/api/config/handler_lora.h"
 #include "app/api/config/handler_upgrade.h"
 #include "app/api/config/handler_wifi.h"
@@ -26,6 +28,34 @@ typedef struct {
 static const char *LOG_TAG = "asuna_httpsrv";
 
 static const app_api_server_handler_t s_app_handler_list[] = {
+    {
+        .name    = "config_base_get",
+        .uri     = &app_api_config_handler_base_get_uri,
+        .init    = NULL,
+        .onopen  = NULL,
+        .onclose = NULL,
+    },
+    {
+        .name    = "config_base_post",
+        .uri     = &app_api_config_handler_base_post_uri,
+        .init    = NULL,
+        .onopen  = NULL,
+        .onclose = NULL,
+    },
+    {
+        .name    = "config_gnss_get",
+        .uri     = &app_api_config_handler_gnss_get_uri,
+        .init    = NULL,
+        .onopen  = NULL,
+        .onclose = NULL,
+    },
+    {
+        .name    = "config_gnss_post",
+        .uri     = &app_api_config_handler_gnss_post_uri,
+        .init    = NULL,
+        .onopen  = NULL,
+        .onclose = NULL,
+    },
     {
         .name    = "config_lora_get",
         .uri     = &app_api_config_handler_lora_get_uri,
@@ -100,6 +130,7 @@ int app_api_server_init(void) {
 
     httpd_config.task_priority    = 2;
     httpd_config.max_uri_handlers = handler_count;
+    httpd_config.max_open_sockets = CONFIG_APP_API_GNSS_STREAM_MAX_CLIENTS + 4;
     httpd_config.uri_match_fn     = httpd_uri_match_wildcard;
     httpd_config.open_fn          = app_api_server_socket_open_callback;
     httpd_config.close_fn         = app_api_server_socket_close_callback;
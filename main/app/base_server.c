@@ -0,0 +1,443 @@
+#include <math.h>
+#include <string.h>
+
+/* IDF */
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/timers.h"
+#include "nvs_flash.h"
+
+/* nl */
+#include "rcv/nl_rtcm_station.h"
+
+/* App */
+#include "app/base_server.h"
+#include "app/gnss/survey.h"
+#include "app/gnss_server.h"
+
+#define APP_BASE_SERVER_NVS_NAMESPACE "a_base_server"
+#define APP_BASE_SERVER_NVS_VERSION   1 /* DO NOT CHANGE THIS VALUE UNLESS THERE IS A STRUCTURE UPDATE */
+
+#define APP_BASE_SERVER_ECEF_SCALE  (10000.0) /* Stored in 0.1 mm, the RTCM 1005 resolution */
+#define APP_BASE_SERVER_RADIUS_MIN  (6.30e6)  /* Sanity bounds of a manually entered position, m from the center */
+#define APP_BASE_SERVER_RADIUS_MAX  (6.40e6)
+#define APP_BASE_SERVER_QUALITY_MAX (5) /* Up to RTK float, dead reckoning and manual fixes are never averaged */
+
+typedef struct {
+    SemaphoreHandle_t    mutex;
+    app_gnss_cb_handle_t gnss_cb_handle;
+
+    app_base_survey_config_t config;
+    app_base_survey_state_t  state;
+    app_gnss_survey_t        survey;
+    int64_t                  start_us;
+    uint32_t                 elapsed_s; /* Frozen once the survey-in ends */
+
+    app_base_position_t position;
+} app_base_server_state_t;
+
+static const char *LOG_TAG = "asuna_base";
+
+static app_base_server_state_t s_app_base_server_state = {
+    .mutex          = NULL,
+    .gnss_cb_handle = NULL,
+    .state          = APP_BASE_SURVEY_IDLE,
+};
+
+static const char *APP_BASE_SERVER_CFG_KEY_FLAG    = "cfg_valid"; /* Position key */
+static const char *APP_BASE_SERVER_CFG_KEY_X       = "ecef_x";    /* ECEF X, 0.1 mm */
+static const char *APP_BASE_SERVER_CFG_KEY_Y       = "ecef_y";    /* ECEF Y, 0.1 mm */
+static const char *APP_BASE_SERVER_CFG_KEY_Z       = "ecef_z";    /* ECEF Z, 0.1 mm */
+static const char *APP_BASE_SERVER_CFG_KEY_ACC     = "acc_mm";    /* Survey-in accuracy */
+static const char *APP_BASE_SERVER_CFG_KEY_SAMPLES = "samples";   /* Fixes averaged */
+
+static int  app_base_server_gnss_cb(void *handle, app_gnss_cb_type_t type, void *payload);
+static void app_base_server_survey_release(void *param1, uint32_t param2);
+static int  app_base_server_position_load(app_base_position_t *position);
+static void app_base_server_position_store(const app_base_position_t *position);
+static void app_base_server_station_update(const app_base_position_t *position);
+
+int app_base_server_init(void) {
+    s_app_base_server_state.mutex = xSemaphoreCreateMutex();
+    if (s_app_base_server_state.mutex == NULL) {
+        ESP_LOGE(LOG_TAG, "Failed to create mutex.");
+        return -1;
+    }
+
+    if (app_base_server_position_load(&s_app_base_server_state.position) == 0) {
+        const app_base_position_t *position = &s_app_base_server_state.position;
+
+        ESP_LOGI(LOG_TAG, "Base position: %.4f %.4f %.4f, accuracy %u mm.", position->ecef[0], position->ecef[1],
+                 position->ecef[2], position->accuracy_mm);
+
+        app_base_server_station_update(position);
+
+        return 0;
+    }
+
+#if CONFIG_APP_BASE_SERVER_SURVEY_AUTO
+    app_base_survey_config_t config;
+    app_base_server_survey_config_init(&config);
+
+    ESP_LOGW(LOG_TAG, "No base position stored, starting survey-in...");
+
+    if (app_base_server_survey_start(&config) != 0) {
+        ESP_LOGE(LOG_TAG, "Failed to start survey-in.");
+        return -2;
+    }
+#endif
+
+    return 0;
+}
+
+void app_base_server_survey_config_init(app_base_survey_config_t *config) {
+    config->min_duration_s = CONFIG_APP_BASE_SERVER_SURVEY_MIN_DURATION;
+    config->max_duration_s = 0;
+    config->accuracy_mm    = CONFIG_APP_BASE_SERVER_SURVEY_ACCURACY;
+    config->min_quality    = 1;
+}
+
+int app_base_server_survey_start(const app_base_survey_config_t *config) {
+    app_base_server_state_t *state = &s_app_base_server_state;
+
+    /* ---- Sanity checks ---- */
+    if (config->min_duration_s == 0 || config->accuracy_mm == 0) return -1;
+    if (config->min_duration_s > APP_BASE_SURVEY_DURATION_MAX || config->max_duration_s > APP_BASE_SURVEY_DURATION_MAX)
+        return -1;
+    if (config->accuracy_mm > APP_BASE_SURVEY_ACCURACY_MAX) return -1;
+    if (config->max_duration_s != 0 && config->max_duration_s < config->min_duration_s) return -1;
+    if (config->min_quality == 0 || config->min_quality > APP_BASE_SERVER_QUALITY_MAX) return -1;
+
+    xSemaphoreTake(state->mutex, portMAX_DELAY);
+
+    if (state->gnss_cb_handle == NULL) {
+        app_gnss_async_config_t async_config = APP_GNSS_ASYNC_CONFIG_DEFAULT();
+
+        async_config.queue_size = 2048;
+        async_config.task_stack = 4096; /* NVS write on completion */
+        async_config.task_name  = "asuna_base";
+
+        state->gnss_cb_handle =
+            app_gnss_server_cb_register_async(APP_GNSS_CB_FIX, app_base_server_gnss_cb, state, &async_config);
+        if (state->gnss_cb_handle == NULL) {
+            xSemaphoreGive(state->mutex);
+
+            return -2;
+        }
+    }
+
+    state->config    = *config;
+    state->state     = APP_BASE_SURVEY_RUNNING;
+    state->start_us  = esp_timer_get_time();
+    state->elapsed_s = 0;
+    app_gnss_survey_init(&state->survey);
+
+    xSemaphoreGive(state->mutex);
+
+    ESP_LOGI(LOG_TAG, "Survey-in started: at least %u s, accuracy %u mm.", config->min_duration_s,
+             config->accuracy_mm);
+
+    return 0;
+}
+
+void app_base_server_survey_stop(void) {
+    app_base_server_state_t *state = &s_app_base_server_state;
+
+    xSemaphoreTake(state->mutex, portMAX_DELAY);
+
+    if (state->state == APP_BASE_SURVEY_RUNNING) {
+        state->state     = APP_BASE_SURVEY_IDLE;
+        state->elapsed_s = (esp_timer_get_time() - state->start_us) / 1000000;
+    }
+
+    app_gnss_cb_handle_t handle = state->gnss_cb_handle;
+    state->gnss_cb_handle       = NULL;
+
+    xSemaphoreGive(state->mutex);
+
+    /* Outside the lock, unregistering waits for a callback that may be waiting for it */
+    if (handle != NULL) {
+        app_gnss_server_cb_unregister(handle);
+    }
+}
+
+void app_base_server_survey_status_get(app_base_survey_status_t *status) {
+    app_base_server_state_t *state = &s_app_base_server_state;
+
+    xSemaphoreTake(state->mutex, portMAX_DELAY);
+
+    const float sigma = app_gnss_survey_sigma(&state->survey);
+
+    status->state       = state->state;
+    status->samples     = state->survey.n;
+    status->elapsed_s   = (state->state == APP_BASE_SURVEY_RUNNING)
+                              ? (uint32_t)((esp_timer_get_time() - state->start_us) / 1000000)
+                              : state->elapsed_s;
+    status->accuracy_mm = (sigma < 4e6f) ? (uint32_t)(sigma * 1000.0f) : UINT32_MAX;
+    app_gnss_survey_mean(&state->survey, status->ecef);
+
+    xSemaphoreGive(state->mutex);
+}
+
+int app_base_server_position_get(app_base_position_t *position) {
+    app_base_server_state_t *state = &s_app_base_server_state;
+
+    int ret = 0;
+
+    xSemaphoreTake(state->mutex, portMAX_DELAY);
+
+    if (state->position.valid) {
+        *position = state->position;
+    } else {
+        ret = -1;
+    }
+
+    xSemaphoreGive(state->mutex);
+
+    return ret;
+}
+
+int app_base_server_position_set(const app_base_position_t *position) {
+    app_base_server_state_t *state = &s_app_base_server_state;
+
+    /* ---- Sanity checks ---- */
+    const double radius = sqrt(position->ecef[0] * position->ecef[0] + position->ecef[1] * position->ecef[1] +
+                               position->ecef[2] * position->ecef[2]);
+    if (radius < APP_BASE_SERVER_RADIUS_MIN || radius > APP_BASE_SERVER_RADIUS_MAX) return -1;
+
+    /* A manual position replaces whatever a running survey-in would produce */
+    app_base_server_survey_stop();
+
+    app_base_position_t stored = *position;
+    stored.valid               = true;
+
+    for (uint8_t i = 0; i < 3; i++) {
+        stored.ecef[i] = round(stored.ecef[i] * APP_BASE_SERVER_ECEF_SCALE) / APP_BASE_SERVER_ECEF_SCALE;
+    }
+
+    xSemaphoreTake(state->mutex, portMAX_DELAY);
+    state->position = stored;
+    xSemaphoreGive(state->mutex);
+
+    app_base_server_position_store(&stored);
+    app_base_server_station_update(&stored);
+
+    return 0;
+}
+
+static int app_base_server_gnss_cb(void *handle, app_gnss_cb_type_t type, void *payload) {
+    app_base_server_state_t *state = handle;
+    const app_gnss_fix_t    *fix   = payload;
+
+    if (type != APP_GNSS_CB_FIX) {
+        return 0;
+    }
+
+    const int64_t now = esp_timer_get_time();
+
+    xSemaphoreTake(state->mutex, portMAX_DELAY);
+
+    if (state->state != APP_BASE_SURVEY_RUNNING) {
+        xSemaphoreGive(state->mutex);
+
+        return 0;
+    }
+
+    state->elapsed_s = (now - state->start_us) / 1000000;
+
+    if ((fix->flags & APP_GNSS_FIX_HAS_POSITION) && fix->quality >= state->config.min_quality &&
+        fix->quality <= APP_BASE_SERVER_QUALITY_MAX) {
+        double ecef[3];
+
+        /* GGA altitude is above the geoid, ECEF needs the ellipsoidal height */
+        app_gnss_survey_llh_to_ecef(fix->latitude, fix->longitude, fix->altitude + fix->geoid_separation, ecef);
+        app_gnss_survey_add(&state->survey, ecef);
+    }
+
+    const float sigma = app_gnss_survey_sigma(&state->survey);
+
+    app_base_position_t position = {0};
+
+    if (state->elapsed_s >= state->config.min_duration_s && sigma * 1000.0f <= state->config.accuracy_mm) {
+        position.valid       = true;
+        position.accuracy_mm = (uint32_t)(sigma * 1000.0f);
+        position.samples     = state->survey.n;
+        app_gnss_survey_mean(&state->survey, position.ecef);
+
+        for (uint8_t i = 0; i < 3; i++) {
+            position.ecef[i] = round(position.ecef[i] * APP_BASE_SERVER_ECEF_SCALE) / APP_BASE_SERVER_ECEF_SCALE;
+        }
+
+        state->position = position;
+        state->state    = APP_BASE_SURVEY_DONE;
+    } else if (state->config.max_duration_s != 0 && state->elapsed_s >= state->config.max_duration_s) {
+        state->state = APP_BASE_SURVEY_FAILED;
+    }
+
+    const app_base_survey_state_t result = state->state;
+
+    xSemaphoreGive(state->mutex);
+
+    if (result == APP_BASE_SURVEY_RUNNING) {
+        return 0;
+    }
+
+    if (result == APP_BASE_SURVEY_DONE) {
+        ESP_LOGI(LOG_TAG, "Survey-in done: %.4f %.4f %.4f, accuracy %u mm over %u fixes.", position.ecef[0],
+                 position.ecef[1], position.ecef[2], position.accuracy_mm, position.samples);
+
+        app_base_server_position_store(&position);
+        app_base_server_station_update(&position);
+    } else {
+        ESP_LOGW(LOG_TAG, "Survey-in failed: accuracy %.3f m after %u s.", sigma, state->config.max_duration_s);
+    }
+
+    /* Callbacks must not unregister themselves, let the timer task do it */
+    xTimerPendFunctionCall(app_base_server_survey_release, NULL, 0, 0);
+
+    return 0;
+}
+
+static void app_base_server_survey_release(void *param1, uint32_t param2) {
+    app_base_server_state_t *state = &s_app_base_server_state;
+
+    xSemaphoreTake(state->mutex, portMAX_DELAY);
+
+    /* A new survey-in may have been started in the meantime */
+    app_gnss_cb_handle_t handle = NULL;
+    if (state->state != APP_BASE_SURVEY_RUNNING) {
+        handle                = state->gnss_cb_handle;
+        state->gnss_cb_handle = NULL;
+    }
+
+    xSemaphoreGive(state->mutex);
+
+    if (handle != NULL) {
+        app_gnss_server_cb_unregister(handle);
+    }
+}
+
+static int app_base_server_position_load(app_base_position_t *position) {
+    esp_err_t err;
+
+    memset(position, 0U, sizeof(app_base_position_t));
+
+    /* ---- Create NVS handle ---- */
+    nvs_handle handle;
+    err = nvs_open(APP_BASE_SERVER_NVS_NAMESPACE, NVS_READONLY, &handle);
+    if (err != ESP_OK) {
+        return -1;
+    }
+
+    /* Check NVS data flag */
+
+    uint8_t cfg_flag;
+    if (nvs_get_u8(handle, APP_BASE_SERVER_CFG_KEY_FLAG, &cfg_flag) != ESP_OK ||
+        cfg_flag > APP_BASE_SERVER_NVS_VERSION) {
+        nvs_close(handle);
+        return -1;
+    }
+
+    /* ---- Load position ---- */
+    int64_t ecef[3];
+    ESP_ERROR_CHECK(nvs_get_i64(handle, APP_BASE_SERVER_CFG_KEY_X, &ecef[0]));
+    ESP_ERROR_CHECK(nvs_get_i64(handle, APP_BASE_SERVER_CFG_KEY_Y, &ecef[1]));
+    ESP_ERROR_CHECK(nvs_get_i64(handle, APP_BASE_SERVER_CFG_KEY_Z, &ecef[2]));
+    ESP_ERROR_CHECK(nvs_get_u32(handle, APP_BASE_SERVER_CFG_KEY_ACC, &position->accuracy_mm));
+    ESP_ERROR_CHECK(nvs_get_u32(handle, APP_BASE_SERVER_CFG_KEY_SAMPLES, &position->samples));
+
+    for (uint8_t i = 0; i < 3; i++) {
+        position->ecef[i] = ecef[i] / APP_BASE_SERVER_ECEF_SCALE;
+    }
+
+    position->valid = true;
+
+    /* ---- Close NVS handle ---- */
+    nvs_close(handle);
+
+    return 0;
+}
+
+static void app_base_server_position_store(const app_base_position_t *position) {
+    /* ---- Create NVS handle ---- */
+    nvs_handle handle;
+    ESP_ERROR_CHECK(nvs_open(APP_BASE_SERVER_NVS_NAMESPACE, NVS_READWRITE, &handle));
+
+    /* ---- Store position ---- */
+    ESP_ERROR_CHECK(nvs_set_u8(handle, APP_BASE_SERVER_CFG_KEY_FLAG, APP_BASE_SERVER_NVS_VERSION));
+
+    ESP_ERROR_CHECK(nvs_set_i64(handle, APP_BASE_SERVER_CFG_KEY_X,
+                                (int64_t)llround(position->ecef[0] * APP_BASE_SERVER_ECEF_SCALE)));
+    ESP_ERROR_CHECK(nvs_set_i64(handle, APP_BASE_SERVER_CFG_KEY_Y,
+                                (int64_t)llround(position->ecef[1] * APP_BASE_SERVER_ECEF_SCALE)));
+    ESP_ERROR_CHECK(nvs_set_i64(handle, APP_BASE_SERVER_CFG_KEY_Z,
+                                (int64_t)llround(position->ecef[2] * APP_BASE_SERVER_ECEF_SCALE)));
+    ESP_ERROR_CHECK(nvs_set_u32(handle, APP_BASE_SERVER_CFG_KEY_ACC, position->accuracy_mm));
+    ESP_ERROR_CHECK(nvs_set_u32(handle, APP_BASE_SERVER_CFG_KEY_SAMPLES, position->samples));
+
+    /* ---- Commit and close NVS handle ---- */
+    ESP_ERROR_CHECK(nvs_commit(handle));
+    nvs_close(handle);
+}
+
+/**
+ * Hand 1005/1006 and 1033 of the stored position to the GNSS server, which sends them between epochs in place of the
+ * module's own and drops whatever 1005 the module still outputs. Runs from the survey-in callback and the REST
+ * handler, so nothing here talks to the module or writes the user's GNSS profile.
+ */
+static void app_base_server_station_update(const app_base_position_t *position) {
+#if CONFIG_APP_BASE_SERVER_RTCM_STATION
+    app_gnss_server_config_t gnss_config;
+    if (app_gnss_server_config_get(&gnss_config) != 0) {
+        app_gnss_server_config_init(&gnss_config);
+    }
+
+    const uint8_t c = gnss_config.constellations;
+
+    const nl_rtcm_arp_t arp = {
+        .station_id     = CONFIG_APP_BASE_SERVER_RTCM_STATION_ID,
+        .itrf_year      = 0,
+        .gps            = (c & APP_GNSS_CONSTELLATION_BIT(APP_GNSS_CONSTELLATION_GPS)) != 0,
+        .glonass        = (c & APP_GNSS_CONSTELLATION_BIT(APP_GNSS_CONSTELLATION_GLONASS)) != 0,
+        .galileo        = (c & APP_GNSS_CONSTELLATION_BIT(APP_GNSS_CONSTELLATION_GALILEO)) != 0,
+        .ecef           = {position->ecef[0], position->ecef[1], position->ecef[2]},
+        .antenna_height = CONFIG_APP_BASE_SERVER_ANTENNA_HEIGHT / 1000.0,
+    };
+
+    const nl_rtcm_descriptor_t desc = {
+        .station_id        = CONFIG_APP_BASE_SERVER_RTCM_STATION_ID,
+        .antenna           = CONFIG_APP_BASE_SERVER_ANTENNA_DESCRIPTOR,
+        .antenna_setup_id  = 0,
+        .antenna_serial    = CONFIG_APP_BASE_SERVER_ANTENNA_SERIAL,
+        .receiver          = CONFIG_APP_BASE_SERVER_RECEIVER_DESCRIPTOR,
+        .receiver_firmware = NULL,
+        .receiver_serial   = NULL,
+    };
+
+    uint8_t frames[NL_RTCM_STATION_1006_SIZE + NL_RTCM_STATION_1033_MAX];
+
+    const int arp_len = nl_rtcm_arp_encode(&arp, CONFIG_APP_BASE_SERVER_ANTENNA_HEIGHT > 0, frames, sizeof(frames));
+    if (arp_len < 0) {
+        ESP_LOGE(LOG_TAG, "Failed to encode the station position.");
+        return;
+    }
+
+    const int desc_len = nl_rtcm_descriptor_encode(&desc, &frames[arp_len], sizeof(frames) - arp_len);
+    if (desc_len < 0) {
+        ESP_LOGE(LOG_TAG, "Failed to encode the station descriptors.");
+        return;
+    }
+
+    if (app_gnss_server_rtcm_station_set(frames, arp_len + desc_len,
+                                         CONFIG_APP_BASE_SERVER_RTCM_STATION_INTERVAL * 1000) != 0) {
+        ESP_LOGE(LOG_TAG, "Failed to install station messages.");
+        return;
+    }
+
+    if (gnss_config.rtcm_station) {
+        ESP_LOGI(LOG_TAG, "Station messages generated onboard, the module's 1005 output is dropped.");
+    }
+#endif
+}
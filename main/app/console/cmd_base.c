@@ -0,0 +1,180 @@
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* IDF */
+#include "esp_console.h"
+
+/* App */
+#include "app/base_server.h"
+#include "app/console/cmd_base.h"
+#include "app/console/private.h"
+
+static int app_console_base_subcommand_help(int argc, char **argv);
+static int app_console_base_subcommand_status(int argc, char **argv);
+static int app_console_base_subcommand_survey(int argc, char **argv);
+static int app_console_base_subcommand_position(int argc, char **argv);
+static int app_console_base_uint(const char *str, uint32_t min, uint32_t max, uint32_t *value);
+
+static const app_console_subcommand_t s_app_console_base_subcommands[] = {
+    {.command = "help", .handler = app_console_base_subcommand_help},
+    {.command = "status", .handler = app_console_base_subcommand_status},
+    {.command = "survey", .handler = app_console_base_subcommand_survey},
+    {.command = "position", .handler = app_console_base_subcommand_position},
+};
+
+/* Indexed by app_base_survey_state_t */
+static const char *s_app_console_base_survey_states[] = {"idle", "running", "done", "failed"};
+
+static int app_console_base_subcommand_help(int argc, char **argv) {
+    printf("Usage: base <command> [options...]\n");
+    printf("Commands:\n");
+    printf("\thelp: Print this help.\n");
+    printf("\tstatus: Show survey-in progress and the stored base position.\n");
+    printf("\tsurvey: Start or stop a survey-in.\n");
+    printf("\tposition: Store a known base position.\n");
+
+    if (argv != NULL) {
+        return 0;
+    }
+
+    return -1;
+}
+
+static int app_console_base_subcommand_status(int argc, char **argv) {
+    app_base_survey_status_t status;
+    app_base_server_survey_status_get(&status);
+
+    printf("Survey-in %s: %" PRIu32 " fixes in %" PRIu32 " s", s_app_console_base_survey_states[status.state],
+           status.samples, status.elapsed_s);
+    if (status.accuracy_mm != UINT32_MAX) {
+        printf(", %" PRIu32 " mm, mean %.4f %.4f %.4f", status.accuracy_mm, status.ecef[0], status.ecef[1],
+               status.ecef[2]);
+    }
+    printf("\n");
+
+    app_base_position_t position;
+    if (app_base_server_position_get(&position) != 0 || !position.valid) {
+        printf("Base position: not set\n");
+
+        return 0;
+    }
+
+    printf("Base position: %.4f %.4f %.4f ECEF, %" PRIu32 " mm, %" PRIu32 " fixes\n", position.ecef[0],
+           position.ecef[1], position.ecef[2], position.accuracy_mm, position.samples);
+
+    return 0;
+}
+
+static int app_console_base_subcommand_survey(int argc, char **argv) {
+    if (argc < 2) {
+        printf("Usage: base survey start [MIN_S] [ACCURACY_MM] [MAX_S] | base survey stop\n");
+        printf("\tMAX_S: Give up after this many seconds, 0 for no limit.\n");
+
+        return -1;
+    }
+
+    if (strcmp(argv[1], "stop") == 0) {
+        app_base_server_survey_stop();
+
+        return 0;
+    }
+
+    if (strcmp(argv[1], "start") != 0) {
+        return -1;
+    }
+
+    app_base_survey_config_t config;
+    app_base_server_survey_config_init(&config);
+
+    if ((argc > 2 && app_console_base_uint(argv[2], 1, APP_BASE_SURVEY_DURATION_MAX, &config.min_duration_s) != 0) ||
+        (argc > 3 && app_console_base_uint(argv[3], 1, APP_BASE_SURVEY_ACCURACY_MAX, &config.accuracy_mm) != 0) ||
+        (argc > 4 && app_console_base_uint(argv[4], 0, APP_BASE_SURVEY_DURATION_MAX, &config.max_duration_s) != 0)) {
+        return -1;
+    }
+
+    if (app_base_server_survey_start(&config) != 0) {
+        printf("Failed to start survey-in.\n");
+
+        return -2;
+    }
+
+    printf("Survey-in started, at least %" PRIu32 " s down to %" PRIu32 " mm.\n", config.min_duration_s,
+           config.accuracy_mm);
+
+    return 0;
+}
+
+static int app_console_base_subcommand_position(int argc, char **argv) {
+    if (argc != 4) {
+        printf("Usage: base position <X> <Y> <Z>\n");
+        printf("\tECEF coordinates of the antenna reference point in meters.\n");
+
+        return -1;
+    }
+
+    app_base_position_t position = {0};
+    for (uint8_t i = 0; i < 3; i++) {
+        char *end;
+
+        position.ecef[i] = strtod(argv[i + 1], &end);
+        if (end == argv[i + 1] || *end != '\0') {
+            printf("Invalid coordinate: %s\n", argv[i + 1]);
+
+            return -1;
+        }
+    }
+
+    if (app_base_server_position_set(&position) != 0) {
+        printf("Invalid base position.\n");
+
+        return -2;
+    }
+
+    return 0;
+}
+
+/* Parses a whole number in min..max, anything else is reported and rejected */
+static int app_console_base_uint(const char *str, uint32_t min, uint32_t max, uint32_t *value) {
+    char *end;
+
+    errno                      = 0;
+    const unsigned long number = strtoul(str, &end, 0);
+    if (end == str || *end != '\0' || errno != 0 || str[0] == '-' || number < min || number > max) {
+        printf("Invalid value: %s, expected %" PRIu32 "-%" PRIu32 ".\n", str, min, max);
+
+        return -1;
+    }
+
+    *value = number;
+
+    return 0;
+}
+
+static int app_console_base_func(int argc, char **argv) {
+    if (argc <= 1) {
+        return app_console_base_subcommand_help(0, NULL);
+    }
+
+    char  *cmd            = argv[1];
+    size_t commands_count = sizeof(s_app_console_base_subcommands) / sizeof(s_app_console_base_subcommands[0]);
+
+    for (size_t i = 0; i < commands_count; i++) {
+        if (strcmp(cmd, s_app_console_base_subcommands[i].command) != 0) {
+            continue;
+        }
+
+        return s_app_console_base_subcommands[i].handler(argc - 1, &argv[1]);
+    }
+
+    return 0;
+}
+
+const esp_console_cmd_t app_console_cmd_base = {
+    .command = "base",
+    .help    = "Base station position and survey-in",
+    .hint    = NULL,
+    .func    = &app_console_base_func,
+};
@@ -1,20 +1,64 @@
 #include <errno.h>
 #include <math.h>
 #include <string.h>
+#include <strings.h>
 
 #include "app/gnss_server.h"
 #include "esp_console.h"
+#include "esp_cpu.h"
+#include "esp_random.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+
+/* nl */
+#include "rcv/nl_crc24q.h"
+#include "rcv/nl_nmea_index.h"
+#include "rcv/nl_rawlog.h"
 
 /* App */
 #include "app/console/cmd_gnss.h"
 #include "app/console/private.h"
-
-static int app_console_gnss_subcommand_help(int argc, char **argv);
-static int app_console_gnss_subcommand_test(int argc, char **argv);
+#include "app/gnss/fix_builder.h"
+#include "app/gnss/frame_demux.h"
+#include "app/gnss/recorder.h"
+
+#define APP_CONSOLE_GNSS_STORAGE       "/storage/"
+#define APP_CONSOLE_GNSS_BENCH_SAMPLES (4096) /* Per-frame latency reservoir */
+
+/* Parser benchmark state, a private demux and fix builder so live consumers see nothing */
+typedef struct {
+    app_gnss_demux_t       demux;
+    app_gnss_fix_builder_t fix_builder;
+    uint32_t               epochs;
+    uint32_t               mark; /* CPU cycles at the end of the previous frame or the start of the chunk */
+    uint32_t               frames;
+    uint32_t               samples[APP_CONSOLE_GNSS_BENCH_SAMPLES];
+    uint8_t                buf[NL_RAWLOG_CHUNK_MAX];
+} app_console_gnss_bench_parse_t;
+
+static int  app_console_gnss_subcommand_help(int argc, char **argv);
+static int  app_console_gnss_subcommand_test(int argc, char **argv);
+static int  app_console_gnss_subcommand_stats(int argc, char **argv);
+static int  app_console_gnss_subcommand_bench(int argc, char **argv);
+static int  app_console_gnss_subcommand_config(int argc, char **argv);
+static int  app_console_gnss_subcommand_record(int argc, char **argv);
+static int  app_console_gnss_subcommand_replay(int argc, char **argv);
+static void app_console_gnss_path(const char *name, char *path, size_t size);
+static int  app_console_gnss_uint(const char *str, unsigned long max, unsigned long *value);
 
 static const app_console_subcommand_t s_app_console_gnss_subcommands[] = {
     {.command = "help", .handler = app_console_gnss_subcommand_help},
     {.command = "test", .handler = app_console_gnss_subcommand_test},
+    {.command = "stats", .handler = app_console_gnss_subcommand_stats},
+    {.command = "bench", .handler = app_console_gnss_subcommand_bench},
+    {.command = "config", .handler = app_console_gnss_subcommand_config},
+    {.command = "record", .handler = app_console_gnss_subcommand_record},
+    {.command = "replay", .handler = app_console_gnss_subcommand_replay},
+};
+
+/* Indexed by app_gnss_constellation_t */
+static const char *s_app_console_gnss_constellations[] = {
+    NULL, "gps", "glonass", "galileo", "beidou", "qzss", "navic",
 };
 
 static int app_console_gnss_event_callback(void *user_data, app_gnss_cb_type_t type, void *data) {
@@ -39,17 +83,55 @@ static int app_console_gnss_event_callback(void *user_data, app_gnss_cb_type_t t
                 s_lon = 'W';
 
             printf("GNSS fix received: %.6f %C, %.6f %C, alt: %.4f\n", lat, s_lat, lon, s_lon, fix->altitude);
+            printf("\t    %02u:%02u:%02u.%03u quality: %u, mode: %u, sats: %u, hdop: %.2f, pdop: %.2f, vdop: %.2f\n",
+                   fix->time.hour, fix->time.minute, fix->time.second, fix->time.millisecond, fix->quality,
+                   fix->fix_mode, fix->sats_used, fix->hdop, fix->pdop, fix->vdop);
+
+            if (fix->flags & APP_GNSS_FIX_HAS_ERROR) {
+                printf("\t    error: lat %.3f m, lon %.3f m, alt %.3f m\n", fix->lat_error, fix->lon_error,
+                       fix->alt_error);
+            }
+
+            if (fix->flags & APP_GNSS_FIX_HAS_VELOCITY) {
+                printf("\t    speed: %.3f m/s, course: %.1f deg\n", fix->speed, fix->course);
+            }
 
             break;
         }
 
-        case APP_GNSS_CB_SAT:
-            printf("GNSS Satellite info received\n");
+        case APP_GNSS_CB_SAT: {
+            const app_gnss_sat_t *sat = data;
+            printf("GNSS Satellite info received: %u in view\n", sat->count);
+
+            for (uint8_t i = 0; i < sat->count; i++) {
+                const app_gnss_sat_info_t *info = &sat->sats[i];
+                printf("\t    [%u] PRN %3u el %3d az %3u C/N0 %2u%s\n", info->constellation, info->prn,
+                       info->elevation, info->azimuth, info->cn0, info->used ? " *" : "");
+            }
 
             break;
+        }
         case APP_GNSS_CB_RAW_NMEA: {
             const app_gnss_nmea_t *nmea = data;
-            printf("Raw NMEA data received: type: %3s, len: %u\n", nmea->type, nmea->data_len);
+            printf("Raw NMEA data received: type: %.3s, len: %u, fields: %u\n", nmea->type, nmea->data_len,
+                   nmea->index->count);
+
+            break;
+        }
+
+        case APP_GNSS_CB_OBS: {
+            const app_gnss_obs_t *obs = data;
+            printf("GNSS observations received: RTCM %u, station %u, epoch %" PRIu32 ", %u sats, %u signals%s\n",
+                   obs->message, obs->station_id, obs->epoch, obs->sats, obs->count, obs->more ? " (more)" : "");
+
+            for (uint8_t i = 0; i < obs->count; i++) {
+                const app_gnss_obs_sig_t *sig = &obs->sigs[i];
+                printf("\t    [%u] sat %2u sig %2u C/N0 %4.1f lock %8" PRIu32 " ms pr %14.3f cp %14.3f%s%s%s\n",
+                       obs->constellation, sig->sat_id, sig->sig_id, sig->cn0, sig->lock_ms, sig->pseudorange,
+                       sig->phase, (sig->flags & APP_GNSS_OBS_HALF_CYCLE) ? " half" : "",
+                       (sig->flags & APP_GNSS_OBS_SLIP) ? " SLIP" : "",
+                       (sig->flags & APP_GNSS_OBS_LOCK_LOST) ? " LOST" : "");
+            }
 
             break;
         }
@@ -63,8 +145,10 @@ static int app_console_gnss_event_callback(void *user_data, app_gnss_cb_type_t t
 
         case APP_GNSS_CB_PPS: {
             const app_gnss_pps_t *pps = data;
-            printf("GNSS PPS event received: %04d-%02u-%02u %02u:%02u:%02u\n", pps->gps_year, pps->gps_month,
-                   pps->gps_day, pps->gps_hour, pps->gps_minute, pps->gps_second);
+            printf("GNSS PPS event received: %04d-%02u-%02u %02u:%02u:%02u%s\n", pps->gps_year, pps->gps_month,
+                   pps->gps_day, pps->gps_hour, pps->gps_minute, pps->gps_second, pps->time_valid ? "" : " (no time)");
+            printf("\t    #%" PRIu32 " at %" PRId64 " us, interval: %" PRId64 " us, latency: %" PRIu32 " us\n",
+                   pps->sequence, pps->timestamp_us, pps->interval_us, pps->latency_us);
             break;
         }
 
@@ -80,6 +164,11 @@ static int app_console_gnss_subcommand_help(int argc, char **argv) {
     printf("Commands:\n");
     printf("\thelp: Print this help.\n");
     printf("\ttest: Start GNSS data capture and dump to terminal.\n");
+    printf("\tstats: Show GNSS receive path statistics.\n");
+    printf("\tbench: Run GNSS parser micro-benchmarks.\n");
+    printf("\tconfig: Show or change the GNSS output profile.\n");
+    printf("\trecord: Record the raw GNSS stream to storage.\n");
+    printf("\treplay: Feed a recording through the GNSS parser.\n");
 
     if (argv != NULL) {
         return 0;
@@ -99,6 +188,7 @@ static int app_console_gnss_subcommand_test(int argc, char **argv) {
         printf("\tBIT2: NMEA raw data\n");
         printf("\tBIT3: RTCM raw data\n");
         printf("\tBIT4: PPS\n");
+        printf("\tBIT5: RTCM MSM observations\n");
 
         return -1;
     }
@@ -111,16 +201,533 @@ static int app_console_gnss_subcommand_test(int argc, char **argv) {
         return -2;
     }
 
-    app_gnss_cb_handle_t handle = NULL;
+    app_gnss_cb_handle_t          handle = NULL;
+    app_gnss_async_stats_t        stats;
+    const app_gnss_async_config_t config = APP_GNSS_ASYNC_CONFIG_DEFAULT();
 
     printf("Start GNSS data monitoring, press any key to stop...\n");
-    handle = app_gnss_server_cb_register(cb_type, app_console_gnss_event_callback, NULL);
+    handle = app_gnss_server_cb_register_async(cb_type, app_console_gnss_event_callback, NULL, &config);
+    if (handle == NULL) {
+        printf("Failed to register GNSS consumer.\n");
+
+        return -3;
+    }
 
     getchar();
 
+    app_gnss_server_cb_async_stats_get(handle, &stats);
     app_gnss_server_cb_unregister(handle);
 
     printf("GNSS data monitoring stopped.\n");
+    printf("\tDelivered %" PRIu32 "/%" PRIu32 " events, dropped %" PRIu32 ", peak lag %" PRIu32
+           ", max latency %" PRIu32 " us\n",
+           stats.delivered, stats.enqueued, stats.dropped, stats.peak_lag, stats.max_latency_us);
+
+    return 0;
+}
+
+static int app_console_gnss_subcommand_stats(int argc, char **argv) {
+    app_gnss_server_stats_t stats;
+
+    if (app_gnss_server_stats_get(&stats) != 0) {
+        printf("Failed to retrieve GNSS statistics.\n");
+
+        return -1;
+    }
+
+    printf("GNSS receive path statistics:\n");
+    printf("\tBytes read: %" PRIu32 "\n", stats.rx_bytes);
+    printf("\tChunks parsed: %" PRIu32 "\n", stats.rx_chunks);
+    printf("\tRX backlog high-water: %" PRIu32 "/%" PRIu32 " bytes\n", stats.rx_backlog_max, stats.rx_buffer_size);
+    printf("\tFIFO overflows: %" PRIu32 "\n", stats.fifo_overflows);
+    printf("\tBaud rate: %" PRIu32 "\n", stats.baud_rate);
+    printf("\tRX wakeups: %" PRIu32 " (%" PRIu32 "/s, %" PRIu32 " bytes each)\n", stats.rx_wakeups,
+           stats.rx_wakeups_per_sec, stats.rx_bytes_per_wakeup);
+    printf("\tBoot: output %" PRIu32 " ms, configured %" PRIu32 " ms, first fix %" PRIu32 " ms\n",
+           stats.boot_output_ms, stats.boot_config_ms, stats.boot_first_fix_ms);
+    printf("\tCommands: %u acked, %u failed, %u retries\n", stats.cmd_acked, stats.cmd_failed, stats.cmd_retries);
+    printf("\tNMEA sentences: %" PRIu32 "\n", stats.nmea_frames);
+    printf("\tRTCM3 frames: %" PRIu32 "\n", stats.rtcm_frames);
+    printf("\tMSM observations: %" PRIu32 " messages, %" PRIu32 " slips, %" PRIu32 " lock losses\n",
+           stats.obs_messages, stats.obs_slips, stats.obs_losses);
+    printf("\tStation messages: %" PRIu32 " sent onboard, %" PRIu32 " module frames replaced\n", stats.station_injected,
+           stats.station_dropped);
+    printf("\tCorrections written: %" PRIu32 " bytes\n", stats.correction_bytes);
+    printf("\tReplay: %" PRIu32 " bytes fed, %" PRIu32 " live chunks dropped\n", stats.replay_bytes,
+           stats.replay_live_dropped);
+    printf("\tRejected frames: %" PRIu32 "\n", stats.rejected_frames);
+    printf("\tSkipped bytes: %" PRIu32 "\n", stats.skipped_bytes);
+
+    return 0;
+}
+
+static int app_console_gnss_bench_crc(uint32_t iterations) {
+    const size_t frame_len = 1029; /* Largest RTCM3 frame */
+
+    uint8_t *buf = malloc(frame_len);
+    if (buf == NULL) {
+        printf("Failed to allocate benchmark buffer.\n");
+
+        return -1;
+    }
+
+    for (size_t i = 0; i < frame_len; i++) {
+        buf[i] = (uint8_t)(i * 31U + 7U);
+    }
+
+    if (nl_crc24q(buf, frame_len) != nl_crc24q_bitwise(buf, frame_len)) {
+        printf("CRC-24Q kernels disagree, table self-test not passed?\n");
+    }
+
+    uint32_t crc = 0;
+
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        crc ^= nl_crc24q(buf, frame_len);
+    }
+    const int64_t table_us = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        crc ^= nl_crc24q_bitwise(buf, frame_len);
+    }
+    const int64_t bitwise_us = esp_timer_get_time() - start;
+
+    free(buf);
+
+    const double total_bytes = (double)frame_len * iterations;
+
+    printf("CRC-24Q over %" PRIu32 " x %u bytes (0x%06" PRIx32 "):\n", iterations, frame_len, crc);
+    printf("\tslicing-by-8: %" PRId64 " us, %.2f MB/s\n", table_us, total_bytes / (double)table_us);
+    printf("\tbitwise: %" PRId64 " us, %.2f MB/s\n", bitwise_us, total_bytes / (double)bitwise_us);
+
+    return 0;
+}
+
+static void app_console_gnss_bench_epoch(void *ctx, const app_gnss_fix_t *fix, const app_gnss_sat_t *sat) {
+    app_console_gnss_bench_parse_t *bench = ctx;
+
+    bench->epochs++;
+}
+
+/* Same decode work as the GNSS server per frame, without dispatching */
+static bool app_console_gnss_bench_frame(void *ctx, app_gnss_frame_type_t type, const uint8_t *frame, size_t len) {
+    app_console_gnss_bench_parse_t *bench = ctx;
+    bool                            ok;
+
+    if (type == APP_GNSS_FRAME_NMEA) {
+        nl_nmea_index_t index;
+
+        ok = nl_nmea_index_build(&index, frame, len) == 0;
+        if (ok) {
+            app_gnss_fix_builder_feed(&bench->fix_builder, &index, true);
+        }
+    } else {
+        const uint32_t crc = ((uint32_t)frame[len - 3] << 16U) | ((uint32_t)frame[len - 2] << 8U) | frame[len - 1];
+
+        ok = nl_crc24q(frame, len - 3) == crc;
+    }
+
+    /* Reservoir sampling keeps the percentiles fair over long captures */
+    const uint32_t now    = esp_cpu_get_cycle_count();
+    const uint32_t cycles = now - bench->mark;
+
+    if (bench->frames < APP_CONSOLE_GNSS_BENCH_SAMPLES) {
+        bench->samples[bench->frames] = cycles;
+    } else {
+        const uint32_t slot = esp_random() % (bench->frames + 1U);
+        if (slot < APP_CONSOLE_GNSS_BENCH_SAMPLES) {
+            bench->samples[slot] = cycles;
+        }
+    }
+
+    bench->frames++;
+    bench->mark = esp_cpu_get_cycle_count();
+
+    return ok;
+}
+
+static int app_console_gnss_bench_cmp(const void *a, const void *b) {
+    const uint32_t x = *(const uint32_t *)a;
+    const uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * Replay a recording through the demux, NMEA indexer, fix builder and RTCM CRC check, timing only the parser.
+ * Prints one JSON object. test/host/bench_parse runs the same recordings on a host, with dispatch and heap counts.
+ */
+static int app_console_gnss_bench_parse(const char *path, uint32_t iterations) {
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) {
+        printf("Failed to open %s.\n", path);
+
+        return -1;
+    }
+
+    app_console_gnss_bench_parse_t *bench = calloc(1, sizeof(app_console_gnss_bench_parse_t));
+    if (bench == NULL) {
+        printf("Failed to allocate benchmark state.\n");
+        fclose(fp);
+
+        return -1;
+    }
+
+    app_gnss_demux_init(&bench->demux, app_console_gnss_bench_frame, bench);
+    app_gnss_fix_builder_init(&bench->fix_builder, app_console_gnss_bench_epoch, bench);
+
+    uint64_t bytes   = 0;
+    int64_t  busy_us = 0;
+    int      ret     = 0;
+
+    for (uint32_t i = 0; i < iterations && ret == 0; i++) {
+        nl_rawlog_reader_t reader;
+
+        rewind(fp);
+        if (nl_rawlog_reader_open(&reader, fp) != 0) {
+            printf("%s is not a GNSS recording.\n", path);
+            ret = -2;
+            break;
+        }
+
+        for (;;) {
+            uint8_t   flags;
+            const int len = nl_rawlog_reader_next(&reader, bench->buf, &flags);
+            if (len < 0) {
+                break;
+            }
+
+            const int64_t start = esp_timer_get_time();
+            bench->mark         = esp_cpu_get_cycle_count();
+
+            app_gnss_demux_input(&bench->demux, bench->buf, len);
+            if (flags & NL_RAWLOG_IDLE) {
+                app_gnss_fix_builder_flush(&bench->fix_builder);
+            }
+
+            busy_us += esp_timer_get_time() - start;
+
+            bytes += len;
+        }
+    }
+
+    fclose(fp);
+
+    if (ret == 0) {
+        const app_gnss_demux_stats_t *stats   = &bench->demux.stats;
+        const uint32_t                samples = (bench->frames < APP_CONSOLE_GNSS_BENCH_SAMPLES)
+                                                    ? bench->frames
+                                                    : APP_CONSOLE_GNSS_BENCH_SAMPLES;
+        const double                  mhz     = esp_rom_get_cpu_ticks_per_us();
+        const double                  seconds = (busy_us > 0) ? busy_us / 1e6 : 1e-6;
+
+        qsort(bench->samples, samples, sizeof(uint32_t), app_console_gnss_bench_cmp);
+
+#define APP_CONSOLE_GNSS_PCT(p) (samples ? bench->samples[(samples - 1U) * (p) / 100U] / mhz : 0.0)
+        printf("{\"target\":\"parse\",\"file\":\"%s\",\"iterations\":%" PRIu32 ",\"bytes\":%" PRIu64
+               ",\"busy_us\":%" PRId64 ",\"nmea_frames\":%" PRIu32 ",\"rtcm_frames\":%" PRIu32
+               ",\"rejected\":%" PRIu32 ",\"skipped_bytes\":%" PRIu32 ",\"epochs\":%" PRIu32
+               ",\"bytes_per_s\":%.0f,\"frames_per_s\":%.0f,\"latency_us\":{\"p50\":%.2f,\"p90\":%.2f,"
+               "\"p99\":%.2f,\"max\":%.2f}}\n",
+               path, iterations, bytes, busy_us, stats->nmea_frames, stats->rtcm_frames, stats->rejected,
+               stats->skipped_bytes, bench->epochs, bytes / seconds, bench->frames / seconds,
+               APP_CONSOLE_GNSS_PCT(50), APP_CONSOLE_GNSS_PCT(90), APP_CONSOLE_GNSS_PCT(99),
+               APP_CONSOLE_GNSS_PCT(100));
+#undef APP_CONSOLE_GNSS_PCT
+    }
+
+    free(bench);
+
+    return ret;
+}
+
+static int app_console_gnss_subcommand_bench(int argc, char **argv) {
+    if (argc < 2) {
+        printf("Usage: gnss bench <TARGET> [ITERATIONS]\n");
+        printf("Targets:\n");
+        printf("\tcrc: CRC-24Q kernel throughput\n");
+        printf("\tparse <FILE>: Parser throughput and per-frame latency on a recording, as JSON\n");
+
+        return -1;
+    }
+
+    if (strcmp(argv[1], "parse") == 0) {
+        if (argc < 3) {
+            printf("Usage: gnss bench parse <FILE> [ITERATIONS]\n");
+
+            return -1;
+        }
+
+        char path[64];
+        app_console_gnss_path(argv[2], path, sizeof(path));
+
+        const uint32_t iterations = (argc > 3) ? strtoul(argv[3], NULL, 0) : 1;
+
+        return app_console_gnss_bench_parse(path, (iterations > 0) ? iterations : 1);
+    }
+
+    uint32_t iterations = 1000;
+    if (argc > 2) {
+        iterations = strtoul(argv[2], NULL, 0);
+        if (iterations == 0) {
+            printf("Invalid iteration count: %s\n", argv[2]);
+
+            return -2;
+        }
+    }
+
+    if (strcmp(argv[1], "crc") == 0) {
+        return app_console_gnss_bench_crc(iterations);
+    }
+
+    printf("Unknown benchmark target: %s\n", argv[1]);
+
+    return -1;
+}
+
+static void app_console_gnss_config_print(const app_gnss_server_config_t *config) {
+    printf("GNSS output profile:\n");
+    printf("\tFix interval: %u ms\n", config->fix_interval_ms);
+
+    printf("\tConstellations:");
+    for (uint8_t i = APP_GNSS_CONSTELLATION_GPS; i <= APP_GNSS_CONSTELLATION_NAVIC; i++) {
+        if (config->constellations & APP_GNSS_CONSTELLATION_BIT(i)) {
+            printf(" %s", s_app_console_gnss_constellations[i]);
+        }
+    }
+    printf("\n");
+
+    printf("\tNMEA rates:");
+    for (uint8_t i = 0; i < APP_GNSS_NMEA_COUNT; i++) {
+        printf(" %s=%u", app_gnss_server_nmea_name(i), config->nmea_rate[i]);
+    }
+    printf("\n");
+
+    printf("\tRTCM: MSM%u, station %s, ephemeris %s\n", config->rtcm_msm, config->rtcm_station ? "on" : "off",
+           config->rtcm_ephemeris ? "on" : "off");
+}
+
+/* Comma separated constellation list, e.g. "gps,galileo,beidou" */
+static int app_console_gnss_config_constellations(const char *list, uint8_t *mask) {
+    char  buf[64];
+    char *save;
+
+    strlcpy(buf, list, sizeof(buf));
+
+    *mask = 0U;
+
+    for (char *name = strtok_r(buf, ",", &save); name != NULL; name = strtok_r(NULL, ",", &save)) {
+        uint8_t i;
+        for (i = APP_GNSS_CONSTELLATION_GPS; i <= APP_GNSS_CONSTELLATION_NAVIC; i++) {
+            if (strcmp(name, s_app_console_gnss_constellations[i]) == 0) {
+                break;
+            }
+        }
+
+        if (i > APP_GNSS_CONSTELLATION_NAVIC) {
+            printf("Unknown constellation: %s\n", name);
+
+            return -1;
+        }
+
+        *mask |= APP_GNSS_CONSTELLATION_BIT(i);
+    }
+
+    return 0;
+}
+
+static int app_console_gnss_subcommand_config(int argc, char **argv) {
+    app_gnss_server_config_t config;
+
+    if (app_gnss_server_config_get(&config) != 0) {
+        app_gnss_server_config_init(&config);
+    }
+
+    if (argc < 2) {
+        app_console_gnss_config_print(&config);
+
+        return 0;
+    }
+
+    const char   *key = argv[1];
+    unsigned long value;
+
+    if (strcmp(key, "default") == 0) {
+        app_gnss_server_config_init(&config);
+    } else if (argc < 3) {
+        printf("Usage: gnss config [<KEY> <VALUE...>]\n");
+        printf("Keys:\n");
+        printf("\tdefault: Restore the default profile.\n");
+        printf("\tfix <MS>: Fix interval, 100-1000 ms.\n");
+        printf("\tconstellations <LIST>: e.g. gps,galileo,beidou; takes effect after a module reset.\n");
+        printf("\tnmea <SENTENCE> <RATE>: Output every RATE fixes, 0 disables, e.g. nmea GSV 0.\n");
+        printf("\tmsm <0|4|7>: RTCM MSM type, 0 disables.\n");
+        printf("\tstation <0|1>: RTCM 1005 station position.\n");
+        printf("\tephemeris <0|1>: RTCM ephemeris messages.\n");
+
+        return -1;
+    } else if (strcmp(key, "fix") == 0) {
+        if (app_console_gnss_uint(argv[2], UINT16_MAX, &value) != 0) {
+            return -1;
+        }
+
+        config.fix_interval_ms = value;
+    } else if (strcmp(key, "constellations") == 0) {
+        if (app_console_gnss_config_constellations(argv[2], &config.constellations) != 0) {
+            return -1;
+        }
+    } else if (strcmp(key, "nmea") == 0) {
+        if (argc < 4) {
+            printf("Usage: gnss config nmea <SENTENCE> <RATE>\n");
+
+            return -1;
+        }
+
+        uint8_t i;
+        for (i = 0; i < APP_GNSS_NMEA_COUNT; i++) {
+            if (strcasecmp(argv[2], app_gnss_server_nmea_name(i)) == 0) {
+                break;
+            }
+        }
+
+        if (i == APP_GNSS_NMEA_COUNT) {
+            printf("Unknown sentence: %s\n", argv[2]);
+
+            return -1;
+        }
+
+        if (app_console_gnss_uint(argv[3], UINT8_MAX, &value) != 0) {
+            return -1;
+        }
+
+        config.nmea_rate[i] = value;
+    } else if (strcmp(key, "msm") == 0) {
+        if (app_console_gnss_uint(argv[2], UINT8_MAX, &value) != 0) {
+            return -1;
+        }
+
+        config.rtcm_msm = value;
+    } else if (strcmp(key, "station") == 0) {
+        if (app_console_gnss_uint(argv[2], 1, &value) != 0) {
+            return -1;
+        }
+
+        config.rtcm_station = value != 0;
+    } else if (strcmp(key, "ephemeris") == 0) {
+        if (app_console_gnss_uint(argv[2], 1, &value) != 0) {
+            return -1;
+        }
+
+        config.rtcm_ephemeris = value != 0;
+    } else {
+        printf("Unknown key: %s\n", key);
+
+        return -1;
+    }
+
+    const int ret = app_gnss_server_config_set(&config);
+    if (ret != 0) {
+        printf("Failed to apply GNSS profile: %d\n", ret);
+
+        return -2;
+    }
+
+    app_console_gnss_config_print(&config);
+
+    return 0;
+}
+
+/* Parses a whole number in 0..max, anything else is reported and rejected before it can be narrowed */
+static int app_console_gnss_uint(const char *str, unsigned long max, unsigned long *value) {
+    char *end;
+
+    errno  = 0;
+    *value = strtoul(str, &end, 0);
+    if (end == str || *end != '\0' || errno != 0 || str[0] == '-' || *value > max) {
+        printf("Invalid value: %s, expected 0-%lu.\n", str, max);
+
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Names without a leading slash live on the storage partition */
+static void app_console_gnss_path(const char *name, char *path, size_t size) {
+    if (name[0] == '/') {
+        snprintf(path, size, "%s", name);
+    } else {
+        snprintf(path, size, APP_CONSOLE_GNSS_STORAGE "%s", name);
+    }
+}
+
+static int app_console_gnss_subcommand_record(int argc, char **argv) {
+    if (argc < 2) {
+        app_gnss_recorder_stats_t stats;
+        app_gnss_recorder_stats_get(&stats);
+
+        printf("Usage: gnss record <FILE> [MAX_KB] | gnss record stop\n");
+        printf("Recorder %s: %" PRIu32 " chunks, %" PRIu32 " bytes, %" PRIu32 " dropped, %" PRIu32 " bytes written\n",
+               stats.active ? "running" : "idle", stats.chunks, stats.bytes, stats.dropped_bytes, stats.file_bytes);
+
+        return -1;
+    }
+
+    if (strcmp(argv[1], "stop") == 0) {
+        app_gnss_recorder_stop();
+
+        return 0;
+    }
+
+    char path[64];
+    app_console_gnss_path(argv[1], path, sizeof(path));
+
+    unsigned long max_kb = 0;
+    if (argc > 2 && app_console_gnss_uint(argv[2], UINT32_MAX / 1024U, &max_kb) != 0) {
+        return -1;
+    }
+
+    if (app_gnss_recorder_start(path, max_kb * 1024U) != 0) {
+        printf("Failed to start recording to %s.\n", path);
+
+        return -2;
+    }
+
+    printf("Recording to %s, stop with: gnss record stop\n", path);
+
+    return 0;
+}
+
+static int app_console_gnss_subcommand_replay(int argc, char **argv) {
+    if (argc < 2) {
+        printf("Usage: gnss replay <FILE> [SPEED] | gnss replay stop\n");
+        printf("\tSPEED: Multiple of the recorded pace, 0 for as fast as possible, 1 by default.\n");
+
+        return -1;
+    }
+
+    if (strcmp(argv[1], "stop") == 0) {
+        app_gnss_server_replay_stop();
+
+        return 0;
+    }
+
+    char path[64];
+    app_console_gnss_path(argv[1], path, sizeof(path));
+
+    unsigned long speed = 1;
+    if (argc > 2 && app_console_gnss_uint(argv[2], UINT16_MAX, &speed) != 0) {
+        return -1;
+    }
+
+    if (app_gnss_server_replay_start(path, speed) != 0) {
+        printf("Failed to replay %s.\n", path);
+
+        return -2;
+    }
+
+    printf("Replaying %s, stop with: gnss replay stop\n", path);
 
     return 0;
 }
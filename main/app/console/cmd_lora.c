@@ -1,3 +1,7 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
 /* IDF */
 #include "esp_chip_info.h"
 #include "esp_console.h"
@@ -14,7 +18,36 @@
 #include "app/console/cmd_lora.h"
 #include "app/lora_server.h"
 
+static int app_console_lora_rtcm_stats(void) {
+    app_gnss_rtcm_sched_stats_t stats[APP_GNSS_RTCM_SCHED_MAX_TYPES + 1];
+
+    const size_t count = app_lora_server_rtcm_stats_get(stats, sizeof(stats) / sizeof(stats[0]));
+
+    printf("RTCM forwarding:\n");
+    printf("\t%6s %10s %12s %10s %12s\n", "Type", "Fwd", "Fwd bytes", "Supp", "Supp bytes");
+
+    for (size_t i = 0; i < count; i++) {
+        printf("\t%6u %10" PRIu32 " %12" PRIu32 " %10" PRIu32 " %12" PRIu32 "\n", stats[i].type,
+               stats[i].forwarded_frames, stats[i].forwarded_bytes, stats[i].suppressed_frames,
+               stats[i].suppressed_bytes);
+    }
+
+    app_lora_server_msm_stats_t msm;
+    if (app_lora_server_msm_stats_get(&msm) == 0 && msm.in_bytes > 0) {
+        printf("MSM transcoding: %" PRIu32 " frames, %" PRIu32 " unchanged, %" PRIu32 " -> %" PRIu32
+               " bytes (%" PRIu32 "%%)\n",
+               msm.transcoded, msm.passthrough, msm.in_bytes, msm.out_bytes,
+               (uint32_t)((uint64_t)msm.out_bytes * 100U / msm.in_bytes));
+    }
+
+    return 0;
+}
+
 static int app_console_lora_func(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "stats") == 0) {
+        return app_console_lora_rtcm_stats();
+    }
+
     uint8_t *buf = malloc(1024);
 
     for (size_t i = 0; i < 1024; i++) {
@@ -32,7 +65,7 @@ static int app_console_lora_func(int argc, char **argv) {
 
 const esp_console_cmd_t app_console_cmd_lora = {
     .command = "lora",
-    .help    = "LoRa control command",
+    .help    = "LoRa control command, \"lora stats\" shows RTCM forwarding per message type",
     .hint    = NULL,
     .func    = app_console_lora_func,
 };
\ No newline at end of file
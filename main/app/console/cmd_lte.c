@@ -0,0 +1,33 @@
+#include <inttypes.h>
+#include <stdio.h>
+
+/* IDF */
+#include "esp_console.h"
+
+/* App */
+#include "app/console/cmd_lte.h"
+#include "app/netif_lte.h"
+
+static int app_console_lte_func(int argc, char **argv) {
+    app_uart_rx_stats_t stats;
+
+    if (app_netif_lte_rx_stats_get(&stats) != 0) {
+        printf("Failed to retrieve LTE statistics.\n");
+
+        return -1;
+    }
+
+    printf("LTE UART receive path statistics:\n");
+    printf("\tBytes read: %" PRIu32 "\n", stats.bytes);
+    printf("\tRX wakeups: %" PRIu32 " (%" PRIu32 "/s, %" PRIu32 " bytes each)\n", stats.wakeups,
+           stats.wakeups_per_sec, stats.bytes_per_wakeup);
+
+    return 0;
+}
+
+const esp_console_cmd_t app_console_cmd_lte = {
+    .command = "lte",
+    .help    = "Get LTE modem UART receive statistics",
+    .hint    = NULL,
+    .func    = app_console_lte_func,
+};
@@ -0,0 +1,76 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+/* IDF */
+#include "esp_console.h"
+
+/* App */
+#include "app/console/cmd_nmea.h"
+#include "app/console/private.h"
+#include "app/nmea_server.h"
+
+static int app_console_nmea_subcommand_help(int argc, char **argv);
+static int app_console_nmea_subcommand_server(int argc, char **argv);
+
+static const app_console_subcommand_t s_app_console_nmea_subcommands[] = {
+    {.command = "help", .handler = app_console_nmea_subcommand_help},
+    {.command = "server", .handler = app_console_nmea_subcommand_server},
+};
+
+static int app_console_nmea_subcommand_help(int argc, char **argv) {
+    printf("Usage: nmea <command> [options...]\n");
+    printf("Commands:\n");
+    printf("\thelp: Print this help.\n");
+    printf("\tserver: Show NMEA server clients and traffic.\n");
+
+    if (argv != NULL) {
+        return 0;
+    }
+
+    return -1;
+}
+
+static int app_console_nmea_subcommand_server(int argc, char **argv) {
+    app_nmea_server_stats_t stats;
+
+    if (app_nmea_server_stats_get(&stats) != 0) {
+        printf("NMEA server disabled.\n");
+
+        return -1;
+    }
+
+    printf("NMEA server:\n");
+    printf("\tClients: %u connected, %" PRIu32 " accepted, %" PRIu32 " rejected, %" PRIu32 " too slow\n",
+           stats.clients, stats.accepted, stats.rejected, stats.slow);
+    printf("\tTraffic: %" PRIu32 " epochs, %" PRIu32 " bytes in, %" PRIu32 " bytes out, %" PRIu32 " datagrams\n",
+           stats.epochs, stats.bytes_in, stats.bytes_out, stats.datagrams);
+
+    return 0;
+}
+
+static int app_console_nmea_func(int argc, char **argv) {
+    if (argc <= 1) {
+        return app_console_nmea_subcommand_help(0, NULL);
+    }
+
+    char  *cmd            = argv[1];
+    size_t commands_count = sizeof(s_app_console_nmea_subcommands) / sizeof(s_app_console_nmea_subcommands[0]);
+
+    for (size_t i = 0; i < commands_count; i++) {
+        if (strcmp(cmd, s_app_console_nmea_subcommands[i].command) != 0) {
+            continue;
+        }
+
+        return s_app_console_nmea_subcommands[i].handler(argc - 1, &argv[1]);
+    }
+
+    return 0;
+}
+
+const esp_console_cmd_t app_console_cmd_nmea = {
+    .command = "nmea",
+    .help    = "NMEA server status",
+    .hint    = NULL,
+    .func    = &app_console_nmea_func,
+};
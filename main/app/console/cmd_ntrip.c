@@ -0,0 +1,153 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* IDF */
+#include "esp_console.h"
+
+/* App */
+#include "app/console/cmd_ntrip.h"
+#include "app/console/private.h"
+#include "app/ntrip_caster.h"
+#include "app/ntrip_client.h"
+
+static int app_console_ntrip_subcommand_help(int argc, char **argv);
+static int app_console_ntrip_subcommand_caster(int argc, char **argv);
+static int app_console_ntrip_subcommand_client(int argc, char **argv);
+
+static const app_console_subcommand_t s_app_console_ntrip_subcommands[] = {
+    {.command = "help", .handler = app_console_ntrip_subcommand_help},
+    {.command = "caster", .handler = app_console_ntrip_subcommand_caster},
+    {.command = "client", .handler = app_console_ntrip_subcommand_client},
+};
+
+static int app_console_ntrip_subcommand_help(int argc, char **argv) {
+    printf("Usage: ntrip <command> [options...]\n");
+    printf("Commands:\n");
+    printf("\thelp: Print this help.\n");
+    printf("\tcaster: Show NTRIP caster clients and traffic.\n");
+    printf("\tclient: Show NTRIP client status and correction metrics.\n");
+    printf("\tclient start <HOST> <PORT> <MOUNTPOINT> [USERNAME] [PASSWORD] [GGA_S]: Pull corrections into the GNSS "
+           "module.\n");
+    printf("\tclient stop: Stop pulling corrections.\n");
+
+    if (argv != NULL) {
+        return 0;
+    }
+
+    return -1;
+}
+
+static int app_console_ntrip_subcommand_caster(int argc, char **argv) {
+    app_ntrip_caster_stats_t stats;
+
+    if (app_ntrip_caster_stats_get(&stats) != 0) {
+        printf("NTRIP caster disabled.\n");
+
+        return -1;
+    }
+
+    printf("NTRIP caster:\n");
+    printf("\tClients: %u streaming, %" PRIu32 " accepted, %" PRIu32 " rejected, %" PRIu32 " too slow\n",
+           stats.clients, stats.accepted, stats.rejected, stats.slow);
+    printf("\tTraffic: %" PRIu32 " bytes in, %" PRIu32 " bytes out\n", stats.bytes_in, stats.bytes_out);
+
+    return 0;
+}
+
+static int app_console_ntrip_subcommand_client(int argc, char **argv) {
+    static const char *status_names[] = {"idle", "connecting", "streaming", "waiting to reconnect"};
+
+    app_ntrip_client_config_t config;
+    app_ntrip_client_config_get(&config);
+
+    if (argc >= 2 && strcmp(argv[1], "stop") == 0) {
+        config.enabled = false;
+
+        return app_ntrip_client_config_set(&config);
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "start") == 0) {
+        if (argc < 5 || argc > 8) {
+            return app_console_ntrip_subcommand_help(0, NULL);
+        }
+
+        char *end;
+        long  port = strtol(argv[3], &end, 10);
+        long  gga  = (argc > 7) ? strtol(argv[7], NULL, 10) : config.gga_interval_s;
+        if (*end != '\0' || port <= 0 || port > UINT16_MAX || gga < 0 || gga > UINT16_MAX) {
+            printf("Invalid port or GGA interval.\n");
+
+            return -1;
+        }
+
+        if (strlen(argv[2]) >= sizeof(config.host) || strlen(argv[4]) >= sizeof(config.mountpoint) ||
+            (argc > 5 && strlen(argv[5]) >= sizeof(config.username)) ||
+            (argc > 6 && strlen(argv[6]) >= sizeof(config.password))) {
+            printf("Argument too long.\n");
+
+            return -1;
+        }
+
+        config.enabled        = true;
+        config.port           = port;
+        config.gga_interval_s = gga;
+        strlcpy(config.host, argv[2], sizeof(config.host));
+        strlcpy(config.mountpoint, argv[4], sizeof(config.mountpoint));
+        strlcpy(config.username, (argc > 5) ? argv[5] : "", sizeof(config.username));
+        strlcpy(config.password, (argc > 6) ? argv[6] : "", sizeof(config.password));
+
+        if (app_ntrip_client_config_set(&config) != 0) {
+            printf("Invalid client configuration.\n");
+
+            return -1;
+        }
+
+        return 0;
+    }
+
+    app_ntrip_client_stats_t stats;
+    app_ntrip_client_stats_get(&stats);
+
+    printf("NTRIP client: %s\n", status_names[stats.status]);
+    if (config.host[0] != '\0') {
+        printf("\tCaster: %s:%u/%s, GGA every %u s\n", config.host, config.port, config.mountpoint,
+               config.gga_interval_s);
+    }
+    printf("\tConnections: %" PRIu32 " streamed, %" PRIu32 " failed\n", stats.connects, stats.failures);
+    printf("\tCorrections: %" PRIu32 " bytes, %" PRIu32 " bytes/s, %" PRIu32 " frames\n", stats.bytes,
+           stats.bytes_per_sec, stats.frames);
+    if (stats.age_ms != UINT32_MAX) {
+        printf("\tLast frame: %u, %" PRIu32 " ms ago\n", stats.last_type, stats.age_ms);
+    }
+    printf("\tGGA sent: %" PRIu32 "\n", stats.gga_sent);
+
+    return 0;
+}
+
+static int app_console_ntrip_func(int argc, char **argv) {
+    if (argc <= 1) {
+        return app_console_ntrip_subcommand_help(0, NULL);
+    }
+
+    char  *cmd            = argv[1];
+    size_t commands_count = sizeof(s_app_console_ntrip_subcommands) / sizeof(s_app_console_ntrip_subcommands[0]);
+
+    for (size_t i = 0; i < commands_count; i++) {
+        if (strcmp(cmd, s_app_console_ntrip_subcommands[i].command) != 0) {
+            continue;
+        }
+
+        return s_app_console_ntrip_subcommands[i].handler(argc - 1, &argv[1]);
+    }
+
+    return 0;
+}
+
+const esp_console_cmd_t app_console_cmd_ntrip = {
+    .command = "ntrip",
+    .help    = "NTRIP caster status and client control",
+    .hint    = NULL,
+    .func    = &app_console_ntrip_func,
+};
@@ -12,10 +12,14 @@
 #include "nvs_flash.h"
 
 /* App */
+#include "app/console/cmd_base.h"
 #include "app/console/cmd_free.h"
 #include "app/console/cmd_gnss.h"
 #include "app/console/cmd_ip.h"
 #include "app/console/cmd_lora.h"
+#include "app/console/cmd_lte.h"
+#include "app/console/cmd_nmea.h"
+#include "app/console/cmd_ntrip.h"
 #include "app/console/cmd_ps.h"
 #include "app/console/cmd_reset.h"
 #include "app/console/cmd_version.h"
@@ -27,10 +31,14 @@
 static const char* LOG_TAG = "asuna_console";
 
 static const esp_console_cmd_t* s_app_console_cmd_list[] = {
+    &app_console_cmd_base,
     &app_console_cmd_free,
     &app_console_cmd_gnss,
     &app_console_cmd_ip,
     &app_console_cmd_lora,
+    &app_console_cmd_lte,
+    &app_console_cmd_nmea,
+    &app_console_cmd_ntrip,
     &app_console_cmd_ps,
     &app_console_cmd_reset,
     &app_console_cmd_version,
@@ -0,0 +1,355 @@
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* IDF */
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_vfs_eventfd.h"
+#include "fcntl.h"
+
+/* App */
+#include "app/fanout_server.h"
+
+static void app_fanout_server_task(void *parameters);
+static void app_fanout_server_accept(app_fanout_server_t *server);
+
+int app_fanout_server_init(app_fanout_server_t *server, const app_fanout_server_config_t *config) {
+    const char *tag = config->log_tag;
+
+    memset(server, 0U, sizeof(app_fanout_server_t));
+
+    server->config    = *config;
+    server->listen_fd = -1;
+    server->event_fd  = -1;
+
+    const uint32_t ring_size = config->buffer_size;
+    if ((ring_size & (ring_size - 1)) != 0) {
+        ESP_LOGE(tag, "Buffer size must be a power of 2.");
+        return -1;
+    }
+
+    uint8_t *ring_buf = malloc(ring_size);
+    if (ring_buf == NULL) {
+        ESP_LOGE(tag, "Failed to allocate server buffer.");
+        return -1;
+    }
+
+    app_gnss_fanout_ring_init(&server->ring, ring_buf, ring_size);
+
+    server->clients = malloc(config->max_clients * sizeof(app_fanout_server_client_t));
+    if (server->clients == NULL) {
+        ESP_LOGE(tag, "Failed to allocate client slots.");
+        goto free_ring_exit;
+    }
+
+    for (size_t i = 0; i < config->max_clients; i++) {
+        server->clients[i].fd        = -1;
+        server->clients[i].streaming = false;
+    }
+
+    server->mutex = xSemaphoreCreateMutex();
+    if (server->mutex == NULL) {
+        ESP_LOGE(tag, "Failed to create mutex.");
+        goto free_clients_exit;
+    }
+
+    /* ---- Wakeup channel from the producer ---- */
+    const esp_vfs_eventfd_config_t eventfd_config = ESP_VFS_EVENTD_CONFIG_DEFAULT();
+
+    const esp_err_t err = esp_vfs_eventfd_register(&eventfd_config);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(tag, "Failed to register eventfd.");
+        goto del_mutex_exit;
+    }
+
+    server->event_fd = eventfd(0, EFD_SUPPORT_ISR);
+    if (server->event_fd < 0) {
+        ESP_LOGE(tag, "Failed to create eventfd.");
+        goto del_mutex_exit;
+    }
+
+    /* ---- Listening socket ---- */
+    server->listen_fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (server->listen_fd < 0) {
+        ESP_LOGE(tag, "Failed to create socket.");
+        goto close_event_exit;
+    }
+
+    const int reuse = 1;
+    setsockopt(server->listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in addr = {
+        .sin_family      = AF_INET,
+        .sin_port        = htons(config->port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+
+    if (bind(server->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(server->listen_fd, config->max_clients) != 0) {
+        ESP_LOGE(tag, "Failed to listen on port %d, errno: %d", config->port, errno);
+        goto close_listen_exit;
+    }
+
+    fcntl(server->listen_fd, F_SETFL, O_NONBLOCK);
+
+    return 0;
+
+close_listen_exit:
+    close(server->listen_fd);
+    server->listen_fd = -1;
+
+close_event_exit:
+    close(server->event_fd);
+    server->event_fd = -1;
+
+del_mutex_exit:
+    vSemaphoreDelete(server->mutex);
+    server->mutex = NULL;
+
+free_clients_exit:
+    free(server->clients);
+    server->clients = NULL;
+
+free_ring_exit:
+    free(ring_buf);
+    server->ring.buf = NULL;
+
+    return -1;
+}
+
+int app_fanout_server_start(app_fanout_server_t *server) {
+    if (xTaskCreate(app_fanout_server_task, server->config.task_name, server->config.task_stack, server, 5,
+                    &server->task) != pdPASS) {
+        ESP_LOGE(server->config.log_tag, "Failed to create server task.");
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Undoes app_fanout_server_init(), the task must not have been started. */
+void app_fanout_server_deinit(app_fanout_server_t *server) {
+    close(server->listen_fd);
+    close(server->event_fd);
+    vSemaphoreDelete(server->mutex);
+    free(server->clients);
+    free(server->ring.buf);
+
+    server->listen_fd = -1;
+    server->event_fd  = -1;
+    server->mutex     = NULL;
+    server->clients   = NULL;
+    server->ring.buf  = NULL;
+}
+
+void app_fanout_server_write(app_fanout_server_t *server, const uint8_t *data, size_t len) {
+    app_gnss_fanout_ring_write(&server->ring, data, len);
+    server->stats.bytes_in += len;
+
+    if (server->stats.clients > 0) {
+        app_fanout_server_wake(server);
+    }
+}
+
+void app_fanout_server_wake(app_fanout_server_t *server) {
+    const uint64_t one = 1;
+    write(server->event_fd, &one, sizeof(one));
+}
+
+bool app_fanout_server_pending(const app_fanout_server_t *server, size_t index, size_t *pending) {
+    return app_gnss_fanout_ring_pending(&server->ring, server->clients[index].pos, pending) &&
+           *pending <= server->config.window;
+}
+
+void app_fanout_server_stream(app_fanout_server_t *server, size_t index) {
+    app_fanout_server_client_t *client = &server->clients[index];
+
+    xSemaphoreTake(server->mutex, portMAX_DELAY);
+
+    /* Writes are whole frames or epochs, so the head is a boundary */
+    client->pos       = app_gnss_fanout_ring_head(&server->ring);
+    client->streaming = true;
+
+    server->stats.clients++;
+    server->stats.accepted++;
+
+    xSemaphoreGive(server->mutex);
+}
+
+void app_fanout_server_reject(app_fanout_server_t *server, size_t index) {
+    xSemaphoreTake(server->mutex, portMAX_DELAY);
+    server->stats.rejected++;
+    xSemaphoreGive(server->mutex);
+
+    app_fanout_server_close(server, index);
+}
+
+void app_fanout_server_close(app_fanout_server_t *server, size_t index) {
+    app_fanout_server_client_t *client = &server->clients[index];
+
+    if (client->streaming) {
+        xSemaphoreTake(server->mutex, portMAX_DELAY);
+        server->stats.clients--;
+        xSemaphoreGive(server->mutex);
+    }
+
+    close(client->fd);
+
+    client->fd        = -1;
+    client->streaming = false;
+}
+
+static void app_fanout_server_task(void *parameters) {
+    app_fanout_server_t              *server = parameters;
+    const app_fanout_server_config_t *config = &server->config;
+
+    for (;;) {
+        fd_set read_fds;
+        fd_set write_fds;
+        int    max_fd = (server->listen_fd > server->event_fd) ? server->listen_fd : server->event_fd;
+
+        FD_ZERO(&read_fds);
+        FD_ZERO(&write_fds);
+        FD_SET(server->listen_fd, &read_fds);
+        FD_SET(server->event_fd, &read_fds);
+
+        struct timeval timeout = {
+            .tv_sec  = config->select_ms / 1000,
+            .tv_usec = (config->select_ms % 1000) * 1000,
+        };
+
+        xSemaphoreTake(server->mutex, portMAX_DELAY);
+
+        if (config->poll != NULL) {
+            config->poll(server, &timeout);
+        }
+
+        for (size_t i = 0; i < config->max_clients; i++) {
+            app_fanout_server_client_t *client = &server->clients[i];
+
+            if (client->fd < 0) {
+                continue;
+            }
+
+            /* Streaming clients are read too, to notice them leaving */
+            FD_SET(client->fd, &read_fds);
+
+            size_t pending = 0;
+            if (client->streaming && ((config->unsent != NULL && config->unsent(server, i)) ||
+                                      !app_gnss_fanout_ring_pending(&server->ring, client->pos, &pending) ||
+                                      pending > 0)) {
+                FD_SET(client->fd, &write_fds);
+            }
+
+            if (client->fd > max_fd) max_fd = client->fd;
+        }
+
+        xSemaphoreGive(server->mutex);
+
+        if (select(max_fd + 1, &read_fds, &write_fds, NULL, &timeout) < 0) {
+            ESP_LOGE(config->log_tag, "select() failed, errno: %d", errno);
+            vTaskDelay(pdMS_TO_TICKS(config->select_ms));
+            continue;
+        }
+
+        if (FD_ISSET(server->event_fd, &read_fds)) {
+            uint64_t count;
+            read(server->event_fd, &count, sizeof(count));
+        }
+
+        if (FD_ISSET(server->listen_fd, &read_fds)) {
+            app_fanout_server_accept(server);
+        }
+
+        const int64_t now = esp_timer_get_time();
+
+        for (size_t i = 0; i < config->max_clients; i++) {
+            app_fanout_server_client_t *client = &server->clients[i];
+
+            if (client->fd < 0) {
+                continue;
+            }
+
+            if (!client->streaming) {
+                config->request(server, i, FD_ISSET(client->fd, &read_fds), now);
+                continue;
+            }
+
+            /* Anything a streaming client sends is discarded */
+            if (FD_ISSET(client->fd, &read_fds)) {
+                char      discard[64];
+                const int ret = recv(client->fd, discard, sizeof(discard), MSG_DONTWAIT);
+
+                if (ret == 0 || (ret < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+                    ESP_LOGI(config->log_tag, "Client left, fd: %d", client->fd);
+                    app_fanout_server_close(server, i);
+                    continue;
+                }
+            }
+
+            xSemaphoreTake(server->mutex, portMAX_DELAY);
+            const int ret = config->flush(server, i);
+            if (ret == -2) {
+                server->stats.slow++;
+            }
+            xSemaphoreGive(server->mutex);
+
+            if (ret == -2) {
+                ESP_LOGW(config->log_tag, "Client too slow, disconnecting, fd: %d", client->fd);
+            }
+
+            if (ret != 0) {
+                app_fanout_server_close(server, i);
+            }
+        }
+    }
+}
+
+static void app_fanout_server_accept(app_fanout_server_t *server) {
+    struct sockaddr_in addr;
+    socklen_t          addr_len = sizeof(addr);
+
+    const int fd = accept(server->listen_fd, (struct sockaddr *)&addr, &addr_len);
+    if (fd < 0) {
+        return;
+    }
+
+    size_t index = server->config.max_clients;
+    for (size_t i = 0; i < server->config.max_clients; i++) {
+        if (server->clients[i].fd < 0) {
+            index = i;
+            break;
+        }
+    }
+
+    if (index == server->config.max_clients) {
+        ESP_LOGW(server->config.log_tag, "No free client slot, rejecting connection.");
+        close(fd);
+
+        xSemaphoreTake(server->mutex, portMAX_DELAY);
+        server->stats.rejected++;
+        xSemaphoreGive(server->mutex);
+
+        return;
+    }
+
+    /* Sends are whole frames or epochs, nothing to gain from holding them back */
+    const int nodelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+
+    app_fanout_server_client_t *client = &server->clients[index];
+
+    client->fd        = fd;
+    client->streaming = false;
+    client->since_us  = esp_timer_get_time();
+
+    if (server->config.request == NULL) {
+        ESP_LOGI(server->config.log_tag, "Streaming to %s, fd: %d", inet_ntoa(addr.sin_addr), fd);
+        app_fanout_server_stream(server, index);
+    } else {
+        ESP_LOGD(server->config.log_tag, "Connection from %s, fd: %d", inet_ntoa(addr.sin_addr), fd);
+    }
+}
@@ -0,0 +1,322 @@
+#include <stdatomic.h>
+#include <stddef.h>
+#include <string.h>
+
+/* IDF */
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/ringbuf.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+/* App */
+#include "app/gnss/async_consumer.h"
+
+#define APP_GNSS_ASYNC_EVICT_ATTEMPTS (4)
+#define APP_GNSS_ASYNC_TYPE_STOP      (0U)
+
+struct app_gnss_async {
+    app_gnss_cb_t cb;
+    void         *user_data;
+
+    app_gnss_async_policy_t policy;
+    TickType_t              block_ticks;
+
+    RingbufHandle_t   ring;
+    TaskHandle_t      task;
+    SemaphoreHandle_t stopped;
+
+    atomic_uint enqueued;
+    atomic_uint delivered;
+    atomic_uint dropped;
+    atomic_uint evicted; /* Subset of dropped: queued events discarded by DROP_OLDEST */
+    atomic_uint peak_lag;
+    atomic_uint max_latency_us;
+};
+
+/* Ring item header, followed by the serialized payload. */
+typedef struct {
+    uint32_t type;
+    uint32_t timestamp_us; /* Low 32 bits of esp_timer at enqueue */
+} app_gnss_async_item_t;
+
+static const char *LOG_TAG = "asuna_gnss_async";
+
+static void   app_gnss_async_task(void *parameters);
+static size_t app_gnss_async_payload_size(app_gnss_cb_type_t type, const void *payload);
+static void   app_gnss_async_serialize(app_gnss_cb_type_t type, const void *payload, uint8_t *dst);
+static void  *app_gnss_async_deserialize(app_gnss_cb_type_t type, uint8_t *src, size_t len);
+static bool   app_gnss_async_acquire(app_gnss_async_t *async, void **item, size_t size);
+
+app_gnss_async_t *app_gnss_async_create(const app_gnss_async_config_t *config, app_gnss_cb_t cb, void *user_data) {
+    app_gnss_async_t *async = calloc(1, sizeof(app_gnss_async_t));
+    if (async == NULL) {
+        return NULL;
+    }
+
+    async->cb          = cb;
+    async->user_data   = user_data;
+    async->policy      = config->policy;
+    async->block_ticks = pdMS_TO_TICKS(config->block_timeout_ms);
+
+    async->ring = xRingbufferCreate(config->queue_size, RINGBUF_TYPE_NOSPLIT);
+    if (async->ring == NULL) {
+        ESP_LOGE(LOG_TAG, "Failed to allocate %u bytes delivery ring", config->queue_size);
+        goto free_async_exit;
+    }
+
+    async->stopped = xSemaphoreCreateBinary();
+    if (async->stopped == NULL) {
+        goto del_ring_exit;
+    }
+
+    if (xTaskCreate(app_gnss_async_task, config->task_name, config->task_stack, async, config->task_priority,
+                    &async->task) != pdPASS) {
+        ESP_LOGE(LOG_TAG, "Failed to create delivery task %s", config->task_name);
+        goto del_sem_exit;
+    }
+
+    return async;
+
+del_sem_exit:
+    vSemaphoreDelete(async->stopped);
+
+del_ring_exit:
+    vRingbufferDelete(async->ring);
+
+free_async_exit:
+    free(async);
+
+    return NULL;
+}
+
+void app_gnss_async_destroy(app_gnss_async_t *async) {
+    /* No producer can reach us anymore, queue the stop marker behind whatever is still pending. */
+    const app_gnss_async_item_t stop = {.type = APP_GNSS_ASYNC_TYPE_STOP};
+
+    xRingbufferSend(async->ring, &stop, sizeof(stop), portMAX_DELAY);
+    xSemaphoreTake(async->stopped, portMAX_DELAY);
+
+    vSemaphoreDelete(async->stopped);
+    vRingbufferDelete(async->ring);
+    free(async);
+}
+
+void app_gnss_async_enqueue(app_gnss_async_t *async, app_gnss_cb_type_t type, const void *payload) {
+    const size_t size = sizeof(app_gnss_async_item_t) + app_gnss_async_payload_size(type, payload);
+
+    void *item;
+    if (!app_gnss_async_acquire(async, &item, size)) {
+        atomic_fetch_add(&async->dropped, 1);
+        return;
+    }
+
+    app_gnss_async_item_t *hdr = item;
+
+    hdr->type         = type;
+    hdr->timestamp_us = (uint32_t)esp_timer_get_time();
+
+    app_gnss_async_serialize(type, payload, (uint8_t *)item + sizeof(app_gnss_async_item_t));
+
+    xRingbufferSendComplete(async->ring, item);
+
+    const uint32_t enqueued = atomic_fetch_add(&async->enqueued, 1) + 1;
+    const uint32_t lag      = enqueued - atomic_load(&async->delivered) - atomic_load(&async->evicted);
+
+    uint32_t peak = atomic_load(&async->peak_lag);
+    while (lag > peak && !atomic_compare_exchange_weak(&async->peak_lag, &peak, lag)) {
+    }
+}
+
+void app_gnss_async_stats_get(app_gnss_async_t *async, app_gnss_async_stats_t *stats) {
+    stats->enqueued       = atomic_load(&async->enqueued);
+    stats->delivered      = atomic_load(&async->delivered);
+    stats->dropped        = atomic_load(&async->dropped);
+    stats->lag            = stats->enqueued - stats->delivered - atomic_load(&async->evicted);
+    stats->peak_lag       = atomic_load(&async->peak_lag);
+    stats->max_latency_us = atomic_load(&async->max_latency_us);
+}
+
+static bool app_gnss_async_acquire(app_gnss_async_t *async, void **item, size_t size) {
+    if (size > xRingbufferGetMaxItemSize(async->ring)) {
+        return false;
+    }
+
+    switch (async->policy) {
+        case APP_GNSS_ASYNC_BLOCK:
+            return xRingbufferSendAcquire(async->ring, item, size, async->block_ticks) == pdTRUE;
+
+        case APP_GNSS_ASYNC_DROP_NEWEST:
+            return xRingbufferSendAcquire(async->ring, item, size, 0) == pdTRUE;
+
+        case APP_GNSS_ASYNC_DROP_OLDEST:
+        default:
+            break;
+    }
+
+    for (uint8_t i = 0; i < APP_GNSS_ASYNC_EVICT_ATTEMPTS; i++) {
+        if (xRingbufferSendAcquire(async->ring, item, size, 0) == pdTRUE) {
+            return true;
+        }
+
+        /* Evict the oldest queued event; the delivery task may hold the head item, so this can take a few rounds. */
+        size_t old_len;
+        void  *old = xRingbufferReceive(async->ring, &old_len, 0);
+        if (old == NULL) {
+            break;
+        }
+
+        vRingbufferReturnItem(async->ring, old);
+
+        atomic_fetch_add(&async->evicted, 1);
+        atomic_fetch_add(&async->dropped, 1);
+    }
+
+    return false;
+}
+
+static size_t app_gnss_async_payload_size(app_gnss_cb_type_t type, const void *payload) {
+    if (payload == NULL) {
+        return 0;
+    }
+
+    switch (type) {
+        case APP_GNSS_CB_FIX:
+            return sizeof(app_gnss_fix_t);
+
+        case APP_GNSS_CB_PPS:
+            return sizeof(app_gnss_pps_t);
+
+        case APP_GNSS_CB_SAT: {
+            const app_gnss_sat_t *sat = payload;
+            return offsetof(app_gnss_sat_t, sats) + sat->count * sizeof(app_gnss_sat_info_t);
+        }
+
+        case APP_GNSS_CB_OBS: {
+            const app_gnss_obs_t *obs = payload;
+            return offsetof(app_gnss_obs_t, sigs) + obs->count * sizeof(app_gnss_obs_sig_t);
+        }
+
+        case APP_GNSS_CB_RAW_RTCM: {
+            const app_gnss_rtcm_t *rtcm = payload;
+            return sizeof(app_gnss_rtcm_t) + rtcm->data_len;
+        }
+
+        case APP_GNSS_CB_RAW_NMEA: {
+            const app_gnss_nmea_t *nmea = payload;
+            return sizeof(app_gnss_nmea_t) + sizeof(nl_nmea_index_t) + nmea->data_len;
+        }
+
+        default:
+            return 0;
+    }
+}
+
+static void app_gnss_async_serialize(app_gnss_cb_type_t type, const void *payload, uint8_t *dst) {
+    if (payload == NULL) {
+        return;
+    }
+
+    switch (type) {
+        case APP_GNSS_CB_FIX:
+            memcpy(dst, payload, sizeof(app_gnss_fix_t));
+            break;
+
+        case APP_GNSS_CB_PPS:
+            memcpy(dst, payload, sizeof(app_gnss_pps_t));
+            break;
+
+        case APP_GNSS_CB_SAT:
+        case APP_GNSS_CB_OBS:
+            /* Only the populated part of the table */
+            memcpy(dst, payload, app_gnss_async_payload_size(type, payload));
+            break;
+
+        case APP_GNSS_CB_RAW_RTCM: {
+            const app_gnss_rtcm_t *rtcm = payload;
+
+            memcpy(dst, rtcm, sizeof(app_gnss_rtcm_t));
+            memcpy(dst + sizeof(app_gnss_rtcm_t), rtcm->data, rtcm->data_len);
+            break;
+        }
+
+        case APP_GNSS_CB_RAW_NMEA: {
+            const app_gnss_nmea_t *nmea = payload;
+
+            memcpy(dst, nmea, sizeof(app_gnss_nmea_t));
+            memcpy(dst + sizeof(app_gnss_nmea_t), nmea->index, sizeof(nl_nmea_index_t));
+            memcpy(dst + sizeof(app_gnss_nmea_t) + sizeof(nl_nmea_index_t), nmea->data, nmea->data_len);
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+/* Point the copied payload back at its own trailing data; returns the payload to hand to the callback. */
+static void *app_gnss_async_deserialize(app_gnss_cb_type_t type, uint8_t *src, size_t len) {
+    if (len == 0) {
+        return NULL;
+    }
+
+    switch (type) {
+        case APP_GNSS_CB_RAW_RTCM: {
+            app_gnss_rtcm_t *rtcm = (app_gnss_rtcm_t *)src;
+
+            rtcm->data = src + sizeof(app_gnss_rtcm_t);
+            break;
+        }
+
+        case APP_GNSS_CB_RAW_NMEA: {
+            app_gnss_nmea_t *nmea  = (app_gnss_nmea_t *)src;
+            nl_nmea_index_t *index = (nl_nmea_index_t *)(src + sizeof(app_gnss_nmea_t));
+
+            nmea->data = src + sizeof(app_gnss_nmea_t) + sizeof(nl_nmea_index_t);
+            nl_nmea_index_rebase(index, (const char *)nmea->data);
+            nmea->index = index;
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    return src;
+}
+
+static void app_gnss_async_task(void *parameters) {
+    app_gnss_async_t *async = parameters;
+
+    for (;;) {
+        size_t                 len;
+        app_gnss_async_item_t *item = xRingbufferReceive(async->ring, &len, portMAX_DELAY);
+        if (item == NULL) {
+            continue;
+        }
+
+        if (item->type == APP_GNSS_ASYNC_TYPE_STOP) {
+            vRingbufferReturnItem(async->ring, item);
+            break;
+        }
+
+        const uint32_t latency = (uint32_t)esp_timer_get_time() - item->timestamp_us;
+        if (latency > atomic_load(&async->max_latency_us)) {
+            atomic_store(&async->max_latency_us, latency);
+        }
+
+        void *payload = app_gnss_async_deserialize(item->type, (uint8_t *)item + sizeof(app_gnss_async_item_t),
+                                                   len - sizeof(app_gnss_async_item_t));
+
+        async->cb(async->user_data, item->type, payload);
+
+        vRingbufferReturnItem(async->ring, item);
+
+        atomic_fetch_add(&async->delivered, 1);
+    }
+
+    xSemaphoreGive(async->stopped);
+
+    vTaskDelete(NULL);
+}
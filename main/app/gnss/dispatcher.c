@@ -0,0 +1,175 @@
+#include <stdlib.h>
+
+/* IDF */
+#include "freertos/task.h"
+
+/* App */
+#include "app/gnss/dispatcher.h"
+
+static unsigned int app_gnss_dispatcher_enter(app_gnss_dispatcher_t *dispatcher);
+static void         app_gnss_dispatcher_exit(app_gnss_dispatcher_t *dispatcher, unsigned int slot);
+static void         app_gnss_dispatcher_synchronize(app_gnss_dispatcher_t *dispatcher);
+
+int app_gnss_dispatcher_init(app_gnss_dispatcher_t *dispatcher) {
+    dispatcher->mutex = xSemaphoreCreateMutex();
+    if (dispatcher->mutex == NULL) {
+        return -1;
+    }
+
+    app_gnss_consumer_set_t *empty_set = calloc(1, sizeof(app_gnss_consumer_set_t));
+    if (empty_set == NULL) {
+        vSemaphoreDelete(dispatcher->mutex);
+
+        return -1;
+    }
+
+    atomic_store(&dispatcher->set, empty_set);
+    atomic_store(&dispatcher->mask, 0U);
+    atomic_store(&dispatcher->epoch, 0U);
+    atomic_store(&dispatcher->readers[0], 0U);
+    atomic_store(&dispatcher->readers[1], 0U);
+
+    return 0;
+}
+
+int app_gnss_dispatcher_update(app_gnss_dispatcher_t *dispatcher, app_gnss_consumer_t *add,
+                               app_gnss_consumer_t *remove) {
+    int ret = 0;
+
+    if (xSemaphoreTake(dispatcher->mutex, portMAX_DELAY) != pdPASS) {
+        return -1;
+    }
+
+    app_gnss_consumer_set_t *old_set = atomic_load(&dispatcher->set);
+
+    /* ---- Size the new set: flat list plus one slot per subscribed type ---- */
+    size_t count   = 0;
+    size_t slots   = 0;
+    bool   removed = false;
+
+    for (size_t i = 0; i <= old_set->count; i++) {
+        const app_gnss_consumer_t *consumer = (i < old_set->count) ? old_set->consumers[i] : add;
+
+        if (consumer == NULL) {
+            continue;
+        }
+
+        if (consumer == remove) {
+            removed = true;
+            continue;
+        }
+
+        count++;
+        slots += __builtin_popcount(consumer->type & ((1U << APP_GNSS_DISPATCHER_TYPE_COUNT) - 1U));
+    }
+
+    if (remove != NULL && !removed) {
+        ret = -3;
+        goto release_mutex_exit;
+    }
+
+    app_gnss_consumer_set_t *new_set =
+        calloc(1, sizeof(app_gnss_consumer_set_t) + (count + slots) * sizeof(app_gnss_consumer_t *));
+    if (new_set == NULL) {
+        ret = -2;
+        goto release_mutex_exit;
+    }
+
+    /* ---- Fill the flat list ---- */
+    for (size_t i = 0; i <= old_set->count; i++) {
+        app_gnss_consumer_t *consumer = (i < old_set->count) ? old_set->consumers[i] : add;
+
+        if (consumer == NULL || consumer == remove) {
+            continue;
+        }
+
+        new_set->consumers[new_set->count++] = consumer;
+    }
+
+    /* ---- Carve the per-type arrays out of the tail ---- */
+    app_gnss_consumer_t **slot = &new_set->consumers[new_set->count];
+    uint32_t              mask = 0U;
+
+    for (size_t t = 0; t < APP_GNSS_DISPATCHER_TYPE_COUNT; t++) {
+        new_set->type_consumers[t] = slot;
+
+        for (size_t i = 0; i < new_set->count; i++) {
+            if (new_set->consumers[i]->type & (1U << t)) {
+                new_set->type_consumers[t][new_set->type_count[t]++] = new_set->consumers[i];
+            }
+        }
+
+        slot += new_set->type_count[t];
+
+        if (new_set->type_count[t] > 0) {
+            mask |= (1U << t);
+        }
+    }
+
+    atomic_store(&dispatcher->set, new_set);
+    atomic_store(&dispatcher->mask, mask);
+
+    app_gnss_dispatcher_synchronize(dispatcher);
+
+    free(old_set);
+
+release_mutex_exit:
+    xSemaphoreGive(dispatcher->mutex);
+
+    return ret;
+}
+
+void app_gnss_dispatcher_dispatch(app_gnss_dispatcher_t *dispatcher, app_gnss_cb_type_t type, void *data) {
+    const unsigned int t = __builtin_ctz(type);
+
+    if (t >= APP_GNSS_DISPATCHER_TYPE_COUNT) {
+        return;
+    }
+
+    unsigned int slot = app_gnss_dispatcher_enter(dispatcher);
+
+    const app_gnss_consumer_set_t *set = atomic_load(&dispatcher->set);
+
+    for (size_t i = 0; i < set->type_count[t]; i++) {
+        const app_gnss_consumer_t *consumer = set->type_consumers[t][i];
+
+        if (consumer->async != NULL) {
+            app_gnss_async_enqueue(consumer->async, type, data);
+        } else {
+            consumer->cb(consumer->user_data, type, data);
+        }
+    }
+
+    app_gnss_dispatcher_exit(dispatcher, slot);
+}
+
+static unsigned int app_gnss_dispatcher_enter(app_gnss_dispatcher_t *dispatcher) {
+    /*
+     * Announce ourselves on the current epoch's reader slot, then confirm the epoch did not flip in between. If it
+     * did, a writer may already have sampled that slot as empty, so retry on the new one.
+     */
+    for (;;) {
+        unsigned int slot = atomic_load(&dispatcher->epoch) & 1U;
+
+        atomic_fetch_add(&dispatcher->readers[slot], 1);
+
+        if ((atomic_load(&dispatcher->epoch) & 1U) == slot) {
+            return slot;
+        }
+
+        atomic_fetch_sub(&dispatcher->readers[slot], 1);
+    }
+}
+
+static void app_gnss_dispatcher_exit(app_gnss_dispatcher_t *dispatcher, unsigned int slot) {
+    atomic_fetch_sub(&dispatcher->readers[slot], 1);
+}
+
+static void app_gnss_dispatcher_synchronize(app_gnss_dispatcher_t *dispatcher) {
+    /* Readers entering after the flip see the new set; wait for those still on the old slot to drain. */
+    unsigned int old_slot = atomic_fetch_add(&dispatcher->epoch, 1) & 1U;
+
+    while (atomic_load(&dispatcher->readers[old_slot]) != 0) {
+        vTaskDelay(1);
+    }
+}
@@ -0,0 +1,52 @@
+#include <string.h>
+
+/* App */
+#include "app/gnss/fanout_ring.h"
+
+void app_gnss_fanout_ring_init(app_gnss_fanout_ring_t *ring, uint8_t *buf, uint32_t size) {
+    ring->buf  = buf;
+    ring->size = size;
+    ring->head = 0;
+}
+
+void app_gnss_fanout_ring_write(app_gnss_fanout_ring_t *ring, const uint8_t *data, size_t len) {
+    /* Only the tail of an oversized write survives anyway */
+    if (len > ring->size) {
+        ring->head += (uint32_t)(len - ring->size);
+        data += len - ring->size;
+        len = ring->size;
+    }
+
+    const uint32_t offset = ring->head & (ring->size - 1);
+    const size_t   first  = (len < ring->size - offset) ? len : ring->size - offset;
+
+    memcpy(&ring->buf[offset], data, first);
+    memcpy(ring->buf, data + first, len - first);
+
+    ring->head += (uint32_t)len;
+}
+
+uint32_t app_gnss_fanout_ring_head(const app_gnss_fanout_ring_t *ring) {
+    return ring->head;
+}
+
+bool app_gnss_fanout_ring_pending(const app_gnss_fanout_ring_t *ring, uint32_t pos, size_t *pending) {
+    const uint32_t distance = ring->head - pos;
+
+    *pending = distance;
+
+    return distance <= ring->size;
+}
+
+size_t app_gnss_fanout_ring_read_span(const app_gnss_fanout_ring_t *ring, uint32_t pos, const uint8_t **ptr) {
+    size_t pending;
+    if (!app_gnss_fanout_ring_pending(ring, pos, &pending) || pending == 0) {
+        return 0;
+    }
+
+    const uint32_t offset = pos & (ring->size - 1);
+
+    *ptr = &ring->buf[offset];
+
+    return (pending < ring->size - offset) ? pending : ring->size - offset;
+}
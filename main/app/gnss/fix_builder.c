@@ -0,0 +1,329 @@
+#include <string.h>
+
+/* App */
+#include "app/gnss/fix_builder.h"
+
+#define APP_GNSS_KNOTS_TO_MPS (0.514444)
+
+static void    app_gnss_fix_builder_reset(app_gnss_fix_builder_t *b);
+static void    app_gnss_fix_builder_epoch(app_gnss_fix_builder_t *b, const nl_nmea_time_t *time);
+static void    app_gnss_fix_builder_gga(app_gnss_fix_builder_t *b, const nl_nmea_index_t *idx);
+static void    app_gnss_fix_builder_rmc(app_gnss_fix_builder_t *b, const nl_nmea_index_t *idx);
+static void    app_gnss_fix_builder_gst(app_gnss_fix_builder_t *b, const nl_nmea_index_t *idx);
+static void    app_gnss_fix_builder_gsa(app_gnss_fix_builder_t *b, const nl_nmea_index_t *idx, bool want_sats);
+static void    app_gnss_fix_builder_gsv(app_gnss_fix_builder_t *b, const nl_nmea_index_t *idx);
+static uint8_t app_gnss_constellation_from_talker(const char *talker);
+static uint8_t app_gnss_constellation_from_system_id(int32_t system_id);
+static float   app_gnss_field_float(const nl_nmea_index_t *idx, uint8_t n, float fallback);
+
+void app_gnss_fix_builder_init(app_gnss_fix_builder_t *b, app_gnss_fix_builder_cb_t cb, void *ctx) {
+    b->cb  = cb;
+    b->ctx = ctx;
+
+    app_gnss_fix_builder_reset(b);
+}
+
+void app_gnss_fix_builder_feed(app_gnss_fix_builder_t *b, const nl_nmea_index_t *idx, bool want_sats) {
+    const char  *address;
+    const size_t address_len = nl_nmea_field(idx, 0, &address);
+
+    /* Standard sentences only: two-letter talker and three-letter formatter */
+    if (address_len != 5) return;
+
+    if (nl_nmea_is(idx, "GSA")) {
+        app_gnss_fix_builder_gsa(b, idx, want_sats);
+        return;
+    }
+
+    if (nl_nmea_is(idx, "GSV")) {
+        if (want_sats) app_gnss_fix_builder_gsv(b, idx);
+        return;
+    }
+
+    const bool gga = nl_nmea_is(idx, "GGA");
+    const bool rmc = !gga && nl_nmea_is(idx, "RMC");
+    const bool gst = !gga && !rmc && nl_nmea_is(idx, "GST");
+
+    if (!gga && !rmc && !gst) return;
+
+    nl_nmea_time_t time;
+    if (nl_nmea_field_time(idx, 1, &time) != 0) return;
+
+    app_gnss_fix_builder_epoch(b, &time);
+
+    if (gga) {
+        app_gnss_fix_builder_gga(b, idx);
+    } else if (rmc) {
+        app_gnss_fix_builder_rmc(b, idx);
+    } else {
+        app_gnss_fix_builder_gst(b, idx);
+    }
+}
+
+void app_gnss_fix_builder_flush(app_gnss_fix_builder_t *b) {
+    if (b->fix.flags == 0 && !b->sat_seen) {
+        app_gnss_fix_builder_reset(b);
+        return;
+    }
+
+    if (b->sat_seen) {
+        b->sat.time = b->epoch;
+
+        for (uint8_t i = 0; i < b->sat.count; i++) {
+            app_gnss_sat_info_t *sat = &b->sat.sats[i];
+
+            for (uint8_t j = 0; j < b->used_count; j++) {
+                if (b->used_prn[j] != sat->prn) continue;
+
+                if (b->used_constellation[j] == APP_GNSS_CONSTELLATION_UNKNOWN ||
+                    b->used_constellation[j] == sat->constellation) {
+                    sat->used = 1U;
+                    break;
+                }
+            }
+        }
+    }
+
+    b->cb(b->ctx, &b->fix, b->sat_seen ? &b->sat : NULL);
+
+    app_gnss_fix_builder_reset(b);
+}
+
+static void app_gnss_fix_builder_reset(app_gnss_fix_builder_t *b) {
+    b->has_epoch  = false;
+    b->sat_seen   = false;
+    b->used_count = 0;
+    b->sat.count  = 0;
+
+    memset(&b->fix, 0U, sizeof(b->fix));
+
+    b->fix.diff_age = -1.0f;
+}
+
+static void app_gnss_fix_builder_epoch(app_gnss_fix_builder_t *b, const nl_nmea_time_t *time) {
+    if (b->has_epoch) {
+        if (b->epoch.hour == time->hour && b->epoch.minute == time->minute && b->epoch.second == time->second &&
+            b->epoch.millisecond == time->millisecond) {
+            return;
+        }
+
+        app_gnss_fix_builder_flush(b);
+    }
+
+    /* GSA/GSV received before the first timed sentence belong to this epoch as well */
+    b->has_epoch = true;
+    b->epoch     = *time;
+    b->fix.time  = *time;
+}
+
+static void app_gnss_fix_builder_gga(app_gnss_fix_builder_t *b, const nl_nmea_index_t *idx) {
+    app_gnss_fix_t *fix = &b->fix;
+    int32_t         value;
+
+    if (nl_nmea_field_int(idx, 6, &value) != 0) return;
+
+    fix->quality = value;
+
+    if (nl_nmea_field_int(idx, 7, &value) == 0) {
+        fix->sats_used = value;
+    }
+
+    if (fix->quality == 0) return;
+
+    if (nl_nmea_field_latlon(idx, 2, &fix->latitude) != 0 || nl_nmea_field_latlon(idx, 4, &fix->longitude) != 0 ||
+        nl_nmea_field_double(idx, 9, &fix->altitude) != 0) {
+        return;
+    }
+
+    fix->geoid_separation = app_gnss_field_float(idx, 11, 0.0f);
+    fix->diff_age         = app_gnss_field_float(idx, 13, -1.0f);
+
+    if (nl_nmea_field_int(idx, 14, &value) == 0) {
+        fix->diff_station = value;
+    }
+
+    /* GSA carries the DOPs; only fall back to the GGA HDOP if none was seen yet */
+    if ((fix->flags & APP_GNSS_FIX_HAS_DOP) == 0) {
+        fix->hdop = app_gnss_field_float(idx, 8, 0.0f);
+    }
+
+    fix->flags |= APP_GNSS_FIX_HAS_POSITION;
+}
+
+static void app_gnss_fix_builder_rmc(app_gnss_fix_builder_t *b, const nl_nmea_index_t *idx) {
+    app_gnss_fix_t *fix = &b->fix;
+    char            status;
+
+    if (nl_nmea_field_date(idx, 9, &fix->date) == 0) {
+        fix->flags |= APP_GNSS_FIX_HAS_DATE;
+    }
+
+    if (nl_nmea_field_char(idx, 2, &status) != 0 || status != 'A') return;
+
+    double speed;
+    if (nl_nmea_field_double(idx, 7, &speed) != 0) return;
+
+    fix->speed  = (float)(speed * APP_GNSS_KNOTS_TO_MPS);
+    fix->course = app_gnss_field_float(idx, 8, 0.0f);
+
+    fix->flags |= APP_GNSS_FIX_HAS_VELOCITY;
+}
+
+static void app_gnss_fix_builder_gst(app_gnss_fix_builder_t *b, const nl_nmea_index_t *idx) {
+    app_gnss_fix_t *fix = &b->fix;
+    double          lat, lon, alt;
+
+    if (nl_nmea_field_double(idx, 6, &lat) != 0 || nl_nmea_field_double(idx, 7, &lon) != 0 ||
+        nl_nmea_field_double(idx, 8, &alt) != 0) {
+        return;
+    }
+
+    fix->lat_error = (float)lat;
+    fix->lon_error = (float)lon;
+    fix->alt_error = (float)alt;
+
+    fix->flags |= APP_GNSS_FIX_HAS_ERROR;
+}
+
+/*
+ * One GSA per constellation on multi-GNSS receivers, all of them share the same DOPs.
+ * NMEA 4.10+ appends the system ID in field 18, older talkers only have the talker ID.
+ */
+static void app_gnss_fix_builder_gsa(app_gnss_fix_builder_t *b, const nl_nmea_index_t *idx, bool want_sats) {
+    app_gnss_fix_t *fix = &b->fix;
+    int32_t         value;
+
+    if (nl_nmea_field_int(idx, 2, &value) == 0) {
+        fix->fix_mode = value;
+    }
+
+    fix->pdop = app_gnss_field_float(idx, 15, fix->pdop);
+    fix->hdop = app_gnss_field_float(idx, 16, fix->hdop);
+    fix->vdop = app_gnss_field_float(idx, 17, fix->vdop);
+
+    fix->flags |= APP_GNSS_FIX_HAS_DOP;
+
+    if (!want_sats) return;
+
+    const char *address;
+    nl_nmea_field(idx, 0, &address);
+
+    uint8_t constellation = app_gnss_constellation_from_talker(address);
+    if (nl_nmea_field_int(idx, 18, &value) == 0) {
+        constellation = app_gnss_constellation_from_system_id(value);
+    }
+
+    for (uint8_t n = 3; n <= 14 && b->used_count < APP_GNSS_FIX_BUILDER_USED_MAX; n++) {
+        if (nl_nmea_field_int(idx, n, &value) != 0) continue;
+
+        b->used_constellation[b->used_count] = constellation;
+        b->used_prn[b->used_count]           = value;
+        b->used_count++;
+    }
+}
+
+/*
+ * GSV lists up to four satellites per sentence; a satellite tracked on several signals shows up
+ * once per signal and is merged into a single entry keeping the strongest C/N0.
+ */
+static void app_gnss_fix_builder_gsv(app_gnss_fix_builder_t *b, const nl_nmea_index_t *idx) {
+    const char *address;
+    nl_nmea_field(idx, 0, &address);
+
+    const uint8_t constellation = app_gnss_constellation_from_talker(address);
+
+    b->sat_seen = true;
+
+    /* Fields 1-3 are message count, message number and satellites in view */
+    for (uint8_t n = 4; n + 3 < idx->count; n += 4) {
+        int32_t prn, elevation, azimuth, cn0;
+
+        if (nl_nmea_field_int(idx, n, &prn) != 0) continue;
+
+        app_gnss_sat_info_t *sat = NULL;
+
+        for (uint8_t i = 0; i < b->sat.count; i++) {
+            if (b->sat.sats[i].prn == prn && b->sat.sats[i].constellation == constellation) {
+                sat = &b->sat.sats[i];
+                break;
+            }
+        }
+
+        if (sat == NULL) {
+            if (b->sat.count >= APP_GNSS_SAT_MAX) continue;
+
+            sat = &b->sat.sats[b->sat.count++];
+
+            sat->constellation = constellation;
+            sat->used          = 0U;
+            sat->prn           = prn;
+            sat->elevation     = -128;
+            sat->azimuth       = 0xFFFFU;
+            sat->cn0           = 0U;
+        }
+
+        if (nl_nmea_field_int(idx, n + 1, &elevation) == 0) {
+            sat->elevation = elevation;
+        }
+
+        if (nl_nmea_field_int(idx, n + 2, &azimuth) == 0) {
+            sat->azimuth = azimuth;
+        }
+
+        if (nl_nmea_field_int(idx, n + 3, &cn0) == 0 && cn0 > sat->cn0) {
+            sat->cn0 = cn0;
+        }
+    }
+}
+
+static uint8_t app_gnss_constellation_from_talker(const char *talker) {
+    if (talker[0] != 'G' && talker[0] != 'B') return APP_GNSS_CONSTELLATION_UNKNOWN;
+
+    if (talker[0] == 'B') {
+        return (talker[1] == 'D') ? APP_GNSS_CONSTELLATION_BEIDOU : APP_GNSS_CONSTELLATION_UNKNOWN;
+    }
+
+    switch (talker[1]) {
+        case 'P':
+            return APP_GNSS_CONSTELLATION_GPS;
+        case 'L':
+            return APP_GNSS_CONSTELLATION_GLONASS;
+        case 'A':
+            return APP_GNSS_CONSTELLATION_GALILEO;
+        case 'B':
+            return APP_GNSS_CONSTELLATION_BEIDOU;
+        case 'Q':
+            return APP_GNSS_CONSTELLATION_QZSS;
+        case 'I':
+            return APP_GNSS_CONSTELLATION_NAVIC;
+        default:
+            return APP_GNSS_CONSTELLATION_UNKNOWN;
+    }
+}
+
+static uint8_t app_gnss_constellation_from_system_id(int32_t system_id) {
+    switch (system_id) {
+        case 1:
+            return APP_GNSS_CONSTELLATION_GPS;
+        case 2:
+            return APP_GNSS_CONSTELLATION_GLONASS;
+        case 3:
+            return APP_GNSS_CONSTELLATION_GALILEO;
+        case 4:
+            return APP_GNSS_CONSTELLATION_BEIDOU;
+        case 5:
+            return APP_GNSS_CONSTELLATION_QZSS;
+        case 6:
+            return APP_GNSS_CONSTELLATION_NAVIC;
+        default:
+            return APP_GNSS_CONSTELLATION_UNKNOWN;
+    }
+}
+
+static float app_gnss_field_float(const nl_nmea_index_t *idx, uint8_t n, float fallback) {
+    double value;
+
+    if (nl_nmea_field_double(idx, n, &value) != 0) return fallback;
+
+    return (float)value;
+}
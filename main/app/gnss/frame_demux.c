@@ -0,0 +1,187 @@
+#include <string.h>
+
+/* App */
+#include "app/gnss/frame_demux.h"
+
+#define APP_GNSS_DEMUX_NMEA_SYNC  (0x24U) /* '$' */
+#define APP_GNSS_DEMUX_RTCM3_SYNC (0xD3U)
+
+#define APP_GNSS_DEMUX_HAS_ZERO(v) (((v) - 0x01010101U) & ~(v) & 0x80808080U)
+
+static const uint8_t *app_gnss_demux_find_sync(const uint8_t *data, size_t len);
+static int            app_gnss_demux_check(const app_gnss_demux_t *demux);
+static void           app_gnss_demux_process(app_gnss_demux_t *demux);
+
+void app_gnss_demux_init(app_gnss_demux_t *demux, app_gnss_frame_cb_t cb, void *ctx) {
+    memset(demux, 0U, sizeof(app_gnss_demux_t));
+
+    demux->cb  = cb;
+    demux->ctx = ctx;
+}
+
+void app_gnss_demux_input(app_gnss_demux_t *demux, const uint8_t *data, size_t len) {
+    while (len > 0) {
+        /* ---- Hunt for a frame start, skipping garbage in bulk ---- */
+        if (demux->len == 0) {
+            const uint8_t *sync = app_gnss_demux_find_sync(data, len);
+            if (sync == NULL) {
+                demux->stats.skipped_bytes += len;
+                return;
+            }
+
+            demux->stats.skipped_bytes += sync - data;
+
+            len -= sync - data;
+            data = sync;
+        }
+
+        /* ---- Append the run belonging to the current frame ---- */
+        const uint8_t lead = (demux->len > 0) ? demux->frame[0] : data[0];
+        size_t        copy;
+
+        if (lead == APP_GNSS_DEMUX_NMEA_SYNC) {
+            const uint8_t *lf = memchr(data, '\n', len);
+
+            copy = (lf != NULL) ? (size_t)(lf - data + 1) : len;
+            if (copy > APP_GNSS_DEMUX_NMEA_MAX_LEN - demux->len) {
+                copy = APP_GNSS_DEMUX_NMEA_MAX_LEN - demux->len;
+            }
+        } else {
+            /* Header is known valid once 3 bytes are buffered, see app_gnss_demux_check() */
+            if (demux->len < 3) {
+                copy = 3 - demux->len;
+            } else {
+                copy = (((demux->frame[1] & 0x03U) << 8U) | demux->frame[2]) + 6 - demux->len;
+            }
+
+            if (copy > len) {
+                copy = len;
+            }
+        }
+
+        memcpy(&demux->frame[demux->len], data, copy);
+
+        demux->len += copy;
+
+        data += copy;
+        len -= copy;
+
+        app_gnss_demux_process(demux);
+    }
+}
+
+/**
+ * Locate the next '$' or 0xD3, testing a word at a time.
+ */
+static const uint8_t *app_gnss_demux_find_sync(const uint8_t *data, size_t len) {
+    const uint8_t *p   = data;
+    const uint8_t *end = data + len;
+
+    while (p < end && ((uintptr_t)p & 0x03U) != 0) {
+        if (*p == APP_GNSS_DEMUX_NMEA_SYNC || *p == APP_GNSS_DEMUX_RTCM3_SYNC) return p;
+        p++;
+    }
+
+    while (end - p >= 4) {
+        uint32_t word;
+        memcpy(&word, p, sizeof(word));
+
+        const uint32_t nmea  = word ^ (APP_GNSS_DEMUX_NMEA_SYNC * 0x01010101U);
+        const uint32_t rtcm3 = word ^ (APP_GNSS_DEMUX_RTCM3_SYNC * 0x01010101U);
+
+        if (APP_GNSS_DEMUX_HAS_ZERO(nmea) || APP_GNSS_DEMUX_HAS_ZERO(rtcm3)) {
+            break;
+        }
+
+        p += 4;
+    }
+
+    while (p < end) {
+        if (*p == APP_GNSS_DEMUX_NMEA_SYNC || *p == APP_GNSS_DEMUX_RTCM3_SYNC) return p;
+        p++;
+    }
+
+    return NULL;
+}
+
+/**
+ * Returns the frame size if the buffer holds a complete frame, 0 if more data is needed
+ * and -1 if the buffered data can not be a valid frame.
+ */
+static int app_gnss_demux_check(const app_gnss_demux_t *demux) {
+    if (demux->frame[0] == APP_GNSS_DEMUX_NMEA_SYNC) {
+        const uint8_t *lf = memchr(demux->frame, '\n', demux->len);
+        if (lf != NULL) {
+            return lf - demux->frame + 1;
+        }
+
+        if (demux->len >= APP_GNSS_DEMUX_NMEA_MAX_LEN) {
+            return -1;
+        }
+
+        return 0;
+    }
+
+    if (demux->len < 3) {
+        return 0;
+    }
+
+    /* 6 reserved bits shall be zero */
+    if ((demux->frame[1] & 0xFCU) != 0) {
+        return -1;
+    }
+
+    const size_t frame_len = (((demux->frame[1] & 0x03U) << 8U) | demux->frame[2]) + 6;
+    if (demux->len < frame_len) {
+        return 0;
+    }
+
+    return frame_len;
+}
+
+static void app_gnss_demux_process(app_gnss_demux_t *demux) {
+    while (demux->len > 0) {
+        const int frame_len = app_gnss_demux_check(demux);
+        if (frame_len == 0) {
+            return;
+        }
+
+        size_t drop = 1;
+
+        if (frame_len > 0) {
+            const app_gnss_frame_type_t type =
+                (demux->frame[0] == APP_GNSS_DEMUX_NMEA_SYNC) ? APP_GNSS_FRAME_NMEA : APP_GNSS_FRAME_RTCM3;
+
+            if (demux->cb(demux->ctx, type, demux->frame, frame_len)) {
+                if (type == APP_GNSS_FRAME_NMEA) {
+                    demux->stats.nmea_frames++;
+                } else {
+                    demux->stats.rtcm_frames++;
+                }
+
+                drop = frame_len;
+            } else {
+                demux->stats.rejected++;
+            }
+        } else {
+            demux->stats.rejected++;
+        }
+
+        /* ---- Resync within what is already buffered ---- */
+        const uint8_t *rest     = &demux->frame[drop];
+        const size_t   rest_len = demux->len - drop;
+        const uint8_t *sync     = app_gnss_demux_find_sync(rest, rest_len);
+
+        if (sync == NULL) {
+            demux->stats.skipped_bytes += rest_len;
+            demux->len = 0;
+
+            return;
+        }
+
+        demux->stats.skipped_bytes += sync - rest;
+
+        demux->len = &demux->frame[demux->len] - sync;
+        memmove(demux->frame, sync, demux->len);
+    }
+}
@@ -0,0 +1,72 @@
+#include <string.h>
+
+/* App */
+#include "app/gnss/ingest_ring.h"
+
+void app_gnss_ingest_ring_init(app_gnss_ingest_ring_t *ring, uint8_t *buf, uint32_t size, uint32_t chunk_size) {
+    ring->buf        = buf;
+    ring->size       = size;
+    ring->chunk_size = chunk_size;
+
+    memset(&ring->stats, 0U, sizeof(ring->stats));
+
+    app_gnss_ingest_ring_reset(ring);
+}
+
+void app_gnss_ingest_ring_reset(app_gnss_ingest_ring_t *ring) {
+    atomic_store(&ring->head, 0U);
+    atomic_store(&ring->tail, 0U);
+}
+
+size_t app_gnss_ingest_ring_used(app_gnss_ingest_ring_t *ring) {
+    const uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    const uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    return (uint32_t)(head - tail);
+}
+
+size_t app_gnss_ingest_ring_write_span(app_gnss_ingest_ring_t *ring, uint8_t **ptr) {
+    const uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    const uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    const uint32_t offset = head & (ring->size - 1);
+
+    size_t span = ring->size - (uint32_t)(head - tail); /* Free space */
+    if (span > ring->size - offset) span = ring->size - offset;
+    if (span > ring->chunk_size) span = ring->chunk_size;
+
+    *ptr = &ring->buf[offset];
+
+    return span;
+}
+
+void app_gnss_ingest_ring_commit(app_gnss_ingest_ring_t *ring, size_t len) {
+    const uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed) + len;
+
+    atomic_store_explicit(&ring->head, head, memory_order_release);
+
+    ring->stats.bytes_in += len;
+}
+
+size_t app_gnss_ingest_ring_read_span(app_gnss_ingest_ring_t *ring, const uint8_t **ptr) {
+    const uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    const uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    const uint32_t offset = tail & (ring->size - 1);
+
+    size_t span = (uint32_t)(head - tail); /* Used space */
+    if (span > ring->size - offset) span = ring->size - offset;
+    if (span > ring->chunk_size) span = ring->chunk_size;
+
+    *ptr = &ring->buf[offset];
+
+    return span;
+}
+
+void app_gnss_ingest_ring_consume(app_gnss_ingest_ring_t *ring, size_t len) {
+    const uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    atomic_store_explicit(&ring->tail, tail + len, memory_order_release);
+
+    ring->stats.chunks++;
+}
@@ -0,0 +1,169 @@
+#include <string.h>
+
+/* App */
+#include "app/gnss/obs_decoder.h"
+
+#define APP_GNSS_OBS_RANGE_MS (299792.458) /* Meters per millisecond of range */
+#define APP_GNSS_OBS_P2_10    (1.0 / 1024.0)
+#define APP_GNSS_OBS_P2_29    (1.0 / 536870912.0)
+#define APP_GNSS_OBS_P2_31    (1.0 / 2147483648.0)
+
+/* Indexed by (message - 1070) / 10 */
+static const uint8_t s_app_gnss_obs_constellations[] = {
+    APP_GNSS_CONSTELLATION_GPS,     APP_GNSS_CONSTELLATION_GLONASS, APP_GNSS_CONSTELLATION_GALILEO,
+    APP_GNSS_CONSTELLATION_UNKNOWN, APP_GNSS_CONSTELLATION_QZSS,    APP_GNSS_CONSTELLATION_BEIDOU,
+    APP_GNSS_CONSTELLATION_NAVIC,
+};
+
+static app_gnss_obs_track_t *app_gnss_obs_track_lookup(app_gnss_obs_decoder_t *dec, uint16_t key, int64_t now_us,
+                                                       bool *known);
+static uint8_t app_gnss_obs_track_update(app_gnss_obs_decoder_t *dec, uint16_t key, const nl_msm_t *msm, size_t cell,
+                                         int64_t now_us);
+
+void app_gnss_obs_decoder_init(app_gnss_obs_decoder_t *dec) {
+    memset(dec, 0U, sizeof(app_gnss_obs_decoder_t));
+}
+
+const app_gnss_obs_t *app_gnss_obs_decoder_feed(app_gnss_obs_decoder_t *dec, const uint8_t *frame, size_t len,
+                                                int64_t now_us) {
+    nl_msm_t       *msm = &dec->msm;
+    app_gnss_obs_t *obs = &dec->obs;
+
+    const int ret = nl_msm_decode(msm, frame, len);
+    if (ret == -2) {
+        dec->stats.errors++;
+    }
+
+    if (ret != 0) {
+        return NULL;
+    }
+
+    const uint8_t system = (msm->type - 1070U) / 10U;
+
+    obs->message       = msm->type;
+    obs->msm_type      = msm->msm_type;
+    obs->constellation = s_app_gnss_obs_constellations[system];
+    obs->station_id    = nl_msm_station(msm);
+    obs->epoch         = nl_msm_epoch(msm);
+    obs->more          = nl_msm_multiple(msm);
+    obs->sats          = msm->nsat;
+    obs->count         = 0;
+
+    size_t cell = 0;
+    for (uint8_t i = 0; i < msm->nsat; i++) {
+        const bool   has_rough = msm->rough_ms[i] != NL_MSM_ROUGH_EMPTY;
+        const double rough_ms  = msm->rough_ms[i] + msm->rough_mod[i] * APP_GNSS_OBS_P2_10;
+
+        for (uint8_t j = 0; j < msm->nsig; j++) {
+            if (!msm->cell[i][j]) {
+                continue;
+            }
+
+            app_gnss_obs_sig_t *sig = &obs->sigs[obs->count++];
+
+            memset(sig, 0U, sizeof(app_gnss_obs_sig_t));
+
+            sig->sat_id  = msm->sat_id[i];
+            sig->sig_id  = msm->sig_id[j];
+            sig->cn0     = msm->cnr[cell] / 16.0f;
+            sig->lock_ms = msm->lock_ms[cell];
+
+            if (has_rough && msm->fine_pr[cell] != NL_MSM_INVALID) {
+                sig->pseudorange = (rough_ms + msm->fine_pr[cell] * APP_GNSS_OBS_P2_29) * APP_GNSS_OBS_RANGE_MS;
+                sig->flags |= APP_GNSS_OBS_HAS_RANGE;
+            }
+
+            if (has_rough && msm->fine_cp[cell] != NL_MSM_INVALID) {
+                sig->phase = (rough_ms + msm->fine_cp[cell] * APP_GNSS_OBS_P2_31) * APP_GNSS_OBS_RANGE_MS;
+                sig->flags |= APP_GNSS_OBS_HAS_PHASE;
+            }
+
+            if (msm->rough_rate[i] != NL_MSM_INVALID && msm->fine_rate[cell] != NL_MSM_INVALID) {
+                sig->range_rate = msm->rough_rate[i] + msm->fine_rate[cell] * 0.0001f;
+                sig->flags |= APP_GNSS_OBS_HAS_RATE;
+            }
+
+            if (msm->half_cycle[cell]) {
+                sig->flags |= APP_GNSS_OBS_HALF_CYCLE;
+            }
+
+            /* 3 bits constellation, 6 bits satellite, 5 bits signal, top bit marks the slot as used */
+            const uint16_t key = 0x8000U | (system << 11U) | ((msm->sat_id[i] - 1U) << 5U) | (msm->sig_id[j] - 1U);
+
+            sig->flags |= app_gnss_obs_track_update(dec, key, msm, cell, now_us);
+
+            cell++;
+        }
+    }
+
+    dec->stats.messages++;
+
+    return obs;
+}
+
+/**
+ * Compare a cell against the previous observation of its signal and remember it for the next one.
+ * Lock time only grows while the receiver keeps phase lock, so a smaller value means the lock was lost in between.
+ */
+static uint8_t app_gnss_obs_track_update(app_gnss_obs_decoder_t *dec, uint16_t key, const nl_msm_t *msm, size_t cell,
+                                         int64_t now_us) {
+    bool                  known;
+    app_gnss_obs_track_t *track = app_gnss_obs_track_lookup(dec, key, now_us, &known);
+
+    if (track == NULL) {
+        dec->stats.untracked++;
+        return 0;
+    }
+
+    const bool phase_valid = msm->fine_cp[cell] != NL_MSM_INVALID;
+    uint8_t    flags       = 0;
+
+    if (known && track->phase_valid) {
+        if (!phase_valid) {
+            flags |= APP_GNSS_OBS_LOCK_LOST;
+            dec->stats.losses++;
+        } else if (msm->lock_ms[cell] < track->lock_ms || msm->half_cycle[cell] != track->half_cycle) {
+            flags |= APP_GNSS_OBS_SLIP;
+            dec->stats.slips++;
+        }
+    }
+
+    track->key         = key;
+    track->phase_valid = phase_valid;
+    track->half_cycle  = msm->half_cycle[cell];
+    track->lock_ms     = msm->lock_ms[cell];
+    track->seen_us     = now_us;
+
+    return flags;
+}
+
+/**
+ * Open-addressed slot table. Slots are never emptied, expired ones are reused, so a probe sequence only ends at a
+ * never-used slot or after a full turn. known is false for a new or expired signal.
+ */
+static app_gnss_obs_track_t *app_gnss_obs_track_lookup(app_gnss_obs_decoder_t *dec, uint16_t key, int64_t now_us,
+                                                       bool *known) {
+    app_gnss_obs_track_t *reuse = NULL;
+    const size_t          start = ((uint32_t)key * 40503U >> 8U) % APP_GNSS_OBS_TRACK_SLOTS;
+
+    *known = false;
+
+    for (size_t n = 0; n < APP_GNSS_OBS_TRACK_SLOTS; n++) {
+        app_gnss_obs_track_t *track = &dec->track[(start + n) % APP_GNSS_OBS_TRACK_SLOTS];
+
+        if (track->key == key) {
+            *known = (now_us - track->seen_us) <= APP_GNSS_OBS_TRACK_EXPIRY;
+            return track;
+        }
+
+        if (track->key == 0) {
+            return (reuse != NULL) ? reuse : track;
+        }
+
+        if (reuse == NULL && (now_us - track->seen_us) > APP_GNSS_OBS_TRACK_EXPIRY) {
+            reuse = track;
+        }
+    }
+
+    return reuse;
+}
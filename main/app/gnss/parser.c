@@ -0,0 +1,75 @@
+/* App */
+#include "app/gnss/parser.h"
+
+int app_gnss_parser_init(app_gnss_parser_t *parser, app_gnss_frame_cb_t frame_cb, app_gnss_fix_builder_cb_t epoch_cb,
+                         void *ctx) {
+    parser->mutex = xSemaphoreCreateMutex();
+    if (parser->mutex == NULL) {
+        return -1;
+    }
+
+    atomic_store(&parser->replay, false);
+    parser->live_dropped = 0;
+
+    app_gnss_demux_init(&parser->demux, frame_cb, ctx);
+    app_gnss_fix_builder_init(&parser->fix_builder, epoch_cb, ctx);
+
+    return 0;
+}
+
+bool app_gnss_parser_input(app_gnss_parser_t *parser, app_gnss_parser_source_t source, const uint8_t *data,
+                           size_t len, bool idle) {
+    bool parsed = false;
+
+    /* Cheap early out, the check that counts is the one under the mutex */
+    if (source == APP_GNSS_PARSER_LIVE && atomic_load(&parser->replay)) {
+        parser->live_dropped++;
+        return false;
+    }
+
+    xSemaphoreTake(parser->mutex, portMAX_DELAY);
+
+    /* A replay may have started while this task waited for the mutex */
+    if (source == APP_GNSS_PARSER_LIVE && atomic_load(&parser->replay)) {
+        parser->live_dropped++;
+        goto release_mutex_exit;
+    }
+
+    if (len > 0) {
+        app_gnss_demux_input(&parser->demux, data, len);
+    }
+
+    if (idle) {
+        app_gnss_fix_builder_flush(&parser->fix_builder);
+    }
+
+    parsed = true;
+
+release_mutex_exit:
+    xSemaphoreGive(parser->mutex);
+
+    return parsed;
+}
+
+int app_gnss_parser_replay_begin(app_gnss_parser_t *parser) {
+    int ret = 0;
+
+    xSemaphoreTake(parser->mutex, portMAX_DELAY);
+
+    if (atomic_load(&parser->replay)) {
+        ret = -1;
+    } else {
+        /* The demux resyncs on the first recorded frame, a partial live frame is rejected */
+        atomic_store(&parser->replay, true);
+    }
+
+    xSemaphoreGive(parser->mutex);
+
+    return ret;
+}
+
+void app_gnss_parser_replay_end(app_gnss_parser_t *parser) {
+    xSemaphoreTake(parser->mutex, portMAX_DELAY);
+    atomic_store(&parser->replay, false);
+    xSemaphoreGive(parser->mutex);
+}
@@ -0,0 +1,259 @@
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+/* IDF */
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/ringbuf.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+/* nl */
+#include "rcv/nl_rawlog.h"
+
+/* App */
+#include "app/gnss/recorder.h"
+
+#define APP_GNSS_RECORDER_STOP_ITEM (1U) /* Ring item size of the stop marker, records are always larger */
+
+typedef struct {
+    SemaphoreHandle_t lock; /* Serializes start and stop */
+    RingbufHandle_t   ring;
+    SemaphoreHandle_t stopped;
+    TaskHandle_t      task;
+    FILE             *fp;
+    uint32_t          max_bytes;
+
+    /* Receive path */
+    atomic_bool active;
+    bool        first;
+    int64_t     last_us;
+
+    atomic_uint chunks;
+    atomic_uint bytes;
+    atomic_uint dropped_bytes;
+    atomic_uint file_bytes;
+} app_gnss_recorder_state_t;
+
+static const char *LOG_TAG = "asuna_gnss_rec";
+
+static app_gnss_recorder_state_t s_app_gnss_recorder_state;
+
+static void app_gnss_recorder_task(void *parameters);
+static void app_gnss_recorder_put(const uint8_t *data, size_t len, uint8_t flags);
+static void app_gnss_recorder_stop_locked(app_gnss_recorder_state_t *state);
+
+int app_gnss_recorder_start(const char *path, uint32_t max_bytes) {
+    app_gnss_recorder_state_t *state = &s_app_gnss_recorder_state;
+
+    int ret = 0;
+
+    if (state->lock == NULL) {
+        state->lock = xSemaphoreCreateMutex();
+        if (state->lock == NULL) {
+            return -1;
+        }
+    }
+
+    xSemaphoreTake(state->lock, portMAX_DELAY);
+
+    app_gnss_recorder_stop_locked(state);
+
+    if (state->ring == NULL) {
+        state->ring    = xRingbufferCreate(CONFIG_APP_GNSS_RECORDER_BUFFER_SIZE, RINGBUF_TYPE_NOSPLIT);
+        state->stopped = xSemaphoreCreateBinary();
+
+        if (state->ring == NULL || state->stopped == NULL) {
+            ESP_LOGE(LOG_TAG, "Failed to allocate recorder buffer.");
+            ret = -1;
+            goto unlock_exit;
+        }
+    }
+
+    /* Leftovers of a receive path call racing the previous stop */
+    size_t len;
+    void  *item;
+    while ((item = xRingbufferReceive(state->ring, &len, 0)) != NULL) {
+        vRingbufferReturnItem(state->ring, item);
+    }
+
+    state->fp = fopen(path, "wb");
+    if (state->fp == NULL) {
+        ESP_LOGE(LOG_TAG, "Failed to open %s for writing.", path);
+        ret = -2;
+        goto unlock_exit;
+    }
+
+    uint8_t header[NL_RAWLOG_FILE_HEADER];
+    nl_rawlog_file_header(header);
+
+    if (fwrite(header, 1, sizeof(header), state->fp) != sizeof(header)) {
+        ESP_LOGE(LOG_TAG, "Failed to write recording header.");
+        ret = -2;
+        goto close_file_exit;
+    }
+
+    state->max_bytes = max_bytes;
+    state->first     = true;
+    atomic_store(&state->chunks, 0);
+    atomic_store(&state->bytes, 0);
+    atomic_store(&state->dropped_bytes, 0);
+    atomic_store(&state->file_bytes, sizeof(header));
+
+    if (xTaskCreate(app_gnss_recorder_task, "asuna_gnss_rec", 3072, state, 2, &state->task) != pdPASS) {
+        ESP_LOGE(LOG_TAG, "Failed to create recorder task.");
+        state->task = NULL;
+        ret         = -1;
+        goto close_file_exit;
+    }
+
+    atomic_store(&state->active, true);
+
+    ESP_LOGI(LOG_TAG, "Recording GNSS stream to %s.", path);
+
+    xSemaphoreGive(state->lock);
+
+    return 0;
+
+close_file_exit:
+    fclose(state->fp);
+    state->fp = NULL;
+
+unlock_exit:
+    xSemaphoreGive(state->lock);
+
+    return ret;
+}
+
+void app_gnss_recorder_stop(void) {
+    app_gnss_recorder_state_t *state = &s_app_gnss_recorder_state;
+
+    if (state->lock == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(state->lock, portMAX_DELAY);
+    app_gnss_recorder_stop_locked(state);
+    xSemaphoreGive(state->lock);
+}
+
+void app_gnss_recorder_stats_get(app_gnss_recorder_stats_t *stats) {
+    const app_gnss_recorder_state_t *state = &s_app_gnss_recorder_state;
+
+    stats->active        = atomic_load(&state->active);
+    stats->chunks        = atomic_load(&state->chunks);
+    stats->bytes         = atomic_load(&state->bytes);
+    stats->dropped_bytes = atomic_load(&state->dropped_bytes);
+    stats->file_bytes    = atomic_load(&state->file_bytes);
+}
+
+void app_gnss_recorder_feed(const uint8_t *data, size_t len) {
+    app_gnss_recorder_put(data, len, 0);
+}
+
+void app_gnss_recorder_idle(void) {
+    app_gnss_recorder_put(NULL, 0, NL_RAWLOG_IDLE);
+}
+
+/**
+ * Called from the GNSS receive task only. Never blocks: a chunk that does not fit the buffer is dropped whole.
+ */
+static void app_gnss_recorder_put(const uint8_t *data, size_t len, uint8_t flags) {
+    app_gnss_recorder_state_t *state = &s_app_gnss_recorder_state;
+
+    if (!atomic_load(&state->active)) {
+        return;
+    }
+
+    const int64_t now = esp_timer_get_time();
+
+    do {
+        const size_t piece = (len > NL_RAWLOG_CHUNK_MAX) ? NL_RAWLOG_CHUNK_MAX : len;
+
+        void *item;
+        if (xRingbufferSendAcquire(state->ring, &item, NL_RAWLOG_RECORD_HEADER + piece, 0) != pdTRUE) {
+            atomic_fetch_add(&state->dropped_bytes, len);
+            return;
+        }
+
+        const int64_t  delta    = state->first ? 0 : (now - state->last_us);
+        const uint32_t delta_us = (delta > UINT32_MAX) ? UINT32_MAX : (uint32_t)delta;
+
+        state->first   = false;
+        state->last_us = now;
+
+        nl_rawlog_record_header(item, delta_us, piece, (piece == len) ? flags : 0);
+        if (piece > 0) {
+            memcpy((uint8_t *)item + NL_RAWLOG_RECORD_HEADER, data, piece);
+        }
+
+        xRingbufferSendComplete(state->ring, item);
+
+        atomic_fetch_add(&state->chunks, 1);
+        atomic_fetch_add(&state->bytes, piece);
+
+        data += piece;
+        len -= piece;
+    } while (len > 0);
+}
+
+static void app_gnss_recorder_stop_locked(app_gnss_recorder_state_t *state) {
+    if (state->task == NULL) {
+        return;
+    }
+
+    atomic_store(&state->active, false);
+
+    void *item;
+    xRingbufferSendAcquire(state->ring, &item, APP_GNSS_RECORDER_STOP_ITEM, portMAX_DELAY);
+    xRingbufferSendComplete(state->ring, item);
+
+    xSemaphoreTake(state->stopped, portMAX_DELAY);
+    state->task = NULL;
+
+    ESP_LOGI(LOG_TAG, "Recording stopped, %u bytes written.", atomic_load(&state->file_bytes));
+}
+
+static void app_gnss_recorder_task(void *parameters) {
+    app_gnss_recorder_state_t *state = parameters;
+
+    for (;;) {
+        size_t   len;
+        uint8_t *item = xRingbufferReceive(state->ring, &len, portMAX_DELAY);
+        if (item == NULL) {
+            continue;
+        }
+
+        if (len == APP_GNSS_RECORDER_STOP_ITEM) {
+            vRingbufferReturnItem(state->ring, item);
+            break;
+        }
+
+        /* After an error or the size limit, keep draining until stopped */
+        if (state->fp != NULL) {
+            if (fwrite(item, 1, len, state->fp) != len) {
+                ESP_LOGE(LOG_TAG, "Failed to write recording, stopping.");
+                atomic_store(&state->active, false);
+                fclose(state->fp);
+                state->fp = NULL;
+            } else if (atomic_fetch_add(&state->file_bytes, len) + len >= state->max_bytes && state->max_bytes > 0) {
+                ESP_LOGI(LOG_TAG, "Recording reached its size limit.");
+                atomic_store(&state->active, false);
+                fclose(state->fp);
+                state->fp = NULL;
+            }
+        }
+
+        vRingbufferReturnItem(state->ring, item);
+    }
+
+    if (state->fp != NULL) {
+        fclose(state->fp);
+        state->fp = NULL;
+    }
+
+    xSemaphoreGive(state->stopped);
+    vTaskDelete(NULL);
+}
@@ -0,0 +1,142 @@
+#include <string.h>
+
+/* App */
+#include "app/gnss/rtcm_scheduler.h"
+
+#define APP_GNSS_RTCM_SCHED_OTHER (APP_GNSS_RTCM_SCHED_MAX_TYPES)
+
+static app_gnss_rtcm_sched_entry_t *app_gnss_rtcm_sched_lookup(app_gnss_rtcm_sched_t *sched, uint16_t type);
+static bool app_gnss_rtcm_sched_msm_epoch(const app_gnss_rtcm_t *rtcm, uint32_t *epoch);
+
+void app_gnss_rtcm_sched_init(app_gnss_rtcm_sched_t *sched) {
+    memset(sched, 0U, sizeof(app_gnss_rtcm_sched_t));
+
+    sched->entries[APP_GNSS_RTCM_SCHED_OTHER].rule.always = true;
+}
+
+int app_gnss_rtcm_sched_rule_set(app_gnss_rtcm_sched_t *sched, const app_gnss_rtcm_sched_rule_t *rule) {
+    app_gnss_rtcm_sched_entry_t *entry = app_gnss_rtcm_sched_lookup(sched, rule->type);
+
+    if (entry == &sched->entries[APP_GNSS_RTCM_SCHED_OTHER]) {
+        return -1;
+    }
+
+    entry->rule        = *rule;
+    entry->epoch_count = 0;
+    entry->epoch_valid = false;
+
+    return 0;
+}
+
+bool app_gnss_rtcm_sched_admit(app_gnss_rtcm_sched_t *sched, const app_gnss_rtcm_t *rtcm, int64_t now_us) {
+    app_gnss_rtcm_sched_entry_t *entry = app_gnss_rtcm_sched_lookup(sched, rtcm->type);
+    const app_gnss_rtcm_sched_rule_t *rule = &entry->rule;
+
+    uint32_t epoch;
+
+    const bool msm = app_gnss_rtcm_sched_msm_epoch(rtcm, &epoch);
+
+    bool forward = true;
+
+    if (msm && entry->epoch_valid && entry->epoch_key == epoch) {
+        /* Continuation of an epoch already decided on */
+        forward = entry->epoch_forward;
+    } else {
+        if (!rule->always && rule->every_n > 1 && (entry->epoch_count % rule->every_n) != 0) {
+            forward = false;
+        }
+
+        if (forward && !rule->always && rule->min_interval_ms > 0 && entry->last_forward_us != 0 &&
+            now_us - entry->last_forward_us < (int64_t)rule->min_interval_ms * 1000) {
+            forward = false;
+        }
+
+        if (forward) {
+            if (entry->forwarded_epochs == 0) {
+                entry->first_forward_us = now_us;
+            } else {
+                entry->stats.interval_ms = (now_us - entry->first_forward_us) / 1000 / entry->forwarded_epochs;
+            }
+
+            entry->forwarded_epochs++;
+            entry->last_forward_us = now_us;
+        }
+
+        entry->epoch_count++;
+        entry->epoch_key     = epoch;
+        entry->epoch_valid   = msm;
+        entry->epoch_forward = forward;
+    }
+
+    if (forward) {
+        entry->stats.forwarded_frames++;
+        entry->stats.forwarded_bytes += rtcm->data_len;
+    } else {
+        entry->stats.suppressed_frames++;
+        entry->stats.suppressed_bytes += rtcm->data_len;
+    }
+
+    return forward;
+}
+
+size_t app_gnss_rtcm_sched_stats_get(const app_gnss_rtcm_sched_t *sched, app_gnss_rtcm_sched_stats_t *stats,
+                                     size_t max) {
+    size_t n = 0;
+
+    for (size_t i = 0; i < sched->count && n < max; i++) {
+        stats[n++] = sched->entries[i].stats;
+    }
+
+    const app_gnss_rtcm_sched_stats_t *other = &sched->entries[APP_GNSS_RTCM_SCHED_OTHER].stats;
+    if (n < max && (other->forwarded_frames > 0 || other->suppressed_frames > 0)) {
+        stats[n++] = *other;
+    }
+
+    return n;
+}
+
+static app_gnss_rtcm_sched_entry_t *app_gnss_rtcm_sched_lookup(app_gnss_rtcm_sched_t *sched, uint16_t type) {
+    for (size_t i = 0; i < sched->count; i++) {
+        if (sched->entries[i].rule.type == type) {
+            return &sched->entries[i];
+        }
+    }
+
+    if (sched->count == APP_GNSS_RTCM_SCHED_MAX_TYPES) {
+        return &sched->entries[APP_GNSS_RTCM_SCHED_OTHER];
+    }
+
+    /* First sight of this type: no limit, counted on its own line */
+    app_gnss_rtcm_sched_entry_t *entry = &sched->entries[sched->count++];
+
+    entry->rule.type       = type;
+    entry->rule.always     = true;
+    entry->stats.type      = type;
+    entry->last_forward_us = 0;
+
+    return entry;
+}
+
+/**
+ * MSM1-7 (10x1-10x7) carry a 30-bit epoch time right after the 12-bit message number and 12-bit station ID.
+ */
+static bool app_gnss_rtcm_sched_msm_epoch(const app_gnss_rtcm_t *rtcm, uint32_t *epoch) {
+    const uint16_t type = rtcm->type;
+
+    *epoch = 0;
+
+    if (type < 1071 || type > 1137 || type % 10 == 0 || type % 10 > 7) {
+        return false;
+    }
+
+    /* 3-byte header, then 24 bits of message number and station ID */
+    if (rtcm->data_len < 3 + 7 + 3) {
+        return false;
+    }
+
+    const uint8_t *p = &rtcm->data[3 + 3];
+
+    *epoch = (((uint32_t)p[0] << 24U) | ((uint32_t)p[1] << 16U) | ((uint32_t)p[2] << 8U) | p[3]) >> 2U;
+
+    return true;
+}
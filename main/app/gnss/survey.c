@@ -0,0 +1,86 @@
+#include <math.h>
+#include <string.h>
+
+/* App */
+#include "app/gnss/survey.h"
+
+#define APP_GNSS_SURVEY_WGS84_A  (6378137.0)
+#define APP_GNSS_SURVEY_WGS84_F  (1.0 / 298.257223563)
+#define APP_GNSS_SURVEY_WGS84_E2 (APP_GNSS_SURVEY_WGS84_F * (2.0 - APP_GNSS_SURVEY_WGS84_F))
+#define APP_GNSS_SURVEY_DEG2RAD  (M_PI / 180.0)
+
+void app_gnss_survey_llh_to_ecef(double lat, double lon, double height, double ecef[3]) {
+    const double sin_lat = sin(lat * APP_GNSS_SURVEY_DEG2RAD);
+    const double cos_lat = cos(lat * APP_GNSS_SURVEY_DEG2RAD);
+    const double sin_lon = sin(lon * APP_GNSS_SURVEY_DEG2RAD);
+    const double cos_lon = cos(lon * APP_GNSS_SURVEY_DEG2RAD);
+
+    /* Prime vertical radius of curvature */
+    const double n = APP_GNSS_SURVEY_WGS84_A / sqrt(1.0 - APP_GNSS_SURVEY_WGS84_E2 * sin_lat * sin_lat);
+
+    ecef[0] = (n + height) * cos_lat * cos_lon;
+    ecef[1] = (n + height) * cos_lat * sin_lon;
+    ecef[2] = (n * (1.0 - APP_GNSS_SURVEY_WGS84_E2) + height) * sin_lat;
+}
+
+void app_gnss_survey_ecef_to_llh(const double ecef[3], double *lat, double *lon, double *height) {
+    const double r2 = ecef[0] * ecef[0] + ecef[1] * ecef[1];
+
+    double z = ecef[2];
+    double n = APP_GNSS_SURVEY_WGS84_A;
+
+    /* Converges to well below a millimeter within a few rounds */
+    for (uint8_t i = 0; i < 8; i++) {
+        const double sin_lat = z / sqrt(r2 + z * z);
+
+        n = APP_GNSS_SURVEY_WGS84_A / sqrt(1.0 - APP_GNSS_SURVEY_WGS84_E2 * sin_lat * sin_lat);
+
+        const double next = ecef[2] + n * APP_GNSS_SURVEY_WGS84_E2 * sin_lat;
+        if (fabs(next - z) < 1e-4) {
+            z = next;
+            break;
+        }
+
+        z = next;
+    }
+
+    *lat    = atan2(z, sqrt(r2)) / APP_GNSS_SURVEY_DEG2RAD;
+    *lon    = (r2 > 0.0) ? atan2(ecef[1], ecef[0]) / APP_GNSS_SURVEY_DEG2RAD : 0.0;
+    *height = sqrt(r2 + z * z) - n;
+}
+
+void app_gnss_survey_init(app_gnss_survey_t *survey) {
+    memset(survey, 0U, sizeof(app_gnss_survey_t));
+}
+
+void app_gnss_survey_add(app_gnss_survey_t *survey, const double ecef[3]) {
+    if (survey->n == 0) {
+        memcpy(survey->origin, ecef, sizeof(survey->origin));
+    }
+
+    survey->n++;
+
+    for (uint8_t i = 0; i < 3; i++) {
+        const double x     = ecef[i] - survey->origin[i];
+        const double delta = x - survey->mean[i];
+
+        survey->mean[i] += delta / survey->n;
+        survey->m2[i] += delta * (x - survey->mean[i]);
+    }
+}
+
+void app_gnss_survey_mean(const app_gnss_survey_t *survey, double ecef[3]) {
+    for (uint8_t i = 0; i < 3; i++) {
+        ecef[i] = survey->origin[i] + survey->mean[i];
+    }
+}
+
+float app_gnss_survey_sigma(const app_gnss_survey_t *survey) {
+    if (survey->n < 2) {
+        return INFINITY;
+    }
+
+    const double var = (survey->m2[0] + survey->m2[1] + survey->m2[2]) / (survey->n - 1U);
+
+    return (float)sqrt(var);
+}
@@ -0,0 +1,228 @@
+#include "sdkconfig.h"
+
+#if CONFIG_APP_GNSS_SERVER_UART_DMA
+
+#include <stdatomic.h>
+#include <string.h>
+
+/* IDF */
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_private/gdma.h"
+#include "esp_private/periph_ctrl.h"
+#include "hal/dma_types.h"
+#include "hal/uhci_ll.h"
+#include "soc/uhci_struct.h"
+
+/* App */
+#include "app/gnss/uart_dma.h"
+
+typedef struct {
+    gdma_channel_handle_t channel;
+    TaskHandle_t          notify_task;
+    uint32_t              next; /* Next descriptor to hand to the consumer */
+
+    atomic_bool overrun;
+
+    app_gnss_uart_dma_stats_t stats;
+} app_gnss_uart_dma_state_t;
+
+static const char *LOG_TAG = "asuna_gnss_dma";
+
+static app_gnss_uart_dma_state_t s_app_gnss_uart_dma;
+
+static DRAM_ATTR dma_descriptor_t s_app_gnss_uart_dma_desc[APP_GNSS_UART_DMA_DESC_NUM] __attribute__((aligned(4)));
+static DRAM_ATTR uint8_t s_app_gnss_uart_dma_buf[APP_GNSS_UART_DMA_DESC_NUM][APP_GNSS_UART_DMA_DESC_SIZE]
+    __attribute__((aligned(4)));
+
+static void app_gnss_uart_dma_desc_init(void);
+static bool app_gnss_uart_dma_on_eof(gdma_channel_handle_t chan, gdma_event_data_t *event, void *user_data);
+static bool app_gnss_uart_dma_on_error(gdma_channel_handle_t chan, gdma_event_data_t *event, void *user_data);
+
+int app_gnss_uart_dma_start(uart_port_t port, TaskHandle_t notify_task) {
+    app_gnss_uart_dma_state_t *state = &s_app_gnss_uart_dma;
+
+    memset(&state->stats, 0U, sizeof(state->stats));
+    atomic_store(&state->overrun, false);
+
+    state->notify_task = notify_task;
+
+    /* ---- UHCI: route the UART RX FIFO to DMA, close a chunk on idle or when a descriptor is full ---- */
+    periph_module_enable(PERIPH_UHCI0_MODULE);
+
+    uhci_ll_init(&UHCI0);
+    uhci_ll_attach_uart_port(&UHCI0, port);
+    uhci_ll_rx_set_eof_mode(&UHCI0, UHCI_RX_IDLE_EOF | UHCI_RX_LEN_EOF);
+    UHCI0.pkt_thres.thrs = APP_GNSS_UART_DMA_DESC_SIZE;
+
+    /* ---- GDMA RX channel with owner check, so a full ring reports an error instead of overwriting ---- */
+    gdma_channel_alloc_config_t alloc_cfg = {
+        .direction = GDMA_CHANNEL_DIRECTION_RX,
+    };
+
+    if (gdma_new_ahb_channel(&alloc_cfg, &state->channel) != ESP_OK) {
+        ESP_LOGE(LOG_TAG, "Failed to allocate GDMA channel");
+        return -1;
+    }
+
+    gdma_connect(state->channel, GDMA_MAKE_TRIGGER(GDMA_TRIG_PERIPH_UHCI, 0));
+
+    gdma_strategy_config_t strategy = {
+        .auto_update_desc = true,
+        .owner_check      = true,
+    };
+
+    gdma_apply_strategy(state->channel, &strategy);
+
+    gdma_rx_event_callbacks_t cbs = {
+        .on_recv_eof  = app_gnss_uart_dma_on_eof,
+        .on_descr_err = app_gnss_uart_dma_on_error,
+    };
+
+    if (gdma_register_rx_event_callbacks(state->channel, &cbs, state) != ESP_OK) {
+        ESP_LOGE(LOG_TAG, "Failed to register GDMA callbacks");
+        goto del_channel_exit;
+    }
+
+    /* The UART driver must not drain the FIFO anymore */
+    uart_disable_rx_intr(port);
+
+    app_gnss_uart_dma_desc_init();
+
+    if (gdma_start(state->channel, (intptr_t)&s_app_gnss_uart_dma_desc[0]) != ESP_OK) {
+        ESP_LOGE(LOG_TAG, "Failed to start GDMA");
+        goto enable_rx_exit;
+    }
+
+    ESP_LOGI(LOG_TAG, "GNSS UART%d reception switched to DMA", port);
+
+    return 0;
+
+enable_rx_exit:
+    uart_enable_rx_intr(port);
+
+del_channel_exit:
+    gdma_disconnect(state->channel);
+    gdma_del_channel(state->channel);
+
+    state->channel = NULL;
+
+    return -2;
+}
+
+void app_gnss_uart_dma_stop(void) {
+    app_gnss_uart_dma_state_t *state = &s_app_gnss_uart_dma;
+
+    if (state->channel == NULL) {
+        return;
+    }
+
+    gdma_stop(state->channel);
+    gdma_disconnect(state->channel);
+    gdma_del_channel(state->channel);
+
+    state->channel = NULL;
+}
+
+bool app_gnss_uart_dma_read(const uint8_t **ptr, size_t *len, bool *idle) {
+    app_gnss_uart_dma_state_t *state = &s_app_gnss_uart_dma;
+    volatile dma_descriptor_t *desc  = &s_app_gnss_uart_dma_desc[state->next];
+
+    if (desc->dw0.owner != DMA_DESCRIPTOR_BUFFER_OWNER_CPU) {
+        return false;
+    }
+
+    /* The DMA writes the data and length back before the owner bit, read nothing ahead of it */
+    atomic_thread_fence(memory_order_acquire);
+
+    const uint32_t length = desc->dw0.length;
+
+    *ptr  = desc->buffer;
+    *len  = length;
+    *idle = desc->dw0.suc_eof && length < APP_GNSS_UART_DMA_DESC_SIZE;
+
+    state->stats.bytes += length;
+    state->stats.chunks++;
+
+    return true;
+}
+
+void app_gnss_uart_dma_release(void) {
+    app_gnss_uart_dma_state_t *state = &s_app_gnss_uart_dma;
+    volatile dma_descriptor_t *desc  = &s_app_gnss_uart_dma_desc[state->next];
+
+    desc->dw0.length  = 0;
+    desc->dw0.suc_eof = 0;
+
+    /* Done with the buffer and the descriptor before the DMA may have it back */
+    atomic_thread_fence(memory_order_release);
+
+    desc->dw0.owner = DMA_DESCRIPTOR_BUFFER_OWNER_DMA;
+
+    state->next = (state->next + 1) % APP_GNSS_UART_DMA_DESC_NUM;
+}
+
+bool app_gnss_uart_dma_recover(void) {
+    app_gnss_uart_dma_state_t *state = &s_app_gnss_uart_dma;
+
+    if (!atomic_exchange(&state->overrun, false)) {
+        return false;
+    }
+
+    /* Whatever was in flight is lost, the demultiplexer resyncs on the next frame start. */
+    gdma_stop(state->channel);
+    gdma_reset(state->channel);
+
+    app_gnss_uart_dma_desc_init();
+
+    gdma_start(state->channel, (intptr_t)&s_app_gnss_uart_dma_desc[0]);
+
+    state->stats.overruns++;
+
+    return true;
+}
+
+void app_gnss_uart_dma_stats_get(app_gnss_uart_dma_stats_t *stats) {
+    *stats = s_app_gnss_uart_dma.stats;
+}
+
+static void app_gnss_uart_dma_desc_init(void) {
+    for (uint32_t i = 0; i < APP_GNSS_UART_DMA_DESC_NUM; i++) {
+        dma_descriptor_t *desc = &s_app_gnss_uart_dma_desc[i];
+
+        desc->dw0.size    = APP_GNSS_UART_DMA_DESC_SIZE;
+        desc->dw0.length  = 0;
+        desc->dw0.suc_eof = 0;
+        desc->dw0.owner   = DMA_DESCRIPTOR_BUFFER_OWNER_DMA;
+        desc->buffer      = s_app_gnss_uart_dma_buf[i];
+        desc->next        = &s_app_gnss_uart_dma_desc[(i + 1) % APP_GNSS_UART_DMA_DESC_NUM];
+    }
+
+    s_app_gnss_uart_dma.next = 0;
+}
+
+static bool IRAM_ATTR app_gnss_uart_dma_on_eof(gdma_channel_handle_t chan, gdma_event_data_t *event,
+                                               void *user_data) {
+    app_gnss_uart_dma_state_t *state = user_data;
+
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    vTaskNotifyGiveFromISR(state->notify_task, &xHigherPriorityTaskWoken);
+
+    return xHigherPriorityTaskWoken == pdTRUE;
+}
+
+static bool IRAM_ATTR app_gnss_uart_dma_on_error(gdma_channel_handle_t chan, gdma_event_data_t *event,
+                                                 void *user_data) {
+    app_gnss_uart_dma_state_t *state = user_data;
+
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    /* The consumer still owns the next descriptor: the ring is full and reception has stalled. */
+    atomic_store(&state->overrun, true);
+    vTaskNotifyGiveFromISR(state->notify_task, &xHigherPriorityTaskWoken);
+
+    return xHigherPriorityTaskWoken == pdTRUE;
+}
+
+#endif  // CONFIG_APP_GNSS_SERVER_UART_DMA
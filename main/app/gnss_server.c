@@ -1,3 +1,7 @@
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 /* IDF */
@@ -5,58 +9,222 @@
 #include "driver/uart.h"
 #include "esp_event.h"
 #include "esp_log.h"
-#include "freertos/list.h"
+#include "esp_timer.h"
 #include "freertos/queue.h"
 #include "freertos/task.h"
+#include "nvs_flash.h"
 
 /* App */
+#include "app/gnss/async_consumer.h"
+#include "app/gnss/dispatcher.h"
+#include "app/gnss/fix_builder.h"
+#include "app/gnss/frame_demux.h"
+#include "app/gnss/ingest_ring.h"
+#include "app/gnss/obs_decoder.h"
+#include "app/gnss/parser.h"
+#include "app/gnss/recorder.h"
+#include "app/gnss/uart_dma.h"
 #include "app/gnss_server.h"
+#include "app/uart_rx.h"
 
 /* nl */
-#include "rcv/nl_rtcm3.h"
-#include "rcv/nmea.h"
+#include "rcv/nl_crc24q.h"
+#include "rcv/nl_msm.h"
+#include "rcv/nl_rawlog.h"
+#include "rcv/nl_nmea_index.h"
+
+#define GNSS_UART_NUM       UART_NUM_2
+#define GNSS_UART_BUF_SIZE  (2048)
+#define GNSS_UART_QUEUE_LEN (8)
+#define GNSS_TX_PIN         CONFIG_APP_GNSS_SERVER_TX_GPIO
+#define GNSS_RX_PIN         CONFIG_APP_GNSS_SERVER_RX_GPIO
+#define GNSS_RST_PIN        CONFIG_APP_GNSS_SERVER_RST_GPIO
+#define GNSS_PPS_PIN        CONFIG_APP_GNSS_SERVER_PPS_GPIO
+
+#define GNSS_BAUD_DEFAULT  (115200) /* Module factory setting */
+#define GNSS_BAUD_TARGET   CONFIG_APP_GNSS_SERVER_BAUD
+#define GNSS_BAUD_PROBE_MS (1500) /* Longer than one output epoch at 1 Hz */
+#define GNSS_CMD_MAX_LEN   (96)
+
+#define GNSS_BOOT_TIMEOUT_MS    (3000) /* Upper bound for the first byte after reset */
+#define GNSS_CMD_ACK_TIMEOUT_MS (500)
+#define GNSS_CMD_RETRIES        (3)
+
+#define GNSS_NVS_NAMESPACE "a_gnss_server"
+#define GNSS_NVS_VERSION   1 /* DO NOT CHANGE THIS VALUE UNLESS THERE IS A STRUCTURE UPDATE */
+
+#define GNSS_FIX_INTERVAL_MIN_MS (100)
+#define GNSS_FIX_INTERVAL_MAX_MS (1000)
+#define GNSS_NMEA_RATE_MAX       (20)
+
+#define GNSS_UART_DMA_IDLE_MS (20) /* Added to twice a descriptor's transfer time before a full chunk counts as idle */
+
+#define GNSS_INGEST_RING_SIZE  (4096) /* Must be a power of 2 */
+#define GNSS_INGEST_CHUNK_SIZE (256)
+
+#define GNSS_RTCM_STATION_MAX (256) /* Onboard 1005/1006 and 1033 frames */
+
+/* PAIR001 result codes */
+typedef enum {
+    APP_GNSS_ACK_OK            = 0,
+    APP_GNSS_ACK_PROCESSING    = 1,
+    APP_GNSS_ACK_FAILED        = 2,
+    APP_GNSS_ACK_NOT_SUPPORTED = 3,
+    APP_GNSS_ACK_PARAM_ERROR   = 4,
+    APP_GNSS_ACK_BUSY          = 5,
+} app_gnss_ack_result_t;
 
-#define GNSS_UART_NUM      UART_NUM_2
-#define GNSS_UART_BUF_SIZE (2048)
-#define GNSS_TX_PIN        CONFIG_APP_GNSS_SERVER_TX_GPIO
-#define GNSS_RX_PIN        CONFIG_APP_GNSS_SERVER_RX_GPIO
-#define GNSS_RST_PIN       CONFIG_APP_GNSS_SERVER_RST_GPIO
-#define GNSS_PPS_PIN       CONFIG_APP_GNSS_SERVER_PPS_GPIO
+typedef struct {
+    int32_t id;
+    int32_t result;
+} app_gnss_ack_t;
+
+/* Sentence reader for bring-up, keeps the unconsumed part of the last UART read between sentences. */
+typedef struct {
+    uint8_t         buf[64];
+    size_t          pos;
+    size_t          len;
+    char            line[APP_GNSS_DEMUX_NMEA_MAX_LEN];
+    size_t          line_len;
+    nl_nmea_index_t index;
+} app_gnss_line_reader_t;
+
+/* Latest RMC time, published by the UART task and read by the PPS task under utc_seq. */
+typedef struct {
+    nl_nmea_date_t date;
+    nl_nmea_time_t time;
+    int64_t        rx_us; /* esp_timer time the sentence was decoded */
+    bool           valid;
+} app_gnss_utc_snapshot_t;
+
+typedef struct {
+    FILE*              fp;
+    nl_rawlog_reader_t reader;
+    uint16_t           speed; /* Multiple of the recorded pace, 0 for as fast as possible */
+    uint8_t            buf[NL_RAWLOG_CHUNK_MAX];
+} app_gnss_replay_t;
 
 typedef struct {
     QueueHandle_t     uart_rx_queue;
     TaskHandle_t      uart_rx_task;
     TaskHandle_t      pps_event_task;
-    SemaphoreHandle_t consumer_mutex;
-
-    nmea_raw_t nmea_raw;
-    nl_rtcm_t  rtcm_raw;
-
-    List_t consumer_list;
+    SemaphoreHandle_t command_mutex; /* One PAIR exchange at a time, also guards the stored profile */
+    QueueHandle_t     ack_queue;     /* PAIR001 answers, forwarded by the parser once the event loop runs */
+    atomic_int        ack_pending;   /* Command id awaiting an answer, -1 if none */
+    atomic_bool       running;       /* Bring-up done, the UART belongs to the event loop */
+
+    /*
+     * Replay of a recording, owns the parser while it runs so the module's output is not parsed meanwhile.
+     * replay_task is set and cleared under the parser mutex; replay_idle is held from start until the task is done.
+     */
+    TaskHandle_t       replay_task;
+    SemaphoreHandle_t  replay_idle;
+    atomic_bool        replay_stop;
+    atomic_uint        replay_bytes;
+    app_gnss_replay_t* replay;
+
+    /* Station messages generated onboard, guarded by the parser mutex. station_len is 0 while the module's own pass */
+    uint8_t  station_frames[GNSS_RTCM_STATION_MAX];
+    size_t   station_len;
+    uint32_t station_interval_ms;
+    int64_t  station_sent_us;
+    uint32_t station_injected;
+    uint32_t station_dropped;
+
+    atomic_uint correction_bytes;
+
+    atomic_uint             utc_seq; /* Seqlock, odd while the snapshot is being written */
+    app_gnss_utc_snapshot_t utc;
+
+    int64_t  pps_last_us;
+    uint32_t pps_sequence;
+
+    app_gnss_ingest_ring_t  ingest_ring;
+    app_gnss_parser_t       parser;
+    app_gnss_demux_t        ack_demux; /* Live output dropped during a replay, scanned for PAIR001 answers only */
+    app_gnss_obs_decoder_t* obs_decoder; /* Allocated on the first MSM frame with an APP_GNSS_CB_OBS consumer */
+    uint32_t                fifo_overflows;
+    uint32_t                baud_rate;
+    uint32_t                rx_buffer_size;
+    uint32_t                rx_backlog_max; /* Most bytes pending at an RX wakeup, RX task only */
+    app_uart_rx_meter_t     rx_meter;
+
+    /* Bring-up timing, milliseconds after the reset line was released */
+    int64_t  boot_reset_us;
+    uint32_t boot_output_ms;
+    uint32_t boot_config_ms;
+    uint32_t boot_first_fix_ms;
+    uint16_t cmd_acked;
+    uint16_t cmd_failed;
+    uint16_t cmd_retries;
+
+    app_gnss_dispatcher_t dispatcher;
 } app_gnss_server_state_t;
 
-typedef struct {
-    app_gnss_cb_type_t type;
-    app_gnss_cb_t      cb;
-    void*              user_data;
-} app_gnss_consumer_t;
-
 static const char* LOG_TAG = "asuna_gnss";
 
+/* Probed in order, the configured target first */
+static const uint32_t s_app_gnss_baud_candidates[] = {
+    GNSS_BAUD_TARGET, GNSS_BAUD_DEFAULT, 921600, 460800, 230400, 9600,
+};
+
+/* Bodies only, app_gnss_send_command() adds the framing and checksum. The profile follows, then PAIR513. */
 static const char* s_app_gnss_init_commands[] = {
-    "$PAIR862,0,0,253*2E\r\n",
-    "$PAIR092,1*2C\r\n",
-    "$PAIR513*3D\r\n",
+    "PAIR862,0,0,253",
+    "PAIR092,1",
 };
 
+/* Indexed by app_gnss_nmea_sentence_t */
+static const char* s_app_gnss_nmea_names[APP_GNSS_NMEA_COUNT] = {
+    "GGA", "GLL", "GSA", "GSV", "RMC", "VTG", "ZDA", "GRS", "GST",
+};
+
+static const char* APP_GNSS_CFG_KEY_FLAG           = "cfg_valid"; /* Configuration key */
+static const char* APP_GNSS_CFG_KEY_FIX_INTERVAL   = "fix_ms";    /* Fix interval */
+static const char* APP_GNSS_CFG_KEY_CONSTELLATIONS = "constel";   /* Constellation bitmask */
+static const char* APP_GNSS_CFG_KEY_NMEA_RATE      = "nmea_rate"; /* Per-sentence output rates */
+static const char* APP_GNSS_CFG_KEY_RTCM_MSM       = "rtcm_msm";  /* MSM type */
+static const char* APP_GNSS_CFG_KEY_RTCM_STATION   = "rtcm_sta";  /* 1005 station position */
+static const char* APP_GNSS_CFG_KEY_RTCM_EPH       = "rtcm_eph";  /* Ephemeris messages */
+
 static app_gnss_server_state_t s_app_gnss_server_state;
+static uint8_t                 s_app_gnss_ingest_buf[GNSS_INGEST_RING_SIZE];
 
 static void app_gnss_pps_event_task(void* parameters);
 static void app_gnss_uart_event_task(void* parameters);
-static void app_gnss_reset(void);
+static void app_gnss_reset(app_gnss_server_state_t* state);
 static void app_gnss_pps_isr_handler(void* arg);
-static void app_gnss_send_init_commands(void);
+static void app_gnss_send_init_commands(app_gnss_server_state_t* state);
+static int  app_gnss_send_command(const char* fmt, ...);
+static int  app_gnss_command_exec(app_gnss_server_state_t* state, const char* fmt, ...);
+static int  app_gnss_ack_wait(app_gnss_server_state_t* state, app_gnss_line_reader_t* reader, int32_t id);
+static bool app_gnss_ack_parse(const nl_nmea_index_t* index, app_gnss_ack_t* ack);
+static int  app_gnss_config_apply(app_gnss_server_state_t* state, const app_gnss_server_config_t* config);
+static int  app_gnss_config_load(app_gnss_server_config_t* config);
+static void app_gnss_config_store(const app_gnss_server_config_t* config);
+static void app_gnss_line_reader_reset(app_gnss_line_reader_t* reader);
+static bool app_gnss_line_read(app_gnss_line_reader_t* reader, TickType_t start, TickType_t timeout);
+static bool app_gnss_baud_probe(uint32_t baud);
+static void app_gnss_baud_negotiate(app_gnss_server_state_t* state);
 static void app_gnss_dispatch(app_gnss_cb_type_t type, void* data);
+static bool app_gnss_subscribed(app_gnss_cb_type_t type);
+static size_t app_gnss_uart_ingest(app_gnss_server_state_t* state);
+#if CONFIG_APP_GNSS_SERVER_UART_DMA
+static void app_gnss_uart_dma_loop(app_gnss_server_state_t* state);
+#endif
+static void app_gnss_parse(app_gnss_server_state_t* state, const uint8_t* data, size_t data_len);
+static void app_gnss_idle(app_gnss_server_state_t* state);
+static void app_gnss_replay_task(void* parameters);
+static bool app_gnss_frame_handler(void* ctx, app_gnss_frame_type_t type, const uint8_t* frame, size_t len);
+static bool app_gnss_handle_nmea(app_gnss_server_state_t* state, const uint8_t* frame, size_t len);
+static bool app_gnss_ack_frame_handler(void* ctx, app_gnss_frame_type_t type, const uint8_t* frame, size_t len);
+static void app_gnss_ack_forward(app_gnss_server_state_t* state, const nl_nmea_index_t* index);
+static bool app_gnss_handle_rtcm(app_gnss_server_state_t* state, const uint8_t* frame, size_t len);
+static void app_gnss_station_inject(app_gnss_server_state_t* state);
+static void app_gnss_epoch_handler(void* ctx, const app_gnss_fix_t* fix, const app_gnss_sat_t* sat);
+static void app_gnss_utc_publish(app_gnss_server_state_t* state, const app_gnss_utc_snapshot_t* utc);
+static void app_gnss_utc_read(app_gnss_server_state_t* state, app_gnss_utc_snapshot_t* utc);
+static void app_gnss_utc_next_second(nl_nmea_date_t* date, nl_nmea_time_t* time);
 
 int app_gnss_server_init(void) {
     gpio_config_t pin_conf = {
@@ -77,8 +245,12 @@ int app_gnss_server_init(void) {
 
     gpio_isr_handler_add(GNSS_PPS_PIN, app_gnss_pps_isr_handler, &s_app_gnss_server_state);
 
+    if (nl_crc24q_init() != 0) {
+        ESP_LOGW(LOG_TAG, "CRC-24Q self-test failed, using bitwise implementation.");
+    }
+
     uart_config_t uart_config = {
-        .baud_rate  = 115200,
+        .baud_rate  = GNSS_BAUD_DEFAULT,
         .data_bits  = UART_DATA_8_BITS,
         .parity     = UART_PARITY_DISABLE,
         .stop_bits  = UART_STOP_BITS_1,
@@ -87,19 +259,62 @@ int app_gnss_server_init(void) {
     };
 
     uart_set_pin(GNSS_UART_NUM, GNSS_TX_PIN, GNSS_RX_PIN, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
-    uart_driver_install(GNSS_UART_NUM, GNSS_UART_BUF_SIZE, GNSS_UART_BUF_SIZE, 8,
+    uart_driver_install(GNSS_UART_NUM, GNSS_UART_BUF_SIZE, GNSS_UART_BUF_SIZE, GNSS_UART_QUEUE_LEN,
                         &s_app_gnss_server_state.uart_rx_queue, 0);
     uart_param_config(GNSS_UART_NUM, &uart_config);
 
-    vListInitialise(&s_app_gnss_server_state.consumer_list);
+    const app_uart_rx_config_t rx_config = {
+        .rx_full_threshold = CONFIG_APP_GNSS_SERVER_RX_FULL_THRESH,
+        .rx_timeout        = CONFIG_APP_GNSS_SERVER_RX_TIMEOUT,
+#if CONFIG_APP_GNSS_SERVER_RX_PATTERN_LF
+        .pattern_chr = '\n',
+#else
+        .pattern_chr = 0,
+#endif
+        .queue_size = GNSS_UART_QUEUE_LEN,
+    };
+
+    app_uart_rx_config_apply(GNSS_UART_NUM, &rx_config);
+    app_uart_rx_meter_init(&s_app_gnss_server_state.rx_meter);
+    s_app_gnss_server_state.rx_buffer_size = GNSS_UART_BUF_SIZE;
+
+    app_gnss_ingest_ring_init(&s_app_gnss_server_state.ingest_ring, s_app_gnss_ingest_buf, GNSS_INGEST_RING_SIZE,
+                              GNSS_INGEST_CHUNK_SIZE);
+    if (app_gnss_parser_init(&s_app_gnss_server_state.parser, app_gnss_frame_handler, app_gnss_epoch_handler,
+                             &s_app_gnss_server_state) != 0) {
+        ESP_LOGE(LOG_TAG, "Failed to create GNSS parser mutex");
+
+        return -1;
+    }
+
+    app_gnss_demux_init(&s_app_gnss_server_state.ack_demux, app_gnss_ack_frame_handler, &s_app_gnss_server_state);
+
+    if (app_gnss_dispatcher_init(&s_app_gnss_server_state.dispatcher) != 0) {
+        ESP_LOGE(LOG_TAG, "Failed to create GNSS consumer dispatcher");
+
+        return -1;
+    }
+
+    s_app_gnss_server_state.command_mutex = xSemaphoreCreateMutex();
+    s_app_gnss_server_state.ack_queue     = xQueueCreate(2, sizeof(app_gnss_ack_t));
+    if (s_app_gnss_server_state.command_mutex == NULL || s_app_gnss_server_state.ack_queue == NULL) {
+        ESP_LOGE(LOG_TAG, "Failed to create GNSS command mutex/queue");
+
+        return -1;
+    }
 
-    s_app_gnss_server_state.consumer_mutex = xSemaphoreCreateMutex();
-    if (s_app_gnss_server_state.consumer_mutex == NULL) {
-        ESP_LOGE(LOG_TAG, "Failed to create GNSS consumer mutex");
+    s_app_gnss_server_state.replay_idle = xSemaphoreCreateBinary();
+    if (s_app_gnss_server_state.replay_idle == NULL) {
+        ESP_LOGE(LOG_TAG, "Failed to create GNSS replay semaphore");
 
         return -1;
     }
 
+    xSemaphoreGive(s_app_gnss_server_state.replay_idle);
+
+    atomic_store(&s_app_gnss_server_state.ack_pending, -1);
+    atomic_store(&s_app_gnss_server_state.running, false);
+
     if (xTaskCreate(app_gnss_uart_event_task, "asuna_gnss", 4096, &s_app_gnss_server_state, 5,
                     &s_app_gnss_server_state.uart_rx_task) != pdPASS) {
         ESP_LOGE(LOG_TAG, "Failed to create GNSS UART event task.");
@@ -127,26 +342,51 @@ app_gnss_cb_handle_t app_gnss_server_cb_register(app_gnss_cb_type_t type, app_gn
     consumer->type      = type;
     consumer->cb        = callback;
     consumer->user_data = handle;
+    consumer->async     = NULL;
 
-    ListItem_t* item = malloc(sizeof(ListItem_t));
-    if (item == NULL) {
+    if (app_gnss_dispatcher_update(&s_app_gnss_server_state.dispatcher, consumer, NULL) != 0) {
         goto free_consumer_exit;
     }
 
-    vListInitialiseItem(item);
+    return consumer;
 
-    item->xItemValue = (TickType_t)consumer;
+free_consumer_exit:
+    free(consumer);
 
-    if (xSemaphoreTake(s_app_gnss_server_state.consumer_mutex, portMAX_DELAY) != pdPASS) {
-        goto free_consumer_exit;
+    return NULL;
+}
+
+app_gnss_cb_handle_t app_gnss_server_cb_register_async(app_gnss_cb_type_t type, app_gnss_cb_t callback, void* handle,
+                                                       const app_gnss_async_config_t* config) {
+    const app_gnss_async_config_t default_config = APP_GNSS_ASYNC_CONFIG_DEFAULT();
+
+    if (config == NULL) {
+        config = &default_config;
+    }
+
+    app_gnss_consumer_t* consumer = malloc(sizeof(app_gnss_consumer_t));
+    if (consumer == NULL) {
+        return NULL;
     }
 
-    vListInsert(&s_app_gnss_server_state.consumer_list, item);
+    consumer->type      = type;
+    consumer->cb        = callback;
+    consumer->user_data = handle;
+
+    consumer->async = app_gnss_async_create(config, callback, handle);
+    if (consumer->async == NULL) {
+        goto free_consumer_exit;
+    }
 
-    xSemaphoreGive(s_app_gnss_server_state.consumer_mutex);
+    if (app_gnss_dispatcher_update(&s_app_gnss_server_state.dispatcher, consumer, NULL) != 0) {
+        goto destroy_async_exit;
+    }
 
     return consumer;
 
+destroy_async_exit:
+    app_gnss_async_destroy(consumer->async);
+
 free_consumer_exit:
     free(consumer);
 
@@ -154,84 +394,772 @@ free_consumer_exit:
 }
 
 void app_gnss_server_cb_unregister(app_gnss_cb_handle_t handle) {
-    if (xSemaphoreTake(s_app_gnss_server_state.consumer_mutex, portMAX_DELAY) != pdPASS) {
+    if (handle == NULL) {
         return;
     }
 
-    ListItem_t*       item = listGET_HEAD_ENTRY(&s_app_gnss_server_state.consumer_list);
-    const ListItem_t* end  = listGET_END_MARKER(&s_app_gnss_server_state.consumer_list);
+    /* Once the update returns no dispatcher can still hold the consumer, so it is safe to free. */
+    if (app_gnss_dispatcher_update(&s_app_gnss_server_state.dispatcher, NULL, handle) == 0) {
+        app_gnss_consumer_t* consumer = handle;
 
-    while (item != NULL) {
-        if (item == end) {
-            break;
+        if (consumer->async != NULL) {
+            app_gnss_async_destroy(consumer->async);
         }
 
-        app_gnss_consumer_t* consumer = (app_gnss_consumer_t*)item->xItemValue;
+        free(consumer);
+    }
+}
 
-        if (consumer == handle) {
-            listREMOVE_ITEM(item);
-            free(consumer);
-            free(item);
+int app_gnss_server_cb_async_stats_get(app_gnss_cb_handle_t handle, app_gnss_async_stats_t* stats) {
+    const app_gnss_consumer_t* consumer = handle;
 
-            break;
+    if (consumer == NULL || consumer->async == NULL) {
+        return -1;
+    }
+
+    app_gnss_async_stats_get(consumer->async, stats);
+
+    return 0;
+}
+
+int app_gnss_server_stats_get(app_gnss_server_stats_t* stats) {
+    const app_gnss_ingest_ring_t* ring  = &s_app_gnss_server_state.ingest_ring;
+    const app_gnss_demux_t*       demux = &s_app_gnss_server_state.parser.demux;
+
+    stats->rx_bytes       = ring->stats.bytes_in;
+    stats->rx_chunks      = ring->stats.chunks;
+    stats->rx_buffer_size = s_app_gnss_server_state.rx_buffer_size;
+    stats->rx_backlog_max = s_app_gnss_server_state.rx_backlog_max;
+    stats->fifo_overflows = s_app_gnss_server_state.fifo_overflows;
+    stats->baud_rate      = s_app_gnss_server_state.baud_rate;
+
+    stats->boot_output_ms    = s_app_gnss_server_state.boot_output_ms;
+    stats->boot_config_ms    = s_app_gnss_server_state.boot_config_ms;
+    stats->boot_first_fix_ms = s_app_gnss_server_state.boot_first_fix_ms;
+    stats->cmd_acked         = s_app_gnss_server_state.cmd_acked;
+    stats->cmd_failed        = s_app_gnss_server_state.cmd_failed;
+    stats->cmd_retries       = s_app_gnss_server_state.cmd_retries;
+
+    app_uart_rx_stats_t rx;
+    app_uart_rx_meter_get(&s_app_gnss_server_state.rx_meter, &rx);
+
+    stats->rx_wakeups          = rx.wakeups;
+    stats->rx_wakeups_per_sec  = rx.wakeups_per_sec;
+    stats->rx_bytes_per_wakeup = rx.bytes_per_wakeup;
+
+#if CONFIG_APP_GNSS_SERVER_UART_DMA
+    app_gnss_uart_dma_stats_t dma;
+    app_gnss_uart_dma_stats_get(&dma);
+
+    stats->rx_bytes += dma.bytes;
+    stats->rx_chunks += dma.chunks;
+    stats->fifo_overflows += dma.overruns;
+#endif
+    const app_gnss_obs_decoder_t* obs = s_app_gnss_server_state.obs_decoder;
+    if (obs != NULL) {
+        stats->obs_messages = obs->stats.messages;
+        stats->obs_slips    = obs->stats.slips;
+        stats->obs_losses   = obs->stats.losses;
+    } else {
+        stats->obs_messages = 0;
+        stats->obs_slips    = 0;
+        stats->obs_losses   = 0;
+    }
+
+    stats->replay_bytes        = atomic_load(&s_app_gnss_server_state.replay_bytes);
+    stats->replay_live_dropped = s_app_gnss_server_state.parser.live_dropped;
+
+    stats->station_injected = s_app_gnss_server_state.station_injected;
+    stats->station_dropped  = s_app_gnss_server_state.station_dropped;
+    stats->correction_bytes = atomic_load(&s_app_gnss_server_state.correction_bytes);
+
+    stats->nmea_frames     = demux->stats.nmea_frames;
+    stats->rtcm_frames     = demux->stats.rtcm_frames;
+    stats->rejected_frames = demux->stats.rejected;
+    stats->skipped_bytes   = demux->stats.skipped_bytes;
+
+    return 0;
+}
+
+int app_gnss_server_replay_start(const char* path, uint16_t speed) {
+    app_gnss_server_state_t* state = &s_app_gnss_server_state;
+
+    if (!atomic_load(&state->running)) {
+        return -1;
+    }
+
+    /* Held until the replay task is gone, a second replay fails here */
+    if (xSemaphoreTake(state->replay_idle, 0) != pdPASS) {
+        return -1;
+    }
+
+    app_gnss_replay_t* replay = malloc(sizeof(app_gnss_replay_t));
+    if (replay == NULL) {
+        goto give_idle_exit;
+    }
+
+    replay->speed = speed;
+    replay->fp    = fopen(path, "rb");
+    if (replay->fp == NULL) {
+        ESP_LOGE(LOG_TAG, "Failed to open %s.", path);
+        goto free_replay_exit;
+    }
+
+    if (nl_rawlog_reader_open(&replay->reader, replay->fp) != 0) {
+        ESP_LOGE(LOG_TAG, "%s is not a GNSS recording.", path);
+        goto close_file_exit;
+    }
+
+    /* Waits for the receive path to leave the parser, from here on live output is dropped */
+    if (app_gnss_parser_replay_begin(&state->parser) != 0) {
+        goto close_file_exit;
+    }
+
+    state->replay = replay;
+    atomic_store(&state->replay_stop, false);
+    atomic_store(&state->replay_bytes, 0);
+
+    /* The task clears its handle under the same mutex before it goes, so the handle is set before it can */
+    xSemaphoreTake(state->parser.mutex, portMAX_DELAY);
+    const BaseType_t created = xTaskCreate(app_gnss_replay_task, "asuna_gnss_rp", 3072, state, 5, &state->replay_task);
+    xSemaphoreGive(state->parser.mutex);
+
+    if (created != pdPASS) {
+        ESP_LOGE(LOG_TAG, "Failed to create GNSS replay task.");
+        state->replay      = NULL;
+        state->replay_task = NULL;
+        app_gnss_parser_replay_end(&state->parser);
+        goto close_file_exit;
+    }
+
+    ESP_LOGI(LOG_TAG, "Replaying %s.", path);
+
+    return 0;
+
+close_file_exit:
+    fclose(replay->fp);
+
+free_replay_exit:
+    free(replay);
+
+give_idle_exit:
+    xSemaphoreGive(state->replay_idle);
+
+    return -1;
+}
+
+void app_gnss_server_replay_stop(void) {
+    app_gnss_server_state_t* state = &s_app_gnss_server_state;
+
+    /* The task cannot clear its handle and delete itself while the mutex is held here */
+    xSemaphoreTake(state->parser.mutex, portMAX_DELAY);
+
+    if (state->replay_task != NULL) {
+        atomic_store(&state->replay_stop, true);
+        xTaskNotifyGive(state->replay_task);
+    }
+
+    xSemaphoreGive(state->parser.mutex);
+
+    /* Given back by the task once it is done, or right away if no replay runs */
+    xSemaphoreTake(state->replay_idle, portMAX_DELAY);
+    xSemaphoreGive(state->replay_idle);
+}
+
+int app_gnss_server_correction_write(const uint8_t* data, size_t len) {
+    app_gnss_server_state_t* state = &s_app_gnss_server_state;
+
+    if (!atomic_load(&state->running)) {
+        return -1;
+    }
+
+    /* The driver copies into its TX ring, this only blocks while the ring is full */
+    if (uart_write_bytes(GNSS_UART_NUM, data, len) != (int)len) {
+        return -2;
+    }
+
+    atomic_fetch_add(&state->correction_bytes, len);
+
+    return 0;
+}
+
+int app_gnss_server_rtcm_station_set(const uint8_t* frames, size_t len, uint32_t interval_ms) {
+    app_gnss_server_state_t* state = &s_app_gnss_server_state;
+
+    /* ---- Sanity checks ---- */
+    if (len > GNSS_RTCM_STATION_MAX) return -1;
+    if (len > 0 && (frames == NULL || interval_ms == 0)) return -1;
+
+    for (size_t pos = 0; pos < len;) {
+        if (len - pos < 6 || frames[pos] != 0xD3) return -1;
+
+        pos += (((size_t)(frames[pos + 1] & 0x03U) << 8U) | frames[pos + 2]) + 6U;
+        if (pos > len) return -1;
+    }
+
+    xSemaphoreTake(state->parser.mutex, portMAX_DELAY);
+
+    if (len > 0) {
+        memcpy(state->station_frames, frames, len);
+    }
+
+    state->station_len         = len;
+    state->station_interval_ms = interval_ms;
+    state->station_sent_us     = 0; /* Due after the next epoch */
+
+    xSemaphoreGive(state->parser.mutex);
+
+    return 0;
+}
+
+void app_gnss_server_config_init(app_gnss_server_config_t* config) {
+    memset(config, 0U, sizeof(app_gnss_server_config_t));
+
+    config->fix_interval_ms = 1000;
+    config->constellations  = APP_GNSS_CONSTELLATION_BIT(APP_GNSS_CONSTELLATION_GPS) |
+                             APP_GNSS_CONSTELLATION_BIT(APP_GNSS_CONSTELLATION_GLONASS) |
+                             APP_GNSS_CONSTELLATION_BIT(APP_GNSS_CONSTELLATION_GALILEO) |
+                             APP_GNSS_CONSTELLATION_BIT(APP_GNSS_CONSTELLATION_BEIDOU) |
+                             APP_GNSS_CONSTELLATION_BIT(APP_GNSS_CONSTELLATION_QZSS);
+
+    /* Everything the fix builder merges */
+    config->nmea_rate[APP_GNSS_NMEA_GGA] = 1;
+    config->nmea_rate[APP_GNSS_NMEA_GSA] = 1;
+    config->nmea_rate[APP_GNSS_NMEA_GSV] = 1;
+    config->nmea_rate[APP_GNSS_NMEA_RMC] = 1;
+    config->nmea_rate[APP_GNSS_NMEA_GST] = 1;
+
+    config->rtcm_msm       = APP_GNSS_RTCM_MSM7;
+    config->rtcm_station   = true;
+    config->rtcm_ephemeris = true;
+}
+
+int app_gnss_server_config_set(const app_gnss_server_config_t* config) {
+    app_gnss_server_state_t* state = &s_app_gnss_server_state;
+    int                      ret   = 0;
+
+    /* ---- Sanity checks ---- */
+    if (config->fix_interval_ms < GNSS_FIX_INTERVAL_MIN_MS) return -1;
+    if (config->fix_interval_ms > GNSS_FIX_INTERVAL_MAX_MS) return -1;
+    if ((config->constellations & APP_GNSS_CONSTELLATION_BIT(APP_GNSS_CONSTELLATION_GPS)) == 0U) return -1;
+    if (config->rtcm_msm != APP_GNSS_RTCM_MSM_OFF && config->rtcm_msm != APP_GNSS_RTCM_MSM4 &&
+        config->rtcm_msm != APP_GNSS_RTCM_MSM7)
+        return -1;
+
+    for (uint8_t i = 0; i < APP_GNSS_NMEA_COUNT; i++) {
+        if (config->nmea_rate[i] > GNSS_NMEA_RATE_MAX) return -1;
+    }
+
+    if (xSemaphoreTake(state->command_mutex, portMAX_DELAY) != pdPASS) {
+        return -2;
+    }
+
+    app_gnss_config_store(config);
+
+    /* Before that, bring-up picks the stored profile up by itself */
+    if (atomic_load(&state->running)) {
+        if (app_gnss_config_apply(state, config) != 0 || app_gnss_command_exec(state, "PAIR513") != 0) {
+            ret = -3;
         }
+    }
+
+    xSemaphoreGive(state->command_mutex);
 
-        item = listGET_NEXT(item);
+    return ret;
+}
+
+int app_gnss_server_config_get(app_gnss_server_config_t* config) {
+    if (xSemaphoreTake(s_app_gnss_server_state.command_mutex, portMAX_DELAY) != pdPASS) {
+        return -1;
+    }
+
+    const int ret = app_gnss_config_load(config);
+
+    xSemaphoreGive(s_app_gnss_server_state.command_mutex);
+
+    return ret;
+}
+
+const char* app_gnss_server_nmea_name(app_gnss_nmea_sentence_t sentence) {
+    if (sentence >= APP_GNSS_NMEA_COUNT) {
+        return NULL;
     }
 
-    xSemaphoreGive(s_app_gnss_server_state.consumer_mutex);
+    return s_app_gnss_nmea_names[sentence];
 }
 
-static void app_gnss_send_init_commands(void) {
+/**
+ * Runs under command_mutex. Constellation changes only take effect after the module restarts, the other settings
+ * apply immediately.
+ */
+static int app_gnss_config_apply(app_gnss_server_state_t* state, const app_gnss_server_config_t* config) {
+    const uint8_t c   = config->constellations;
+    int           ret = 0;
+
+#define GNSS_HAS(x) ((c & APP_GNSS_CONSTELLATION_BIT(APP_GNSS_CONSTELLATION_##x)) ? 1 : 0)
+
+    ret |= app_gnss_command_exec(state, "PAIR066,%d,%d,%d,%d,%d,%d", GNSS_HAS(GPS), GNSS_HAS(GLONASS),
+                                 GNSS_HAS(GALILEO), GNSS_HAS(BEIDOU), GNSS_HAS(QZSS), GNSS_HAS(NAVIC));
+
+#undef GNSS_HAS
+
+    ret |= app_gnss_command_exec(state, "PAIR050,%u", config->fix_interval_ms);
+
+    for (uint8_t i = 0; i < APP_GNSS_NMEA_COUNT; i++) {
+        ret |= app_gnss_command_exec(state, "PAIR062,%u,%u", i, config->nmea_rate[i]);
+    }
+
+    /* MSM output: -1 disabled, 0 MSM4, 1 MSM7 */
+    const int msm_mode = (config->rtcm_msm == APP_GNSS_RTCM_MSM7)   ? 1
+                         : (config->rtcm_msm == APP_GNSS_RTCM_MSM4) ? 0
+                                                                    : -1;
+
+    ret |= app_gnss_command_exec(state, "PAIR432,%d", msm_mode);
+    ret |= app_gnss_command_exec(state, "PAIR434,%d", config->rtcm_station ? 1 : 0);
+    ret |= app_gnss_command_exec(state, "PAIR436,%d", config->rtcm_ephemeris ? 1 : 0);
+
+    return ret;
+}
+
+static int app_gnss_config_load(app_gnss_server_config_t* config) {
+    int       ret = 0;
+    esp_err_t err;
+
+    /* ---- Create NVS handle ---- */
+    nvs_handle handle;
+    err = nvs_open(GNSS_NVS_NAMESPACE, NVS_READONLY, &handle);
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        return -1;
+    }
+
+    /* Check NVS data flag */
+
+    uint8_t cfg_flag;
+    if (nvs_get_u8(handle, APP_GNSS_CFG_KEY_FLAG, &cfg_flag) != ESP_OK) {
+        ret = -1;
+        goto close_handle_exit;
+    }
+
+    /* ?? Downgrade is not allowed ?? */
+    if (cfg_flag > GNSS_NVS_VERSION) {
+        ret = -2;
+        goto close_handle_exit;
+    }
+
+    /* ---- Load configuration ---- */
+    ESP_ERROR_CHECK(nvs_get_u16(handle, APP_GNSS_CFG_KEY_FIX_INTERVAL, &config->fix_interval_ms));
+    ESP_ERROR_CHECK(nvs_get_u8(handle, APP_GNSS_CFG_KEY_CONSTELLATIONS, &config->constellations));
+
+    size_t rate_len = sizeof(config->nmea_rate);
+    ESP_ERROR_CHECK(nvs_get_blob(handle, APP_GNSS_CFG_KEY_NMEA_RATE, config->nmea_rate, &rate_len));
+
+    uint8_t rtcm_station;
+    uint8_t rtcm_ephemeris;
+    ESP_ERROR_CHECK(nvs_get_u8(handle, APP_GNSS_CFG_KEY_RTCM_MSM, &config->rtcm_msm));
+    ESP_ERROR_CHECK(nvs_get_u8(handle, APP_GNSS_CFG_KEY_RTCM_STATION, &rtcm_station));
+    ESP_ERROR_CHECK(nvs_get_u8(handle, APP_GNSS_CFG_KEY_RTCM_EPH, &rtcm_ephemeris));
+    config->rtcm_station   = rtcm_station;
+    config->rtcm_ephemeris = rtcm_ephemeris;
+
+close_handle_exit:
+    nvs_close(handle);
+
+    return ret;
+}
+
+static void app_gnss_config_store(const app_gnss_server_config_t* config) {
+    /* ---- Create NVS handle ---- */
+    nvs_handle handle;
+    ESP_ERROR_CHECK(nvs_open(GNSS_NVS_NAMESPACE, NVS_READWRITE, &handle));
+
+    /* ---- Store configuration ---- */
+    ESP_ERROR_CHECK(nvs_set_u8(handle, APP_GNSS_CFG_KEY_FLAG, GNSS_NVS_VERSION));
+
+    ESP_ERROR_CHECK(nvs_set_u16(handle, APP_GNSS_CFG_KEY_FIX_INTERVAL, config->fix_interval_ms));
+    ESP_ERROR_CHECK(nvs_set_u8(handle, APP_GNSS_CFG_KEY_CONSTELLATIONS, config->constellations));
+    ESP_ERROR_CHECK(nvs_set_blob(handle, APP_GNSS_CFG_KEY_NMEA_RATE, config->nmea_rate, sizeof(config->nmea_rate)));
+    ESP_ERROR_CHECK(nvs_set_u8(handle, APP_GNSS_CFG_KEY_RTCM_MSM, config->rtcm_msm));
+    ESP_ERROR_CHECK(nvs_set_u8(handle, APP_GNSS_CFG_KEY_RTCM_STATION, config->rtcm_station));
+    ESP_ERROR_CHECK(nvs_set_u8(handle, APP_GNSS_CFG_KEY_RTCM_EPH, config->rtcm_ephemeris));
+
+    ESP_ERROR_CHECK(nvs_commit(handle));
+
+    nvs_close(handle);
+}
+
+static void app_gnss_send_init_commands(app_gnss_server_state_t* state) {
     const size_t num_commands = sizeof(s_app_gnss_init_commands) / sizeof(s_app_gnss_init_commands[0]);
 
+    app_gnss_server_config_t config;
+
+    xSemaphoreTake(state->command_mutex, portMAX_DELAY);
+
     for (int i = 0; i < num_commands; i++) {
-        uart_write_bytes(GNSS_UART_NUM, s_app_gnss_init_commands[i], strlen(s_app_gnss_init_commands[i]));
-        ESP_LOGD(LOG_TAG, "Sent command: %s", s_app_gnss_init_commands[i]);
+        app_gnss_command_exec(state, "%s", s_app_gnss_init_commands[i]);
+    }
+
+    if (app_gnss_config_load(&config) != 0) {
+        ESP_LOGW(LOG_TAG, "GNSS profile invalid, restore to default...");
+
+        app_gnss_server_config_init(&config);
+        app_gnss_config_store(&config);
+    }
+
+    app_gnss_config_apply(state, &config);
+    app_gnss_command_exec(state, "PAIR513");
+
+    /* From now on acknowledgements come through the parser */
+    atomic_store(&state->running, true);
+
+    xSemaphoreGive(state->command_mutex);
+
+    state->boot_config_ms = (uint32_t)((esp_timer_get_time() - state->boot_reset_us) / 1000);
+
+    ESP_LOGI(LOG_TAG, "GNSS module configured %" PRIu32 " ms after reset, %u commands acknowledged, %u failed.",
+             state->boot_config_ms, state->cmd_acked, state->cmd_failed);
+}
+
+/**
+ * Send a PAIR command and wait for its $PAIR001 acknowledgement, retrying on timeout or when the module is busy.
+ * Returns 0 once the module accepted the command, -1 if it rejected it or never answered. Callers hold command_mutex.
+ */
+static int app_gnss_command_exec(app_gnss_server_state_t* state, const char* fmt, ...) {
+    char    body[GNSS_CMD_MAX_LEN];
+    va_list args;
+
+    va_start(args, fmt);
+    const int len = vsnprintf(body, sizeof(body), fmt, args);
+    va_end(args);
+
+    if (len < 0 || len >= (int)sizeof(body)) {
+        return -1;
+    }
+
+    if (strncmp(body, "PAIR", 4) != 0) {
+        return app_gnss_send_command("%s", body);
+    }
+
+    const int32_t id  = strtol(&body[4], NULL, 10);
+    int           ret = -1;
+
+    app_gnss_line_reader_t reader;
+
+    atomic_store(&state->ack_pending, id);
+
+    for (int attempt = 0; attempt < GNSS_CMD_RETRIES; attempt++) {
+        if (attempt > 0) {
+            state->cmd_retries++;
+        }
+
+        if (atomic_load(&state->running)) {
+            xQueueReset(state->ack_queue);
+        } else {
+            uart_flush_input(GNSS_UART_NUM);
+            app_gnss_line_reader_reset(&reader);
+        }
+
+        if (app_gnss_send_command("%s", body) != 0) {
+            break;
+        }
+
+        const int result = app_gnss_ack_wait(state, &reader, id);
+
+        if (result == APP_GNSS_ACK_OK) {
+            ESP_LOGD(LOG_TAG, "%s acknowledged", body);
+
+            state->cmd_acked++;
+            ret = 0;
+            goto clear_pending_exit;
+        }
+
+        if (result == APP_GNSS_ACK_FAILED || result == APP_GNSS_ACK_NOT_SUPPORTED ||
+            result == APP_GNSS_ACK_PARAM_ERROR) {
+            ESP_LOGE(LOG_TAG, "GNSS module rejected %s, result %d", body, result);
+
+            state->cmd_failed++;
+            goto clear_pending_exit;
+        }
+
+        /* Timed out or busy */
+    }
+
+    ESP_LOGE(LOG_TAG, "No acknowledgement for %s after %d attempts", body, GNSS_CMD_RETRIES);
+
+    state->cmd_failed++;
+
+clear_pending_exit:
+    atomic_store(&state->ack_pending, -1);
+
+    return ret;
+}
+
+/**
+ * Wait for the final PAIR001 answer to command id. Returns its result, or -1 on timeout.
+ */
+static int app_gnss_ack_wait(app_gnss_server_state_t* state, app_gnss_line_reader_t* reader, int32_t id) {
+    const TickType_t start   = xTaskGetTickCount();
+    const TickType_t timeout = pdMS_TO_TICKS(GNSS_CMD_ACK_TIMEOUT_MS);
+
+    app_gnss_ack_t ack;
+
+    if (!atomic_load(&state->running)) {
+        while (app_gnss_line_read(reader, start, timeout)) {
+            /* "Processing" is followed by the final result */
+            if (app_gnss_ack_parse(&reader->index, &ack) && ack.id == id && ack.result != APP_GNSS_ACK_PROCESSING) {
+                return ack.result;
+            }
+        }
+
+        return -1;
+    }
+
+    for (;;) {
+        const TickType_t elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= timeout) {
+            return -1;
+        }
+
+        if (xQueueReceive(state->ack_queue, &ack, timeout - elapsed) != pdPASS) {
+            return -1;
+        }
+
+        if (ack.id == id && ack.result != APP_GNSS_ACK_PROCESSING) {
+            return ack.result;
+        }
+    }
+}
+
+static bool app_gnss_ack_parse(const nl_nmea_index_t* index, app_gnss_ack_t* ack) {
+    const char*  address;
+    const size_t address_len = nl_nmea_field(index, 0, &address);
+
+    if (address_len != 7 || memcmp(address, "PAIR001", 7) != 0) {
+        return false;
+    }
+
+    return nl_nmea_field_int(index, 1, &ack->id) == 0 && nl_nmea_field_int(index, 2, &ack->result) == 0;
+}
+
+/**
+ * Send "$<body>*<checksum>\r\n", the body being formatted from fmt without the leading '$'.
+ */
+static int app_gnss_send_command(const char* fmt, ...) {
+    char    cmd[GNSS_CMD_MAX_LEN];
+    va_list args;
+
+    va_start(args, fmt);
+    int len = vsnprintf(&cmd[1], sizeof(cmd) - 6, fmt, args);
+    va_end(args);
+
+    if (len < 0 || len >= (int)sizeof(cmd) - 6) {
+        return -1;
+    }
+
+    uint8_t checksum = 0U;
+    for (int i = 1; i <= len; i++) {
+        checksum ^= (uint8_t)cmd[i];
+    }
+
+    cmd[0] = '$';
+    len    = 1 + len + snprintf(&cmd[1 + len], 6, "*%02X\r\n", checksum);
+
+    if (uart_write_bytes(GNSS_UART_NUM, cmd, len) != len) {
+        return -2;
+    }
+
+    ESP_LOGD(LOG_TAG, "Sent command: %.*s", len - 2, cmd);
+
+    return 0;
+}
+
+static void app_gnss_line_reader_reset(app_gnss_line_reader_t* reader) {
+    reader->pos      = 0;
+    reader->len      = 0;
+    reader->line_len = 0;
+}
+
+/**
+ * Read until one sentence with a valid checksum is complete, its index is left in reader->index.
+ * Runs before the event loop starts, so the UART is read directly.
+ */
+static bool app_gnss_line_read(app_gnss_line_reader_t* reader, TickType_t start, TickType_t timeout) {
+    for (;;) {
+        while (reader->pos < reader->len) {
+            const uint8_t c = reader->buf[reader->pos++];
+
+            if (c == '$') {
+                reader->line_len = 0;
+            }
+
+            if (reader->line_len >= sizeof(reader->line)) {
+                reader->line_len = 0;
+                continue;
+            }
+
+            reader->line[reader->line_len++] = (char)c;
+
+            if (c != '\n' || reader->line[0] != '$') {
+                continue;
+            }
+
+            const size_t line_len = reader->line_len;
+
+            reader->line_len = 0;
+
+            if (nl_nmea_index_build(&reader->index, (const uint8_t*)reader->line, line_len) == 0) {
+                return true;
+            }
+        }
+
+        if (xTaskGetTickCount() - start >= timeout) {
+            return false;
+        }
+
+        const int ret = uart_read_bytes(GNSS_UART_NUM, reader->buf, sizeof(reader->buf), pdMS_TO_TICKS(20));
+
+        reader->pos = 0;
+        reader->len = (ret > 0) ? ret : 0;
+    }
+}
+
+/**
+ * Switch the host side to baud and wait for one sentence with a valid checksum.
+ */
+static bool app_gnss_baud_probe(uint32_t baud) {
+    app_gnss_line_reader_t reader;
+
+    uart_set_baudrate(GNSS_UART_NUM, baud);
+    uart_flush_input(GNSS_UART_NUM);
+
+    app_gnss_line_reader_reset(&reader);
+
+    return app_gnss_line_read(&reader, xTaskGetTickCount(), pdMS_TO_TICKS(GNSS_BAUD_PROBE_MS));
+}
+
+/**
+ * Find the rate the module currently talks at, then ask it to move to the configured target with PAIR864.
+ * If the module does not come back at the target rate, stay at (or return to) the detected one.
+ */
+static void app_gnss_baud_negotiate(app_gnss_server_state_t* state) {
+    const size_t num_candidates = sizeof(s_app_gnss_baud_candidates) / sizeof(s_app_gnss_baud_candidates[0]);
+
+    uint32_t current = 0;
+
+    for (size_t i = 0; i < num_candidates; i++) {
+        if (i > 0 && s_app_gnss_baud_candidates[i] == GNSS_BAUD_TARGET) {
+            continue;
+        }
+
+        if (app_gnss_baud_probe(s_app_gnss_baud_candidates[i])) {
+            current = s_app_gnss_baud_candidates[i];
+            break;
+        }
+    }
+
+    if (current == 0) {
+        ESP_LOGE(LOG_TAG, "No output from GNSS module at any baud rate, assuming %d.", GNSS_BAUD_DEFAULT);
+
+        current = GNSS_BAUD_DEFAULT;
+        uart_set_baudrate(GNSS_UART_NUM, current);
+    } else {
+        ESP_LOGI(LOG_TAG, "GNSS module detected at %" PRIu32 " baud.", current);
+    }
+
+    if (current != GNSS_BAUD_TARGET) {
+        app_gnss_send_command("PAIR864,0,0,%d", GNSS_BAUD_TARGET);
+        uart_wait_tx_done(GNSS_UART_NUM, pdMS_TO_TICKS(100));
         vTaskDelay(pdMS_TO_TICKS(100));
+
+        if (app_gnss_baud_probe(GNSS_BAUD_TARGET)) {
+            ESP_LOGI(LOG_TAG, "GNSS UART switched to %d baud.", GNSS_BAUD_TARGET);
+
+            current = GNSS_BAUD_TARGET;
+        } else {
+            ESP_LOGW(LOG_TAG, "GNSS module did not switch to %d baud, staying at %" PRIu32 ".", GNSS_BAUD_TARGET,
+                     current);
+
+            uart_set_baudrate(GNSS_UART_NUM, current);
+        }
     }
 
-    ESP_LOGI(LOG_TAG, "Sent all initialization commands to GNSS module");
+    state->baud_rate = current;
+
+    uart_flush_input(GNSS_UART_NUM);
+    xQueueReset(state->uart_rx_queue);
 }
 
-static void app_gnss_reset(void) {
+/**
+ * Pulse the reset line, then wait for the module to start talking instead of sleeping a worst-case boot time.
+ * Any byte counts, the baud rate is not known yet.
+ */
+static void app_gnss_reset(app_gnss_server_state_t* state) {
+    uint8_t c;
+
     gpio_set_level(GNSS_RST_PIN, 0U);
     vTaskDelay(pdMS_TO_TICKS(100));
+    uart_flush_input(GNSS_UART_NUM);
     gpio_set_level(GNSS_RST_PIN, 1U);
-    vTaskDelay(pdMS_TO_TICKS(2000));
+
+    state->boot_reset_us     = esp_timer_get_time();
+    state->boot_first_fix_ms = 0;
+
+    if (uart_read_bytes(GNSS_UART_NUM, &c, 1, pdMS_TO_TICKS(GNSS_BOOT_TIMEOUT_MS)) != 1) {
+        ESP_LOGW(LOG_TAG, "No output from GNSS module %d ms after reset.", GNSS_BOOT_TIMEOUT_MS);
+        return;
+    }
+
+    state->boot_output_ms = (uint32_t)((esp_timer_get_time() - state->boot_reset_us) / 1000);
+
+    ESP_LOGI(LOG_TAG, "GNSS module output started %" PRIu32 " ms after reset.", state->boot_output_ms);
 }
 
+/**
+ * Timestamp the edge right here, the task may run arbitrarily later. Only the low 32 bits fit in the notification
+ * value; the task widens them back against its own clock.
+ */
 static void IRAM_ATTR app_gnss_pps_isr_handler(void* arg) {
     const app_gnss_server_state_t* state = arg;
+    const uint32_t                 now   = (uint32_t)esp_timer_get_time();
 
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
-    xTaskNotifyFromISR(state->pps_event_task, BIT0, eSetBits, &xHigherPriorityTaskWoken);
+    xTaskNotifyFromISR(state->pps_event_task, now, eSetValueWithOverwrite, &xHigherPriorityTaskWoken);
     if (xHigherPriorityTaskWoken) {
         portYIELD_FROM_ISR();
     }
 }
 
 static void app_gnss_uart_event_task(void* parameters) {
-    esp_err_t                ret;
     app_gnss_server_state_t* state = parameters;
     uart_event_t             event;
 
-    app_gnss_reset();
-    app_gnss_send_init_commands();
+    app_gnss_reset(state);
+    app_gnss_baud_negotiate(state);
+    app_gnss_send_init_commands(state);
+
+#if CONFIG_APP_GNSS_SERVER_UART_DMA
+    /* Bring-up needs the driver's RX path, switch to DMA only once the module is configured. */
+    if (app_gnss_uart_dma_start(GNSS_UART_NUM, xTaskGetCurrentTaskHandle()) == 0) {
+        state->rx_buffer_size = APP_GNSS_UART_DMA_CAPACITY;
+        app_gnss_uart_dma_loop(state);
+    }
+
+    ESP_LOGW(LOG_TAG, "GNSS UART DMA unavailable, using the interrupt-driven driver.");
+#endif
 
     for (;;) {
         if (xQueueReceive(state->uart_rx_queue, &event, portMAX_DELAY) != pdPASS) {
             continue;
         }
 
-        if (event.type != UART_DATA) {
+        if (event.type != UART_DATA && event.type != UART_PATTERN_DET && event.type != UART_BUFFER_FULL) {
             switch (event.type) {
                 case UART_FIFO_OVF: {
                     ESP_LOGE(LOG_TAG, "Hardware FIFO overflowed...");
                     uart_flush_input(GNSS_UART_NUM);
 
                     xQueueReset(state->uart_rx_queue);
+                    state->fifo_overflows++;
                     break;
                 }
 
@@ -243,126 +1171,546 @@ static void app_gnss_uart_event_task(void* parameters) {
             continue;
         }
 
-        /* Only UART data event exists from now on. */
+        /* Only events with data to drain exist from now on. */
 
         ESP_LOGD(LOG_TAG, "UART data event.");
 
-        size_t   gnss_data_size;
-        uint8_t* gnss_data_buf;
-        ret = uart_get_buffered_data_len(GNSS_UART_NUM, &gnss_data_size);
+        app_uart_rx_meter_wakeup(&state->rx_meter, app_gnss_uart_ingest(state));
 
-        if (ret != ESP_OK || gnss_data_size == 0) {
-            ESP_LOGD(LOG_TAG, "Received UART data event without data, continue...");
-            continue;
+        /* The line went idle: the receiver finished its output burst, close the epoch. */
+        if (event.timeout_flag) {
+            app_gnss_idle(state);
+        }
+    }
+}
+
+/**
+ * Drain the UART driver into the ingest ring and parse it in fixed-size chunks.
+ * The ring is statically allocated, nothing on this path touches the heap.
+ */
+static size_t app_gnss_uart_ingest(app_gnss_server_state_t* state) {
+    app_gnss_ingest_ring_t* ring  = &state->ingest_ring;
+    size_t                  total = 0;
+
+    /* The ring never holds more than a chunk, the driver buffer is where a late wakeup shows */
+    size_t backlog;
+    if (uart_get_buffered_data_len(GNSS_UART_NUM, &backlog) == ESP_OK && backlog > state->rx_backlog_max) {
+        state->rx_backlog_max = backlog;
+    }
+
+    for (;;) {
+        uint8_t* write_ptr;
+        size_t   write_len = app_gnss_ingest_ring_write_span(ring, &write_ptr);
+
+        if (write_len > 0) {
+            const int ret = uart_read_bytes(GNSS_UART_NUM, write_ptr, write_len, 0);
+            if (ret < 0) {
+                ESP_LOGE(LOG_TAG, "Failed to read from UART.");
+                write_len = 0;
+            } else {
+                write_len = ret;
+            }
+
+            app_gnss_ingest_ring_commit(ring, write_len);
+            total += write_len;
+        }
+
+        const uint8_t* read_ptr;
+        const size_t   read_len = app_gnss_ingest_ring_read_span(ring, &read_ptr);
+
+        if (read_len == 0) {
+            break;
         }
 
-        gnss_data_buf = malloc(gnss_data_size);
-        if (gnss_data_buf == NULL) {
-            ESP_LOGE(LOG_TAG, "Failed to allocate GNSS content buffer.");
+        app_gnss_parse(state, read_ptr, read_len);
+        app_gnss_ingest_ring_consume(ring, read_len);
+    }
+
+    return total;
+}
+
+#if CONFIG_APP_GNSS_SERVER_UART_DMA
+/**
+ * Chunks are parsed straight out of the DMA descriptors: no FIFO copy in an ISR and no uart_read_bytes copy.
+ * A full descriptor may have been closed by an idle line as well as by its length, the epoch is closed once nothing
+ * else arrives for longer than the next descriptor would take to fill.
+ */
+static void app_gnss_uart_dma_loop(app_gnss_server_state_t* state) {
+    bool full = false; /* The last chunk filled its descriptor */
+
+    for (;;) {
+        const uint32_t   full_ms = 2U * APP_GNSS_UART_DMA_DESC_SIZE * 10U * 1000U / state->baud_rate;
+        const TickType_t wait    = full ? pdMS_TO_TICKS(full_ms + GNSS_UART_DMA_IDLE_MS) + 1 : portMAX_DELAY;
+
+        if (ulTaskNotifyTake(pdTRUE, wait) == 0) {
+            if (full) {
+                full = false;
+                app_gnss_idle(state);
+            }
+
             continue;
         }
 
-        gnss_data_size = uart_read_bytes(GNSS_UART_NUM, gnss_data_buf, gnss_data_size, portMAX_DELAY);
-        if (gnss_data_size <= 0) {
-            ESP_LOGE(LOG_TAG, "Not enough data read from UART.");
-            goto free_buf_continue;
+        const uint8_t* data;
+        size_t         len;
+        size_t         total = 0;
+        bool           idle;
+
+        while (app_gnss_uart_dma_read(&data, &len, &idle)) {
+            total += len;
+
+            app_gnss_parse(state, data, len);
+            app_gnss_uart_dma_release();
+
+            full = !idle && len == APP_GNSS_UART_DMA_DESC_SIZE;
+
+            if (idle) {
+                app_gnss_idle(state);
+            }
         }
 
-        for (size_t i = 0; i < gnss_data_size; i++) {
-            if (input_nmea(&state->nmea_raw, gnss_data_buf[i])) {
-                ESP_LOGD(LOG_TAG, "NMEA[%c%c%c] received.", state->nmea_raw.type[0], state->nmea_raw.type[1],
-                         state->nmea_raw.type[2]);
+        app_uart_rx_meter_wakeup(&state->rx_meter, total);
 
-                app_gnss_nmea_t nmea = {
-                    .type =
-                        {
-                            state->nmea_raw.type[0],
-                            state->nmea_raw.type[1],
-                            state->nmea_raw.type[2],
-                        },
-                    .data_len = state->nmea_raw.len,
-                    .data     = state->nmea_raw.buf,
-                };
+        /* Closed descriptors drained in one wakeup, what piled up while the task was not running */
+        if (total > state->rx_backlog_max) {
+            state->rx_backlog_max = total;
+        }
 
-                app_gnss_dispatch(APP_GNSS_CB_RAW_NMEA, &nmea);
+        if (app_gnss_uart_dma_recover()) {
+            ESP_LOGE(LOG_TAG, "GNSS DMA descriptor ring overrun...");
+        }
+    }
+}
+#endif
+
+static void app_gnss_parse(app_gnss_server_state_t* state, const uint8_t* data, size_t data_len) {
+    app_gnss_recorder_feed(data, data_len);
 
-                if (strcmp(nmea.type, "GGA") == 0 && state->nmea_raw.gga.status != 0) {
-                    app_gnss_fix_t fix = {
-                        .latitude  = state->nmea_raw.gga.lat,
-                        .longitude = state->nmea_raw.gga.lon,
-                        .altitude  = state->nmea_raw.gga.msl,
+    /* Live output is still recorded during a replay, but not parsed, except for the answers to live commands */
+    if (!app_gnss_parser_input(&state->parser, APP_GNSS_PARSER_LIVE, data, data_len, false) &&
+        atomic_load(&state->ack_pending) >= 0) {
+        app_gnss_demux_input(&state->ack_demux, data, data_len);
+    }
+}
 
-                        /* TODO: Add more fields. */
-                    };
+static void app_gnss_idle(app_gnss_server_state_t* state) {
+    app_gnss_recorder_idle();
 
-                    app_gnss_dispatch(APP_GNSS_CB_FIX, &fix);
-                }
+    app_gnss_parser_input(&state->parser, APP_GNSS_PARSER_LIVE, NULL, 0, true);
+}
+
+/**
+ * Feed a recording through the parser, paced by its record timestamps. Chunks and idle marks go through the same
+ * demux and fix builder calls as live data, so consumers cannot tell the difference.
+ */
+static void app_gnss_replay_task(void* parameters) {
+    app_gnss_server_state_t* state  = parameters;
+    app_gnss_replay_t*       replay = state->replay;
+
+    const int64_t start_us = esp_timer_get_time();
+    int           ret      = 0;
+
+    while (!atomic_load(&state->replay_stop)) {
+        uint8_t flags;
+
+        ret = nl_rawlog_reader_next(&replay->reader, replay->buf, &flags);
+        if (ret < 0) {
+            break;
+        }
+
+        if (replay->speed > 0) {
+            const int64_t due  = start_us + (int64_t)(replay->reader.time_us / replay->speed);
+            const int64_t wait = due - esp_timer_get_time();
+
+            /* Notified by app_gnss_server_replay_stop() */
+            if (wait >= portTICK_PERIOD_MS * 1000) {
+                ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait / 1000));
             }
+        } else {
+            taskYIELD();
+        }
+
+        app_gnss_parser_input(&state->parser, APP_GNSS_PARSER_REPLAY, replay->buf, ret, flags & NL_RAWLOG_IDLE);
+
+        atomic_fetch_add(&state->replay_bytes, ret);
+    }
+
+    if (ret == -2) {
+        ESP_LOGE(LOG_TAG, "Replay stopped at a corrupt record.");
+    }
+
+    ESP_LOGI(LOG_TAG, "Replay finished, %" PRIu32 " records in %" PRId64 " ms.", replay->reader.records,
+             (esp_timer_get_time() - start_us) / 1000);
+
+    fclose(replay->fp);
+    free(replay);
 
-            if (nl_input_rtcm3_v2(&state->rtcm_raw, gnss_data_buf[i])) {
-                ESP_LOGD(LOG_TAG, "RTCM[%d] received", state->rtcm_raw.type);
+    xSemaphoreTake(state->parser.mutex, portMAX_DELAY);
+    state->replay      = NULL;
+    state->replay_task = NULL;
+    xSemaphoreGive(state->parser.mutex);
 
-                app_gnss_rtcm_t rtcm = {
-                    .type     = state->rtcm_raw.type,
-                    .data     = state->rtcm_raw.buf,
-                    .data_len = state->rtcm_raw.len,
-                };
+    app_gnss_parser_replay_end(&state->parser);
+
+    /* Nothing of the state is touched past this point, a new replay may start right away */
+    xSemaphoreGive(state->replay_idle);
+
+    vTaskDelete(NULL);
+}
+
+/**
+ * Each candidate frame goes to exactly one decoder, garbage between frames never reaches either of them.
+ */
+static bool app_gnss_frame_handler(void* ctx, app_gnss_frame_type_t type, const uint8_t* frame, size_t len) {
+    app_gnss_server_state_t* state   = ctx;
+    bool                     decoded = false;
+
+    switch (type) {
+        case APP_GNSS_FRAME_NMEA: {
+            decoded = app_gnss_handle_nmea(state, frame, len);
+            break;
+        }
 
-                app_gnss_dispatch(APP_GNSS_CB_RAW_RTCM, &rtcm);
+        case APP_GNSS_FRAME_RTCM3: {
+            decoded = app_gnss_handle_rtcm(state, frame, len);
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    return decoded;
+}
+
+/**
+ * Only the comma index and checksum are computed here, fields are decoded on demand by whoever reads them.
+ */
+static bool app_gnss_handle_nmea(app_gnss_server_state_t* state, const uint8_t* frame, size_t len) {
+    nl_nmea_index_t index;
+
+    if (nl_nmea_index_build(&index, frame, len) != 0) {
+        ESP_LOGD(LOG_TAG, "Invalid NMEA sentence, len: %d", len);
+        return false;
+    }
+
+    if (app_gnss_subscribed(APP_GNSS_CB_RAW_NMEA)) {
+        const char*  address;
+        const size_t address_len = nl_nmea_field(&index, 0, &address);
+
+        app_gnss_nmea_t nmea = {
+            .type     = {0},
+            .data_len = len,
+            .data     = (uint8_t*)frame,
+            .index    = &index,
+        };
+
+        /* Talker (or 'P' + manufacturer) followed by the formatter */
+        if (address_len >= 5) {
+            memcpy(nmea.type, &address[2], sizeof(nmea.type));
+        }
+
+        ESP_LOGD(LOG_TAG, "NMEA[%.3s] received.", nmea.type);
+
+        app_gnss_dispatch(APP_GNSS_CB_RAW_NMEA, &nmea);
+    }
+
+    if (app_gnss_subscribed(APP_GNSS_CB_FIX | APP_GNSS_CB_SAT)) {
+        app_gnss_fix_builder_feed(&state->parser.fix_builder, &index, app_gnss_subscribed(APP_GNSS_CB_SAT));
+    }
+
+    /* A recorded answer belongs to a command of another session, live ones come through the ack demux meanwhile */
+    if (!app_gnss_parser_replaying(&state->parser)) {
+        app_gnss_ack_forward(state, &index);
+    }
+
+    if (state->boot_first_fix_ms == 0 && nl_nmea_is(&index, "GGA")) {
+        int32_t quality;
+
+        if (nl_nmea_field_int(&index, 6, &quality) == 0 && quality > 0) {
+            state->boot_first_fix_ms = (uint32_t)((esp_timer_get_time() - state->boot_reset_us) / 1000);
+
+            ESP_LOGI(LOG_TAG, "First fix message %" PRIu32 " ms after reset.", state->boot_first_fix_ms);
+        }
+    }
+
+    if (nl_nmea_is(&index, "RMC")) {
+        app_gnss_utc_snapshot_t utc;
+
+        utc.rx_us = esp_timer_get_time();
+        utc.valid = nl_nmea_field_time(&index, 1, &utc.time) == 0 && nl_nmea_field_date(&index, 9, &utc.date) == 0;
+
+        app_gnss_utc_publish(state, &utc);
+    }
+
+    return true;
+}
+
+/**
+ * Frames of the live output while a replay owns the parser. RTCM3 frames are rejected unchecked, so a false lock
+ * cannot swallow an answer.
+ */
+static bool app_gnss_ack_frame_handler(void* ctx, app_gnss_frame_type_t type, const uint8_t* frame, size_t len) {
+    app_gnss_server_state_t* state = ctx;
+    nl_nmea_index_t          index;
+
+    if (type != APP_GNSS_FRAME_NMEA || nl_nmea_index_build(&index, frame, len) != 0) {
+        return false;
+    }
+
+    app_gnss_ack_forward(state, &index);
+
+    return true;
+}
+
+static void app_gnss_ack_forward(app_gnss_server_state_t* state, const nl_nmea_index_t* index) {
+    app_gnss_ack_t ack;
+
+    if (atomic_load(&state->ack_pending) >= 0 && app_gnss_ack_parse(index, &ack)) {
+        xQueueSend(state->ack_queue, &ack, 0);
+    }
+}
+
+/**
+ * The frame is already delimited by the demultiplexer, only the CRC is left to check.
+ */
+static bool app_gnss_handle_rtcm(app_gnss_server_state_t* state, const uint8_t* frame, size_t len) {
+    const uint32_t crc = ((uint32_t)frame[len - 3] << 16U) | ((uint32_t)frame[len - 2] << 8U) | frame[len - 1];
+
+    if (nl_crc24q(frame, len - 3) != crc) {
+        ESP_LOGD(LOG_TAG, "RTCM CRC mismatch, len: %d", len);
+        return false;
+    }
+
+    if (!app_gnss_subscribed(APP_GNSS_CB_RAW_RTCM | APP_GNSS_CB_OBS)) {
+        return true;
+    }
+
+    /* Message number takes the first 12 bits of the payload */
+    const uint16_t type = (len >= 8) ? (((uint16_t)frame[3] << 4U) | (frame[4] >> 4U)) : 0U;
+
+    ESP_LOGD(LOG_TAG, "RTCM[%d] received", type);
+
+    /* Onboard station messages take the place of the module's */
+    if (state->station_len > 0 && (type == 1005 || type == 1006 || type == 1033)) {
+        state->station_dropped++;
+        return true;
+    }
+
+    if (app_gnss_subscribed(APP_GNSS_CB_RAW_RTCM)) {
+        app_gnss_rtcm_t rtcm = {
+            .type     = type,
+            .data     = (uint8_t*)frame,
+            .data_len = len,
+        };
+
+        app_gnss_dispatch(APP_GNSS_CB_RAW_RTCM, &rtcm);
+    }
+
+    const uint8_t msm_type = nl_msm_type(type);
+    if ((msm_type == 4 || msm_type == 7) && app_gnss_subscribed(APP_GNSS_CB_OBS)) {
+        if (state->obs_decoder == NULL) {
+            app_gnss_obs_decoder_t* decoder = malloc(sizeof(app_gnss_obs_decoder_t));
+            if (decoder == NULL) {
+                ESP_LOGE(LOG_TAG, "Failed to allocate MSM observation decoder.");
+                return true;
             }
+
+            app_gnss_obs_decoder_init(decoder);
+            state->obs_decoder = decoder;
         }
 
-        /* Dispatch */
-        app_gnss_dispatch(APP_GNSS_CB_SAT, NULL);
+        const app_gnss_obs_t* obs = app_gnss_obs_decoder_feed(state->obs_decoder, frame, len, esp_timer_get_time());
+        if (obs != NULL) {
+            app_gnss_dispatch(APP_GNSS_CB_OBS, (void*)obs);
+        }
+    }
+
+    /* Multiple message bit (DF393) clear: the last MSM of the epoch, the gap before the next one starts here */
+    if (msm_type != 0 && len >= 13 && (frame[9] & 0x02U) == 0U) {
+        app_gnss_station_inject(state);
+    }
+
+    return true;
+}
+
+/**
+ * Runs under the parser mutex, in order with the module's frames, so consumers see the station messages between epochs
+ * like those of any other base.
+ */
+static void app_gnss_station_inject(app_gnss_server_state_t* state) {
+    if (state->station_len == 0) {
+        return;
+    }
+
+    const int64_t now = esp_timer_get_time();
+    if (state->station_sent_us != 0 && now - state->station_sent_us < (int64_t)state->station_interval_ms * 1000) {
+        return;
+    }
+
+    state->station_sent_us = now;
+
+    if (!app_gnss_subscribed(APP_GNSS_CB_RAW_RTCM)) {
+        return;
+    }
+
+    for (size_t pos = 0; pos < state->station_len;) {
+        uint8_t*     frame = &state->station_frames[pos];
+        const size_t len   = (((size_t)(frame[1] & 0x03U) << 8U) | frame[2]) + 6U;
+
+        app_gnss_rtcm_t rtcm = {
+            .type     = ((uint16_t)frame[3] << 4U) | (frame[4] >> 4U),
+            .data     = frame,
+            .data_len = len,
+        };
+
+        app_gnss_dispatch(APP_GNSS_CB_RAW_RTCM, &rtcm);
+
+        state->station_injected++;
+        pos += len;
+    }
+}
+
+static void app_gnss_epoch_handler(void* ctx, const app_gnss_fix_t* fix, const app_gnss_sat_t* sat) {
+    if ((fix->flags & APP_GNSS_FIX_HAS_POSITION) && app_gnss_subscribed(APP_GNSS_CB_FIX)) {
+        app_gnss_dispatch(APP_GNSS_CB_FIX, (void*)fix);
+    }
 
-    free_buf_continue:
-        free(gnss_data_buf);
+    if (sat != NULL && app_gnss_subscribed(APP_GNSS_CB_SAT)) {
+        app_gnss_dispatch(APP_GNSS_CB_SAT, (void*)sat);
     }
 }
 
 static void app_gnss_pps_event_task(void* parameters) {
-    uint32_t notify_value;
+    app_gnss_server_state_t* state = parameters;
+    uint32_t                 edge_low;
+
     for (;;) {
-        if (xTaskNotifyWait(0UL, 0xFFFFFFFFUL, &notify_value, portMAX_DELAY) != pdPASS) {
+        if (xTaskNotifyWait(0UL, 0xFFFFFFFFUL, &edge_low, portMAX_DELAY) != pdPASS) {
             continue;
         }
 
+        const int64_t now  = esp_timer_get_time();
+        const int64_t edge = now - (uint32_t)((uint32_t)now - edge_low);
+
         ESP_LOGD(LOG_TAG, "GNSS PPS event.");
 
-        app_gnss_pps_t pps;
+        app_gnss_pps_t pps = {
+            .time_valid   = false,
+            .timestamp_us = edge,
+            .interval_us  = (state->pps_sequence > 0) ? edge - state->pps_last_us : 0,
+            .latency_us   = (uint32_t)(now - edge),
+            .sequence     = state->pps_sequence,
+        };
+
+        state->pps_last_us = edge;
+        state->pps_sequence++;
+
+        if (!app_gnss_subscribed(APP_GNSS_CB_PPS)) {
+            continue;
+        }
 
-        pps.gps_year   = (uint16_t)s_app_gnss_server_state.nmea_raw.rmc.year;
-        pps.gps_month  = (uint16_t)s_app_gnss_server_state.nmea_raw.rmc.mouth;
-        pps.gps_day    = (uint16_t)s_app_gnss_server_state.nmea_raw.rmc.day;
-        pps.gps_hour   = (uint16_t)s_app_gnss_server_state.nmea_raw.rmc.hour;
-        pps.gps_minute = (uint16_t)s_app_gnss_server_state.nmea_raw.rmc.min;
-        pps.gps_second = (uint16_t)s_app_gnss_server_state.nmea_raw.rmc.sec;
+        /*
+         * The edge marks the start of a UTC second and the navigation message describing it is only output after
+         * the edge, so the latest RMC labels the previous second.
+         */
+        app_gnss_utc_snapshot_t utc;
+        app_gnss_utc_read(state, &utc);
+
+        if (utc.valid && edge > utc.rx_us && edge - utc.rx_us < 1000000) {
+            app_gnss_utc_next_second(&utc.date, &utc.time);
+
+            pps.gps_year   = utc.date.year;
+            pps.gps_month  = utc.date.month;
+            pps.gps_day    = utc.date.day;
+            pps.gps_hour   = utc.time.hour;
+            pps.gps_minute = utc.time.minute;
+            pps.gps_second = utc.time.second;
+            pps.time_valid = true;
+        }
 
         app_gnss_dispatch(APP_GNSS_CB_PPS, &pps);
     }
 }
 
-static void app_gnss_dispatch(app_gnss_cb_type_t type, void* data) {
-    if (xSemaphoreTake(s_app_gnss_server_state.consumer_mutex, portMAX_DELAY) != pdPASS) {
+/* Single writer: the UART task. */
+static void app_gnss_utc_publish(app_gnss_server_state_t* state, const app_gnss_utc_snapshot_t* utc) {
+    const unsigned int seq = atomic_load_explicit(&state->utc_seq, memory_order_relaxed);
+
+    atomic_store_explicit(&state->utc_seq, seq + 1U, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    state->utc = *utc;
+
+    atomic_store_explicit(&state->utc_seq, seq + 2U, memory_order_release);
+}
+
+static void app_gnss_utc_read(app_gnss_server_state_t* state, app_gnss_utc_snapshot_t* utc) {
+    unsigned int begin;
+    unsigned int end;
+
+    do {
+        begin = atomic_load_explicit(&state->utc_seq, memory_order_acquire);
+        if (begin & 1U) {
+            continue;
+        }
+
+        *utc = state->utc;
+
+        atomic_thread_fence(memory_order_acquire);
+        end = atomic_load_explicit(&state->utc_seq, memory_order_relaxed);
+    } while ((begin & 1U) || begin != end);
+}
+
+static void app_gnss_utc_next_second(nl_nmea_date_t* date, nl_nmea_time_t* time) {
+    static const uint8_t days_in_month[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+    time->millisecond = 0;
+
+    if (++time->second < 60) {
         return;
     }
 
-    ListItem_t*       item = listGET_HEAD_ENTRY(&s_app_gnss_server_state.consumer_list);
-    const ListItem_t* end  = listGET_END_MARKER(&s_app_gnss_server_state.consumer_list);
+    time->second = 0;
 
-    while (item != NULL) {
-        if (item == end) {
-            break;
-        }
+    if (++time->minute < 60) {
+        return;
+    }
 
-        app_gnss_consumer_t* consumer = (app_gnss_consumer_t*)item->xItemValue;
+    time->minute = 0;
 
-        if (consumer->type & type) {
-            consumer->cb(consumer->user_data, type, data);
-        }
+    if (++time->hour < 24) {
+        return;
+    }
+
+    time->hour = 0;
 
-        item = listGET_NEXT(item);
+    const bool leap = (date->year % 4 == 0 && date->year % 100 != 0) || date->year % 400 == 0;
+
+    uint8_t days = days_in_month[(date->month - 1) % 12];
+    if (date->month == 2 && leap) {
+        days++;
+    }
+
+    if (++date->day <= days) {
+        return;
+    }
+
+    date->day = 1;
+
+    if (++date->month <= 12) {
+        return;
     }
 
-    xSemaphoreGive(s_app_gnss_server_state.consumer_mutex);
-}
\ No newline at end of file
+    date->month = 1;
+
+    date->year++;
+}
+
+static bool app_gnss_subscribed(app_gnss_cb_type_t type) {
+    return app_gnss_dispatcher_subscribed(&s_app_gnss_server_state.dispatcher, type);
+}
+
+static void app_gnss_dispatch(app_gnss_cb_type_t type, void* data) {
+    app_gnss_dispatcher_dispatch(&s_app_gnss_server_state.dispatcher, type, data);
+}
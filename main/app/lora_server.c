@@ -6,6 +6,7 @@
 #include "driver/uart.h"
 #include "esp_event.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/list.h"
 #include "freertos/queue.h"
 #include "freertos/task.h"
@@ -14,7 +15,11 @@
 /* LLCC68 */
 #include "lora_modem.h"
 
+/* nl */
+#include "rcv/nl_msm.h"
+
 /* App */
+#include "app/gnss/rtcm_scheduler.h"
 #include "app/gnss_server.h"
 #include "app/lora_server.h"
 
@@ -39,6 +44,8 @@
 
 #define APP_LORA_SERVER_POWER_DEFAULT (7) /* 7dBm */
 
+#define APP_LORA_SERVER_MSM_SYSTEMS (7) /* GPS, GLONASS, Galileo, SBAS, QZSS, BeiDou, NavIC: 107x-113x */
+
 typedef struct {
     uint8_t *data;
     size_t   data_len;
@@ -57,11 +64,24 @@ typedef struct {
 
     uint8_t *rtcm_buffer;
     size_t   rtcm_buffer_size;
+
+    app_gnss_rtcm_sched_t rtcm_sched;
+
+#if CONFIG_APP_LORA_SERVER_RTCM_TRANSCODE
+    nl_msm_t                    msm;
+    uint8_t                     msm_frame[NL_MSM_MAX_FRAME];
+    uint64_t                    msm_sat_low[APP_LORA_SERVER_MSM_SYSTEMS]; /* Satellites below the elevation mask */
+    app_lora_server_msm_stats_t msm_stats;
+#endif
 } app_lora_server_state_t;
 
 static const char *LOG_TAG = "asuna_lora";
 
 static int  app_lora_server_gnss_forwarder_cb(void *handle, app_gnss_cb_type_t type, void *payload);
+#if CONFIG_APP_LORA_SERVER_RTCM_TRANSCODE
+static void app_lora_server_msm_elevation_update(app_lora_server_state_t *state, const app_gnss_sat_t *sat);
+static void app_lora_server_msm_transcode(app_lora_server_state_t *state, const uint8_t **frame, size_t *len);
+#endif
 static void app_lora_server_gpio_init(void);
 static int  app_lora_server_spi_init(void);
 static int  app_lora_modem_ops_spi(void *handle, const lora_modem_spi_transfer_t *transfer);
@@ -98,6 +118,22 @@ static app_lora_server_state_t s_lora_server_state = {
     .rtcm_buffer_size = 0,
 };
 
+/* Station metadata changes rarely, rovers only need it once in a while. MSM observations are never thinned. */
+static const app_gnss_rtcm_sched_rule_t s_app_lora_server_rtcm_rules[] = {
+    {.type = 1005, .min_interval_ms = 10000}, /* Station ARP */
+    {.type = 1006, .min_interval_ms = 10000}, /* Station ARP with height */
+    {.type = 1033, .min_interval_ms = 30000}, /* Receiver and antenna descriptors */
+    {.type = 1230, .min_interval_ms = 10000}, /* GLONASS code-phase biases */
+    {.type = 1074, .always = true},
+    {.type = 1077, .always = true},
+    {.type = 1084, .always = true},
+    {.type = 1087, .always = true},
+    {.type = 1094, .always = true},
+    {.type = 1097, .always = true},
+    {.type = 1124, .always = true},
+    {.type = 1127, .always = true},
+};
+
 static const char *APP_LORA_SERVER_CFG_KEY_FLAG    = "cfg_valid"; /* Configuration key */
 static const char *APP_LORA_SERVER_CFG_KEY_FW_RTCM = "fw_rtcm";   /* Forward RTCM payload */
 static const char *APP_LORA_SERVER_CFG_KEY_FREQ    = "freq";      /* Frequency */
@@ -146,6 +182,12 @@ int app_lora_server_init(void) {
         goto del_queue_exit;
     }
 
+    app_gnss_rtcm_sched_init(&s_lora_server_state.rtcm_sched);
+
+    for (size_t i = 0; i < sizeof(s_app_lora_server_rtcm_rules) / sizeof(s_app_lora_server_rtcm_rules[0]); i++) {
+        app_gnss_rtcm_sched_rule_set(&s_lora_server_state.rtcm_sched, &s_app_lora_server_rtcm_rules[i]);
+    }
+
     app_lora_server_config_t cfg;
 
     if (app_lora_server_config_get(&cfg) != 0) {
@@ -233,8 +275,21 @@ int app_lora_server_config_set(const app_lora_server_config_t *config) {
 
     if (config->fw_rtcm) {
         if (s_lora_server_state.gnss_cb_handle == NULL) {
-            s_lora_server_state.gnss_cb_handle = app_gnss_server_cb_register(
-                APP_GNSS_CB_RAW_RTCM, app_lora_server_gnss_forwarder_cb, &s_lora_server_state);
+            app_gnss_async_config_t async_config = APP_GNSS_ASYNC_CONFIG_DEFAULT();
+
+            /* Keep the freshest corrections when the radio falls behind. */
+            async_config.queue_size = 8192;
+            async_config.policy     = APP_GNSS_ASYNC_DROP_OLDEST;
+            async_config.task_name  = "asuna_lrfw";
+
+            app_gnss_cb_type_t cb_type = APP_GNSS_CB_RAW_RTCM;
+#if CONFIG_APP_LORA_SERVER_RTCM_TRANSCODE
+            /* Elevations for the MSM elevation mask */
+            cb_type |= APP_GNSS_CB_SAT;
+#endif
+
+            s_lora_server_state.gnss_cb_handle = app_gnss_server_cb_register_async(
+                cb_type, app_lora_server_gnss_forwarder_cb, &s_lora_server_state, &async_config);
         }
     } else {
         if (s_lora_server_state.gnss_cb_handle != NULL) {
@@ -324,6 +379,20 @@ release_lock_exit:
     return ret;
 }
 
+size_t app_lora_server_rtcm_stats_get(app_gnss_rtcm_sched_stats_t *stats, size_t max) {
+    return app_gnss_rtcm_sched_stats_get(&s_lora_server_state.rtcm_sched, stats, max);
+}
+
+int app_lora_server_msm_stats_get(app_lora_server_msm_stats_t *stats) {
+#if CONFIG_APP_LORA_SERVER_RTCM_TRANSCODE
+    *stats = s_lora_server_state.msm_stats;
+
+    return 0;
+#else
+    return -1;
+#endif
+}
+
 int app_lora_server_broadcast(const uint8_t *data, size_t length) {
     void *payload = malloc(length);
     if (payload == NULL) {
@@ -355,10 +424,30 @@ free_buf_exit:
 static int app_lora_server_gnss_forwarder_cb(void *handle, app_gnss_cb_type_t type, void *payload) {
     app_lora_server_state_t *state = handle;
 
+#if CONFIG_APP_LORA_SERVER_RTCM_TRANSCODE
+    if (type == APP_GNSS_CB_SAT) {
+        app_lora_server_msm_elevation_update(state, payload);
+    }
+#endif
+
     if (type == APP_GNSS_CB_RAW_RTCM) {
         const app_gnss_rtcm_t *data = payload;
 
-        uint8_t *new_buffer = realloc(state->rtcm_buffer, (state->rtcm_buffer_size + data->data_len));
+        if (!app_gnss_rtcm_sched_admit(&state->rtcm_sched, data, esp_timer_get_time())) {
+            return 0;
+        }
+
+        const uint8_t *frame     = data->data;
+        size_t         frame_len = data->data_len;
+
+#if CONFIG_APP_LORA_SERVER_RTCM_TRANSCODE
+        const uint8_t msm_type = nl_msm_type(data->type);
+        if (msm_type == 4 || msm_type == 7) {
+            app_lora_server_msm_transcode(state, &frame, &frame_len);
+        }
+#endif
+
+        uint8_t *new_buffer = realloc(state->rtcm_buffer, (state->rtcm_buffer_size + frame_len));
         if (new_buffer == NULL) {
             ESP_LOGE(LOG_TAG, "Failed to allocate buffer for RTCM payload.");
             free(state->rtcm_buffer);
@@ -368,9 +457,9 @@ static int app_lora_server_gnss_forwarder_cb(void *handle, app_gnss_cb_type_t ty
 
         state->rtcm_buffer = new_buffer;
 
-        memcpy(&state->rtcm_buffer[state->rtcm_buffer_size], data->data, data->data_len);
+        memcpy(&state->rtcm_buffer[state->rtcm_buffer_size], frame, frame_len);
 
-        state->rtcm_buffer_size += data->data_len;
+        state->rtcm_buffer_size += frame_len;
 
         if (state->rtcm_buffer_size >= 256) {
             app_lora_server_broadcast(state->rtcm_buffer, state->rtcm_buffer_size);
@@ -385,6 +474,118 @@ static int app_lora_server_gnss_forwarder_cb(void *handle, app_gnss_cb_type_t ty
     return 0;
 }
 
+#if CONFIG_APP_LORA_SERVER_RTCM_TRANSCODE
+/**
+ * NMEA satellite numbers to MSM satellite IDs, per MSM system index. Returns false for satellites MSM cannot carry.
+ */
+static bool app_lora_server_msm_sat_id(const app_gnss_sat_info_t *info, uint8_t *system, uint8_t *id) {
+    uint16_t prn = info->prn;
+
+    switch (info->constellation) {
+        case APP_GNSS_CONSTELLATION_GPS:
+            *system = 0;
+            break;
+
+        case APP_GNSS_CONSTELLATION_GLONASS:
+            *system = 1;
+            prn     = (prn > 64) ? prn - 64 : prn;
+            break;
+
+        case APP_GNSS_CONSTELLATION_GALILEO:
+            *system = 2;
+            prn     = (prn > 300) ? prn - 300 : prn;
+            break;
+
+        case APP_GNSS_CONSTELLATION_QZSS:
+            *system = 4;
+            prn     = (prn > 192) ? prn - 192 : prn;
+            break;
+
+        case APP_GNSS_CONSTELLATION_BEIDOU:
+            *system = 5;
+            prn     = (prn > 400) ? prn - 400 : prn;
+            break;
+
+        case APP_GNSS_CONSTELLATION_NAVIC:
+            *system = 6;
+            break;
+
+        default:
+            return false;
+    }
+
+    if (prn == 0 || prn > 64) {
+        return false;
+    }
+
+    *id = prn;
+
+    return true;
+}
+
+static void app_lora_server_msm_elevation_update(app_lora_server_state_t *state, const app_gnss_sat_t *sat) {
+    uint64_t low[APP_LORA_SERVER_MSM_SYSTEMS] = {0};
+
+    for (uint8_t i = 0; i < sat->count; i++) {
+        const app_gnss_sat_info_t *info = &sat->sats[i];
+
+        uint8_t system;
+        uint8_t id;
+
+        /* Unknown elevation is reported as -128 and keeps the satellite */
+        if (info->elevation == -128 || info->elevation >= CONFIG_APP_LORA_SERVER_RTCM_ELEVATION_MASK) {
+            continue;
+        }
+
+        if (app_lora_server_msm_sat_id(info, &system, &id)) {
+            low[system] |= 1ULL << (id - 1U);
+        }
+    }
+
+    memcpy(state->msm_sat_low, low, sizeof(low));
+}
+
+/**
+ * Re-encode one MSM frame in place of the original. On any decode error the original frame is forwarded untouched.
+ */
+static void app_lora_server_msm_transcode(app_lora_server_state_t *state, const uint8_t **frame, size_t *len) {
+    nl_msm_t *msm = &state->msm;
+
+    state->msm_stats.in_bytes += *len;
+
+    if (nl_msm_decode(msm, *frame, *len) != 0) {
+        state->msm_stats.passthrough++;
+        state->msm_stats.out_bytes += *len;
+
+        return;
+    }
+
+    const uint8_t system = (msm->type - 1070U) / 10U;
+
+    nl_msm_prune(msm, ~state->msm_sat_low[system], CONFIG_APP_LORA_SERVER_RTCM_SIGNAL_MASK);
+
+    /* CONFIG_APP_LORA_SERVER_RTCM_MSM is 0 when the type is left unchanged */
+    uint8_t out_type = msm->msm_type;
+    if (CONFIG_APP_LORA_SERVER_RTCM_MSM != 0) {
+        out_type = (msm->msm_type == 7) ? CONFIG_APP_LORA_SERVER_RTCM_MSM : 4;
+    }
+
+    const int ret = nl_msm_encode(msm, out_type, state->msm_frame, sizeof(state->msm_frame));
+    if (ret < 0) {
+        state->msm_stats.passthrough++;
+        state->msm_stats.out_bytes += *len;
+
+        return;
+    }
+
+    *frame = state->msm_frame;
+    *len   = ret;
+
+    state->msm_stats.transcoded++;
+    state->msm_stats.out_bytes += ret;
+}
+#endif
+
 static void app_lora_server_gpio_init(void) {
     gpio_config_t pin_cfg = {
         .pin_bit_mask = BIT64(APP_LORA_SERVER_PIN_CS) | BIT64(APP_LORA_SERVER_PIN_RST),
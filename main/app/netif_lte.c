@@ -16,12 +16,14 @@
 
 /* App */
 #include "app/netif_lte.h"
+#include "app/uart_rx.h"
 
-#define LTE_UART_NUM      UART_NUM_1
-#define LTE_UART_BUF_SIZE (1024)
-#define LTE_RST_PIN       CONFIG_APP_NETIF_LTE_RST_GPIO
-#define LTE_TX_PIN        CONFIG_APP_NETIF_LTE_TX_GPIO
-#define LTE_RX_PIN        CONFIG_APP_NETIF_LTE_RX_GPIO
+#define LTE_UART_NUM       UART_NUM_1
+#define LTE_UART_BUF_SIZE  (1024)
+#define LTE_UART_QUEUE_LEN (8)
+#define LTE_RST_PIN        CONFIG_APP_NETIF_LTE_RST_GPIO
+#define LTE_TX_PIN         CONFIG_APP_NETIF_LTE_TX_GPIO
+#define LTE_RX_PIN         CONFIG_APP_NETIF_LTE_RX_GPIO
 
 static const char* LOG_TAG = "asuna_lte";
 
@@ -34,6 +36,7 @@ typedef struct {
 } app_netif_lte_ctx_t;
 
 static CellularCommInterface_t s_cellular_comm_interface;
+static app_uart_rx_meter_t     s_app_netif_lte_rx_meter;
 
 static void                         app_netif_lte_pin_init(void);
 static void                         app_netif_lte_reset(void);
@@ -119,7 +122,9 @@ static void app_netif_lte_comm_task(void* arguments) {
         if (xQueueReceive(ctx->uart_rx_queue, &event, portMAX_DELAY) == pdPASS) {
             switch (event.type) {
                 case UART_DATA:
+                case UART_PATTERN_DET:
                     ESP_LOGD(LOG_TAG, "Received UART_DATA event.");
+                    app_uart_rx_meter_wakeup(&s_app_netif_lte_rx_meter, event.size);
                     ctx->recv_callback(ctx->user_data, (CellularCommInterfaceHandle_t)ctx);
                     break;
                 case UART_FIFO_OVF:
@@ -162,10 +167,25 @@ static CellularCommInterfaceError_t app_netif_lte_comm_open(CellularCommInterfac
     ctx->recv_callback = receiveCallback;
     ctx->user_data     = pUserData;
 
-    uart_driver_install(LTE_UART_NUM, LTE_UART_BUF_SIZE, LTE_UART_BUF_SIZE, 8, &ctx->uart_rx_queue, 0);
+    const app_uart_rx_config_t rx_config = {
+        .rx_full_threshold = CONFIG_APP_NETIF_LTE_RX_FULL_THRESH,
+        .rx_timeout        = CONFIG_APP_NETIF_LTE_RX_TIMEOUT,
+#if CONFIG_APP_NETIF_LTE_RX_PATTERN_LF
+        .pattern_chr = '\n',
+#else
+        .pattern_chr = 0,
+#endif
+        .queue_size = LTE_UART_QUEUE_LEN,
+    };
+
+    uart_driver_install(LTE_UART_NUM, LTE_UART_BUF_SIZE, LTE_UART_BUF_SIZE, LTE_UART_QUEUE_LEN, &ctx->uart_rx_queue,
+                        0);
     uart_param_config(LTE_UART_NUM, &uart_config);
     uart_set_pin(LTE_UART_NUM, LTE_TX_PIN, LTE_RX_PIN, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
 
+    app_uart_rx_config_apply(LTE_UART_NUM, &rx_config);
+    app_uart_rx_meter_init(&s_app_netif_lte_rx_meter);
+
     if (xTaskCreate(app_netif_lte_comm_task, "asuna_lte_comm", 2048, ctx, 3, &ctx->uart_rx_task) != pdPASS) {
         ESP_LOGE(LOG_TAG, "Failed to create LTE comm RX task");
 
@@ -243,3 +263,9 @@ static CellularCommInterfaceError_t app_netif_lte_comm_close(CellularCommInterfa
 
     return IOT_COMM_INTERFACE_SUCCESS;
 }
+
+int app_netif_lte_rx_stats_get(app_uart_rx_stats_t* stats) {
+    app_uart_rx_meter_get(&s_app_netif_lte_rx_meter, stats);
+
+    return 0;
+}
@@ -0,0 +1,369 @@
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/* IDF */
+#include "esp_log.h"
+#include "fcntl.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+
+/* nl */
+#include "rcv/nl_nmea_index.h"
+
+/* App */
+#include "app/fanout_server.h"
+#include "app/gnss_server.h"
+#include "app/nmea_server.h"
+
+#if CONFIG_APP_NMEA_SERVER
+
+#define APP_NMEA_SERVER_BATCH_MAX    (2048) /* One epoch of sentences, a larger one is sent in pieces */
+#define APP_NMEA_SERVER_DATAGRAM_MAX (1472) /* UDP payload of an unfragmented Ethernet frame */
+#define APP_NMEA_SERVER_SELECT_MS    (1000)
+#define APP_NMEA_SERVER_IDLE_MS      (100) /* A batch that stops growing for this long is sent as it is */
+
+typedef struct {
+    app_fanout_server_t  server; /* Its mutex guards the epoch batch and the stats as well */
+    app_gnss_cb_handle_t gnss_cb_handle;
+
+    int udp_fd; /* -1 without UDP output */
+
+    struct sockaddr_in udp_addr;
+
+    /* Epoch batch, filled by the GNSS callback task, sent by it or by the server task once idle */
+    uint8_t        batch[APP_NMEA_SERVER_BATCH_MAX];
+    size_t         batch_len;
+    TickType_t     batch_tick;  /* Last sentence added */
+    bool           batch_timed; /* batch_time is known */
+    nl_nmea_time_t batch_time;
+
+    /* Contiguous copy of pending data wrapped around the end of the ring, server task only */
+    uint8_t scratch[APP_NMEA_SERVER_BATCH_MAX];
+
+    uint32_t epochs;    /* Stats kept besides the server's */
+    uint32_t datagrams;
+} app_nmea_server_state_t;
+
+static const char *LOG_TAG = "asuna_nmea";
+
+static app_nmea_server_state_t s_app_nmea_server_state;
+
+static int  app_nmea_server_gnss_cb(void *handle, app_gnss_cb_type_t type, void *payload);
+static bool app_nmea_server_time_equal(const nl_nmea_time_t *a, const nl_nmea_time_t *b);
+static void app_nmea_server_batch_flush(app_nmea_server_state_t *state);
+static void app_nmea_server_batch_idle(app_fanout_server_t *server, struct timeval *timeout);
+static void app_nmea_server_udp_send(app_nmea_server_state_t *state, const uint8_t *data, size_t len);
+static int  app_nmea_server_flush(app_fanout_server_t *server, size_t index);
+
+int app_nmea_server_init(void) {
+    app_nmea_server_state_t *state = &s_app_nmea_server_state;
+
+    /* ---- UDP output, broadcast or multicast ---- */
+    state->udp_fd = -1;
+
+#if CONFIG_APP_NMEA_SERVER_UDP
+    state->udp_addr.sin_family = AF_INET;
+    state->udp_addr.sin_port   = htons(CONFIG_APP_NMEA_SERVER_UDP_PORT);
+
+    if (inet_aton(CONFIG_APP_NMEA_SERVER_UDP_ADDRESS, &state->udp_addr.sin_addr) == 0) {
+        ESP_LOGE(LOG_TAG, "Invalid UDP address: %s", CONFIG_APP_NMEA_SERVER_UDP_ADDRESS);
+        return -1;
+    }
+
+    state->udp_fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (state->udp_fd < 0) {
+        ESP_LOGE(LOG_TAG, "Failed to create UDP socket.");
+        return -1;
+    }
+
+    const int     broadcast = 1;
+    const uint8_t ttl       = 1; /* Multicast stays on the local network */
+    setsockopt(state->udp_fd, SOL_SOCKET, SO_BROADCAST, &broadcast, sizeof(broadcast));
+    setsockopt(state->udp_fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+    fcntl(state->udp_fd, F_SETFL, O_NONBLOCK);
+#endif
+
+    /* ---- TCP output ---- */
+    const app_fanout_server_config_t server_config = {
+        .log_tag     = LOG_TAG,
+        .task_name   = "asuna_nmea_srv",
+        .task_stack  = 3072,
+        .port        = CONFIG_APP_NMEA_SERVER_PORT,
+        .max_clients = CONFIG_APP_NMEA_SERVER_MAX_CLIENTS,
+        .buffer_size = CONFIG_APP_NMEA_SERVER_BUFFER_SIZE,
+        .window      = CONFIG_APP_NMEA_SERVER_CLIENT_WINDOW,
+        .select_ms   = APP_NMEA_SERVER_SELECT_MS,
+        .ctx         = state,
+        .poll        = app_nmea_server_batch_idle,
+        .flush       = app_nmea_server_flush,
+    };
+
+    if (app_fanout_server_init(&state->server, &server_config) != 0) {
+        goto close_udp_exit;
+    }
+
+    /* ---- Feed, fixes mark the end of each epoch in the same queue as the sentences ---- */
+    app_gnss_async_config_t async_config = APP_GNSS_ASYNC_CONFIG_DEFAULT();
+
+    async_config.queue_size = 8192;
+    async_config.task_name  = "asuna_nmea_cb";
+
+    state->gnss_cb_handle = app_gnss_server_cb_register_async(APP_GNSS_CB_RAW_NMEA | APP_GNSS_CB_FIX,
+                                                              app_nmea_server_gnss_cb, state, &async_config);
+    if (state->gnss_cb_handle == NULL) {
+        ESP_LOGE(LOG_TAG, "Failed to register GNSS callback.");
+        goto deinit_server_exit;
+    }
+
+    if (app_fanout_server_start(&state->server) != 0) {
+        goto unregister_exit;
+    }
+
+    ESP_LOGI(LOG_TAG, "NMEA server listening on port %d.", CONFIG_APP_NMEA_SERVER_PORT);
+
+    return 0;
+
+unregister_exit:
+    app_gnss_server_cb_unregister(state->gnss_cb_handle);
+    state->gnss_cb_handle = NULL;
+
+deinit_server_exit:
+    app_fanout_server_deinit(&state->server);
+
+close_udp_exit:
+    if (state->udp_fd >= 0) {
+        close(state->udp_fd);
+        state->udp_fd = -1;
+    }
+
+    return -1;
+}
+
+int app_nmea_server_stats_get(app_nmea_server_stats_t *stats) {
+    app_nmea_server_state_t *state  = &s_app_nmea_server_state;
+    app_fanout_server_t     *server = &state->server;
+
+    if (server->mutex == NULL) {
+        return -1;
+    }
+
+    xSemaphoreTake(server->mutex, portMAX_DELAY);
+
+    stats->clients   = server->stats.clients;
+    stats->accepted  = server->stats.accepted;
+    stats->rejected  = server->stats.rejected;
+    stats->slow      = server->stats.slow;
+    stats->epochs    = state->epochs;
+    stats->bytes_in  = server->stats.bytes_in;
+    stats->bytes_out = server->stats.bytes_out;
+    stats->datagrams = state->datagrams;
+
+    xSemaphoreGive(server->mutex);
+
+    return 0;
+}
+
+/**
+ * Sentences are collected until the epoch ends, which is either a timed sentence with a new UTC time or the fix
+ * the server closes the epoch with. The sentence that starts a new epoch is dispatched before the fix of the old one,
+ * so a fix only ends the batch if the batch is still on its time. Epochs without a position have no fix and the last
+ * epoch before the module goes quiet has no successor, the server task sends those once they stop growing.
+ */
+static int app_nmea_server_gnss_cb(void *handle, app_gnss_cb_type_t type, void *payload) {
+    app_nmea_server_state_t *state = handle;
+
+    if (type == APP_GNSS_CB_FIX) {
+        const app_gnss_fix_t *fix = payload;
+
+        xSemaphoreTake(state->server.mutex, portMAX_DELAY);
+        if (!state->batch_timed || app_nmea_server_time_equal(&fix->time, &state->batch_time)) {
+            app_nmea_server_batch_flush(state);
+        }
+        xSemaphoreGive(state->server.mutex);
+
+        return 0;
+    }
+
+    if (type != APP_GNSS_CB_RAW_NMEA) {
+        return 0;
+    }
+
+    const app_gnss_nmea_t *nmea = payload;
+
+    const bool timed_type = nl_nmea_is(nmea->index, "GGA") || nl_nmea_is(nmea->index, "RMC") ||
+                            nl_nmea_is(nmea->index, "GNS") || nl_nmea_is(nmea->index, "GST");
+
+    nl_nmea_time_t time  = {0};
+    const bool     timed = timed_type && nl_nmea_field_time(nmea->index, 1, &time) == 0;
+
+    xSemaphoreTake(state->server.mutex, portMAX_DELAY);
+
+    if (timed) {
+        if (state->batch_timed && !app_nmea_server_time_equal(&time, &state->batch_time)) {
+            app_nmea_server_batch_flush(state);
+        }
+
+        state->batch_timed = true;
+        state->batch_time  = time;
+    }
+
+    if (state->batch_len + nmea->data_len > sizeof(state->batch)) {
+        const bool timed_before = state->batch_timed;
+
+        app_nmea_server_batch_flush(state);
+
+        /* Keep the epoch time, the rest of the epoch still belongs to it */
+        state->batch_timed = timed_before;
+    }
+
+    if (nmea->data_len <= sizeof(state->batch)) {
+        /* Have the server task time the new batch */
+        if (state->batch_len == 0) {
+            app_fanout_server_wake(&state->server);
+        }
+
+        memcpy(&state->batch[state->batch_len], nmea->data, nmea->data_len);
+        state->batch_len += nmea->data_len;
+        state->batch_tick = xTaskGetTickCount();
+    }
+
+    xSemaphoreGive(state->server.mutex);
+
+    return 0;
+}
+
+static bool app_nmea_server_time_equal(const nl_nmea_time_t *a, const nl_nmea_time_t *b) {
+    return a->hour == b->hour && a->minute == b->minute && a->second == b->second &&
+           a->millisecond == b->millisecond;
+}
+
+/* Runs under the mutex */
+static void app_nmea_server_batch_flush(app_nmea_server_state_t *state) {
+    state->batch_timed = false;
+
+    if (state->batch_len == 0) {
+        return;
+    }
+
+    app_fanout_server_write(&state->server, state->batch, state->batch_len);
+    state->epochs++;
+
+    if (state->udp_fd >= 0) {
+        app_nmea_server_udp_send(state, state->batch, state->batch_len);
+    }
+
+    state->batch_len = 0;
+}
+
+/* Runs under the mutex. Sends the batch if it has gone idle, otherwise shortens timeout to when it would. */
+static void app_nmea_server_batch_idle(app_fanout_server_t *server, struct timeval *timeout) {
+    app_nmea_server_state_t *state = server->config.ctx;
+
+    if (state->batch_len == 0) {
+        return;
+    }
+
+    const TickType_t idle    = pdMS_TO_TICKS(APP_NMEA_SERVER_IDLE_MS);
+    const TickType_t elapsed = xTaskGetTickCount() - state->batch_tick;
+
+    if (elapsed >= idle) {
+        app_nmea_server_batch_flush(state);
+        return;
+    }
+
+    const uint32_t wait_ms = (idle - elapsed) * portTICK_PERIOD_MS;
+    if (wait_ms < APP_NMEA_SERVER_SELECT_MS) {
+        timeout->tv_sec  = wait_ms / 1000;
+        timeout->tv_usec = (wait_ms % 1000) * 1000;
+    }
+}
+
+/* One datagram per epoch, split at sentence boundaries if the epoch does not fit. Runs under the mutex. */
+static void app_nmea_server_udp_send(app_nmea_server_state_t *state, const uint8_t *data, size_t len) {
+    uint32_t datagrams = 0;
+
+    while (len > 0) {
+        size_t size = len;
+
+        if (size > APP_NMEA_SERVER_DATAGRAM_MAX) {
+            size = APP_NMEA_SERVER_DATAGRAM_MAX;
+            while (size > 0 && data[size - 1] != '\n') size--;
+
+            /* No line ending at all, cut the oversized sentence */
+            if (size == 0) size = APP_NMEA_SERVER_DATAGRAM_MAX;
+        }
+
+        /* Fails until the network is up, the epoch is just not sent */
+        if (sendto(state->udp_fd, data, size, 0, (struct sockaddr *)&state->udp_addr, sizeof(state->udp_addr)) ==
+            (int)size) {
+            datagrams++;
+        }
+
+        data += size;
+        len -= size;
+    }
+
+    state->datagrams += datagrams;
+}
+
+/**
+ * Send everything pending in one call, copying it out first if it wraps around the end of the ring. Runs under the
+ * mutex. Returns 0 while the client keeps up, -1 if the connection failed and -2 if the client fell behind its send
+ * window.
+ */
+static int app_nmea_server_flush(app_fanout_server_t *server, size_t index) {
+    app_nmea_server_state_t    *state  = server->config.ctx;
+    app_fanout_server_client_t *client = &server->clients[index];
+
+    size_t pending;
+    if (!app_fanout_server_pending(server, index, &pending)) {
+        return -2;
+    }
+
+    while (pending > 0) {
+        const uint8_t *data;
+        size_t         len = app_gnss_fanout_ring_read_span(&server->ring, client->pos, &data);
+
+        if (len < pending && pending <= sizeof(state->scratch)) {
+            memcpy(state->scratch, data, len);
+            app_gnss_fanout_ring_read_span(&server->ring, client->pos + len, &data);
+            memcpy(&state->scratch[len], data, pending - len);
+
+            data = state->scratch;
+            len  = pending;
+        }
+
+        const int ret = send(client->fd, data, len, MSG_DONTWAIT);
+        if (ret < 0) {
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+
+        client->pos += ret;
+        server->stats.bytes_out += ret;
+
+        /* Socket buffer full, the rest waits for select() */
+        if ((size_t)ret < len) {
+            return 0;
+        }
+
+        pending -= ret;
+    }
+
+    return 0;
+}
+
+#else
+
+int app_nmea_server_init(void) {
+    return 0;
+}
+
+int app_nmea_server_stats_get(app_nmea_server_stats_t *stats) {
+    return -1;
+}
+
+#endif
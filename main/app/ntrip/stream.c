@@ -0,0 +1,232 @@
+#include <ctype.h>
+#include <string.h>
+#include <strings.h>
+
+/* nl */
+#include "rcv/nl_crc24q.h"
+
+/* App */
+#include "app/ntrip/stream.h"
+
+#define APP_NTRIP_STREAM_RTCM3_SYNC (0xD3U)
+
+static void app_ntrip_stream_frames(app_ntrip_stream_t *stream, const uint8_t *data, size_t len);
+static int  app_ntrip_stream_check(const uint8_t *data, size_t len);
+static bool app_ntrip_stream_crc_ok(const uint8_t *frame, size_t len);
+static void app_ntrip_stream_process(app_ntrip_stream_t *stream);
+
+void app_ntrip_stream_init(app_ntrip_stream_t *stream, app_ntrip_stream_frame_cb_t cb, void *ctx) {
+    memset(stream, 0U, sizeof(app_ntrip_stream_t));
+
+    stream->cb  = cb;
+    stream->ctx = ctx;
+}
+
+int app_ntrip_stream_response(app_ntrip_stream_t *stream, const char *header) {
+    const char *end = strstr(header, "\r\n\r\n");
+    if (end == NULL) {
+        return 0;
+    }
+
+    if (strncmp(header, "ICY 200", 7) == 0) {
+        stream->chunked = false;
+    } else if (strncmp(header, "HTTP/1.", 7) == 0 && strncmp(&header[8], " 200", 4) == 0) {
+        stream->chunked = false;
+
+        /* Header names and this value are case-insensitive */
+        for (const char *line = strstr(header, "\r\n") + 2; line < end + 2; line = strstr(line, "\r\n") + 2) {
+            if (strncasecmp(line, "Transfer-Encoding:", 18) != 0) {
+                continue;
+            }
+
+            const char *eol = strstr(line, "\r\n");
+
+            for (const char *value = line + 18; value + 7 <= eol; value++) {
+                if (strncasecmp(value, "chunked", 7) == 0) {
+                    stream->chunked = true;
+                    break;
+                }
+            }
+        }
+    } else if (strncmp(header, "SOURCETABLE", 11) == 0) {
+        return -1;
+    } else {
+        return -2;
+    }
+
+    return (int)(end + 4 - header);
+}
+
+int app_ntrip_stream_input(app_ntrip_stream_t *stream, const uint8_t *data, size_t len) {
+    if (!stream->chunked) {
+        app_ntrip_stream_frames(stream, data, len);
+        return 0;
+    }
+
+    while (len > 0) {
+        switch (stream->chunk_state) {
+            case APP_NTRIP_STREAM_CHUNK_SIZE:
+            case APP_NTRIP_STREAM_CHUNK_EXTENSION: {
+                const char c = (char)*data;
+
+                if (c == '\n') {
+                    /* The zero-size chunk ends the body */
+                    if (stream->chunk_left == 0) return -1;
+
+                    stream->chunk_state = APP_NTRIP_STREAM_CHUNK_DATA;
+                } else if (stream->chunk_state == APP_NTRIP_STREAM_CHUNK_SIZE && isxdigit((unsigned char)c)) {
+                    if (stream->chunk_left > 0xFFFFFU) return -1;
+
+                    stream->chunk_left =
+                        stream->chunk_left * 16U + (isdigit((unsigned char)c) ? c - '0' : (c | 0x20) - 'a' + 10);
+                } else {
+                    stream->chunk_state = APP_NTRIP_STREAM_CHUNK_EXTENSION;
+                }
+
+                data++;
+                len--;
+                break;
+            }
+
+            case APP_NTRIP_STREAM_CHUNK_DATA: {
+                const size_t n = (len < stream->chunk_left) ? len : stream->chunk_left;
+
+                app_ntrip_stream_frames(stream, data, n);
+
+                stream->chunk_left -= n;
+                if (stream->chunk_left == 0) {
+                    stream->chunk_state = APP_NTRIP_STREAM_CHUNK_TRAILER;
+                }
+
+                data += n;
+                len -= n;
+                break;
+            }
+
+            case APP_NTRIP_STREAM_CHUNK_TRAILER: {
+                if (*data == '\n') {
+                    stream->chunk_state = APP_NTRIP_STREAM_CHUNK_SIZE;
+                }
+
+                data++;
+                len--;
+                break;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* Frames that arrive in one piece are passed on in place, only those split across inputs are copied */
+static void app_ntrip_stream_frames(app_ntrip_stream_t *stream, const uint8_t *data, size_t len) {
+    while (len > 0) {
+        /* ---- Hunt for a preamble, frames complete in the input go out without a copy ---- */
+        if (stream->frame_len == 0) {
+            const uint8_t *sync = memchr(data, APP_NTRIP_STREAM_RTCM3_SYNC, len);
+            if (sync == NULL) {
+                stream->skipped += len;
+                return;
+            }
+
+            stream->skipped += sync - data;
+
+            len -= sync - data;
+            data = sync;
+
+            const int frame_len = app_ntrip_stream_check(data, len);
+
+            if (frame_len != 0) {
+                if (frame_len > 0 && app_ntrip_stream_crc_ok(data, frame_len)) {
+                    stream->cb(stream->ctx, data, frame_len);
+                    data += frame_len;
+                    len -= frame_len;
+                } else {
+                    /* Not a frame after all, resync from the byte after the preamble */
+                    stream->skipped++;
+                    data++;
+                    len--;
+                }
+                continue;
+            }
+        }
+
+        /* ---- Buffer the part of a frame that continues in a later input ---- */
+        size_t copy;
+
+        if (stream->frame_len < 3) {
+            copy = 3 - stream->frame_len;
+        } else {
+            copy = ((((size_t)stream->frame[1] & 0x03U) << 8U) | stream->frame[2]) + 6U - stream->frame_len;
+        }
+
+        if (copy > len) {
+            copy = len;
+        }
+
+        memcpy(&stream->frame[stream->frame_len], data, copy);
+        stream->frame_len += copy;
+        data += copy;
+        len -= copy;
+
+        app_ntrip_stream_process(stream);
+    }
+}
+
+/* Returns the frame size if data holds a complete frame, 0 if more data is needed and -1 if it cannot be one */
+static int app_ntrip_stream_check(const uint8_t *data, size_t len) {
+    if (len < 3) {
+        return 0;
+    }
+
+    /* 6 reserved bits shall be zero */
+    if ((data[1] & 0xFCU) != 0) {
+        return -1;
+    }
+
+    const size_t frame_len = ((((size_t)data[1] & 0x03U) << 8U) | data[2]) + 6U;
+
+    return (len < frame_len) ? 0 : (int)frame_len;
+}
+
+static bool app_ntrip_stream_crc_ok(const uint8_t *frame, size_t len) {
+    const uint32_t crc = ((uint32_t)frame[len - 3] << 16U) | ((uint32_t)frame[len - 2] << 8U) | frame[len - 1];
+
+    return nl_crc24q(frame, len - 3) == crc;
+}
+
+/* Same resync as the GNSS frame demux: a rejected frame only gives up its preamble */
+static void app_ntrip_stream_process(app_ntrip_stream_t *stream) {
+    while (stream->frame_len > 0) {
+        const int frame_len = app_ntrip_stream_check(stream->frame, stream->frame_len);
+        if (frame_len == 0) {
+            return;
+        }
+
+        size_t drop = 1;
+
+        if (frame_len > 0 && app_ntrip_stream_crc_ok(stream->frame, frame_len)) {
+            stream->cb(stream->ctx, stream->frame, frame_len);
+            drop = frame_len;
+        } else {
+            stream->skipped++;
+        }
+
+        /* ---- Resync within what is already buffered ---- */
+        const uint8_t *rest     = &stream->frame[drop];
+        const size_t   rest_len = stream->frame_len - drop;
+        const uint8_t *sync     = memchr(rest, APP_NTRIP_STREAM_RTCM3_SYNC, rest_len);
+
+        if (sync == NULL) {
+            stream->skipped += rest_len;
+            stream->frame_len = 0;
+
+            return;
+        }
+
+        stream->skipped += sync - rest;
+
+        stream->frame_len = &stream->frame[stream->frame_len] - sync;
+        memmove(stream->frame, sync, stream->frame_len);
+    }
+}
@@ -0,0 +1,525 @@
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+/* IDF */
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+#include "mbedtls/base64.h"
+
+/* App */
+#include "app/base_server.h"
+#include "app/fanout_server.h"
+#include "app/gnss/rtcm_scheduler.h"
+#include "app/gnss/survey.h"
+#include "app/gnss_server.h"
+#include "app/ntrip_caster.h"
+
+#if CONFIG_APP_NTRIP_CASTER
+
+#define APP_NTRIP_CASTER_REQUEST_MAX     (512)  /* Request line and headers */
+#define APP_NTRIP_CASTER_REQUEST_TIMEOUT (10)   /* s, to send a complete request */
+#define APP_NTRIP_CASTER_CHUNK_MAX       (1024) /* NTRIP 2 chunk payload */
+#define APP_NTRIP_CASTER_SELECT_MS       (1000) /* Upper bound between request timeout checks */
+#define APP_NTRIP_CASTER_SERVER          "NTRIP Asuna/1.0"
+
+/* Protocol state next to the server's client slot of the same index, zeroed whenever the slot is given up */
+typedef struct {
+    /* Request */
+    char   request[APP_NTRIP_CASTER_REQUEST_MAX];
+    size_t request_len;
+
+    /* Stream */
+    bool    chunked;    /* NTRIP 2: HTTP chunked transfer encoding around the data */
+    size_t  chunk_left; /* Data bytes left in the current chunk */
+    char    frame[12];  /* Chunk header or trailer, not sent yet from frame_off on */
+    uint8_t frame_len;
+    uint8_t frame_off;
+} app_ntrip_caster_client_t;
+
+typedef struct {
+    app_fanout_server_t  server; /* Its mutex guards the message types as well */
+    app_gnss_cb_handle_t gnss_cb_handle;
+
+    app_gnss_rtcm_sched_t rtcm_sched; /* No rules, only tracks the message types in the stream for the sourcetable */
+    char                  auth[96];   /* Expected "Basic ..." credentials, empty if none are configured */
+
+    app_ntrip_caster_client_t clients[CONFIG_APP_NTRIP_CASTER_MAX_CLIENTS];
+} app_ntrip_caster_state_t;
+
+static const char *LOG_TAG = "asuna_ntrip";
+
+static app_ntrip_caster_state_t s_app_ntrip_caster_state;
+
+static int  app_ntrip_caster_gnss_cb(void *handle, app_gnss_cb_type_t type, void *payload);
+static void app_ntrip_caster_request(app_fanout_server_t *server, size_t index, bool readable, int64_t now_us);
+static void app_ntrip_caster_respond(app_ntrip_caster_state_t *state, size_t index);
+static void app_ntrip_caster_drop(app_ntrip_caster_state_t *state, size_t index, bool reject);
+static void app_ntrip_caster_sourcetable(app_ntrip_caster_state_t *state, int fd, bool ntrip2);
+static bool app_ntrip_caster_unsent(app_fanout_server_t *server, size_t index);
+static int  app_ntrip_caster_flush(app_fanout_server_t *server, size_t index);
+static int  app_ntrip_caster_send(int fd, const void *data, size_t len);
+static int  app_ntrip_caster_send_str(int fd, const char *str);
+
+int app_ntrip_caster_init(void) {
+    app_ntrip_caster_state_t *state = &s_app_ntrip_caster_state;
+
+    /* ---- Credentials, compared in their encoded form ---- */
+    state->auth[0] = '\0';
+    if (strlen(CONFIG_APP_NTRIP_CASTER_USERNAME) > 0) {
+        char   plain[66];
+        size_t encoded_len;
+
+        const int plain_len =
+            snprintf(plain, sizeof(plain), "%s:%s", CONFIG_APP_NTRIP_CASTER_USERNAME, CONFIG_APP_NTRIP_CASTER_PASSWORD);
+
+        strcpy(state->auth, "Basic ");
+        if (plain_len >= sizeof(plain) ||
+            mbedtls_base64_encode((unsigned char *)&state->auth[6], sizeof(state->auth) - 6, &encoded_len,
+                                  (const unsigned char *)plain, plain_len) != 0) {
+            ESP_LOGE(LOG_TAG, "Credentials too long.");
+            return -1;
+        }
+    }
+
+    const app_fanout_server_config_t server_config = {
+        .log_tag     = LOG_TAG,
+        .task_name   = "asuna_ntrip_cst",
+        .task_stack  = 4096,
+        .port        = CONFIG_APP_NTRIP_CASTER_PORT,
+        .max_clients = CONFIG_APP_NTRIP_CASTER_MAX_CLIENTS,
+        .buffer_size = CONFIG_APP_NTRIP_CASTER_BUFFER_SIZE,
+        .window      = CONFIG_APP_NTRIP_CASTER_CLIENT_WINDOW,
+        .select_ms   = APP_NTRIP_CASTER_SELECT_MS,
+        .ctx         = state,
+        .request     = app_ntrip_caster_request,
+        .unsent      = app_ntrip_caster_unsent,
+        .flush       = app_ntrip_caster_flush,
+    };
+
+    if (app_fanout_server_init(&state->server, &server_config) != 0) {
+        return -1;
+    }
+
+    app_gnss_rtcm_sched_init(&state->rtcm_sched);
+
+    /* ---- Feed ---- */
+    app_gnss_async_config_t async_config = APP_GNSS_ASYNC_CONFIG_DEFAULT();
+
+    async_config.task_name = "asuna_ntrip_cb";
+
+    state->gnss_cb_handle =
+        app_gnss_server_cb_register_async(APP_GNSS_CB_RAW_RTCM, app_ntrip_caster_gnss_cb, state, &async_config);
+    if (state->gnss_cb_handle == NULL) {
+        ESP_LOGE(LOG_TAG, "Failed to register GNSS callback.");
+        goto deinit_server_exit;
+    }
+
+    if (app_fanout_server_start(&state->server) != 0) {
+        goto unregister_exit;
+    }
+
+    ESP_LOGI(LOG_TAG, "NTRIP caster listening on port %d, mountpoint /%s.", CONFIG_APP_NTRIP_CASTER_PORT,
+             CONFIG_APP_NTRIP_CASTER_MOUNTPOINT);
+
+    return 0;
+
+unregister_exit:
+    app_gnss_server_cb_unregister(state->gnss_cb_handle);
+    state->gnss_cb_handle = NULL;
+
+deinit_server_exit:
+    app_fanout_server_deinit(&state->server);
+
+    return -1;
+}
+
+int app_ntrip_caster_stats_get(app_ntrip_caster_stats_t *stats) {
+    app_fanout_server_t *server = &s_app_ntrip_caster_state.server;
+
+    if (server->mutex == NULL) {
+        return -1;
+    }
+
+    xSemaphoreTake(server->mutex, portMAX_DELAY);
+
+    stats->clients   = server->stats.clients;
+    stats->accepted  = server->stats.accepted;
+    stats->rejected  = server->stats.rejected;
+    stats->slow      = server->stats.slow;
+    stats->bytes_in  = server->stats.bytes_in;
+    stats->bytes_out = server->stats.bytes_out;
+
+    xSemaphoreGive(server->mutex);
+
+    return 0;
+}
+
+/**
+ * The only copy of the stream: every client sends from the ring at its own position.
+ */
+static int app_ntrip_caster_gnss_cb(void *handle, app_gnss_cb_type_t type, void *payload) {
+    app_ntrip_caster_state_t *state = handle;
+    const app_gnss_rtcm_t    *rtcm  = payload;
+
+    if (type != APP_GNSS_CB_RAW_RTCM) {
+        return 0;
+    }
+
+    xSemaphoreTake(state->server.mutex, portMAX_DELAY);
+    app_fanout_server_write(&state->server, rtcm->data, rtcm->data_len);
+    app_gnss_rtcm_sched_admit(&state->rtcm_sched, rtcm, esp_timer_get_time());
+    xSemaphoreGive(state->server.mutex);
+
+    return 0;
+}
+
+static void app_ntrip_caster_request(app_fanout_server_t *server, size_t index, bool readable, int64_t now_us) {
+    app_ntrip_caster_state_t  *state  = server->config.ctx;
+    app_ntrip_caster_client_t *client = &state->clients[index];
+
+    const int fd = server->clients[index].fd;
+
+    if (!readable) {
+        if (now_us - server->clients[index].since_us > APP_NTRIP_CASTER_REQUEST_TIMEOUT * 1000000LL) {
+            ESP_LOGD(LOG_TAG, "Request timeout, fd: %d", fd);
+            app_ntrip_caster_drop(state, index, false);
+        }
+        return;
+    }
+
+    const size_t room = sizeof(client->request) - 1 - client->request_len;
+
+    const int ret = recv(fd, &client->request[client->request_len], room, MSG_DONTWAIT);
+    if (ret == 0 || (ret < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+        app_ntrip_caster_drop(state, index, false);
+        return;
+    }
+
+    if (ret < 0) {
+        return;
+    }
+
+    client->request_len += ret;
+    client->request[client->request_len] = '\0';
+
+    if (strstr(client->request, "\r\n\r\n") != NULL) {
+        app_ntrip_caster_respond(state, index);
+    } else if (client->request_len == sizeof(client->request) - 1) {
+        ESP_LOGW(LOG_TAG, "Request too long, fd: %d", fd);
+        app_ntrip_caster_drop(state, index, false);
+    }
+}
+
+/**
+ * NTRIP 1 and 2 are told apart by the Ntrip-Version header. Sourcetable requests need no credentials, NTRIP 1
+ * clients asking for an unknown mountpoint get the sourcetable as well.
+ */
+static void app_ntrip_caster_respond(app_ntrip_caster_state_t *state, size_t index) {
+    app_ntrip_caster_client_t *client = &state->clients[index];
+
+    const int fd = state->server.clients[index].fd;
+
+    char *line = client->request;
+    char *end  = strstr(line, "\r\n");
+
+    *end = '\0';
+
+    /* ---- Request line ---- */
+    char method[8];
+    char path[64];
+    char version[12];
+
+    if (sscanf(line, "%7s %63s %11s", method, path, version) != 3 || path[0] != '/') {
+        app_ntrip_caster_send_str(fd, "HTTP/1.0 400 Bad Request\r\n\r\n");
+        goto reject_exit;
+    }
+
+    char *query = strchr(path, '?');
+    if (query != NULL) *query = '\0';
+
+    /* ---- Headers ---- */
+    bool        ntrip2        = false;
+    const char *authorization = "";
+
+    for (line = end + 2; (end = strstr(line, "\r\n")) != NULL && end != line; line = end + 2) {
+        *end = '\0';
+
+        char *value = strchr(line, ':');
+        if (value == NULL) continue;
+
+        *value++ = '\0';
+        while (*value == ' ') value++;
+
+        if (strcasecmp(line, "Ntrip-Version") == 0) {
+            ntrip2 = strcasecmp(value, "Ntrip/2.0") == 0;
+        } else if (strcasecmp(line, "Authorization") == 0) {
+            authorization = value;
+        }
+    }
+
+    if (strcmp(method, "GET") != 0) {
+        if (ntrip2) {
+            app_ntrip_caster_send_str(fd, "HTTP/1.1 405 Method Not Allowed\r\n\r\n");
+        } else {
+            app_ntrip_caster_send_str(fd, "ERROR - Bad Request\r\n");
+        }
+        goto reject_exit;
+    }
+
+    const bool mountpoint = strcmp(&path[1], CONFIG_APP_NTRIP_CASTER_MOUNTPOINT) == 0;
+
+    if (!mountpoint) {
+        if (ntrip2 && path[1] != '\0') {
+            app_ntrip_caster_send_str(fd, "HTTP/1.1 404 Not Found\r\nNtrip-Version: Ntrip/2.0\r\n\r\n");
+            goto reject_exit;
+        }
+
+        app_ntrip_caster_sourcetable(state, fd, ntrip2);
+        app_ntrip_caster_drop(state, index, false);
+        return;
+    }
+
+    if (state->auth[0] != '\0' && strcmp(authorization, state->auth) != 0) {
+        if (ntrip2) {
+            static const char resp[] = "HTTP/1.1 401 Unauthorized\r\nNtrip-Version: Ntrip/2.0\r\n"
+                                       "WWW-Authenticate: Basic realm=\"/" CONFIG_APP_NTRIP_CASTER_MOUNTPOINT "\"\r\n"
+                                       "Content-Length: 0\r\n\r\n";
+            app_ntrip_caster_send_str(fd, resp);
+        } else {
+            app_ntrip_caster_send_str(fd, "ERROR - Bad Password\r\n");
+        }
+        goto reject_exit;
+    }
+
+    /* ---- Stream ---- */
+    const bool chunked = ntrip2 && strcmp(version, "HTTP/1.1") == 0;
+
+    if (ntrip2) {
+        char      resp[256];
+        const int len = snprintf(resp, sizeof(resp),
+                                 "HTTP/1.1 200 OK\r\n"
+                                 "Ntrip-Version: Ntrip/2.0\r\n"
+                                 "Server: " APP_NTRIP_CASTER_SERVER "\r\n"
+                                 "Content-Type: gnss/data\r\n"
+                                 "Cache-Control: no-store, no-cache, max-age=0\r\n"
+                                 "Connection: close\r\n"
+                                 "%s\r\n",
+                                 chunked ? "Transfer-Encoding: chunked\r\n" : "");
+        if (app_ntrip_caster_send(fd, resp, len) != 0) goto reject_exit;
+    } else {
+        if (app_ntrip_caster_send_str(fd, "ICY 200 OK\r\n\r\n") != 0) goto reject_exit;
+    }
+
+    memset(client, 0U, sizeof(app_ntrip_caster_client_t));
+    client->chunked = chunked;
+
+    app_fanout_server_stream(&state->server, index);
+
+    ESP_LOGI(LOG_TAG, "Streaming /%s to NTRIP %d client, fd: %d", CONFIG_APP_NTRIP_CASTER_MOUNTPOINT, ntrip2 ? 2 : 1,
+             fd);
+
+    return;
+
+reject_exit:
+    app_ntrip_caster_drop(state, index, true);
+}
+
+/* Gives up a client still in its request, clearing the slot for the next connection. */
+static void app_ntrip_caster_drop(app_ntrip_caster_state_t *state, size_t index, bool reject) {
+    memset(&state->clients[index], 0U, sizeof(app_ntrip_caster_client_t));
+
+    if (reject) {
+        app_fanout_server_reject(&state->server, index);
+    } else {
+        app_fanout_server_close(&state->server, index);
+    }
+}
+
+static void app_ntrip_caster_sourcetable(app_ntrip_caster_state_t *state, int fd, bool ntrip2) {
+    /* Approximate position of the base for the client's nearest-mountpoint logic */
+    double              lat = 0.0, lon = 0.0, height;
+    app_base_position_t position;
+    if (app_base_server_position_get(&position) == 0) {
+        app_gnss_survey_ecef_to_llh(position.ecef, &lat, &lon, &height);
+    }
+
+    char nav[32] = "";
+
+    app_gnss_server_config_t config;
+    if (app_gnss_server_config_get(&config) == 0) {
+        static const struct {
+            app_gnss_constellation_t constellation;
+            const char              *name;
+        } systems[] = {
+            {APP_GNSS_CONSTELLATION_GPS, "GPS"},     {APP_GNSS_CONSTELLATION_GLONASS, "GLO"},
+            {APP_GNSS_CONSTELLATION_GALILEO, "GAL"}, {APP_GNSS_CONSTELLATION_BEIDOU, "BDS"},
+            {APP_GNSS_CONSTELLATION_QZSS, "QZS"},
+        };
+
+        for (size_t i = 0; i < sizeof(systems) / sizeof(systems[0]); i++) {
+            if (config.constellations & APP_GNSS_CONSTELLATION_BIT(systems[i].constellation)) {
+                if (nav[0] != '\0') strcat(nav, "+");
+                strcat(nav, systems[i].name);
+            }
+        }
+    }
+
+    /* Message types seen in the stream so far, with their update interval in seconds once it is known */
+    char   details[160] = "";
+    size_t details_len  = 0;
+
+    xSemaphoreTake(state->server.mutex, portMAX_DELAY);
+
+    for (size_t i = 0; i < state->rtcm_sched.count; i++) {
+        const app_gnss_rtcm_sched_stats_t *stats = &state->rtcm_sched.entries[i].stats;
+
+        const char *sep = (details_len > 0) ? "," : "";
+
+        char item[16];
+        int  item_len;
+        if (stats->interval_ms > 0) {
+            const uint32_t interval = (stats->interval_ms + 500) / 1000;
+            item_len =
+                snprintf(item, sizeof(item), "%s%u(%u)", sep, stats->type, (unsigned int)(interval > 0 ? interval : 1));
+        } else {
+            item_len = snprintf(item, sizeof(item), "%s%u", sep, stats->type);
+        }
+
+        if (details_len + item_len >= sizeof(details)) {
+            break;
+        }
+
+        memcpy(&details[details_len], item, item_len + 1);
+        details_len += item_len;
+    }
+
+    xSemaphoreGive(state->server.mutex);
+
+    char      body[384];
+    const int body_len =
+        snprintf(body, sizeof(body),
+                 "STR;%s;%s;RTCM 3.3;%s;2;%s;Asuna;;%.2f;%.2f;0;0;Asuna;none;%c;N;0;\r\n"
+                 "ENDSOURCETABLE\r\n",
+                 CONFIG_APP_NTRIP_CASTER_MOUNTPOINT, CONFIG_APP_NTRIP_CASTER_MOUNTPOINT, details, nav, lat, lon,
+                 (state->auth[0] != '\0') ? 'B' : 'N');
+
+    char      header[224];
+    const int header_len = snprintf(header, sizeof(header),
+                                    "%s\r\n"
+                                    "%s"
+                                    "Server: " APP_NTRIP_CASTER_SERVER "\r\n"
+                                    "Content-Type: %s\r\n"
+                                    "Content-Length: %d\r\n"
+                                    "Connection: close\r\n\r\n",
+                                    ntrip2 ? "HTTP/1.1 200 OK" : "SOURCETABLE 200 OK",
+                                    ntrip2 ? "Ntrip-Version: Ntrip/2.0\r\n" : "",
+                                    ntrip2 ? "gnss/sourcetable" : "text/plain", body_len);
+
+    if (app_ntrip_caster_send(fd, header, header_len) == 0) {
+        app_ntrip_caster_send(fd, body, body_len);
+    }
+}
+
+/* Runs under the mutex */
+static bool app_ntrip_caster_unsent(app_fanout_server_t *server, size_t index) {
+    const app_ntrip_caster_state_t  *state  = server->config.ctx;
+    const app_ntrip_caster_client_t *client = &state->clients[index];
+
+    return client->frame_off < client->frame_len;
+}
+
+/**
+ * Send as much as the socket takes without blocking. Runs under the mutex, lwIP copies the data so the ring can be
+ * written again as soon as this returns. Returns 0 while the client keeps up, -1 if the connection failed and -2 if
+ * the client fell behind its send window.
+ */
+static int app_ntrip_caster_flush(app_fanout_server_t *server, size_t index) {
+    app_ntrip_caster_state_t   *state  = server->config.ctx;
+    app_ntrip_caster_client_t  *client = &state->clients[index];
+    app_fanout_server_client_t *slot   = &server->clients[index];
+
+    for (;;) {
+        /* Chunk framing first */
+        if (client->frame_off < client->frame_len) {
+            const int ret =
+                send(slot->fd, &client->frame[client->frame_off], client->frame_len - client->frame_off, MSG_DONTWAIT);
+            if (ret < 0) {
+                return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+            }
+
+            client->frame_off += ret;
+            continue;
+        }
+
+        size_t pending;
+        if (!app_fanout_server_pending(server, index, &pending)) {
+            return -2;
+        }
+
+        if (client->chunked && client->chunk_left == 0) {
+            if (pending == 0) {
+                return 0;
+            }
+
+            client->chunk_left = (pending < APP_NTRIP_CASTER_CHUNK_MAX) ? pending : APP_NTRIP_CASTER_CHUNK_MAX;
+            client->frame_len  = snprintf(client->frame, sizeof(client->frame), "%x\r\n", (unsigned int)client->chunk_left);
+            client->frame_off  = 0;
+            continue;
+        }
+
+        const uint8_t *data;
+        size_t         span = app_gnss_fanout_ring_read_span(&server->ring, slot->pos, &data);
+        if (span == 0) {
+            return 0;
+        }
+
+        if (client->chunked && span > client->chunk_left) {
+            span = client->chunk_left;
+        }
+
+        const int ret = send(slot->fd, data, span, MSG_DONTWAIT);
+        if (ret < 0) {
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+
+        slot->pos += ret;
+        server->stats.bytes_out += ret;
+
+        if (client->chunked) {
+            client->chunk_left -= ret;
+
+            if (client->chunk_left == 0) {
+                memcpy(client->frame, "\r\n", 2);
+                client->frame_len = 2;
+                client->frame_off = 0;
+            }
+        }
+    }
+}
+
+/* Responses are small enough for an empty socket buffer, a short send is treated as a failure. */
+static int app_ntrip_caster_send(int fd, const void *data, size_t len) {
+    return (send(fd, data, len, MSG_DONTWAIT) == (int)len) ? 0 : -1;
+}
+
+static int app_ntrip_caster_send_str(int fd, const char *str) {
+    return app_ntrip_caster_send(fd, str, strlen(str));
+}
+
+#else
+
+int app_ntrip_caster_init(void) {
+    return 0;
+}
+
+int app_ntrip_caster_stats_get(app_ntrip_caster_stats_t *stats) {
+    return -1;
+}
+
+#endif
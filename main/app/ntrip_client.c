@@ -0,0 +1,631 @@
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/* IDF */
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "fcntl.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "lwip/netdb.h"
+#include "lwip/sockets.h"
+#include "mbedtls/base64.h"
+#include "nvs_flash.h"
+
+/* App */
+#include "app/gnss_server.h"
+#include "app/ntrip/stream.h"
+#include "app/ntrip_client.h"
+
+#define APP_NTRIP_CLIENT_NVS_NAMESPACE "a_ntrip_client"
+#define APP_NTRIP_CLIENT_NVS_VERSION   1 /* DO NOT CHANGE THIS VALUE UNLESS THERE IS A STRUCTURE UPDATE */
+
+#define APP_NTRIP_CLIENT_CONNECT_TIMEOUT (10)    /* s, for the connection and the response header each */
+#define APP_NTRIP_CLIENT_DATA_TIMEOUT    (30)    /* s without data before reconnecting */
+#define APP_NTRIP_CLIENT_BACKOFF_MIN     (1000)  /* ms */
+#define APP_NTRIP_CLIENT_BACKOFF_MAX     (60000) /* ms */
+#define APP_NTRIP_CLIENT_RECV_SIZE       (512)   /* Also bounds the response header */
+#define APP_NTRIP_CLIENT_GGA_MAX         (96)
+#define APP_NTRIP_CLIENT_GGA_MAX_AGE     (5) /* s, an older GGA is not sent */
+#define APP_NTRIP_CLIENT_AGENT           "NTRIP Asuna/1.0"
+
+/* One connection. Frames are passed on as soon as they are complete, one UART write each. */
+typedef struct {
+    int     fd;
+    int64_t data_us;
+    int64_t gga_us;
+    bool    delivered;
+
+    app_ntrip_stream_t stream;
+
+    uint8_t buf[APP_NTRIP_CLIENT_RECV_SIZE];
+} app_ntrip_client_session_t;
+
+typedef struct {
+    TaskHandle_t         task;
+    SemaphoreHandle_t    mutex; /* Configuration, GGA and stats */
+    app_gnss_cb_handle_t gnss_cb_handle;
+    atomic_bool          restart; /* Configuration changed, drop the session */
+
+    app_ntrip_client_config_t config;
+
+    char    gga[APP_NTRIP_CLIENT_GGA_MAX];
+    size_t  gga_len;
+    int64_t gga_us;
+
+    app_ntrip_client_stats_t stats;
+    int64_t                  frame_us; /* Last complete frame, 0 before the first */
+    int64_t                  meter_us; /* Start of the current throughput second */
+    uint32_t                 meter_bytes;
+
+    app_ntrip_client_session_t session;
+} app_ntrip_client_state_t;
+
+static const char *LOG_TAG = "asuna_ntrip_cli";
+
+static app_ntrip_client_state_t s_app_ntrip_client_state;
+
+static const char *APP_NTRIP_CLIENT_CFG_KEY_FLAG    = "cfg_valid"; /* Configuration key */
+static const char *APP_NTRIP_CLIENT_CFG_KEY_ENABLED = "enabled";   /* Client enabled */
+static const char *APP_NTRIP_CLIENT_CFG_KEY_HOST    = "host";      /* Caster host name or address */
+static const char *APP_NTRIP_CLIENT_CFG_KEY_PORT    = "port";      /* Caster port */
+static const char *APP_NTRIP_CLIENT_CFG_KEY_MOUNT   = "mount";     /* Mountpoint */
+static const char *APP_NTRIP_CLIENT_CFG_KEY_USER    = "user";      /* Username */
+static const char *APP_NTRIP_CLIENT_CFG_KEY_PASS    = "pass";      /* Password */
+static const char *APP_NTRIP_CLIENT_CFG_KEY_GGA     = "gga_s";     /* GGA interval */
+
+static void app_ntrip_client_task(void *parameters);
+static int  app_ntrip_client_gnss_cb(void *handle, app_gnss_cb_type_t type, void *payload);
+static void app_ntrip_client_status_set(app_ntrip_client_state_t *state, app_ntrip_client_status_t status);
+static int  app_ntrip_client_session(app_ntrip_client_state_t *state, const app_ntrip_client_config_t *config);
+static int  app_ntrip_client_connect(const app_ntrip_client_config_t *config);
+static int  app_ntrip_client_request(app_ntrip_client_state_t *state, const app_ntrip_client_config_t *config);
+static void app_ntrip_client_gga_send(app_ntrip_client_state_t *state, const app_ntrip_client_config_t *config);
+static void app_ntrip_client_deliver(void *ctx, const uint8_t *frame, size_t len);
+static int  app_ntrip_client_config_load(app_ntrip_client_config_t *config);
+static void app_ntrip_client_config_store(const app_ntrip_client_config_t *config);
+
+int app_ntrip_client_init(void) {
+    app_ntrip_client_state_t *state = &s_app_ntrip_client_state;
+
+    state->mutex = xSemaphoreCreateMutex();
+    if (state->mutex == NULL) {
+        ESP_LOGE(LOG_TAG, "Failed to create mutex.");
+        return -1;
+    }
+
+    if (app_ntrip_client_config_load(&state->config) != 0) {
+        app_ntrip_client_config_init(&state->config);
+    }
+
+    state->session.fd = -1;
+    state->stats.age_ms = UINT32_MAX;
+
+    if (xTaskCreate(app_ntrip_client_task, "asuna_ntrip_cli", 4096, state, 4, &state->task) != pdPASS) {
+        ESP_LOGE(LOG_TAG, "Failed to create client task.");
+        return -1;
+    }
+
+    return 0;
+}
+
+void app_ntrip_client_config_init(app_ntrip_client_config_t *config) {
+    memset(config, 0U, sizeof(app_ntrip_client_config_t));
+
+    config->enabled        = false;
+    config->port           = 2101;
+    config->gga_interval_s = 10;
+}
+
+int app_ntrip_client_config_set(const app_ntrip_client_config_t *config) {
+    app_ntrip_client_state_t *state = &s_app_ntrip_client_state;
+
+    /* ---- Sanity checks ---- */
+    if (config->enabled && (config->host[0] == '\0' || config->mountpoint[0] == '\0' || config->port == 0)) return -1;
+    if (strnlen(config->host, sizeof(config->host)) == sizeof(config->host)) return -1;
+    if (strnlen(config->mountpoint, sizeof(config->mountpoint)) == sizeof(config->mountpoint)) return -1;
+    if (strnlen(config->username, sizeof(config->username)) == sizeof(config->username)) return -1;
+    if (strnlen(config->password, sizeof(config->password)) == sizeof(config->password)) return -1;
+
+    app_ntrip_client_config_store(config);
+
+    xSemaphoreTake(state->mutex, portMAX_DELAY);
+    state->config = *config;
+    xSemaphoreGive(state->mutex);
+
+    atomic_store(&state->restart, true);
+    xTaskNotifyGive(state->task);
+
+    return 0;
+}
+
+int app_ntrip_client_config_get(app_ntrip_client_config_t *config) {
+    app_ntrip_client_state_t *state = &s_app_ntrip_client_state;
+
+    xSemaphoreTake(state->mutex, portMAX_DELAY);
+    *config = state->config;
+    xSemaphoreGive(state->mutex);
+
+    return 0;
+}
+
+int app_ntrip_client_stats_get(app_ntrip_client_stats_t *stats) {
+    app_ntrip_client_state_t *state = &s_app_ntrip_client_state;
+
+    const int64_t now = esp_timer_get_time();
+
+    xSemaphoreTake(state->mutex, portMAX_DELAY);
+
+    *stats = state->stats;
+
+    if (state->frame_us != 0) {
+        const int64_t age_ms = (now - state->frame_us) / 1000;
+        stats->age_ms        = (age_ms < UINT32_MAX) ? (uint32_t)age_ms : UINT32_MAX;
+    }
+
+    /* Nothing arrived for more than a second */
+    if (now - state->meter_us > 2000000) {
+        stats->bytes_per_sec = 0;
+    }
+
+    xSemaphoreGive(state->mutex);
+
+    return 0;
+}
+
+static void app_ntrip_client_task(void *parameters) {
+    app_ntrip_client_state_t *state = parameters;
+
+    uint32_t backoff_ms = APP_NTRIP_CLIENT_BACKOFF_MIN;
+
+    for (;;) {
+        app_ntrip_client_config_t config;
+        app_ntrip_client_config_get(&config);
+
+        atomic_store(&state->restart, false);
+
+        /* ---- GGA feed, only while a VRS mountpoint may want it ---- */
+        const bool want_gga = config.enabled && config.gga_interval_s > 0;
+
+        if (want_gga && state->gnss_cb_handle == NULL) {
+            app_gnss_async_config_t async_config = APP_GNSS_ASYNC_CONFIG_DEFAULT();
+
+            async_config.queue_size = 1024;
+            async_config.task_name  = "asuna_ntrip_gga";
+
+            state->gnss_cb_handle =
+                app_gnss_server_cb_register_async(APP_GNSS_CB_RAW_NMEA, app_ntrip_client_gnss_cb, state, &async_config);
+        } else if (!want_gga && state->gnss_cb_handle != NULL) {
+            app_gnss_server_cb_unregister(state->gnss_cb_handle);
+            state->gnss_cb_handle = NULL;
+        }
+
+        if (!config.enabled) {
+            app_ntrip_client_status_set(state, APP_NTRIP_CLIENT_IDLE);
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+            backoff_ms = APP_NTRIP_CLIENT_BACKOFF_MIN;
+            continue;
+        }
+
+        app_ntrip_client_status_set(state, APP_NTRIP_CLIENT_CONNECTING);
+
+        const int ret = app_ntrip_client_session(state, &config);
+
+        if (atomic_load(&state->restart)) {
+            backoff_ms = APP_NTRIP_CLIENT_BACKOFF_MIN;
+            continue;
+        }
+
+        xSemaphoreTake(state->mutex, portMAX_DELAY);
+        state->stats.failures++;
+        xSemaphoreGive(state->mutex);
+
+        /* A stream that carried data starts the backoff over */
+        if (ret > 0) {
+            backoff_ms = APP_NTRIP_CLIENT_BACKOFF_MIN;
+        }
+
+        const uint32_t delay_ms = backoff_ms + esp_random() % (backoff_ms / 4 + 1);
+
+        ESP_LOGI(LOG_TAG, "Reconnecting in %" PRIu32 " ms.", delay_ms);
+        app_ntrip_client_status_set(state, APP_NTRIP_CLIENT_BACKOFF);
+
+        /* A configuration change cuts the wait short */
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(delay_ms));
+
+        backoff_ms = (backoff_ms * 2 < APP_NTRIP_CLIENT_BACKOFF_MAX) ? backoff_ms * 2 : APP_NTRIP_CLIENT_BACKOFF_MAX;
+    }
+}
+
+static int app_ntrip_client_gnss_cb(void *handle, app_gnss_cb_type_t type, void *payload) {
+    app_ntrip_client_state_t *state = handle;
+    const app_gnss_nmea_t    *nmea  = payload;
+
+    if (type != APP_GNSS_CB_RAW_NMEA || memcmp(nmea->type, "GGA", 3) != 0 ||
+        nmea->data_len > APP_NTRIP_CLIENT_GGA_MAX) {
+        return 0;
+    }
+
+    xSemaphoreTake(state->mutex, portMAX_DELAY);
+    memcpy(state->gga, nmea->data, nmea->data_len);
+    state->gga_len = nmea->data_len;
+    state->gga_us  = esp_timer_get_time();
+    xSemaphoreGive(state->mutex);
+
+    return 0;
+}
+
+static void app_ntrip_client_status_set(app_ntrip_client_state_t *state, app_ntrip_client_status_t status) {
+    xSemaphoreTake(state->mutex, portMAX_DELAY);
+    state->stats.status = status;
+    xSemaphoreGive(state->mutex);
+}
+
+/**
+ * Connect, request the mountpoint and pass the stream on until it breaks off, times out or the configuration
+ * changes. Returns 1 if corrections were delivered, 0 if not and -1 if the stream was never reached.
+ */
+static int app_ntrip_client_session(app_ntrip_client_state_t *state, const app_ntrip_client_config_t *config) {
+    app_ntrip_client_session_t *session = &state->session;
+
+    memset(session, 0U, sizeof(app_ntrip_client_session_t));
+    app_ntrip_stream_init(&session->stream, app_ntrip_client_deliver, state);
+
+    session->fd = app_ntrip_client_connect(config);
+    if (session->fd < 0) {
+        return -1;
+    }
+
+    int ret = app_ntrip_client_request(state, config);
+    if (ret != 0) {
+        ret = -1;
+        goto close_exit;
+    }
+
+    ESP_LOGI(LOG_TAG, "Streaming %s:%u/%s.", config->host, config->port, config->mountpoint);
+
+    xSemaphoreTake(state->mutex, portMAX_DELAY);
+    state->stats.status = APP_NTRIP_CLIENT_STREAMING;
+    state->stats.connects++;
+    xSemaphoreGive(state->mutex);
+
+    session->data_us = esp_timer_get_time();
+
+    while (!atomic_load(&state->restart)) {
+        app_ntrip_client_gga_send(state, config);
+
+        fd_set read_fds;
+        FD_ZERO(&read_fds);
+        FD_SET(session->fd, &read_fds);
+
+        struct timeval timeout = {.tv_sec = 1, .tv_usec = 0};
+
+        ret = select(session->fd + 1, &read_fds, NULL, NULL, &timeout);
+        if (ret < 0) {
+            ESP_LOGE(LOG_TAG, "select() failed, errno: %d", errno);
+            break;
+        }
+
+        const int64_t now = esp_timer_get_time();
+
+        if (ret > 0) {
+            const int len = recv(session->fd, session->buf, sizeof(session->buf), MSG_DONTWAIT);
+
+            if (len == 0) {
+                ESP_LOGW(LOG_TAG, "Caster closed the connection.");
+                break;
+            }
+
+            if (len < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) continue;
+
+                ESP_LOGW(LOG_TAG, "Connection lost, errno: %d", errno);
+                break;
+            }
+
+            if (app_ntrip_stream_input(&session->stream, session->buf, len) != 0) {
+                ESP_LOGW(LOG_TAG, "Stream ended.");
+                break;
+            }
+
+            session->data_us = now;
+        } else if (now - session->data_us > APP_NTRIP_CLIENT_DATA_TIMEOUT * 1000000LL) {
+            ESP_LOGW(LOG_TAG, "No data for %d s.", APP_NTRIP_CLIENT_DATA_TIMEOUT);
+            break;
+        }
+    }
+
+    ret = session->delivered ? 1 : 0;
+
+close_exit:
+    close(session->fd);
+    session->fd = -1;
+
+    return ret;
+}
+
+static int app_ntrip_client_connect(const app_ntrip_client_config_t *config) {
+    const struct addrinfo hints = {
+        .ai_family   = AF_INET,
+        .ai_socktype = SOCK_STREAM,
+    };
+
+    char port[6];
+    snprintf(port, sizeof(port), "%u", config->port);
+
+    struct addrinfo *res = NULL;
+    if (getaddrinfo(config->host, port, &hints, &res) != 0 || res == NULL) {
+        ESP_LOGW(LOG_TAG, "Failed to resolve %s.", config->host);
+        return -1;
+    }
+
+    int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (fd < 0) {
+        freeaddrinfo(res);
+        return -1;
+    }
+
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+
+    int ret = connect(fd, res->ai_addr, res->ai_addrlen);
+    freeaddrinfo(res);
+
+    if (ret != 0 && errno == EINPROGRESS) {
+        fd_set write_fds;
+        FD_ZERO(&write_fds);
+        FD_SET(fd, &write_fds);
+
+        struct timeval timeout = {.tv_sec = APP_NTRIP_CLIENT_CONNECT_TIMEOUT, .tv_usec = 0};
+
+        int       err     = ETIMEDOUT;
+        socklen_t err_len = sizeof(err);
+        if (select(fd + 1, NULL, &write_fds, NULL, &timeout) > 0) {
+            getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &err_len);
+        }
+
+        ret   = (err == 0) ? 0 : -1;
+        errno = err;
+    }
+
+    if (ret != 0) {
+        ESP_LOGW(LOG_TAG, "Failed to connect to %s:%u, errno: %d", config->host, config->port, errno);
+        close(fd);
+        return -1;
+    }
+
+    const int nodelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+    return fd;
+}
+
+/**
+ * Ask for the mountpoint as NTRIP 2, casters that only speak NTRIP 1 answer with ICY 200 OK. Stream bytes that
+ * arrived with the header are passed on before returning.
+ */
+static int app_ntrip_client_request(app_ntrip_client_state_t *state, const app_ntrip_client_config_t *config) {
+    app_ntrip_client_session_t *session = &state->session;
+
+    char   *header = (char *)session->buf;
+    int     len;
+    int64_t deadline;
+
+    /* ---- Request ---- */
+    len = snprintf(header, sizeof(session->buf),
+                   "GET /%s HTTP/1.1\r\n"
+                   "Host: %s\r\n"
+                   "Ntrip-Version: Ntrip/2.0\r\n"
+                   "User-Agent: " APP_NTRIP_CLIENT_AGENT "\r\n"
+                   "Connection: close\r\n",
+                   config->mountpoint, config->host);
+
+    if (config->username[0] != '\0') {
+        char   plain[sizeof(config->username) + sizeof(config->password)];
+        size_t encoded_len;
+
+        const int plain_len = snprintf(plain, sizeof(plain), "%s:%s", config->username, config->password);
+
+        len += snprintf(&header[len], sizeof(session->buf) - len, "Authorization: Basic ");
+        if (mbedtls_base64_encode((unsigned char *)&header[len], sizeof(session->buf) - len, &encoded_len,
+                                  (const unsigned char *)plain, plain_len) != 0) {
+            return -1;
+        }
+        len += encoded_len;
+        len += snprintf(&header[len], sizeof(session->buf) - len, "\r\n");
+    }
+
+    len += snprintf(&header[len], sizeof(session->buf) - len, "\r\n");
+    if (len >= (int)sizeof(session->buf) - 1 || send(session->fd, header, len, 0) != len) {
+        ESP_LOGW(LOG_TAG, "Failed to send request.");
+        return -1;
+    }
+
+    /* ---- Response header ---- */
+    size_t received   = 0;
+    int    header_len = 0;
+
+    deadline = esp_timer_get_time() + APP_NTRIP_CLIENT_CONNECT_TIMEOUT * 1000000LL;
+
+    while (header_len == 0) {
+        const int64_t left_us = deadline - esp_timer_get_time();
+        if (left_us <= 0 || received == sizeof(session->buf) - 1) {
+            ESP_LOGW(LOG_TAG, "No valid response from the caster.");
+            return -1;
+        }
+
+        fd_set read_fds;
+        FD_ZERO(&read_fds);
+        FD_SET(session->fd, &read_fds);
+
+        struct timeval timeout = {.tv_sec = left_us / 1000000, .tv_usec = left_us % 1000000};
+        if (select(session->fd + 1, &read_fds, NULL, NULL, &timeout) <= 0) {
+            continue;
+        }
+
+        len = recv(session->fd, &header[received], sizeof(session->buf) - 1 - received, MSG_DONTWAIT);
+        if (len == 0 || (len < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+            ESP_LOGW(LOG_TAG, "Connection closed during the response.");
+            return -1;
+        }
+
+        if (len > 0) {
+            received += len;
+            header[received] = '\0';
+            header_len       = app_ntrip_stream_response(&session->stream, header);
+        }
+    }
+
+    /* ---- Status ---- */
+    if (header_len == -1) {
+        ESP_LOGW(LOG_TAG, "Mountpoint /%s not found.", config->mountpoint);
+        return -1;
+    }
+
+    if (header_len < 0) {
+        ESP_LOGW(LOG_TAG, "Caster refused: %.*s", (int)strcspn(header, "\r\n"), header);
+        return -1;
+    }
+
+    if (received > (size_t)header_len) {
+        return app_ntrip_stream_input(&session->stream, &session->buf[header_len], received - header_len);
+    }
+
+    return 0;
+}
+
+/* Runs between reads. The first GGA goes out right after connecting, as VRS casters wait for it. */
+static void app_ntrip_client_gga_send(app_ntrip_client_state_t *state, const app_ntrip_client_config_t *config) {
+    app_ntrip_client_session_t *session = &state->session;
+
+    if (config->gga_interval_s == 0) {
+        return;
+    }
+
+    const int64_t now = esp_timer_get_time();
+    if (session->gga_us != 0 && now - session->gga_us < config->gga_interval_s * 1000000LL) {
+        return;
+    }
+
+    char   gga[APP_NTRIP_CLIENT_GGA_MAX];
+    size_t gga_len = 0;
+
+    xSemaphoreTake(state->mutex, portMAX_DELAY);
+    if (state->gga_len > 0 && now - state->gga_us < APP_NTRIP_CLIENT_GGA_MAX_AGE * 1000000LL) {
+        memcpy(gga, state->gga, state->gga_len);
+        gga_len = state->gga_len;
+    }
+    xSemaphoreGive(state->mutex);
+
+    if (gga_len == 0) {
+        return;
+    }
+
+    session->gga_us = now;
+
+    if (send(session->fd, gga, gga_len, MSG_DONTWAIT) == (int)gga_len) {
+        xSemaphoreTake(state->mutex, portMAX_DELAY);
+        state->stats.gga_sent++;
+        xSemaphoreGive(state->mutex);
+    }
+}
+
+/**
+ * Straight into the GNSS UART, a whole frame per write so a PAIR command from the GNSS server can only go out between
+ * two frames. Frames reach here with their CRC already checked.
+ */
+static void app_ntrip_client_deliver(void *ctx, const uint8_t *frame, size_t len) {
+    app_ntrip_client_state_t   *state   = ctx;
+    app_ntrip_client_session_t *session = &state->session;
+
+    /* Nothing to correct before bring-up, the stream goes on regardless */
+    app_gnss_server_correction_write(frame, len);
+
+    const int64_t now = esp_timer_get_time();
+
+    session->delivered = true;
+
+    xSemaphoreTake(state->mutex, portMAX_DELAY);
+
+    state->stats.bytes += len;
+    state->stats.frames++;
+    state->stats.last_type = ((uint16_t)frame[3] << 4U) | (frame[4] >> 4U);
+    state->frame_us        = now;
+
+    if (now - state->meter_us >= 1000000) {
+        state->stats.bytes_per_sec = (now - state->meter_us < 2000000) ? state->meter_bytes : 0;
+        state->meter_us            = now;
+        state->meter_bytes         = 0;
+    }
+    state->meter_bytes += len;
+
+    xSemaphoreGive(state->mutex);
+}
+
+static int app_ntrip_client_config_load(app_ntrip_client_config_t *config) {
+    esp_err_t err;
+
+    /* ---- Create NVS handle ---- */
+    nvs_handle handle;
+    err = nvs_open(APP_NTRIP_CLIENT_NVS_NAMESPACE, NVS_READONLY, &handle);
+    if (err != ESP_OK) {
+        return -1;
+    }
+
+    /* Check NVS data flag */
+
+    uint8_t cfg_flag;
+    if (nvs_get_u8(handle, APP_NTRIP_CLIENT_CFG_KEY_FLAG, &cfg_flag) != ESP_OK ||
+        cfg_flag > APP_NTRIP_CLIENT_NVS_VERSION) {
+        nvs_close(handle);
+        return -1;
+    }
+
+    /* ---- Load configuration ---- */
+    uint8_t enabled;
+    size_t  len;
+    ESP_ERROR_CHECK(nvs_get_u8(handle, APP_NTRIP_CLIENT_CFG_KEY_ENABLED, &enabled));
+    config->enabled = enabled;
+
+    len = sizeof(config->host);
+    ESP_ERROR_CHECK(nvs_get_str(handle, APP_NTRIP_CLIENT_CFG_KEY_HOST, config->host, &len));
+    ESP_ERROR_CHECK(nvs_get_u16(handle, APP_NTRIP_CLIENT_CFG_KEY_PORT, &config->port));
+    len = sizeof(config->mountpoint);
+    ESP_ERROR_CHECK(nvs_get_str(handle, APP_NTRIP_CLIENT_CFG_KEY_MOUNT, config->mountpoint, &len));
+    len = sizeof(config->username);
+    ESP_ERROR_CHECK(nvs_get_str(handle, APP_NTRIP_CLIENT_CFG_KEY_USER, config->username, &len));
+    len = sizeof(config->password);
+    ESP_ERROR_CHECK(nvs_get_str(handle, APP_NTRIP_CLIENT_CFG_KEY_PASS, config->password, &len));
+    ESP_ERROR_CHECK(nvs_get_u16(handle, APP_NTRIP_CLIENT_CFG_KEY_GGA, &config->gga_interval_s));
+
+    /* ---- Close NVS handle ---- */
+    nvs_close(handle);
+
+    return 0;
+}
+
+static void app_ntrip_client_config_store(const app_ntrip_client_config_t *config) {
+    /* ---- Create NVS handle ---- */
+    nvs_handle handle;
+    ESP_ERROR_CHECK(nvs_open(APP_NTRIP_CLIENT_NVS_NAMESPACE, NVS_READWRITE, &handle));
+
+    /* ---- Store configuration ---- */
+    ESP_ERROR_CHECK(nvs_set_u8(handle, APP_NTRIP_CLIENT_CFG_KEY_FLAG, APP_NTRIP_CLIENT_NVS_VERSION));
+
+    ESP_ERROR_CHECK(nvs_set_u8(handle, APP_NTRIP_CLIENT_CFG_KEY_ENABLED, config->enabled));
+    ESP_ERROR_CHECK(nvs_set_str(handle, APP_NTRIP_CLIENT_CFG_KEY_HOST, config->host));
+    ESP_ERROR_CHECK(nvs_set_u16(handle, APP_NTRIP_CLIENT_CFG_KEY_PORT, config->port));
+    ESP_ERROR_CHECK(nvs_set_str(handle, APP_NTRIP_CLIENT_CFG_KEY_MOUNT, config->mountpoint));
+    ESP_ERROR_CHECK(nvs_set_str(handle, APP_NTRIP_CLIENT_CFG_KEY_USER, config->username));
+    ESP_ERROR_CHECK(nvs_set_str(handle, APP_NTRIP_CLIENT_CFG_KEY_PASS, config->password));
+    ESP_ERROR_CHECK(nvs_set_u16(handle, APP_NTRIP_CLIENT_CFG_KEY_GGA, config->gga_interval_s));
+
+    /* ---- Commit and close NVS handle ---- */
+    ESP_ERROR_CHECK(nvs_commit(handle));
+    nvs_close(handle);
+}
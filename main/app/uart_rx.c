@@ -0,0 +1,73 @@
+/* IDF */
+#include "esp_log.h"
+#include "freertos/task.h"
+
+/* App */
+#include "app/uart_rx.h"
+
+static const char *LOG_TAG = "asuna_uart";
+
+int app_uart_rx_config_apply(uart_port_t port, const app_uart_rx_config_t *config) {
+    if (uart_set_rx_full_threshold(port, config->rx_full_threshold) != ESP_OK) {
+        ESP_LOGE(LOG_TAG, "UART%d: invalid RX full threshold %u", port, config->rx_full_threshold);
+        return -1;
+    }
+
+    if (uart_set_rx_timeout(port, config->rx_timeout) != ESP_OK) {
+        ESP_LOGE(LOG_TAG, "UART%d: invalid RX timeout %u", port, config->rx_timeout);
+        return -2;
+    }
+
+    if (config->pattern_chr != 0) {
+        /* Single character, default gap timings in baud cycles */
+        if (uart_enable_pattern_det_baud_intr(port, config->pattern_chr, 1, 9, 0, 0) != ESP_OK) {
+            return -3;
+        }
+
+        uart_pattern_queue_reset(port, config->queue_size);
+    } else {
+        uart_disable_pattern_det_intr(port);
+    }
+
+    ESP_LOGI(LOG_TAG, "UART%d RX: full threshold %u, timeout %u symbols, pattern 0x%02x", port,
+             config->rx_full_threshold, config->rx_timeout, (uint8_t)config->pattern_chr);
+
+    return 0;
+}
+
+void app_uart_rx_meter_init(app_uart_rx_meter_t *meter) {
+    meter->stats.wakeups          = 0;
+    meter->stats.bytes            = 0;
+    meter->stats.wakeups_per_sec  = 0;
+    meter->stats.bytes_per_wakeup = 0;
+
+    meter->window_start   = xTaskGetTickCount();
+    meter->window_wakeups = 0;
+    meter->window_bytes   = 0;
+}
+
+void app_uart_rx_meter_wakeup(app_uart_rx_meter_t *meter, size_t bytes) {
+    const TickType_t now = xTaskGetTickCount();
+
+    meter->stats.wakeups++;
+    meter->stats.bytes += bytes;
+
+    meter->window_wakeups++;
+    meter->window_bytes += bytes;
+
+    const TickType_t elapsed = now - meter->window_start;
+
+    if (elapsed >= pdMS_TO_TICKS(1000)) {
+        /* Normalize, the window closes on the first wakeup after one second */
+        meter->stats.wakeups_per_sec  = (uint64_t)meter->window_wakeups * pdMS_TO_TICKS(1000) / elapsed;
+        meter->stats.bytes_per_wakeup = meter->window_bytes / meter->window_wakeups;
+
+        meter->window_start   = now;
+        meter->window_wakeups = 0;
+        meter->window_bytes   = 0;
+    }
+}
+
+void app_uart_rx_meter_get(const app_uart_rx_meter_t *meter, app_uart_rx_stats_t *stats) {
+    *stats = meter->stats;
+}
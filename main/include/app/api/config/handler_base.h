@@ -0,0 +1,7 @@
+#ifndef APP_API_CONFIG_HANDLER_BASE_H
+#define APP_API_CONFIG_HANDLER_BASE_H
+
+extern const httpd_uri_t app_api_config_handler_base_get_uri;
+extern const httpd_uri_t app_api_config_handler_base_post_uri;
+
+#endif  // APP_API_CONFIG_HANDLER_BASE_H
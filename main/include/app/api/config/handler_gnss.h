@@ -0,0 +1,7 @@
+#ifndef APP_API_CONFIG_HANDLER_GNSS_H
+#define APP_API_CONFIG_HANDLER_GNSS_H
+
+extern const httpd_uri_t app_api_config_handler_gnss_get_uri;
+extern const httpd_uri_t app_api_config_handler_gnss_post_uri;
+
+#endif  // APP_API_CONFIG_HANDLER_GNSS_H
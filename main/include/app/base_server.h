@@ -0,0 +1,50 @@
+#ifndef APP_BASE_SERVER_H
+#define APP_BASE_SERVER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Survey-in limits, app_base_server_survey_start() refuses anything longer or looser */
+#define APP_BASE_SURVEY_DURATION_MAX (7U * 86400U) /* s, for both durations */
+#define APP_BASE_SURVEY_ACCURACY_MAX (100000U)     /* mm */
+
+typedef enum {
+    APP_BASE_SURVEY_IDLE = 0,
+    APP_BASE_SURVEY_RUNNING,
+    APP_BASE_SURVEY_DONE,   /* Position stored */
+    APP_BASE_SURVEY_FAILED, /* Maximum duration reached before the accuracy limit */
+} app_base_survey_state_t;
+
+typedef struct {
+    uint32_t min_duration_s;
+    uint32_t max_duration_s; /* 0 for no limit */
+    uint32_t accuracy_mm;    /* 3D standard deviation of the averaged fixes */
+    uint8_t  min_quality;    /* Lowest GGA fix quality accepted */
+} app_base_survey_config_t;
+
+typedef struct {
+    app_base_survey_state_t state;
+    uint32_t                samples;
+    uint32_t                elapsed_s;
+    uint32_t                accuracy_mm; /* UINT32_MAX until two fixes are averaged */
+    double                  ecef[3];     /* Current mean, m */
+} app_base_survey_status_t;
+
+/* Antenna reference point, ECEF, stored in NVS. */
+typedef struct {
+    bool     valid;
+    double   ecef[3]; /* m, kept at 0.1 mm resolution */
+    uint32_t accuracy_mm;
+    uint32_t samples; /* Fixes averaged, 0 if entered manually */
+} app_base_position_t;
+
+int  app_base_server_init(void);
+void app_base_server_survey_config_init(app_base_survey_config_t *config);
+/* Returns -1 for a configuration out of the survey limits, -2 if the GNSS feed cannot be set up */
+int  app_base_server_survey_start(const app_base_survey_config_t *config);
+void app_base_server_survey_stop(void);
+void app_base_server_survey_status_get(app_base_survey_status_t *status);
+int  app_base_server_position_get(app_base_position_t *position);
+int  app_base_server_position_set(const app_base_position_t *position);
+
+#endif  // APP_BASE_SERVER_H
@@ -0,0 +1,6 @@
+#ifndef CMD_BASE_H
+#define CMD_BASE_H
+
+extern const esp_console_cmd_t app_console_cmd_base;
+
+#endif //CMD_BASE_H
@@ -0,0 +1,6 @@
+#ifndef APP_CONSOLE_CMD_LTE_H
+#define APP_CONSOLE_CMD_LTE_H
+
+extern const esp_console_cmd_t app_console_cmd_lte;
+
+#endif //APP_CONSOLE_CMD_LTE_H
@@ -0,0 +1,6 @@
+#ifndef CMD_NMEA_H
+#define CMD_NMEA_H
+
+extern const esp_console_cmd_t app_console_cmd_nmea;
+
+#endif //CMD_NMEA_H
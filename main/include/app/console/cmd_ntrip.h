@@ -0,0 +1,6 @@
+#ifndef CMD_NTRIP_H
+#define CMD_NTRIP_H
+
+extern const esp_console_cmd_t app_console_cmd_ntrip;
+
+#endif //CMD_NTRIP_H
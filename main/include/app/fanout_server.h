@@ -0,0 +1,102 @@
+#ifndef APP_FANOUT_SERVER_H
+#define APP_FANOUT_SERVER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* IDF */
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+
+/* App */
+#include "app/gnss/fanout_ring.h"
+
+typedef struct app_fanout_server app_fanout_server_t;
+
+typedef struct {
+    const char *log_tag;
+    const char *task_name;
+    uint32_t    task_stack;
+    uint16_t    port;
+    size_t      max_clients;
+    uint32_t    buffer_size; /* Fan-out ring, must be a power of 2 */
+    uint32_t    window;      /* Bytes a client may fall behind the head before it is dropped */
+    uint32_t    select_ms;   /* Upper bound between two rounds of the server task */
+    void       *ctx;         /* Owner state, handed back through app_fanout_server_t */
+
+    /* Optional, under the mutex before every select(). May shorten timeout. */
+    void (*poll)(app_fanout_server_t *server, struct timeval *timeout);
+
+    /*
+     * Optional, every round for each client that is not streaming yet, until it calls app_fanout_server_stream(),
+     * app_fanout_server_reject() or app_fanout_server_close(). Accepted clients stream right away without it.
+     */
+    void (*request)(app_fanout_server_t *server, size_t index, bool readable, int64_t now_us);
+
+    /* Optional, under the mutex: the client has bytes of its own to send besides the ring */
+    bool (*unsent)(app_fanout_server_t *server, size_t index);
+
+    /*
+     * Under the mutex: send what is pending to a streaming client without blocking. Returns 0 while the client keeps
+     * up, -1 if the connection failed and -2 if it fell behind its window (see app_fanout_server_pending()).
+     */
+    int (*flush)(app_fanout_server_t *server, size_t index);
+} app_fanout_server_config_t;
+
+typedef struct {
+    int      fd;        /* -1 for a free slot */
+    bool     streaming; /* Sent from the ring, otherwise still handled by the request hook */
+    uint32_t pos;       /* Next byte of the fan-out ring to send */
+    int64_t  since_us;  /* Accepted */
+} app_fanout_server_client_t;
+
+typedef struct {
+    uint8_t  clients;   /* Clients currently streaming */
+    uint32_t accepted;  /* Connections that got the stream */
+    uint32_t rejected;  /* Connections refused, for lack of a free slot or by the request hook */
+    uint32_t slow;      /* Clients disconnected for falling behind their window */
+    uint32_t bytes_in;  /* Bytes written to the ring */
+    uint32_t bytes_out; /* Bytes sent to all clients, counted by the flush hook */
+} app_fanout_server_stats_t;
+
+/**
+ * TCP server streaming one fan-out ring to many clients from a single task.
+ * The task waits in select() on the listening socket, the clients and an eventfd the producer signals through
+ * app_fanout_server_write() or app_fanout_server_wake(). The mutex guards the ring, the client positions and the
+ * stats, owners may guard their own state with it as well.
+ */
+struct app_fanout_server {
+    app_fanout_server_config_t config;
+
+    TaskHandle_t      task;
+    SemaphoreHandle_t mutex;
+
+    int listen_fd;
+    int event_fd;
+
+    app_gnss_fanout_ring_t      ring;
+    app_fanout_server_client_t *clients; /* config.max_clients slots */
+    app_fanout_server_stats_t   stats;
+};
+
+/* Sets up the ring and the sockets, the task only runs after app_fanout_server_start(). */
+int  app_fanout_server_init(app_fanout_server_t *server, const app_fanout_server_config_t *config);
+int  app_fanout_server_start(app_fanout_server_t *server);
+void app_fanout_server_deinit(app_fanout_server_t *server);
+
+/* Producer side, under the mutex. Writes wake the task only while clients are streaming. */
+void app_fanout_server_write(app_fanout_server_t *server, const uint8_t *data, size_t len);
+void app_fanout_server_wake(app_fanout_server_t *server);
+
+/* Bytes a streaming client has left to send from the ring, false if it was lapped or fell behind its window */
+bool app_fanout_server_pending(const app_fanout_server_t *server, size_t index, size_t *pending);
+
+/* Server task only, from the hooks */
+void app_fanout_server_stream(app_fanout_server_t *server, size_t index);
+void app_fanout_server_reject(app_fanout_server_t *server, size_t index);
+void app_fanout_server_close(app_fanout_server_t *server, size_t index);
+
+#endif  // APP_FANOUT_SERVER_H
@@ -0,0 +1,19 @@
+#ifndef APP_GNSS_ASYNC_CONSUMER_H
+#define APP_GNSS_ASYNC_CONSUMER_H
+
+/* App */
+#include "app/gnss_server.h"
+
+/**
+ * Asynchronous delivery context of one GNSS consumer.
+ * Events are serialized into a bounded ring by the dispatching task and replayed to the
+ * callback from a dedicated task, subject to the configured overflow policy.
+ */
+typedef struct app_gnss_async app_gnss_async_t;
+
+app_gnss_async_t *app_gnss_async_create(const app_gnss_async_config_t *config, app_gnss_cb_t cb, void *user_data);
+void              app_gnss_async_destroy(app_gnss_async_t *async);
+void              app_gnss_async_enqueue(app_gnss_async_t *async, app_gnss_cb_type_t type, const void *payload);
+void              app_gnss_async_stats_get(app_gnss_async_t *async, app_gnss_async_stats_t *stats);
+
+#endif  // APP_GNSS_ASYNC_CONSUMER_H
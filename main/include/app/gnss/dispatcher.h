@@ -0,0 +1,72 @@
+#ifndef APP_GNSS_DISPATCHER_H
+#define APP_GNSS_DISPATCHER_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* IDF */
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+/* App */
+#include "app/gnss/async_consumer.h"
+#include "app/gnss_server.h"
+
+#define APP_GNSS_DISPATCHER_TYPE_COUNT (6) /* Number of bits in app_gnss_cb_type_t */
+
+typedef struct {
+    app_gnss_cb_type_t type;
+    app_gnss_cb_t      cb;
+    void              *user_data;
+    app_gnss_async_t  *async; /* NULL for consumers called synchronously from the dispatching task */
+} app_gnss_consumer_t;
+
+/*
+ * Immutable consumer snapshot. Updates build a new set, publish it atomically and only free the old one once every
+ * dispatcher that could still be reading it has left.
+ */
+typedef struct {
+    size_t                count;
+    size_t                type_count[APP_GNSS_DISPATCHER_TYPE_COUNT];
+    app_gnss_consumer_t **type_consumers[APP_GNSS_DISPATCHER_TYPE_COUNT]; /* Per event type, points into consumers[] */
+    app_gnss_consumer_t  *consumers[]; /* All consumers, followed by the per-type arrays */
+} app_gnss_consumer_set_t;
+
+/**
+ * Event fan-out to the registered consumers.
+ * Dispatch never takes a lock: readers announce themselves on one of two epoch slots, and an update waits for the
+ * readers of the previous epoch to drain before it frees the set they may still hold.
+ */
+typedef struct {
+    SemaphoreHandle_t mutex; /* Serializes updates */
+
+    _Atomic(app_gnss_consumer_set_t *) set;
+    atomic_uint                        mask; /* Union of subscribed types, lets producers skip work */
+    atomic_uint                        epoch;
+    atomic_uint                        readers[2];
+} app_gnss_dispatcher_t;
+
+/* Returns 0 on success, -1 if the mutex or the empty set could not be allocated. */
+int app_gnss_dispatcher_init(app_gnss_dispatcher_t *dispatcher);
+
+/**
+ * Publish a new set with add appended and/or remove left out, either may be NULL.
+ * Once this returns no dispatch can still see remove, so the caller may free it.
+ * Returns 0 on success, -2 on allocation failure, -3 if remove is not registered.
+ */
+int app_gnss_dispatcher_update(app_gnss_dispatcher_t *dispatcher, app_gnss_consumer_t *add,
+                               app_gnss_consumer_t *remove);
+
+/* True if any consumer subscribed to one of the types in the mask */
+static inline bool app_gnss_dispatcher_subscribed(app_gnss_dispatcher_t *dispatcher, app_gnss_cb_type_t type) {
+    return (atomic_load_explicit(&dispatcher->mask, memory_order_relaxed) & type) != 0;
+}
+
+/**
+ * Only consumers subscribed to this event type are visited. Callers are expected to check
+ * app_gnss_dispatcher_subscribed() first so payloads nobody reads are never built.
+ */
+void app_gnss_dispatcher_dispatch(app_gnss_dispatcher_t *dispatcher, app_gnss_cb_type_t type, void *data);
+
+#endif  // APP_GNSS_DISPATCHER_H
@@ -0,0 +1,30 @@
+#ifndef APP_GNSS_FANOUT_RING_H
+#define APP_GNSS_FANOUT_RING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Single-writer byte log shared by any number of readers.
+ * The writer never waits: it overwrites the oldest bytes. Each reader only keeps its free-running position in the
+ * stream and sends straight out of the ring, so the data exists once however many readers there are. A reader the
+ * writer has lapped lost data and has to be dropped or resynchronized. Callers serialize access.
+ */
+typedef struct {
+    uint8_t *buf;
+    uint32_t size; /* Must be a power of 2 */
+    uint32_t head; /* Free-running write index */
+} app_gnss_fanout_ring_t;
+
+void     app_gnss_fanout_ring_init(app_gnss_fanout_ring_t *ring, uint8_t *buf, uint32_t size);
+void     app_gnss_fanout_ring_write(app_gnss_fanout_ring_t *ring, const uint8_t *data, size_t len);
+uint32_t app_gnss_fanout_ring_head(const app_gnss_fanout_ring_t *ring);
+
+/* Bytes between pos and the head, false if the writer lapped pos */
+bool app_gnss_fanout_ring_pending(const app_gnss_fanout_ring_t *ring, uint32_t pos, size_t *pending);
+
+/* Contiguous readable span at pos, 0 if nothing is pending or pos was lapped */
+size_t app_gnss_fanout_ring_read_span(const app_gnss_fanout_ring_t *ring, uint32_t pos, const uint8_t **ptr);
+
+#endif  // APP_GNSS_FANOUT_RING_H
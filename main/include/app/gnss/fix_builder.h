@@ -0,0 +1,45 @@
+#ifndef APP_GNSS_FIX_BUILDER_H
+#define APP_GNSS_FIX_BUILDER_H
+
+#include <stdbool.h>
+
+/* App */
+#include "app/gnss_server.h"
+
+/* nl */
+#include "rcv/nl_nmea_index.h"
+
+#define APP_GNSS_FIX_BUILDER_USED_MAX (48)
+
+/**
+ * Epoch flush handler. sat is NULL when no satellite table was built for the epoch.
+ */
+typedef void (*app_gnss_fix_builder_cb_t)(void *ctx, const app_gnss_fix_t *fix, const app_gnss_sat_t *sat);
+
+/**
+ * Merges the NMEA sentences of one navigation epoch into a fix record and a satellite table.
+ * An epoch ends when a sentence with a different UTC time arrives or when the caller
+ * flushes explicitly, e.g. once the receiver goes idle after its output burst.
+ */
+typedef struct {
+    app_gnss_fix_builder_cb_t cb;
+    void                     *ctx;
+
+    bool           has_epoch;
+    nl_nmea_time_t epoch;
+
+    app_gnss_fix_t fix;
+    app_gnss_sat_t sat;
+    bool           sat_seen;
+
+    /* Satellites listed by GSA, resolved against the table when the epoch is flushed */
+    uint8_t  used_count;
+    uint8_t  used_constellation[APP_GNSS_FIX_BUILDER_USED_MAX];
+    uint16_t used_prn[APP_GNSS_FIX_BUILDER_USED_MAX];
+} app_gnss_fix_builder_t;
+
+void app_gnss_fix_builder_init(app_gnss_fix_builder_t *b, app_gnss_fix_builder_cb_t cb, void *ctx);
+void app_gnss_fix_builder_feed(app_gnss_fix_builder_t *b, const nl_nmea_index_t *idx, bool want_sats);
+void app_gnss_fix_builder_flush(app_gnss_fix_builder_t *b);
+
+#endif  // APP_GNSS_FIX_BUILDER_H
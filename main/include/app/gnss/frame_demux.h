@@ -0,0 +1,42 @@
+#ifndef APP_GNSS_FRAME_DEMUX_H
+#define APP_GNSS_FRAME_DEMUX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define APP_GNSS_DEMUX_NMEA_MAX_LEN  (256)          /* Including "$" and "\r\n" */
+#define APP_GNSS_DEMUX_RTCM3_MAX_LEN (3 + 1023 + 3) /* Header, payload and CRC */
+
+typedef enum {
+    APP_GNSS_FRAME_NMEA,
+    APP_GNSS_FRAME_RTCM3,
+} app_gnss_frame_type_t;
+
+/**
+ * Frame handler, called with a candidate frame delimited by the framing rules only.
+ * Return true if the frame decoded, false to reject it and resync from the next byte.
+ */
+typedef bool (*app_gnss_frame_cb_t)(void *ctx, app_gnss_frame_type_t type, const uint8_t *frame, size_t len);
+
+typedef struct {
+    uint32_t nmea_frames;   /* Accepted NMEA sentences */
+    uint32_t rtcm_frames;   /* Accepted RTCM3 frames */
+    uint32_t rejected;      /* Candidates rejected by framing or decoder */
+    uint32_t skipped_bytes; /* Bytes discarded while hunting for a frame start */
+} app_gnss_demux_stats_t;
+
+typedef struct {
+    app_gnss_frame_cb_t cb;
+    void               *ctx;
+
+    size_t  len;
+    uint8_t frame[APP_GNSS_DEMUX_RTCM3_MAX_LEN];
+
+    app_gnss_demux_stats_t stats;
+} app_gnss_demux_t;
+
+void app_gnss_demux_init(app_gnss_demux_t *demux, app_gnss_frame_cb_t cb, void *ctx);
+void app_gnss_demux_input(app_gnss_demux_t *demux, const uint8_t *data, size_t len);
+
+#endif  // APP_GNSS_FRAME_DEMUX_H
@@ -0,0 +1,37 @@
+#ifndef APP_GNSS_INGEST_RING_H
+#define APP_GNSS_INGEST_RING_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    uint32_t bytes_in; /* Total bytes committed by the producer */
+    uint32_t chunks;   /* Total chunks handed to the consumer */
+} app_gnss_ingest_stats_t;
+
+/**
+ * Single-producer single-consumer byte ring.
+ * Both sides work on contiguous spans of at most chunk_size bytes, so data can be
+ * read into and parsed out of the ring in place without any intermediate copy.
+ */
+typedef struct {
+    uint8_t *buf;
+    uint32_t size; /* Must be a power of 2 */
+    uint32_t chunk_size;
+
+    atomic_uint_fast32_t head; /* Free-running write index */
+    atomic_uint_fast32_t tail; /* Free-running read index */
+
+    app_gnss_ingest_stats_t stats;
+} app_gnss_ingest_ring_t;
+
+void   app_gnss_ingest_ring_init(app_gnss_ingest_ring_t *ring, uint8_t *buf, uint32_t size, uint32_t chunk_size);
+void   app_gnss_ingest_ring_reset(app_gnss_ingest_ring_t *ring);
+size_t app_gnss_ingest_ring_used(app_gnss_ingest_ring_t *ring);
+size_t app_gnss_ingest_ring_write_span(app_gnss_ingest_ring_t *ring, uint8_t **ptr);
+void   app_gnss_ingest_ring_commit(app_gnss_ingest_ring_t *ring, size_t len);
+size_t app_gnss_ingest_ring_read_span(app_gnss_ingest_ring_t *ring, const uint8_t **ptr);
+void   app_gnss_ingest_ring_consume(app_gnss_ingest_ring_t *ring, size_t len);
+
+#endif  // APP_GNSS_INGEST_RING_H
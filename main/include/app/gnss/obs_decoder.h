@@ -0,0 +1,54 @@
+#ifndef APP_GNSS_OBS_DECODER_H
+#define APP_GNSS_OBS_DECODER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* App */
+#include "app/gnss_server.h"
+
+/* nl */
+#include "rcv/nl_msm.h"
+
+#define APP_GNSS_OBS_TRACK_SLOTS  (256)     /* Signals followed for slip detection, across all constellations */
+#define APP_GNSS_OBS_TRACK_EXPIRY (5000000) /* us without an observation before a slot is reused */
+
+typedef struct {
+    uint16_t key; /* Constellation, satellite and signal, 0 if the slot is free */
+    bool     phase_valid;
+    uint8_t  half_cycle;
+    uint32_t lock_ms;
+    int64_t  seen_us;
+} app_gnss_obs_track_t;
+
+typedef struct {
+    uint32_t messages;  /* MSM4/MSM7 messages decoded */
+    uint32_t errors;    /* Malformed MSM messages */
+    uint32_t slips;     /* Cells flagged APP_GNSS_OBS_SLIP */
+    uint32_t losses;    /* Cells flagged APP_GNSS_OBS_LOCK_LOST */
+    uint32_t untracked; /* Cells without a free slot, no slip detection for them */
+} app_gnss_obs_decoder_stats_t;
+
+/**
+ * Decodes MSM4/MSM7 frames into per-signal observations and flags cycle slips and lock losses by comparing each
+ * signal's lock time, half-cycle state and phase availability against its previous observation.
+ * Not thread-safe, feed it from one task.
+ */
+typedef struct {
+    nl_msm_t                     msm;
+    app_gnss_obs_t               obs;
+    app_gnss_obs_track_t         track[APP_GNSS_OBS_TRACK_SLOTS];
+    app_gnss_obs_decoder_stats_t stats;
+} app_gnss_obs_decoder_t;
+
+void app_gnss_obs_decoder_init(app_gnss_obs_decoder_t *dec);
+
+/**
+ * Decode one complete RTCM3 frame. Returns the observations, valid until the next call, or NULL if the frame is not
+ * an MSM4/MSM7 message or is malformed.
+ */
+const app_gnss_obs_t *app_gnss_obs_decoder_feed(app_gnss_obs_decoder_t *dec, const uint8_t *frame, size_t len,
+                                                int64_t now_us);
+
+#endif  // APP_GNSS_OBS_DECODER_H
@@ -0,0 +1,57 @@
+#ifndef APP_GNSS_PARSER_H
+#define APP_GNSS_PARSER_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* IDF */
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+/* App */
+#include "app/gnss/fix_builder.h"
+#include "app/gnss/frame_demux.h"
+
+typedef enum {
+    APP_GNSS_PARSER_LIVE,   /* Receiver output */
+    APP_GNSS_PARSER_REPLAY, /* A recording played back in its place */
+} app_gnss_parser_source_t;
+
+/**
+ * Frame demux and fix builder shared by the live receive path and a replay.
+ * A replay owns the parser from app_gnss_parser_replay_begin() to app_gnss_parser_replay_end(), live input is
+ * dropped meanwhile. Ownership is checked under the mutex, so live input that raced the start of a replay is dropped
+ * as well instead of landing between recorded frames.
+ */
+typedef struct {
+    SemaphoreHandle_t mutex; /* Held while the demux or fix builder runs, frame callbacks run under it */
+    atomic_bool       replay;
+
+    app_gnss_demux_t       demux;
+    app_gnss_fix_builder_t fix_builder;
+
+    uint32_t live_dropped; /* Live chunks dropped while a replay owned the parser */
+} app_gnss_parser_t;
+
+/* Returns 0 on success, -1 if the mutex could not be created. */
+int app_gnss_parser_init(app_gnss_parser_t *parser, app_gnss_frame_cb_t frame_cb, app_gnss_fix_builder_cb_t epoch_cb,
+                         void *ctx);
+
+/**
+ * Feed a chunk, then flush the fix builder if the port went idle after it. data may be NULL when len is 0.
+ * Live input is dropped while a replay owns the parser. Returns false if the chunk was dropped.
+ */
+bool app_gnss_parser_input(app_gnss_parser_t *parser, app_gnss_parser_source_t source, const uint8_t *data,
+                           size_t len, bool idle);
+
+/* Waits for live input in progress to leave the parser. Returns -1 if a replay already owns it. */
+int  app_gnss_parser_replay_begin(app_gnss_parser_t *parser);
+void app_gnss_parser_replay_end(app_gnss_parser_t *parser);
+
+static inline bool app_gnss_parser_replaying(app_gnss_parser_t *parser) {
+    return atomic_load(&parser->replay);
+}
+
+#endif  // APP_GNSS_PARSER_H
@@ -0,0 +1,29 @@
+#ifndef APP_GNSS_RECORDER_H
+#define APP_GNSS_RECORDER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    bool     active;
+    uint32_t chunks;        /* Records queued */
+    uint32_t bytes;         /* Stream bytes queued */
+    uint32_t dropped_bytes; /* Stream bytes lost to a full write buffer */
+    uint32_t file_bytes;    /* Bytes written to the file, headers included */
+} app_gnss_recorder_stats_t;
+
+/**
+ * Record the raw GNSS UART stream with chunk timestamps in the nl_rawlog format.
+ * The receive path only copies into a bounded buffer, a separate task writes the file. Recording stops on its own
+ * once the file reaches max_bytes (0 for no limit) or on a write error.
+ */
+int  app_gnss_recorder_start(const char *path, uint32_t max_bytes);
+void app_gnss_recorder_stop(void);
+void app_gnss_recorder_stats_get(app_gnss_recorder_stats_t *stats);
+
+/* Receive path hooks, cheap no-ops while not recording */
+void app_gnss_recorder_feed(const uint8_t *data, size_t len);
+void app_gnss_recorder_idle(void);
+
+#endif  // APP_GNSS_RECORDER_H
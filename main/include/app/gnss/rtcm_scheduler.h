@@ -0,0 +1,59 @@
+#ifndef APP_GNSS_RTCM_SCHEDULER_H
+#define APP_GNSS_RTCM_SCHEDULER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* App */
+#include "app/gnss_server.h"
+
+#define APP_GNSS_RTCM_SCHED_MAX_TYPES (32) /* Message types tracked, later types are accounted as type 0 */
+
+typedef struct {
+    uint16_t type;            /* RTCM message number */
+    bool     always;          /* Forward every frame, the other limits are ignored */
+    uint8_t  every_n;         /* Keep one epoch out of N, 0 or 1 keeps all */
+    uint32_t min_interval_ms; /* Minimum time between two forwarded epochs, 0 for none */
+} app_gnss_rtcm_sched_rule_t;
+
+typedef struct {
+    uint16_t type;
+    uint32_t forwarded_frames;
+    uint32_t forwarded_bytes;
+    uint32_t suppressed_frames;
+    uint32_t suppressed_bytes;
+    uint32_t interval_ms; /* Mean time between forwarded epochs, 0 until two were forwarded */
+} app_gnss_rtcm_sched_stats_t;
+
+typedef struct {
+    app_gnss_rtcm_sched_rule_t  rule;
+    app_gnss_rtcm_sched_stats_t stats;
+
+    uint32_t epoch_count;
+    uint32_t epoch_key;     /* MSM epoch time of the last decision */
+    bool     epoch_valid;   /* epoch_key holds a decision */
+    bool     epoch_forward; /* Decision taken for epoch_key */
+    int64_t  first_forward_us;
+    int64_t  last_forward_us;
+    uint32_t forwarded_epochs;
+} app_gnss_rtcm_sched_entry_t;
+
+/**
+ * Per message type rate limiter for an RTCM stream.
+ * Types without a rule are forwarded and only counted, along with the mean interval between their epochs. Frames of
+ * one MSM epoch (multiple message bit) share the decision taken for the first one, so an epoch is never forwarded
+ * partially. Not thread-safe, feed it from one task.
+ */
+typedef struct {
+    size_t                      count;
+    app_gnss_rtcm_sched_entry_t entries[APP_GNSS_RTCM_SCHED_MAX_TYPES + 1]; /* Last one collects untracked types */
+} app_gnss_rtcm_sched_t;
+
+void   app_gnss_rtcm_sched_init(app_gnss_rtcm_sched_t *sched);
+int    app_gnss_rtcm_sched_rule_set(app_gnss_rtcm_sched_t *sched, const app_gnss_rtcm_sched_rule_t *rule);
+bool   app_gnss_rtcm_sched_admit(app_gnss_rtcm_sched_t *sched, const app_gnss_rtcm_t *rtcm, int64_t now_us);
+size_t app_gnss_rtcm_sched_stats_get(const app_gnss_rtcm_sched_t *sched, app_gnss_rtcm_sched_stats_t *stats,
+                                     size_t max);
+
+#endif  // APP_GNSS_RTCM_SCHEDULER_H
@@ -0,0 +1,28 @@
+#ifndef APP_GNSS_SURVEY_H
+#define APP_GNSS_SURVEY_H
+
+#include <stdint.h>
+
+/**
+ * Running ECEF position average (Welford). Samples are accumulated as offsets from the first one, which keeps the
+ * squared deviations small next to the ~6e6 m ECEF coordinates and the variance free of cancellation.
+ */
+typedef struct {
+    uint32_t n;
+    double   origin[3]; /* First sample, m */
+    double   mean[3];   /* Mean offset from origin, m */
+    double   m2[3];     /* Sum of squared deviations from the mean, m^2 */
+} app_gnss_survey_t;
+
+/* WGS84 geodetic (degrees, ellipsoidal height in m) to ECEF (m). */
+void app_gnss_survey_llh_to_ecef(double lat, double lon, double height, double ecef[3]);
+
+/* ECEF (m) to WGS84 geodetic (degrees, ellipsoidal height in m). */
+void app_gnss_survey_ecef_to_llh(const double ecef[3], double *lat, double *lon, double *height);
+
+void  app_gnss_survey_init(app_gnss_survey_t *survey);
+void  app_gnss_survey_add(app_gnss_survey_t *survey, const double ecef[3]);
+void  app_gnss_survey_mean(const app_gnss_survey_t *survey, double ecef[3]);
+float app_gnss_survey_sigma(const app_gnss_survey_t *survey); /* 3D standard deviation of the samples, m */
+
+#endif  // APP_GNSS_SURVEY_H
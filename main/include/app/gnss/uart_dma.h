@@ -0,0 +1,44 @@
+#ifndef APP_GNSS_UART_DMA_H
+#define APP_GNSS_UART_DMA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* IDF */
+#include "driver/uart.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define APP_GNSS_UART_DMA_DESC_NUM  (16)
+#define APP_GNSS_UART_DMA_DESC_SIZE (256) /* Also the UHCI length EOF threshold */
+#define APP_GNSS_UART_DMA_CAPACITY  (APP_GNSS_UART_DMA_DESC_NUM * APP_GNSS_UART_DMA_DESC_SIZE)
+
+typedef struct {
+    uint32_t bytes;    /* Total bytes received by DMA */
+    uint32_t chunks;   /* Descriptors handed to the consumer */
+    uint32_t overruns; /* Descriptor ring overruns, each one restarts reception */
+} app_gnss_uart_dma_stats_t;
+
+/**
+ * UHCI + GDMA reception for one UART.
+ * The DMA engine writes into a circular list of descriptors, closing one on RX idle or when it is full.
+ * Closed descriptors are handed to the consumer in place and returned to the DMA once parsed.
+ * The UART driver stays installed for transmission, only its RX interrupts are turned off.
+ */
+int  app_gnss_uart_dma_start(uart_port_t port, TaskHandle_t notify_task);
+void app_gnss_uart_dma_stop(void);
+
+/**
+ * Next completed chunk, false if none. idle is set when the chunk was closed by line idle. A full chunk was closed
+ * by the length EOF, or by an idle that happened to land on the descriptor end: the caller finds out from whether
+ * more data follows.
+ */
+bool app_gnss_uart_dma_read(const uint8_t **ptr, size_t *len, bool *idle);
+void app_gnss_uart_dma_release(void);
+
+/* Restart reception after an overrun, returns true if one was pending. */
+bool app_gnss_uart_dma_recover(void);
+void app_gnss_uart_dma_stats_get(app_gnss_uart_dma_stats_t *stats);
+
+#endif  // APP_GNSS_UART_DMA_H
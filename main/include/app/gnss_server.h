@@ -1,48 +1,303 @@
 #ifndef APP_GNSS_SERVER_H
 #define APP_GNSS_SERVER_H
 
+/* nl */
+#include "rcv/nl_nmea_index.h"
+
 typedef enum {
     APP_GNSS_CB_FIX      = 1 << 0U,
     APP_GNSS_CB_SAT      = 1 << 1U,
     APP_GNSS_CB_RAW_NMEA = 1 << 2U,
     APP_GNSS_CB_RAW_RTCM = 1 << 3U,
     APP_GNSS_CB_PPS      = 1 << 4U,
+    APP_GNSS_CB_OBS      = 1 << 5U,
 } app_gnss_cb_type_t;
 
+typedef enum {
+    APP_GNSS_FIX_HAS_POSITION = 1 << 0U, /* GGA: latitude, longitude, altitude, quality, satellites used */
+    APP_GNSS_FIX_HAS_DOP      = 1 << 1U, /* GSA: fix mode, PDOP, HDOP, VDOP */
+    APP_GNSS_FIX_HAS_ERROR    = 1 << 2U, /* GST: 1-sigma position error estimates */
+    APP_GNSS_FIX_HAS_VELOCITY = 1 << 3U, /* RMC: speed and course over ground */
+    APP_GNSS_FIX_HAS_DATE     = 1 << 4U, /* RMC: UTC date */
+} app_gnss_fix_flags_t;
+
+typedef enum {
+    APP_GNSS_CONSTELLATION_UNKNOWN = 0,
+    APP_GNSS_CONSTELLATION_GPS,
+    APP_GNSS_CONSTELLATION_GLONASS,
+    APP_GNSS_CONSTELLATION_GALILEO,
+    APP_GNSS_CONSTELLATION_BEIDOU,
+    APP_GNSS_CONSTELLATION_QZSS,
+    APP_GNSS_CONSTELLATION_NAVIC,
+} app_gnss_constellation_t;
+
+#define APP_GNSS_CONSTELLATION_BIT(c) (1U << (c))
+
+/* Numbered like the PAIR062 sentence types */
+typedef enum {
+    APP_GNSS_NMEA_GGA = 0,
+    APP_GNSS_NMEA_GLL,
+    APP_GNSS_NMEA_GSA,
+    APP_GNSS_NMEA_GSV,
+    APP_GNSS_NMEA_RMC,
+    APP_GNSS_NMEA_VTG,
+    APP_GNSS_NMEA_ZDA,
+    APP_GNSS_NMEA_GRS,
+    APP_GNSS_NMEA_GST,
+    APP_GNSS_NMEA_COUNT,
+} app_gnss_nmea_sentence_t;
+
+typedef enum {
+    APP_GNSS_RTCM_MSM_OFF = 0,
+    APP_GNSS_RTCM_MSM4    = 4,
+    APP_GNSS_RTCM_MSM7    = 7,
+} app_gnss_rtcm_msm_t;
+
+/* Output profile, stored in NVS and pushed to the module with PAIR commands at boot and on every change. */
 typedef struct {
-    double latitude;
-    double longitude;
-    double altitude;
+    uint16_t fix_interval_ms;                /* 100-1000 */
+    uint8_t  constellations;                 /* APP_GNSS_CONSTELLATION_BIT() mask, GPS is mandatory */
+    uint8_t  nmea_rate[APP_GNSS_NMEA_COUNT]; /* Output once every N fixes, 0 disables the sentence */
+    uint8_t  rtcm_msm;                       /* app_gnss_rtcm_msm_t */
+    bool     rtcm_station;                   /* 1005 antenna reference point */
+    bool     rtcm_ephemeris;                 /* 1019/1020/1042/1046 */
+} app_gnss_server_config_t;
+
+/* One navigation epoch, merged from every GGA/GSA/GST/RMC sentence carrying the same UTC time. */
+typedef struct {
+    uint32_t flags; /* app_gnss_fix_flags_t */
+
+    nl_nmea_date_t date;
+    nl_nmea_time_t time;
+
+    double latitude;  /* Degrees, north positive */
+    double longitude; /* Degrees, east positive */
+    double altitude;  /* Above mean sea level, m */
+    float  geoid_separation;
 
-    /* TODO: Add more fields. */
+    uint8_t  quality;   /* GGA fix quality: 0 invalid, 1 GPS, 2 DGPS, 4 RTK fixed, 5 RTK float... */
+    uint8_t  fix_mode;  /* GSA: 1 no fix, 2 2D, 3 3D */
+    uint8_t  sats_used; /* Satellites used in the solution */
+    float    diff_age;  /* Age of differential corrections, s; negative if none */
+    uint16_t diff_station;
+
+    float pdop;
+    float hdop;
+    float vdop;
+
+    float lat_error; /* 1-sigma, m */
+    float lon_error;
+    float alt_error;
+
+    float speed;  /* Over ground, m/s */
+    float course; /* Over ground, degrees true */
 } app_gnss_fix_t;
 
+#define APP_GNSS_SAT_MAX (64)
+
+typedef struct {
+    uint8_t  constellation; /* app_gnss_constellation_t */
+    uint8_t  used;          /* Listed in a GSA of the epoch */
+    uint16_t prn;           /* As reported in NMEA */
+    int8_t   elevation;     /* Degrees, -128 if unknown */
+    uint16_t azimuth;       /* Degrees, 0xFFFF if unknown */
+    uint8_t  cn0;           /* dB-Hz, best of all tracked signals; 0 if not tracked */
+} app_gnss_sat_info_t;
+
+/* Satellites in view, merged from the GSV/GSA sentences of one epoch. */
+typedef struct {
+    nl_nmea_time_t      time;
+    uint8_t             count;
+    app_gnss_sat_info_t sats[APP_GNSS_SAT_MAX];
+} app_gnss_sat_t;
+
 typedef struct {
     uint16_t type;
     size_t   data_len;
-    uint8_t *data;
+    uint8_t *data; /* Complete frame: preamble, length, payload and CRC */
 } app_gnss_rtcm_t;
 
+#define APP_GNSS_OBS_MAX (64) /* Cells of one MSM message */
+
+typedef enum {
+    APP_GNSS_OBS_HAS_RANGE  = 1 << 0U, /* pseudorange is valid */
+    APP_GNSS_OBS_HAS_PHASE  = 1 << 1U, /* phase is valid */
+    APP_GNSS_OBS_HAS_RATE   = 1 << 2U, /* range_rate is valid, MSM7 only */
+    APP_GNSS_OBS_HALF_CYCLE = 1 << 3U, /* Half-cycle ambiguity unresolved */
+    APP_GNSS_OBS_SLIP       = 1 << 4U, /* Lock time went backwards or the half-cycle state changed */
+    APP_GNSS_OBS_LOCK_LOST  = 1 << 5U, /* Phase was valid in the previous message and is missing now */
+} app_gnss_obs_flags_t;
+
+typedef struct {
+    double   pseudorange; /* Meters */
+    double   phase;       /* Carrier phase range, meters */
+    float    range_rate;  /* Phase range rate, m/s */
+    float    cn0;         /* dB-Hz, 1/16 dB-Hz resolution for MSM7 */
+    uint32_t lock_ms;     /* Minimum lock time */
+    uint8_t  sat_id;      /* MSM satellite ID (DF394 position), GLONASS slot, QZSS PRN - 192 */
+    uint8_t  sig_id;      /* MSM signal ID (DF395 position) */
+    uint8_t  flags;       /* app_gnss_obs_flags_t */
+} app_gnss_obs_sig_t;
+
+/* Observations of one RTCM3 MSM4 or MSM7 message, i.e. one constellation of an epoch. */
 typedef struct {
-    char     type[3];
+    uint16_t           message;       /* e.g. 1077 */
+    uint8_t            msm_type;      /* 4 or 7 */
+    uint8_t            constellation; /* app_gnss_constellation_t, unknown for SBAS */
+    uint16_t           station_id;
+    uint32_t           epoch; /* Epoch time in ms of week, GLONASS: day of week (3 bits) and ms of day */
+    bool               more;  /* Multiple message bit, further messages of this epoch follow */
+    uint8_t            sats;  /* Satellites in the message */
+    uint8_t            count;
+    app_gnss_obs_sig_t sigs[APP_GNSS_OBS_MAX];
+} app_gnss_obs_t;
+
+typedef struct {
+    char     type[3]; /* Formatter, not NUL-terminated, e.g. "GGA" */
     size_t   data_len;
-    uint8_t *data;
+    uint8_t *data; /* Complete sentence as received, including checksum and line ending */
+
+    const nl_nmea_index_t *index; /* Field index, decode with the nl_nmea_field_*() accessors */
 } app_gnss_nmea_t;
 
 typedef struct {
+    /* UTC of the edge, only meaningful if time_valid is set */
     uint16_t gps_year;
     uint16_t gps_month;
     uint16_t gps_day;
     uint16_t gps_hour;
     uint16_t gps_minute;
     uint16_t gps_second;
+    bool     time_valid; /* An RMC younger than one second was available to label the edge */
+
+    int64_t  timestamp_us; /* esp_timer time captured in the edge ISR */
+    int64_t  interval_us;  /* Time since the previous edge, 0 for the first one */
+    uint32_t latency_us;   /* Edge to dispatch delay */
+    uint32_t sequence;     /* Edge counter */
 } app_gnss_pps_t;
 
+typedef struct {
+    uint32_t rx_bytes;       /* Bytes read from the UART into the ingest ring */
+    uint32_t rx_chunks;      /* Chunks handed to the parser */
+    uint32_t rx_buffer_size; /* UART driver RX buffer or DMA descriptor ring capacity */
+    uint32_t rx_backlog_max; /* Most bytes waiting to be read when the RX task woke up */
+    uint32_t fifo_overflows; /* Hardware FIFO overflow events */
+    uint32_t baud_rate;      /* Negotiated UART baud rate */
+
+    uint32_t rx_wakeups;          /* RX task wakeups since boot */
+    uint32_t rx_wakeups_per_sec;  /* Wakeups during the last second */
+    uint32_t rx_bytes_per_wakeup; /* Average bytes drained per wakeup during the last second */
+
+    /* Bring-up, milliseconds after the module reset was released; 0 if not reached yet */
+    uint32_t boot_output_ms;    /* First byte from the module */
+    uint32_t boot_config_ms;    /* Initialization commands done */
+    uint32_t boot_first_fix_ms; /* First GGA with a valid fix */
+    uint16_t cmd_acked;         /* Commands acknowledged with PAIR001 success */
+    uint16_t cmd_failed;        /* Commands rejected or never acknowledged */
+    uint16_t cmd_retries;       /* Resends after a timeout or busy answer */
+
+    uint32_t obs_messages; /* MSM messages decoded for APP_GNSS_CB_OBS */
+    uint32_t obs_slips;    /* Cycle slips detected */
+    uint32_t obs_losses;   /* Phase lock losses detected */
+
+    uint32_t replay_bytes;        /* Recorded bytes fed to the parser by the current or last replay */
+    uint32_t replay_live_dropped; /* Live chunks left unparsed because a replay owned the parser */
+
+    uint32_t station_injected; /* Onboard station message frames sent to RTCM consumers */
+    uint32_t station_dropped;  /* Module 1005/1006/1033 frames replaced by them */
+    uint32_t correction_bytes; /* Correction data written to the module */
+
+    uint32_t nmea_frames;     /* NMEA sentences decoded */
+    uint32_t rtcm_frames;     /* RTCM3 frames decoded */
+    uint32_t rejected_frames; /* Frame candidates rejected during resync */
+    uint32_t skipped_bytes;   /* Bytes skipped while hunting for a frame start */
+} app_gnss_server_stats_t;
+
+typedef enum {
+    APP_GNSS_ASYNC_DROP_OLDEST, /* Evict queued events to make room for the new one */
+    APP_GNSS_ASYNC_DROP_NEWEST, /* Discard the new event when the queue is full */
+    APP_GNSS_ASYNC_BLOCK,       /* Wait up to block_timeout_ms for room, then discard the new event */
+} app_gnss_async_policy_t;
+
+typedef struct {
+    size_t                  queue_size; /* Delivery ring size in bytes */
+    app_gnss_async_policy_t policy;
+    uint32_t                block_timeout_ms;
+    uint32_t                task_stack;
+    uint32_t                task_priority;
+    const char             *task_name;
+} app_gnss_async_config_t;
+
+#define APP_GNSS_ASYNC_CONFIG_DEFAULT()                 \
+    {                                                   \
+        .queue_size       = 4096,                       \
+        .policy           = APP_GNSS_ASYNC_DROP_OLDEST, \
+        .block_timeout_ms = 0,                          \
+        .task_stack       = 3072,                       \
+        .task_priority    = 4,                          \
+        .task_name        = "asuna_gnss_cb",            \
+    }
+
+typedef struct {
+    uint32_t enqueued;       /* Events accepted into the delivery ring */
+    uint32_t delivered;      /* Events handed to the callback */
+    uint32_t dropped;        /* Events lost to the queue policy */
+    uint32_t lag;            /* Events currently queued */
+    uint32_t peak_lag;       /* Maximum number of events queued at once */
+    uint32_t max_latency_us; /* Longest time an event spent queued */
+} app_gnss_async_stats_t;
+
 typedef void *app_gnss_cb_handle_t;
+
+/*
+ * Callbacks run lock-free from the GNSS tasks on a snapshot of the consumer list. They must not call
+ * app_gnss_server_cb_register/unregister, which wait for in-flight dispatches to finish.
+ */
 typedef int (*app_gnss_cb_t)(void *handle, app_gnss_cb_type_t type, void *payload);
 
 int                  app_gnss_server_init(void);
 app_gnss_cb_handle_t app_gnss_server_cb_register(app_gnss_cb_type_t type, app_gnss_cb_t cb, void *handle);
 void                 app_gnss_server_cb_unregister(app_gnss_cb_handle_t handle);
 
+/*
+ * Register a consumer delivered from its own task through a bounded queue, so it cannot stall the GNSS parser.
+ * Payloads are copied; pointers inside them are valid for the duration of the callback only.
+ * Unregister with app_gnss_server_cb_unregister().
+ */
+app_gnss_cb_handle_t app_gnss_server_cb_register_async(app_gnss_cb_type_t type, app_gnss_cb_t cb, void *handle,
+                                                       const app_gnss_async_config_t *config);
+int app_gnss_server_cb_async_stats_get(app_gnss_cb_handle_t handle, app_gnss_async_stats_t *stats);
+int                  app_gnss_server_stats_get(app_gnss_server_stats_t *stats);
+
+/*
+ * Feed a raw stream recording (app/gnss/recorder.h) through the parser instead of the module output, speed times
+ * faster than recorded, 0 for as fast as possible. Fails during bring-up or while another replay runs.
+ * app_gnss_server_replay_stop() returns once the replay task is gone, live output is parsed again from then on.
+ */
+int  app_gnss_server_replay_start(const char *path, uint16_t speed);
+void app_gnss_server_replay_stop(void);
+
+/*
+ * Write correction data, e.g. RTCM3 from an NTRIP client, to the module. Each call goes out in one piece and PAIR
+ * commands can only fall between two calls, so pass whole frames: a command written into the middle of a frame breaks
+ * both. Fails until bring-up is done.
+ */
+int app_gnss_server_correction_write(const uint8_t *data, size_t len);
+
+/*
+ * Send frames, complete RTCM3 frames back to back, to RTCM consumers every interval_ms right after the last MSM of an
+ * epoch, and drop the module's own 1005/1006/1033 meanwhile. len 0 lets the module's station messages through again.
+ */
+int app_gnss_server_rtcm_station_set(const uint8_t *frames, size_t len, uint32_t interval_ms);
+
+/*
+ * Store the profile and, once bring-up is done, apply it to the module. Returns -1 if a value is out of range, -2 if
+ * the command channel could not be taken and -3 if the module did not acknowledge every command.
+ */
+int app_gnss_server_config_set(const app_gnss_server_config_t *config);
+
+void        app_gnss_server_config_init(app_gnss_server_config_t *config);
+int         app_gnss_server_config_get(app_gnss_server_config_t *config);
+const char *app_gnss_server_nmea_name(app_gnss_nmea_sentence_t sentence);
+
 #endif  // APP_GNSS_SERVER_H
\ No newline at end of file
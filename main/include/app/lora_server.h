@@ -3,6 +3,17 @@
 
 #include "lora_modem.h"
 
+/* App */
+#include "app/gnss/rtcm_scheduler.h"
+
+/* MSM transcoding ahead of the LoRa link, byte counts cover MSM frames only */
+typedef struct {
+    uint32_t transcoded;  /* Frames re-encoded */
+    uint32_t passthrough; /* Frames forwarded unchanged after a decode or encode failure */
+    uint32_t in_bytes;
+    uint32_t out_bytes;
+} app_lora_server_msm_stats_t;
+
 typedef struct {
     bool                fw_rtcm;
     lora_modem_config_t modem_config;
@@ -14,4 +25,10 @@ int  app_lora_server_config_set(const app_lora_server_config_t *config);
 int  app_lora_server_config_get(app_lora_server_config_t *config);
 int  app_lora_server_broadcast(const uint8_t *data, size_t length);
 
+/* Forwarded and suppressed RTCM traffic per message type, returns the number of entries written. */
+size_t app_lora_server_rtcm_stats_get(app_gnss_rtcm_sched_stats_t *stats, size_t max);
+
+/* Returns -1 if MSM transcoding is disabled in Kconfig. */
+int app_lora_server_msm_stats_get(app_lora_server_msm_stats_t *stats);
+
 #endif  // APP_LORA_SERVER_H
@@ -1,6 +1,10 @@
 #ifndef APP_NETIF_LTE_H
 #define APP_NETIF_LTE_H
 
+/* App */
+#include "app/uart_rx.h"
+
 int app_netif_lte_init(void);
+int app_netif_lte_rx_stats_get(app_uart_rx_stats_t* stats);
 
 #endif //APP_NETIF_LTE_H
@@ -0,0 +1,22 @@
+#ifndef APP_NMEA_SERVER_H
+#define APP_NMEA_SERVER_H
+
+#include <stdint.h>
+
+typedef struct {
+    uint8_t  clients;   /* TCP clients currently connected */
+    uint32_t accepted;  /* TCP connections accepted */
+    uint32_t rejected;  /* TCP connections refused for lack of a free slot */
+    uint32_t slow;      /* TCP clients disconnected for falling behind their send window */
+    uint32_t epochs;    /* Sentence batches sent, one per epoch unless it overflowed */
+    uint32_t bytes_in;  /* NMEA bytes taken from the GNSS server */
+    uint32_t bytes_out; /* Bytes sent to all TCP clients */
+    uint32_t datagrams; /* UDP datagrams sent */
+} app_nmea_server_stats_t;
+
+int app_nmea_server_init(void);
+
+/* Returns -1 if the server is disabled in Kconfig. */
+int app_nmea_server_stats_get(app_nmea_server_stats_t *stats);
+
+#endif  // APP_NMEA_SERVER_H
@@ -0,0 +1,56 @@
+#ifndef APP_NTRIP_STREAM_H
+#define APP_NTRIP_STREAM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define APP_NTRIP_STREAM_FRAME_MAX (3 + 1023 + 3) /* RTCM3 header, payload and CRC */
+
+typedef enum {
+    APP_NTRIP_STREAM_CHUNK_SIZE = 0,
+    APP_NTRIP_STREAM_CHUNK_EXTENSION, /* Rest of the size line */
+    APP_NTRIP_STREAM_CHUNK_DATA,
+    APP_NTRIP_STREAM_CHUNK_TRAILER, /* CRLF after the data */
+} app_ntrip_stream_chunk_state_t;
+
+/**
+ * Called with each complete RTCM3 frame whose CRC-24Q checked out. frame points into the input when the frame arrived
+ * in one piece and into the stream's buffer otherwise.
+ */
+typedef void (*app_ntrip_stream_frame_cb_t)(void *ctx, const uint8_t *frame, size_t len);
+
+/**
+ * Socket-free side of an NTRIP client connection: the caster's response header, HTTP chunked transfer decoding and
+ * RTCM3 framing. Fed whatever recv() returned, split anywhere. Only whole frames are passed on, so whoever writes
+ * them out can keep other traffic from landing inside one; bytes outside frames are dropped. A preamble whose frame
+ * fails the CRC only costs its own byte, the hunt resumes right after it as in the GNSS frame demux.
+ */
+typedef struct {
+    app_ntrip_stream_frame_cb_t cb;
+    void                       *ctx;
+
+    bool chunked; /* NTRIP 2 with HTTP chunked transfer encoding */
+
+    app_ntrip_stream_chunk_state_t chunk_state;
+    uint32_t                       chunk_left;
+
+    uint16_t frame_len; /* Bytes of a frame split across inputs buffered so far, 0 while hunting */
+    uint8_t  frame[APP_NTRIP_STREAM_FRAME_MAX];
+
+    uint32_t skipped; /* Bytes dropped outside frames, false preambles included */
+} app_ntrip_stream_t;
+
+void app_ntrip_stream_init(app_ntrip_stream_t *stream, app_ntrip_stream_frame_cb_t cb, void *ctx);
+
+/**
+ * Parse the response header received so far, NUL terminated. Accepts ICY 200 (NTRIP 1) and HTTP 200 (NTRIP 2), the
+ * latter possibly chunked. Returns the header length including the blank line once complete, 0 while incomplete, -1
+ * for a SOURCETABLE (unknown mountpoint) and -2 for any other answer.
+ */
+int app_ntrip_stream_response(app_ntrip_stream_t *stream, const char *header);
+
+/* Strips the chunked transfer encoding, if any, and passes the frames on. Returns -1 once the caster ends the body. */
+int app_ntrip_stream_input(app_ntrip_stream_t *stream, const uint8_t *data, size_t len);
+
+#endif  // APP_NTRIP_STREAM_H
@@ -0,0 +1,20 @@
+#ifndef APP_NTRIP_CASTER_H
+#define APP_NTRIP_CASTER_H
+
+#include <stdint.h>
+
+typedef struct {
+    uint8_t  clients;   /* Clients currently streaming */
+    uint32_t accepted;  /* Connections that got the stream */
+    uint32_t rejected;  /* Connections refused: no free slot, bad request, unknown mountpoint or credentials */
+    uint32_t slow;      /* Clients disconnected for falling behind their send window */
+    uint32_t bytes_in;  /* RTCM bytes taken from the GNSS server */
+    uint32_t bytes_out; /* Payload bytes sent to all clients */
+} app_ntrip_caster_stats_t;
+
+int app_ntrip_caster_init(void);
+
+/* Returns -1 if the caster is disabled in Kconfig. */
+int app_ntrip_caster_stats_get(app_ntrip_caster_stats_t *stats);
+
+#endif  // APP_NTRIP_CASTER_H
@@ -0,0 +1,42 @@
+#ifndef APP_NTRIP_CLIENT_H
+#define APP_NTRIP_CLIENT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    APP_NTRIP_CLIENT_IDLE = 0,
+    APP_NTRIP_CLIENT_CONNECTING,
+    APP_NTRIP_CLIENT_STREAMING,
+    APP_NTRIP_CLIENT_BACKOFF, /* Waiting to reconnect */
+} app_ntrip_client_status_t;
+
+typedef struct {
+    bool     enabled;
+    char     host[64];
+    uint16_t port;
+    char     mountpoint[32];
+    char     username[32];
+    char     password[32];
+    uint16_t gga_interval_s; /* GGA sent upstream for VRS mountpoints, 0 to never send it */
+} app_ntrip_client_config_t;
+
+typedef struct {
+    app_ntrip_client_status_t status;
+    uint32_t                  connects;      /* Connections that reached the stream */
+    uint32_t                  failures;      /* Attempts that failed or streams that broke off */
+    uint32_t                  bytes;         /* Correction bytes passed on, in whole frames */
+    uint32_t                  bytes_per_sec; /* During the last full second */
+    uint32_t                  frames;        /* RTCM3 frames passed through */
+    uint16_t                  last_type;     /* Message number of the last frame */
+    uint32_t                  age_ms;        /* Since the last complete frame, UINT32_MAX before the first one */
+    uint32_t                  gga_sent;
+} app_ntrip_client_stats_t;
+
+int  app_ntrip_client_init(void);
+void app_ntrip_client_config_init(app_ntrip_client_config_t *config);
+int  app_ntrip_client_config_set(const app_ntrip_client_config_t *config);
+int  app_ntrip_client_config_get(app_ntrip_client_config_t *config);
+int  app_ntrip_client_stats_get(app_ntrip_client_stats_t *stats);
+
+#endif  // APP_NTRIP_CLIENT_H
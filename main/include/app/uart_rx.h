@@ -0,0 +1,43 @@
+#ifndef APP_UART_RX_H
+#define APP_UART_RX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* IDF */
+#include "driver/uart.h"
+#include "freertos/FreeRTOS.h"
+
+/**
+ * RX event coalescing policy of one UART port.
+ * Fewer, larger UART_DATA events cost less CPU at the price of delivery latency.
+ */
+typedef struct {
+    uint8_t rx_full_threshold; /* FIFO bytes that raise an RX interrupt, 1-127 */
+    uint8_t rx_timeout;        /* Idle symbol times that raise a timeout interrupt, 1-126 */
+    char    pattern_chr;       /* Raise an event on this character as well, 0 to disable */
+    int     queue_size;        /* Event queue length the driver was installed with */
+} app_uart_rx_config_t;
+
+typedef struct {
+    uint32_t wakeups;          /* RX task wakeups since boot */
+    uint32_t bytes;            /* Bytes handled by those wakeups */
+    uint32_t wakeups_per_sec;  /* Wakeups during the last complete one-second window */
+    uint32_t bytes_per_wakeup; /* Average over the last complete window */
+} app_uart_rx_stats_t;
+
+/* Wakeup counter, updated by the RX task only. */
+typedef struct {
+    app_uart_rx_stats_t stats;
+
+    TickType_t window_start;
+    uint32_t   window_wakeups;
+    uint32_t   window_bytes;
+} app_uart_rx_meter_t;
+
+int  app_uart_rx_config_apply(uart_port_t port, const app_uart_rx_config_t *config);
+void app_uart_rx_meter_init(app_uart_rx_meter_t *meter);
+void app_uart_rx_meter_wakeup(app_uart_rx_meter_t *meter, size_t bytes);
+void app_uart_rx_meter_get(const app_uart_rx_meter_t *meter, app_uart_rx_stats_t *stats);
+
+#endif  // APP_UART_RX_H
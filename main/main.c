@@ -18,12 +18,16 @@
 #include <app/lora_server.h>
 
 #include "app/api_server.h"
+#include "app/base_server.h"
 #include "app/console_common.h"
 #include "app/gnss_server.h"
 #include "app/lora_server.h"
 #include "app/netif_common.h"
 #include "app/netif_lte.h"
 #include "app/netif_wifi.h"
+#include "app/nmea_server.h"
+#include "app/ntrip_caster.h"
+#include "app/ntrip_client.h"
 #include "app/version_manager.h"
 #include "app/vfs_common.h"
 
@@ -50,13 +54,18 @@ void app_main(void) {
     ESP_LOGI(LOG_TAG, "Project Asuna -- Initializing...");
 
     APP_ERROR_CHECK(app_version_manager_init(), "version manager");
+    APP_ERROR_CHECK(app_vfs_common_init(), "storage");
     APP_ERROR_CHECK(app_console_init(), "console");
     APP_ERROR_CHECK(app_netif_init(), "network interfaces");
     APP_ERROR_CHECK(app_netif_wifi_init(), "WiFi interface");
     APP_ERROR_CHECK(app_netif_lte_init(), "LTE interface");
     APP_ERROR_CHECK(app_gnss_server_init(), "GNSS server");
+    APP_ERROR_CHECK(app_base_server_init(), "base server");
     APP_ERROR_CHECK(app_lora_server_init(), "LoRa server");
     APP_ERROR_CHECK(app_api_server_init(), "web server");
+    APP_ERROR_CHECK(app_ntrip_caster_init(), "NTRIP caster");
+    APP_ERROR_CHECK(app_ntrip_client_init(), "NTRIP client");
+    APP_ERROR_CHECK(app_nmea_server_init(), "NMEA server");
 
     ESP_LOGI(LOG_TAG, "Initialization completed.");
 
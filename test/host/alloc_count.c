@@ -0,0 +1,47 @@
+#include <stdatomic.h>
+#include <stddef.h>
+
+#include "alloc_count.h"
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+static atomic_bool s_host_alloc_counting;
+static atomic_uint s_host_alloc_count;
+
+static void host_alloc_count_hit(void) {
+    if (atomic_load_explicit(&s_host_alloc_counting, memory_order_relaxed)) {
+        atomic_fetch_add_explicit(&s_host_alloc_count, 1, memory_order_relaxed);
+    }
+}
+
+void *__wrap_malloc(size_t size) {
+    host_alloc_count_hit();
+
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    host_alloc_count_hit();
+
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    host_alloc_count_hit();
+
+    return __real_realloc(ptr, size);
+}
+
+void host_alloc_count_enable(bool enable) {
+    atomic_store(&s_host_alloc_counting, enable);
+}
+
+uint32_t host_alloc_count_get(void) {
+    return atomic_load(&s_host_alloc_count);
+}
+
+void host_alloc_count_reset(void) {
+    atomic_store(&s_host_alloc_count, 0U);
+}
@@ -0,0 +1,16 @@
+#ifndef HOST_ALLOC_COUNT_H
+#define HOST_ALLOC_COUNT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Heap allocation counter for benchmarks. Executables linking alloc_count.c must pass
+ * -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc so calls from the code under test land here.
+ */
+
+void     host_alloc_count_enable(bool enable);
+uint32_t host_alloc_count_get(void);
+void     host_alloc_count_reset(void);
+
+#endif  // HOST_ALLOC_COUNT_H
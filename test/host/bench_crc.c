@@ -0,0 +1,96 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* nl */
+#include "rcv/nl_crc24q.h"
+
+/*
+ * Host counterpart of "gnss bench crc": checks the slicing-by-8 kernel against the bitwise reference over every
+ * length and alignment up to a full RTCM3 frame, then reports the throughput of both in MB/s as one JSON object.
+ */
+
+#define HOST_BENCH_CRC_FRAME (1029) /* Largest RTCM3 frame */
+
+static uint64_t host_bench_now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int host_bench_crc_verify(const uint8_t *buf) {
+    for (size_t offset = 0; offset < 8; offset++) {
+        for (size_t len = 0; len + offset <= HOST_BENCH_CRC_FRAME; len++) {
+            const uint32_t table   = nl_crc24q(&buf[offset], len);
+            const uint32_t bitwise = nl_crc24q_bitwise(&buf[offset], len);
+
+            if (table != bitwise) {
+                fprintf(stderr, "CRC-24Q mismatch at offset %zu, length %zu: 0x%06" PRIx32 " != 0x%06" PRIx32 "\n",
+                        offset, len, table, bitwise);
+
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const uint32_t iterations = (argc > 1) ? strtoul(argv[1], NULL, 0) : 20000;
+
+    if (nl_crc24q_init() != 0) {
+        fprintf(stderr, "CRC-24Q table self-test failed.\n");
+
+        return 1;
+    }
+
+    static uint8_t buf[HOST_BENCH_CRC_FRAME + 8];
+    for (size_t i = 0; i < sizeof(buf); i++) {
+        buf[i] = (uint8_t)(i * 31U + 7U);
+    }
+
+    /* Catalogue check value of CRC-24Q */
+    static const uint8_t check[] = "123456789";
+    if (nl_crc24q(check, sizeof(check) - 1) != 0xCDE703UL) {
+        fprintf(stderr, "CRC-24Q check value mismatch: 0x%06" PRIx32 "\n", nl_crc24q(check, sizeof(check) - 1));
+
+        return 1;
+    }
+
+    if (host_bench_crc_verify(buf) != 0) {
+        return 1;
+    }
+
+    uint32_t crc = 0;
+
+    uint64_t start = host_bench_now_ns();
+    for (uint32_t i = 0; i < iterations; i++) {
+        crc ^= nl_crc24q(buf, HOST_BENCH_CRC_FRAME);
+        __asm__ volatile("" : : "r"(crc) : "memory");
+    }
+    const uint64_t table_ns = host_bench_now_ns() - start;
+
+    start = host_bench_now_ns();
+    for (uint32_t i = 0; i < iterations; i++) {
+        crc ^= nl_crc24q_bitwise(buf, HOST_BENCH_CRC_FRAME);
+        __asm__ volatile("" : : "r"(crc) : "memory");
+    }
+    const uint64_t bitwise_ns = host_bench_now_ns() - start;
+
+    const double total_bytes = (double)HOST_BENCH_CRC_FRAME * iterations;
+    const double table_mbs   = total_bytes * 1e3 / (double)(table_ns ? table_ns : 1);
+    const double bitwise_mbs = total_bytes * 1e3 / (double)(bitwise_ns ? bitwise_ns : 1);
+
+    printf("{\"target\":\"crc\",\"iterations\":%" PRIu32 ",\"bytes\":%u,\"crc\":\"0x%06" PRIx32
+           "\",\"slicing_by_8\":{\"us\":%" PRIu64 ",\"mb_per_s\":%.2f},\"bitwise\":{\"us\":%" PRIu64
+           ",\"mb_per_s\":%.2f},\"speedup\":%.2f}\n",
+           iterations, HOST_BENCH_CRC_FRAME, nl_crc24q(buf, HOST_BENCH_CRC_FRAME), table_ns / 1000U, table_mbs, bitwise_ns / 1000U, bitwise_mbs,
+           table_mbs / bitwise_mbs);
+
+    return 0;
+}
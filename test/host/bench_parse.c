@@ -0,0 +1,195 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* nl */
+#include "rcv/nl_crc24q.h"
+#include "rcv/nl_rawlog.h"
+
+#include "alloc_count.h"
+#include "pipeline.h"
+
+/*
+ * Host counterpart of "gnss bench parse": replays nl_rawlog recordings through the GNSS server's receive path (see
+ * pipeline.h), with one synchronous consumer for every event type, and prints one JSON object per file. Heap
+ * allocations made while parsing are counted through the linker's malloc wrapper.
+ */
+
+#define HOST_BENCH_SAMPLES (4096) /* Per-frame latency reservoir */
+
+typedef struct {
+    host_pipeline_t     pipeline;
+    app_gnss_consumer_t consumer;
+    uint32_t            events[APP_GNSS_DISPATCHER_TYPE_COUNT];
+    uint64_t            mark_ns; /* End of the previous frame or start of the chunk */
+    uint32_t            frames;
+    uint64_t            samples[HOST_BENCH_SAMPLES];
+    uint8_t             buf[NL_RAWLOG_CHUNK_MAX];
+} host_bench_parse_t;
+
+static uint64_t host_bench_now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int host_bench_consumer(void *user_data, app_gnss_cb_type_t type, void *data) {
+    host_bench_parse_t *bench = user_data;
+
+    bench->events[__builtin_ctz(type)]++;
+
+    return 0;
+}
+
+static void host_bench_frame(void *ctx, app_gnss_frame_type_t type, const uint8_t *frame, size_t len, bool ok) {
+    host_bench_parse_t *bench = ctx;
+
+    /* Reservoir sampling keeps the percentiles fair over long captures */
+    const uint64_t now = host_bench_now_ns();
+    const uint64_t ns  = now - bench->mark_ns;
+
+    if (bench->frames < HOST_BENCH_SAMPLES) {
+        bench->samples[bench->frames] = ns;
+    } else {
+        const uint32_t slot = (uint32_t)rand() % (bench->frames + 1U);
+        if (slot < HOST_BENCH_SAMPLES) {
+            bench->samples[slot] = ns;
+        }
+    }
+
+    bench->frames++;
+    bench->mark_ns = host_bench_now_ns();
+}
+
+static int host_bench_cmp(const void *a, const void *b) {
+    const uint64_t x = *(const uint64_t *)a;
+    const uint64_t y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static int host_bench_parse(const char *path, uint32_t iterations) {
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) {
+        fprintf(stderr, "Failed to open %s.\n", path);
+
+        return -1;
+    }
+
+    host_bench_parse_t *bench = calloc(1, sizeof(host_bench_parse_t));
+    if (bench == NULL || host_pipeline_init(&bench->pipeline, host_bench_frame, bench) != 0) {
+        fprintf(stderr, "Failed to allocate benchmark state.\n");
+        free(bench);
+        fclose(fp);
+
+        return -1;
+    }
+
+    bench->consumer = (app_gnss_consumer_t){
+        .type      = APP_GNSS_CB_FIX | APP_GNSS_CB_SAT | APP_GNSS_CB_RAW_NMEA | APP_GNSS_CB_RAW_RTCM | APP_GNSS_CB_OBS,
+        .cb        = host_bench_consumer,
+        .user_data = bench,
+    };
+
+    app_gnss_dispatcher_update(&bench->pipeline.dispatcher, &bench->consumer, NULL);
+
+    uint64_t bytes   = 0;
+    uint64_t busy_ns = 0;
+    int      ret     = 0;
+
+    host_alloc_count_reset();
+
+    for (uint32_t i = 0; i < iterations && ret == 0; i++) {
+        nl_rawlog_reader_t reader;
+
+        rewind(fp);
+        if (nl_rawlog_reader_open(&reader, fp) != 0) {
+            fprintf(stderr, "%s is not a GNSS recording.\n", path);
+            ret = -2;
+            break;
+        }
+
+        for (;;) {
+            uint8_t   flags;
+            const int len = nl_rawlog_reader_next(&reader, bench->buf, &flags);
+            if (len < 0) {
+                break;
+            }
+
+            host_alloc_count_enable(true);
+            const uint64_t start = host_bench_now_ns();
+            bench->mark_ns       = start;
+
+            bench->pipeline.now_us = (int64_t)(start / 1000U);
+            app_gnss_parser_input(&bench->pipeline.parser, APP_GNSS_PARSER_REPLAY, bench->buf, len,
+                                  flags & NL_RAWLOG_IDLE);
+
+            busy_ns += host_bench_now_ns() - start;
+            host_alloc_count_enable(false);
+
+            bytes += len;
+        }
+    }
+
+    fclose(fp);
+
+    if (ret == 0) {
+        const app_gnss_demux_stats_t *stats   = &bench->pipeline.parser.demux.stats;
+        const uint32_t samples = (bench->frames < HOST_BENCH_SAMPLES) ? bench->frames : HOST_BENCH_SAMPLES;
+        const double   seconds = (busy_ns > 0) ? busy_ns / 1e9 : 1e-9;
+
+        qsort(bench->samples, samples, sizeof(uint64_t), host_bench_cmp);
+
+#define HOST_BENCH_PCT(p) (samples ? bench->samples[(samples - 1U) * (p) / 100U] / 1e3 : 0.0)
+        printf("{\"target\":\"parse\",\"file\":\"%s\",\"iterations\":%" PRIu32 ",\"bytes\":%" PRIu64
+               ",\"busy_us\":%" PRIu64 ",\"nmea_frames\":%" PRIu32 ",\"rtcm_frames\":%" PRIu32
+               ",\"rejected\":%" PRIu32 ",\"skipped_bytes\":%" PRIu32 ",\"epochs\":%" PRIu32
+               ",\"events\":{\"fix\":%" PRIu32 ",\"sat\":%" PRIu32 ",\"nmea\":%" PRIu32 ",\"rtcm\":%" PRIu32
+               ",\"obs\":%" PRIu32 "},\"bytes_per_s\":%.0f,\"frames_per_s\":%.0f,\"latency_us\":{\"p50\":%.2f,"
+               "\"p90\":%.2f,\"p99\":%.2f,\"max\":%.2f},\"allocs_per_frame\":%.3f}\n",
+               path, iterations, bytes, busy_ns / 1000U, stats->nmea_frames, stats->rtcm_frames, stats->rejected,
+               stats->skipped_bytes, bench->pipeline.epochs, bench->events[0], bench->events[1], bench->events[2],
+               bench->events[3], bench->events[5], bytes / seconds, bench->frames / seconds, HOST_BENCH_PCT(50),
+               HOST_BENCH_PCT(90), HOST_BENCH_PCT(99), HOST_BENCH_PCT(100),
+               bench->frames ? (double)host_alloc_count_get() / bench->frames : 0.0);
+#undef HOST_BENCH_PCT
+    }
+
+    app_gnss_dispatcher_update(&bench->pipeline.dispatcher, NULL, &bench->consumer);
+    free(bench);
+
+    return ret;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s [-n ITERATIONS] <RECORDING>...\n", argv[0]);
+
+        return 2;
+    }
+
+    uint32_t iterations = 1;
+    int      arg        = 1;
+
+    if (strcmp(argv[arg], "-n") == 0 && argc > 2) {
+        iterations = strtoul(argv[arg + 1], NULL, 0);
+        iterations = (iterations > 0) ? iterations : 1;
+        arg += 2;
+    }
+
+    nl_crc24q_init();
+
+    int ret = 0;
+
+    for (; arg < argc; arg++) {
+        if (host_bench_parse(argv[arg], iterations) != 0) {
+            ret = 1;
+        }
+    }
+
+    return ret;
+}
@@ -0,0 +1,229 @@
+#include <stdarg.h>
+#include <string.h>
+
+/* nl */
+#include "rcv/nl_msm.h"
+#include "rcv/nl_rawlog.h"
+#include "rcv/nl_rtcm_station.h"
+
+#include "capture.h"
+
+#define HOST_CAPTURE_EPOCH_MAX (8192)
+#define HOST_CAPTURE_TOW_START (345600U) /* GPS time of week at the first epoch, seconds */
+
+typedef struct {
+    uint8_t  buf[HOST_CAPTURE_EPOCH_MAX];
+    size_t   len;
+    uint32_t rng;
+} host_capture_epoch_t;
+
+typedef struct {
+    uint16_t      message;
+    uint8_t       nsat;
+    const uint8_t sig_id[4];
+    uint8_t       nsig;
+    char          talker[3];
+} host_capture_system_t;
+
+static const host_capture_system_t s_host_capture_systems[] = {
+    {.message = 1077, .nsat = 10, .sig_id = {2, 16, 22}, .nsig = 3, .talker = "GP"}, /* L1C, L2L, L5I */
+    {.message = 1097, .nsat = 8, .sig_id = {2, 15}, .nsig = 2, .talker = "GA"},      /* E1C, E5bQ */
+};
+
+static uint32_t host_capture_rand(host_capture_epoch_t *epoch) {
+    /* xorshift32 */
+    uint32_t x = epoch->rng;
+
+    x ^= x << 13U;
+    x ^= x >> 17U;
+    x ^= x << 5U;
+
+    return epoch->rng = x;
+}
+
+static int32_t host_capture_range(host_capture_epoch_t *epoch, int32_t min, int32_t max) {
+    return min + (int32_t)(host_capture_rand(epoch) % (uint32_t)(max - min + 1));
+}
+
+static void host_capture_nmea(host_capture_epoch_t *epoch, const char *fmt, ...) {
+    char    body[256];
+    va_list args;
+
+    va_start(args, fmt);
+    vsnprintf(body, sizeof(body), fmt, args);
+    va_end(args);
+
+    uint8_t cs = 0U;
+    for (const char *p = body; *p != '\0'; p++) {
+        cs ^= (uint8_t)*p;
+    }
+
+    epoch->len += snprintf((char *)&epoch->buf[epoch->len], sizeof(epoch->buf) - epoch->len, "$%s*%02X\r\n", body, cs);
+}
+
+static void host_capture_msm(host_capture_epoch_t *epoch, const host_capture_system_t *system, uint32_t tow_ms,
+                             bool multiple) {
+    nl_msm_t msm;
+
+    memset(&msm, 0U, sizeof(msm));
+
+    msm.type      = system->message;
+    msm.msm_type  = 7;
+    msm.header[0] = (0U << 20U) | ((tow_ms >> 10U) & 0xFFFFFU);
+    msm.header[1] = ((tow_ms & 0x3FFU) << 19U) | ((multiple ? 1U : 0U) << 18U);
+
+    msm.nsat = system->nsat;
+    msm.nsig = system->nsig;
+
+    for (uint8_t i = 0; i < msm.nsat; i++) {
+        msm.sat_id[i] = 1U + i * 3U;
+    }
+
+    memcpy(msm.sig_id, system->sig_id, msm.nsig);
+
+    for (uint8_t i = 0; i < msm.nsat; i++) {
+        msm.rough_ms[i]   = host_capture_range(epoch, 64, 90);
+        msm.ext_info[i]   = host_capture_range(epoch, 0, 15);
+        msm.rough_mod[i]  = host_capture_range(epoch, 0, 1023);
+        msm.rough_rate[i] = host_capture_range(epoch, -800, 800);
+
+        for (uint8_t j = 0; j < msm.nsig; j++) {
+            /* The first signal is always tracked, the others 9 times out of 10 */
+            msm.cell[i][j] = (j == 0) || host_capture_rand(epoch) % 10U != 0U;
+            if (!msm.cell[i][j]) {
+                continue;
+            }
+
+            const uint8_t n = msm.ncell++;
+
+            msm.fine_pr[n]    = host_capture_range(epoch, -(1 << 19) + 64, (1 << 19) - 64);
+            msm.fine_cp[n]    = host_capture_range(epoch, -(1 << 23) + 8, (1 << 23) - 8);
+            msm.lock_ms[n]    = host_capture_range(epoch, 0, 600000);
+            msm.half_cycle[n] = host_capture_range(epoch, 0, 1);
+            msm.cnr[n]        = host_capture_range(epoch, 25 * 16, 52 * 16);
+            msm.fine_rate[n]  = host_capture_range(epoch, -16000, 16000);
+
+            /* Carrier phase is lost now and then */
+            if (host_capture_rand(epoch) % 20U == 0U) {
+                msm.fine_cp[n] = NL_MSM_INVALID;
+            }
+        }
+    }
+
+    const int len = nl_msm_encode(&msm, 7, &epoch->buf[epoch->len], sizeof(epoch->buf) - epoch->len);
+    if (len > 0) {
+        epoch->len += len;
+    }
+}
+
+static void host_capture_epoch(host_capture_epoch_t *epoch, uint32_t n) {
+    const uint32_t tow = HOST_CAPTURE_TOW_START + n;
+    const uint32_t sod = (tow + 86400U - 18U) % 86400U; /* UTC second of day */
+    char           utc[16];
+
+    snprintf(utc, sizeof(utc), "%02u%02u%02u.00", sod / 3600U, (sod / 60U) % 60U, sod % 60U);
+
+    /* A slow walk around a fixed point, centimeters per epoch */
+    const double lat = 3958.1234567 + host_capture_range(epoch, -50, 50) * 1e-6;
+    const double lon = 11619.1234567 + host_capture_range(epoch, -50, 50) * 1e-6;
+
+    host_capture_nmea(epoch, "GNGGA,%s,%.7f,N,%.7f,E,4,24,0.6,55.%03d,M,-8.5,M,1.0,0000", utc, lat, lon,
+                      host_capture_range(epoch, 0, 999));
+    host_capture_nmea(epoch, "GNRMC,%s,A,%.7f,N,%.7f,E,0.012,42.1,170726,,,R,V", utc, lat, lon);
+
+    for (size_t s = 0; s < sizeof(s_host_capture_systems) / sizeof(s_host_capture_systems[0]); s++) {
+        const host_capture_system_t *system = &s_host_capture_systems[s];
+        char                         used[64];
+        size_t                       used_len = 0;
+
+        for (uint8_t i = 0; i < 12; i++) {
+            if (i < system->nsat) {
+                used_len += snprintf(&used[used_len], sizeof(used) - used_len, "%02u,", 1U + i * 3U);
+            } else {
+                used_len += snprintf(&used[used_len], sizeof(used) - used_len, ",");
+            }
+        }
+
+        host_capture_nmea(epoch, "GNGSA,A,3,%s1.2,0.6,1.0,%u", used, (unsigned)(s == 0 ? 1 : 3));
+
+        const uint8_t pages = (system->nsat + 3U) / 4U;
+
+        for (uint8_t page = 0; page < pages; page++) {
+            char   sats[96];
+            size_t sats_len = 0;
+
+            for (uint8_t i = page * 4U; i < system->nsat && i < page * 4U + 4U; i++) {
+                sats_len += snprintf(&sats[sats_len], sizeof(sats) - sats_len, ",%02u,%02d,%03d,%02d", 1U + i * 3U,
+                                     host_capture_range(epoch, 10, 89), host_capture_range(epoch, 0, 359),
+                                     host_capture_range(epoch, 25, 52));
+            }
+
+            host_capture_nmea(epoch, "%sGSV,%u,%u,%02u%s,1", system->talker, pages, page + 1U, system->nsat, sats);
+        }
+    }
+
+    for (size_t s = 0; s < sizeof(s_host_capture_systems) / sizeof(s_host_capture_systems[0]); s++) {
+        const bool last = s + 1 == sizeof(s_host_capture_systems) / sizeof(s_host_capture_systems[0]);
+
+        host_capture_msm(epoch, &s_host_capture_systems[s], (tow * 1000U) % 604800000U, !last);
+    }
+
+    if (n % 10U == 0U) {
+        const nl_rtcm_arp_t arp = {
+            .station_id = 0,
+            .gps        = true,
+            .galileo    = true,
+            .ecef       = {-2148744.3969, 4426641.2099, 4044655.8564},
+        };
+
+        const int len = nl_rtcm_arp_encode(&arp, false, &epoch->buf[epoch->len], sizeof(epoch->buf) - epoch->len);
+        if (len > 0) {
+            epoch->len += len;
+        }
+    }
+}
+
+static int host_capture_record(FILE *fp, uint32_t delta_us, const uint8_t *data, uint16_t len, uint8_t flags) {
+    uint8_t header[NL_RAWLOG_RECORD_HEADER];
+
+    nl_rawlog_record_header(header, delta_us, len, flags);
+
+    if (fwrite(header, 1, sizeof(header), fp) != sizeof(header)) return -1;
+    if (len > 0 && fwrite(data, 1, len, fp) != len) return -1;
+
+    return 0;
+}
+
+int host_capture_write(FILE *fp, const host_capture_config_t *config) {
+    host_capture_epoch_t epoch = {.rng = 0x2545F491U};
+    uint8_t              header[NL_RAWLOG_FILE_HEADER];
+
+    nl_rawlog_file_header(header);
+    if (fwrite(header, 1, sizeof(header), fp) != sizeof(header)) return -1;
+
+    const uint32_t chunk_size = (config->chunk_size > NL_RAWLOG_CHUNK_MAX) ? NL_RAWLOG_CHUNK_MAX : config->chunk_size;
+    const uint32_t chunk_us   = (uint32_t)((uint64_t)chunk_size * 10U * 1000000U / config->baud_rate);
+    uint32_t       burst_us   = 0;
+
+    for (uint32_t n = 0; n < config->epochs; n++) {
+        epoch.len = 0;
+        host_capture_epoch(&epoch, n);
+
+        /* The burst starts on the second, records follow at the line rate */
+        uint32_t delta_us = (n == 0) ? 0U : 1000000U - burst_us;
+
+        burst_us = 0;
+
+        for (size_t pos = 0; pos < epoch.len; pos += chunk_size) {
+            const size_t  len   = (epoch.len - pos < chunk_size) ? epoch.len - pos : chunk_size;
+            const uint8_t flags = (pos + len == epoch.len) ? NL_RAWLOG_IDLE : 0U;
+
+            if (host_capture_record(fp, delta_us, &epoch.buf[pos], len, flags) != 0) return -1;
+
+            delta_us = chunk_us;
+            burst_us += chunk_us;
+        }
+    }
+
+    return 0;
+}
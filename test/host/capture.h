@@ -0,0 +1,24 @@
+#ifndef HOST_CAPTURE_H
+#define HOST_CAPTURE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Synthetic receiver output in the nl_rawlog format the recorder writes on target: one 1 Hz epoch of NMEA (GGA,
+ * RMC, GSA and GSV for GPS and Galileo) followed by GPS and Galileo MSM7 and a 1005 every 10 epochs, cut into
+ * UART-sized records with the idle flag after each burst. Deterministic, so results compare across runs.
+ */
+
+typedef struct {
+    uint32_t epochs;
+    uint32_t chunk_size; /* Bytes per record, like the UART RX full threshold */
+    uint32_t baud_rate;  /* Paces the record timestamps */
+} host_capture_config_t;
+
+#define HOST_CAPTURE_CONFIG_DEFAULT() {.epochs = 600, .chunk_size = 120, .baud_rate = 921600}
+
+/* Returns 0 on success, -1 on a write error. */
+int host_capture_write(FILE *fp, const host_capture_config_t *config);
+
+#endif  // HOST_CAPTURE_H
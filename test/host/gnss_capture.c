@@ -0,0 +1,40 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "capture.h"
+
+/* Writes a synthetic recording, the input of the host benchmarks and round-trip tests. */
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <OUTPUT> [EPOCHS] [CHUNK_SIZE]\n", argv[0]);
+
+        return 2;
+    }
+
+    host_capture_config_t config = HOST_CAPTURE_CONFIG_DEFAULT();
+
+    if (argc > 2) {
+        config.epochs = strtoul(argv[2], NULL, 0);
+    }
+
+    if (argc > 3) {
+        config.chunk_size = strtoul(argv[3], NULL, 0);
+    }
+
+    FILE *fp = fopen(argv[1], "wb");
+    if (fp == NULL) {
+        fprintf(stderr, "Failed to create %s.\n", argv[1]);
+
+        return 1;
+    }
+
+    const int ret = host_capture_write(fp, &config);
+
+    if (fclose(fp) != 0 || ret != 0) {
+        fprintf(stderr, "Failed to write %s.\n", argv[1]);
+
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include <string.h>
+
+/* nl */
+#include "rcv/nl_crc24q.h"
+#include "rcv/nl_nmea_index.h"
+
+#include "pipeline.h"
+
+static void host_pipeline_epoch(void *ctx, const app_gnss_fix_t *fix, const app_gnss_sat_t *sat) {
+    host_pipeline_t *pipeline = ctx;
+
+    pipeline->epochs++;
+
+    if ((fix->flags & APP_GNSS_FIX_HAS_POSITION) &&
+        app_gnss_dispatcher_subscribed(&pipeline->dispatcher, APP_GNSS_CB_FIX)) {
+        app_gnss_dispatcher_dispatch(&pipeline->dispatcher, APP_GNSS_CB_FIX, (void *)fix);
+    }
+
+    if (sat != NULL && app_gnss_dispatcher_subscribed(&pipeline->dispatcher, APP_GNSS_CB_SAT)) {
+        app_gnss_dispatcher_dispatch(&pipeline->dispatcher, APP_GNSS_CB_SAT, (void *)sat);
+    }
+}
+
+static bool host_pipeline_nmea(host_pipeline_t *pipeline, const uint8_t *frame, size_t len) {
+    nl_nmea_index_t index;
+
+    if (nl_nmea_index_build(&index, frame, len) != 0) {
+        return false;
+    }
+
+    if (app_gnss_dispatcher_subscribed(&pipeline->dispatcher, APP_GNSS_CB_RAW_NMEA)) {
+        const char  *address;
+        const size_t address_len = nl_nmea_field(&index, 0, &address);
+
+        app_gnss_nmea_t nmea = {
+            .type     = {0},
+            .data_len = len,
+            .data     = (uint8_t *)frame,
+            .index    = &index,
+        };
+
+        if (address_len >= 5) {
+            memcpy(nmea.type, &address[2], sizeof(nmea.type));
+        }
+
+        app_gnss_dispatcher_dispatch(&pipeline->dispatcher, APP_GNSS_CB_RAW_NMEA, &nmea);
+    }
+
+    if (app_gnss_dispatcher_subscribed(&pipeline->dispatcher, APP_GNSS_CB_FIX | APP_GNSS_CB_SAT)) {
+        app_gnss_fix_builder_feed(&pipeline->parser.fix_builder, &index,
+                                  app_gnss_dispatcher_subscribed(&pipeline->dispatcher, APP_GNSS_CB_SAT));
+    }
+
+    return true;
+}
+
+static bool host_pipeline_rtcm(host_pipeline_t *pipeline, const uint8_t *frame, size_t len) {
+    const uint32_t crc = ((uint32_t)frame[len - 3] << 16U) | ((uint32_t)frame[len - 2] << 8U) | frame[len - 1];
+
+    if (nl_crc24q(frame, len - 3) != crc) {
+        return false;
+    }
+
+    const uint16_t type = (len >= 8) ? (((uint16_t)frame[3] << 4U) | (frame[4] >> 4U)) : 0U;
+
+    if (app_gnss_dispatcher_subscribed(&pipeline->dispatcher, APP_GNSS_CB_RAW_RTCM)) {
+        app_gnss_rtcm_t rtcm = {
+            .type     = type,
+            .data     = (uint8_t *)frame,
+            .data_len = len,
+        };
+
+        app_gnss_dispatcher_dispatch(&pipeline->dispatcher, APP_GNSS_CB_RAW_RTCM, &rtcm);
+    }
+
+    const uint8_t msm_type = nl_msm_type(type);
+    if ((msm_type == 4 || msm_type == 7) && app_gnss_dispatcher_subscribed(&pipeline->dispatcher, APP_GNSS_CB_OBS)) {
+        const app_gnss_obs_t *obs = app_gnss_obs_decoder_feed(&pipeline->obs_decoder, frame, len, pipeline->now_us);
+        if (obs != NULL) {
+            app_gnss_dispatcher_dispatch(&pipeline->dispatcher, APP_GNSS_CB_OBS, (void *)obs);
+        }
+    }
+
+    return true;
+}
+
+static bool host_pipeline_frame(void *ctx, app_gnss_frame_type_t type, const uint8_t *frame, size_t len) {
+    host_pipeline_t *pipeline = ctx;
+
+    const bool ok = (type == APP_GNSS_FRAME_NMEA) ? host_pipeline_nmea(pipeline, frame, len)
+                                                  : host_pipeline_rtcm(pipeline, frame, len);
+
+    if (pipeline->hook != NULL) {
+        pipeline->hook(pipeline->hook_ctx, type, frame, len, ok);
+    }
+
+    return ok;
+}
+
+int host_pipeline_init(host_pipeline_t *pipeline, host_pipeline_hook_t hook, void *hook_ctx) {
+    memset(pipeline, 0U, sizeof(host_pipeline_t));
+
+    pipeline->hook     = hook;
+    pipeline->hook_ctx = hook_ctx;
+
+    app_gnss_obs_decoder_init(&pipeline->obs_decoder);
+
+    if (app_gnss_parser_init(&pipeline->parser, host_pipeline_frame, host_pipeline_epoch, pipeline) != 0) {
+        return -1;
+    }
+
+    return app_gnss_dispatcher_init(&pipeline->dispatcher);
+}
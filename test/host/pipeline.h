@@ -0,0 +1,35 @@
+#ifndef HOST_PIPELINE_H
+#define HOST_PIPELINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* App */
+#include "app/gnss/dispatcher.h"
+#include "app/gnss/obs_decoder.h"
+#include "app/gnss/parser.h"
+
+/*
+ * The GNSS server's receive path without the UART: parser, NMEA indexer, fix builder, RTCM CRC check, MSM
+ * observation decoder and consumer dispatch, wired the way gnss_server.c wires them.
+ */
+
+/* Called after each candidate frame, under the parser mutex, with the decoder's verdict */
+typedef void (*host_pipeline_hook_t)(void *ctx, app_gnss_frame_type_t type, const uint8_t *frame, size_t len, bool ok);
+
+typedef struct {
+    app_gnss_parser_t      parser;
+    app_gnss_obs_decoder_t obs_decoder;
+    app_gnss_dispatcher_t  dispatcher;
+    uint32_t               epochs;
+    int64_t                now_us; /* Timestamp handed to the observation decoder */
+
+    host_pipeline_hook_t hook;
+    void                *hook_ctx;
+} host_pipeline_t;
+
+/* Returns 0 on success, -1 if a mutex or the consumer set could not be allocated. */
+int host_pipeline_init(host_pipeline_t *pipeline, host_pipeline_hook_t hook, void *hook_ctx);
+
+#endif  // HOST_PIPELINE_H
@@ -0,0 +1,246 @@
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* nl */
+#include "rcv/nl_crc24q.h"
+#include "rcv/nl_rawlog.h"
+
+#include "host_freertos.h"
+#include "pipeline.h"
+
+/*
+ * Host counterpart of "gnss replay": plays recordings through the parser, paced like the replay task, while a second
+ * thread keeps feeding live receiver output the way the UART task does. Live sentences are $GPTXT only, which never
+ * appear in a recording, so any of them decoded while a replay owns the parser means live input got past the
+ * ownership check. Prints one JSON object per run and fails on any such leak.
+ */
+
+#define HOST_REPLAY_LIVE_SENTENCE "$GPTXT,01,01,02,LIVE*5B\r\n"
+
+typedef struct {
+    host_pipeline_t     pipeline;
+    app_gnss_consumer_t consumer;
+    uint32_t            fixes;
+
+    pthread_t   live_thread;
+    atomic_bool live_stop;
+    uint32_t    live_frames;  /* Live sentences decoded outside a replay */
+    uint32_t    live_leaked;  /* Live sentences decoded while a replay owned the parser */
+    uint32_t    live_chunks;  /* Live chunks offered to the parser */
+
+    uint8_t buf[NL_RAWLOG_CHUNK_MAX];
+} host_replay_t;
+
+static int64_t host_replay_now_us(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (int64_t)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+static void host_replay_sleep_us(int64_t us) {
+    const struct timespec delay = {
+        .tv_sec  = us / 1000000,
+        .tv_nsec = (us % 1000000) * 1000,
+    };
+
+    nanosleep(&delay, NULL);
+}
+
+static int host_replay_consumer(void *user_data, app_gnss_cb_type_t type, void *data) {
+    host_replay_t *replay = user_data;
+
+    replay->fixes++;
+
+    return 0;
+}
+
+/* Runs under the parser mutex, so the ownership flag cannot change underneath */
+static void host_replay_frame(void *ctx, app_gnss_frame_type_t type, const uint8_t *frame, size_t len, bool ok) {
+    host_replay_t *replay = ctx;
+
+    if (!ok || type != APP_GNSS_FRAME_NMEA || len < 6 || memcmp(frame, "$GPTXT", 6) != 0) {
+        return;
+    }
+
+    if (app_gnss_parser_replaying(&replay->pipeline.parser)) {
+        replay->live_leaked++;
+    } else {
+        replay->live_frames++;
+    }
+}
+
+/* Stands in for the UART task: a sentence per chunk, an idle mark now and then */
+static void *host_replay_live_task(void *parameters) {
+    host_replay_t *replay = parameters;
+    const size_t   len    = strlen(HOST_REPLAY_LIVE_SENTENCE);
+
+    for (uint32_t n = 0; !atomic_load(&replay->live_stop); n++) {
+        app_gnss_parser_input(&replay->pipeline.parser, APP_GNSS_PARSER_LIVE,
+                              (const uint8_t *)HOST_REPLAY_LIVE_SENTENCE, len, n % 8U == 7U);
+
+        replay->live_chunks++;
+
+        if (n % 64U == 63U) {
+            host_replay_sleep_us(100);
+        }
+    }
+
+    return NULL;
+}
+
+/* Same loop as app_gnss_replay_task() */
+static int host_replay_play(host_replay_t *replay, FILE *fp, uint16_t speed, uint64_t *bytes) {
+    nl_rawlog_reader_t reader;
+
+    rewind(fp);
+    if (nl_rawlog_reader_open(&reader, fp) != 0) {
+        return -1;
+    }
+
+    if (app_gnss_parser_replay_begin(&replay->pipeline.parser) != 0) {
+        return -1;
+    }
+
+    const int64_t start_us = host_replay_now_us();
+    int           ret      = 0;
+
+    for (;;) {
+        uint8_t flags;
+
+        ret = nl_rawlog_reader_next(&reader, replay->buf, &flags);
+        if (ret < 0) {
+            break;
+        }
+
+        if (speed > 0) {
+            const int64_t wait = start_us + (int64_t)(reader.time_us / speed) - host_replay_now_us();
+            if (wait > 0) {
+                host_replay_sleep_us(wait);
+            }
+        }
+
+        app_gnss_parser_input(&replay->pipeline.parser, APP_GNSS_PARSER_REPLAY, replay->buf, ret,
+                              flags & NL_RAWLOG_IDLE);
+
+        *bytes += ret;
+    }
+
+    app_gnss_parser_replay_end(&replay->pipeline.parser);
+
+    return (ret == -2) ? -2 : 0;
+}
+
+int main(int argc, char **argv) {
+    uint16_t speed  = 0;
+    uint32_t rounds = 1;
+    uint32_t jitter = 0;
+    int      arg    = 1;
+
+    for (; arg + 1 < argc && argv[arg][0] == '-'; arg += 2) {
+        if (strcmp(argv[arg], "-s") == 0) {
+            speed = strtoul(argv[arg + 1], NULL, 0);
+        } else if (strcmp(argv[arg], "-n") == 0) {
+            rounds = strtoul(argv[arg + 1], NULL, 0);
+        } else if (strcmp(argv[arg], "-j") == 0) {
+            jitter = strtoul(argv[arg + 1], NULL, 0);
+        } else {
+            break;
+        }
+    }
+
+    if (arg >= argc) {
+        fprintf(stderr, "Usage: %s [-s SPEED] [-n ROUNDS] [-j JITTER] <RECORDING>\n", argv[0]);
+        fprintf(stderr, "\tSPEED: multiple of the recorded pace, 0 (default) for as fast as possible\n");
+        fprintf(stderr, "\tJITTER: random delay before each mutex take, up to JITTER us\n");
+
+        return 2;
+    }
+
+    const char *path = argv[arg];
+
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) {
+        fprintf(stderr, "Failed to open %s.\n", path);
+
+        return 1;
+    }
+
+    nl_crc24q_init();
+    host_freertos_take_jitter_set(jitter);
+
+    static host_replay_t replay;
+
+    if (host_pipeline_init(&replay.pipeline, host_replay_frame, &replay) != 0) {
+        fprintf(stderr, "Failed to set up the parser.\n");
+        fclose(fp);
+
+        return 1;
+    }
+
+    replay.consumer = (app_gnss_consumer_t){
+        .type      = APP_GNSS_CB_FIX,
+        .cb        = host_replay_consumer,
+        .user_data = &replay,
+    };
+
+    app_gnss_dispatcher_update(&replay.pipeline.dispatcher, &replay.consumer, NULL);
+
+    atomic_store(&replay.live_stop, false);
+    pthread_create(&replay.live_thread, NULL, host_replay_live_task, &replay);
+
+    uint64_t      bytes    = 0;
+    int           ret      = 0;
+    const int64_t start_us = host_replay_now_us();
+
+    /* Back to back rounds, each one a fresh handover in both directions */
+    for (uint32_t i = 0; i < rounds && ret == 0; i++) {
+        host_replay_sleep_us(200);
+
+        ret = host_replay_play(&replay, fp, speed, &bytes);
+    }
+
+    const int64_t elapsed_us = host_replay_now_us() - start_us;
+
+    host_replay_sleep_us(1000);
+    atomic_store(&replay.live_stop, true);
+    pthread_join(replay.live_thread, NULL);
+
+    fclose(fp);
+
+    if (ret != 0) {
+        fprintf(stderr, "%s: %s.\n", path, (ret == -2) ? "corrupt record" : "not a GNSS recording");
+
+        return 1;
+    }
+
+    const app_gnss_demux_stats_t *stats = &replay.pipeline.parser.demux.stats;
+
+    printf("{\"target\":\"replay\",\"file\":\"%s\",\"speed\":%u,\"rounds\":%" PRIu32 ",\"bytes\":%" PRIu64
+           ",\"elapsed_ms\":%" PRId64 ",\"nmea_frames\":%" PRIu32 ",\"rtcm_frames\":%" PRIu32 ",\"rejected\":%" PRIu32
+           ",\"epochs\":%" PRIu32 ",\"fixes\":%" PRIu32 ",\"live\":{\"chunks\":%" PRIu32 ",\"frames\":%" PRIu32
+           ",\"dropped\":%" PRIu32 ",\"leaked\":%" PRIu32 "}}\n",
+           path, speed, rounds, bytes, elapsed_us / 1000, stats->nmea_frames, stats->rtcm_frames, stats->rejected,
+           replay.pipeline.epochs, replay.fixes, replay.live_chunks, replay.live_frames,
+           replay.pipeline.parser.live_dropped, replay.live_leaked);
+
+    if (replay.live_leaked > 0) {
+        fprintf(stderr, "%" PRIu32 " live sentences were parsed during a replay.\n", replay.live_leaked);
+
+        return 1;
+    }
+
+    if (replay.live_frames == 0) {
+        fprintf(stderr, "No live sentence was parsed, the live thread never ran.\n");
+
+        return 1;
+    }
+
+    return 0;
+}
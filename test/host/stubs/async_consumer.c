@@ -0,0 +1,21 @@
+#include <stdlib.h>
+
+/* App */
+#include "app/gnss/async_consumer.h"
+
+/*
+ * Host builds only register synchronous consumers. Asynchronous delivery needs the IDF ring buffer, so creating
+ * one fails and the dispatcher never sees an async context.
+ */
+
+app_gnss_async_t *app_gnss_async_create(const app_gnss_async_config_t *config, app_gnss_cb_t cb, void *user_data) {
+    return NULL;
+}
+
+void app_gnss_async_destroy(app_gnss_async_t *async) {}
+
+void app_gnss_async_enqueue(app_gnss_async_t *async, app_gnss_cb_type_t type, const void *payload) {
+    abort();
+}
+
+void app_gnss_async_stats_get(app_gnss_async_t *async, app_gnss_async_stats_t *stats) {}
@@ -0,0 +1,81 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "host_freertos.h"
+
+struct host_semaphore {
+    pthread_mutex_t mutex;
+};
+
+static atomic_uint s_host_freertos_take_jitter_us;
+
+void host_freertos_take_jitter_set(uint32_t max_us) {
+    atomic_store(&s_host_freertos_take_jitter_us, max_us);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    SemaphoreHandle_t sem = malloc(sizeof(struct host_semaphore));
+    if (sem == NULL) {
+        return NULL;
+    }
+
+    pthread_mutex_init(&sem->mutex, NULL);
+
+    return sem;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+    const uint32_t jitter_us = atomic_load_explicit(&s_host_freertos_take_jitter_us, memory_order_relaxed);
+
+    if (jitter_us > 0) {
+        const struct timespec delay = {.tv_sec = 0, .tv_nsec = (long)(random() % (jitter_us + 1U)) * 1000L};
+
+        nanosleep(&delay, NULL);
+    }
+
+    if (ticks == portMAX_DELAY) {
+        return (pthread_mutex_lock(&sem->mutex) == 0) ? pdPASS : pdFAIL;
+    }
+
+    struct timespec deadline;
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += ticks / 1000U;
+    deadline.tv_nsec += (long)(ticks % 1000U) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    return (pthread_mutex_timedlock(&sem->mutex, &deadline) == 0) ? pdPASS : pdFAIL;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    return (pthread_mutex_unlock(&sem->mutex) == 0) ? pdPASS : pdFAIL;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) {
+    pthread_mutex_destroy(&sem->mutex);
+    free(sem);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    if (ticks == 0) {
+        sched_yield();
+
+        return;
+    }
+
+    const struct timespec delay = {
+        .tv_sec  = ticks / 1000U,
+        .tv_nsec = (long)(ticks % 1000U) * 1000000L,
+    };
+
+    nanosleep(&delay, NULL);
+}
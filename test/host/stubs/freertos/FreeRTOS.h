@@ -0,0 +1,23 @@
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+/*
+ * Just enough of the FreeRTOS API for the app modules built on the host. Tasks are pthreads, ticks are
+ * milliseconds.
+ */
+
+#include <stdint.h>
+
+typedef int32_t  BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE            (0)
+#define pdTRUE             (1)
+#define pdFAIL             (0)
+#define pdPASS             (1)
+#define portMAX_DELAY      (UINT32_MAX)
+#define portTICK_PERIOD_MS (1)
+#define pdMS_TO_TICKS(ms)  ((TickType_t)(ms))
+
+#endif  // HOST_FREERTOS_H
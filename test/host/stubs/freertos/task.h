@@ -0,0 +1,10 @@
+#ifndef HOST_FREERTOS_TASK_H
+#define HOST_FREERTOS_TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+void vTaskDelay(TickType_t ticks);
+
+#define taskYIELD() vTaskDelay(0)
+
+#endif  // HOST_FREERTOS_TASK_H
@@ -0,0 +1,13 @@
+#ifndef HOST_FREERTOS_HOST_H
+#define HOST_FREERTOS_HOST_H
+
+#include <stdint.h>
+
+/*
+ * Fault injection for the host FreeRTOS stubs. A non-zero jitter makes every xSemaphoreTake() sleep for a random
+ * 0 to max_us microseconds before it locks, which widens the window between a caller's unlocked check and the lock
+ * the way preemption by a higher priority task would on target.
+ */
+void host_freertos_take_jitter_set(uint32_t max_us);
+
+#endif  // HOST_FREERTOS_HOST_H
@@ -0,0 +1,509 @@
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* nl */
+#include "rcv/nl_crc24q.h"
+#include "rcv/nl_msm.h"
+#include "rcv/nl_rawlog.h"
+
+/* App */
+#include "app/gnss/frame_demux.h"
+
+/*
+ * MSM decoding against golden frames first: an MSM7 and an MSM4 message encoded field by field from the RTCM 10403.3
+ * definitions, outside of nl_msm, from known observations. The decoded values must give back those observations
+ * within the resolution of the message type.
+ *
+ * Then the MSM transcoding round trip on recorded streams, the path the LoRa server takes before forwarding. Every
+ * MSM frame of a recording, and each golden frame, is decoded and:
+ *   - re-encoded unchanged, which must reproduce the input bytes;
+ *   - re-encoded as MSM4 (MSM7 input only), then decoded again and checked against the input within MSM4
+ *     resolution;
+ *   - pruned to a satellite and signal subset and re-encoded at its own resolution, then decoded again and checked
+ *     cell by cell for exact values.
+ * Every frame produced must carry a valid CRC. Prints the average bytes per epoch of each form as JSON.
+ */
+
+#define HOST_MSM_SUBSET_SATS (0x5555555555555555ULL) /* Odd satellite IDs */
+#define HOST_MSM_SUBSET_SIGS (0x00000002UL)          /* Signal ID 2: GPS L1C, Galileo E1C, BeiDou B1I */
+#define HOST_MSM_M_PER_MS    (299792.458)
+#define HOST_MSM_GOLDEN_MAX  (8)
+
+/* One observation as it went into a golden frame */
+typedef struct {
+    uint8_t  sat_id;
+    uint8_t  sig_id;
+    double   range_m;
+    double   phase_m; /* NAN: sent as invalid */
+    double   rate_mps;
+    uint32_t lock_ms; /* Minimum lock time of the indicator sent */
+    uint8_t  half_cycle;
+    double   cnr_dbhz; /* 0: not computed */
+} host_msm_golden_cell_t;
+
+typedef struct {
+    const char            *name;
+    const uint8_t         *frame;
+    size_t                 len;
+    uint16_t               type;
+    uint8_t                ncell;
+    host_msm_golden_cell_t cells[HOST_MSM_GOLDEN_MAX];
+    double                 range_tolerance_m; /* Half the fine range resolution */
+    double                 phase_tolerance_m; /* Half the fine phase resolution */
+} host_msm_golden_t;
+
+typedef struct {
+    const char *path;
+    uint32_t    frames;
+    uint32_t    epochs;
+    uint32_t    failures;
+    uint64_t    bytes_in;
+    uint64_t    bytes_msm4;
+    uint64_t    bytes_subset;
+
+    nl_msm_t ref;
+    nl_msm_t work;
+    nl_msm_t check;
+    uint8_t  out[NL_MSM_MAX_FRAME];
+} host_msm_test_t;
+
+/* GPS, station 1234, TOW 345600 s, satellites 5, 12 and 25 on 1C and 2S, signal rates only in MSM7 */
+static const uint8_t HOST_MSM_GOLDEN_1077[] = {
+    0xD3, 0x00, 0x56, 0x43, 0x54, 0xD2, 0x52, 0x65, 0xC0, 0x00, 0x00, 0x00, 0x04, 0x08, 0x00, 0x40, 0x00, 0x00, 0x00,
+    0x00, 0x20, 0x01, 0x00, 0x00, 0x76, 0x8C, 0x9C, 0x84, 0x00, 0x1A, 0x99, 0xF3, 0x82, 0x7D, 0x90, 0x0E, 0x38, 0x01,
+    0xFD, 0x5F, 0x19, 0xD7, 0x37, 0x04, 0x4A, 0xC6, 0x18, 0x85, 0x41, 0x9A, 0xD7, 0xF6, 0x30, 0x17, 0xF4, 0x96, 0xD5,
+    0x00, 0x00, 0x00, 0x06, 0x51, 0xBA, 0x04, 0xFD, 0x17, 0x60, 0x25, 0x82, 0x30, 0x00, 0x00, 0xA2, 0xD9, 0xA2, 0xE3,
+    0x0C, 0x88, 0x00, 0xDC, 0x53, 0xC1, 0x50, 0x26, 0x96, 0xF1, 0xE1, 0xB0, 0x00, 0xEF, 0x01, 0xC2,
+};
+
+static const uint8_t HOST_MSM_GOLDEN_1074[] = {
+    0xD3, 0x00, 0x35, 0x43, 0x24, 0xD2, 0x52, 0x65, 0xC0, 0x00, 0x00, 0x00, 0x04, 0x08, 0x00, 0x40, 0x00, 0x00, 0x00,
+    0x00, 0x20, 0x01, 0x00, 0x00, 0x74, 0x8C, 0x9C, 0x85, 0xA9, 0x9F, 0x38, 0x27, 0x57, 0xCE, 0xB9, 0xC4, 0x4A, 0xC3,
+    0x10, 0xFD, 0x8C, 0x07, 0xF4, 0x96, 0xD4, 0x00, 0x00, 0x00, 0x65, 0x1B, 0xFA, 0x84, 0x25, 0xB4, 0x47, 0x90, 0x1C,
+    0x02, 0x36,
+};
+
+/* Lock times cover the DF407 end value and segments, and the DF402 extremes */
+static const host_msm_golden_t HOST_MSM_GOLDEN[] = {
+    {
+        .name              = "golden 1077",
+        .frame             = HOST_MSM_GOLDEN_1077,
+        .len               = sizeof(HOST_MSM_GOLDEN_1077),
+        .type              = 1077,
+        .ncell             = 5,
+        .cells             = {
+            {5, 2, 21234567.891, 21234571.102, -312.4567, 67108864, 0, 45.5625},
+            {5, 15, 21234569.345, 21234563.789, -312.4012, 11264, 1, 40.6875},
+            {12, 2, 23456789.012, NAN, 455.1234, 76, 0, 35.0},
+            {25, 2, 20012345.678, 20012346.543, 14.5678, 0, 0, 50.125},
+            {25, 15, 20012347.001, 20012340.456, 15.3456, 1, 0, 0.0},
+        },
+        .range_tolerance_m = 0.0003, /* 2^-30 ms */
+        .phase_tolerance_m = 0.0001, /* 2^-32 ms */
+    },
+    {
+        .name              = "golden 1074",
+        .frame             = HOST_MSM_GOLDEN_1074,
+        .len               = sizeof(HOST_MSM_GOLDEN_1074),
+        .type              = 1074,
+        .ncell             = 4,
+        .cells             = {
+            {5, 2, 21234567.891, 21234571.102, NAN, 524288, 0, 45.0},
+            {5, 15, 21234569.345, 21234563.789, NAN, 512, 1, 40.0},
+            {12, 2, 23456789.012, NAN, NAN, 0, 0, 35.0},
+            {25, 2, 20012345.678, 20012346.543, NAN, 4096, 0, 50.0},
+        },
+        .range_tolerance_m = 0.009,  /* 2^-25 ms */
+        .phase_tolerance_m = 0.0003, /* 2^-30 ms */
+    },
+};
+
+static void host_msm_fail(host_msm_test_t *test, const char *what, uint16_t type, int cell) {
+    if (test->failures++ < 10) {
+        fprintf(stderr, "%s: frame %" PRIu32 " (%u), cell %d: %s\n", test->path, test->frames, type, cell, what);
+    }
+}
+
+static bool host_msm_crc_ok(const uint8_t *frame, size_t len) {
+    if (len < 6) {
+        return false;
+    }
+
+    const uint32_t crc = ((uint32_t)frame[len - 3] << 16U) | ((uint32_t)frame[len - 2] << 8U) | frame[len - 1];
+
+    return nl_crc24q(frame, len - 3) == crc;
+}
+
+/* Index of the cell of a satellite and signal in the wire order, -1 if the message does not carry it */
+static int host_msm_cell(const nl_msm_t *msm, uint8_t sat_id, uint8_t sig_id) {
+    int cell = 0;
+
+    for (uint8_t i = 0; i < msm->nsat; i++) {
+        for (uint8_t j = 0; j < msm->nsig; j++) {
+            if (!msm->cell[i][j]) continue;
+
+            if (msm->sat_id[i] == sat_id && msm->sig_id[j] == sig_id) return cell;
+
+            cell++;
+        }
+    }
+
+    return -1;
+}
+
+static int host_msm_sat(const nl_msm_t *msm, uint8_t sat_id) {
+    for (uint8_t i = 0; i < msm->nsat; i++) {
+        if (msm->sat_id[i] == sat_id) return i;
+    }
+
+    return -1;
+}
+
+/* Encode, check the CRC and decode again into test->check. Returns the frame length, -1 on failure. */
+static int host_msm_reencode(host_msm_test_t *test, const nl_msm_t *msm, uint8_t msm_type) {
+    const int len = nl_msm_encode(msm, msm_type, test->out, sizeof(test->out));
+    if (len < 0) {
+        host_msm_fail(test, "encode failed", msm->type, -1);
+        return -1;
+    }
+
+    if (!host_msm_crc_ok(test->out, len)) {
+        host_msm_fail(test, "CRC mismatch", msm->type, -1);
+        return -1;
+    }
+
+    if (nl_msm_decode(&test->check, test->out, len) != 0) {
+        host_msm_fail(test, "re-encoded frame does not decode", msm->type, -1);
+        return -1;
+    }
+
+    if (test->check.msm_type != msm_type || test->check.header[0] != msm->header[0] ||
+        test->check.header[1] != msm->header[1]) {
+        host_msm_fail(test, "header changed", msm->type, -1);
+        return -1;
+    }
+
+    return len;
+}
+
+static bool host_msm_near(int32_t got, int32_t want, int32_t tolerance) {
+    if (got == NL_MSM_INVALID || want == NL_MSM_INVALID) return got == want;
+
+    return labs((long)got - (long)want) <= tolerance;
+}
+
+static void host_msm_check_msm4(host_msm_test_t *test) {
+    const nl_msm_t *ref = &test->ref;
+    const nl_msm_t *m4  = &test->check;
+
+    if (m4->nsat != ref->nsat || m4->nsig != ref->nsig || m4->ncell != ref->ncell ||
+        memcmp(m4->cell, ref->cell, sizeof(ref->cell)) != 0) {
+        host_msm_fail(test, "MSM4 masks differ", ref->type, -1);
+        return;
+    }
+
+    for (uint8_t i = 0; i < ref->nsat; i++) {
+        if (m4->sat_id[i] != ref->sat_id[i] || m4->rough_ms[i] != ref->rough_ms[i] ||
+            m4->rough_mod[i] != ref->rough_mod[i] || m4->ext_info[i] != 0 || m4->rough_rate[i] != NL_MSM_INVALID) {
+            host_msm_fail(test, "MSM4 satellite data", ref->type, -1);
+        }
+    }
+
+    for (uint8_t c = 0; c < ref->ncell; c++) {
+        /* Rounded to 2^-24 and 2^-29 ms, clamped into the narrower fields */
+        if (!host_msm_near(m4->fine_pr[c], ref->fine_pr[c], 16 + 32)) host_msm_fail(test, "MSM4 range", ref->type, c);
+        if (!host_msm_near(m4->fine_cp[c], ref->fine_cp[c], 2 + 4)) host_msm_fail(test, "MSM4 phase", ref->type, c);
+
+        /* Minimum lock time, never more than the input and at least half of it */
+        if (m4->lock_ms[c] > ref->lock_ms[c] ||
+            (ref->lock_ms[c] >= 32 && m4->lock_ms[c] < (1UL << 19U) && m4->lock_ms[c] * 2U <= ref->lock_ms[c])) {
+            host_msm_fail(test, "MSM4 lock time", ref->type, c);
+        }
+
+        if (m4->half_cycle[c] != ref->half_cycle[c]) host_msm_fail(test, "MSM4 half-cycle", ref->type, c);
+        if (m4->cnr[c] != ((ref->cnr[c] + 8U) / 16U > 63U ? 63U : (ref->cnr[c] + 8U) / 16U) * 16U) {
+            host_msm_fail(test, "MSM4 CNR", ref->type, c);
+        }
+
+        if (m4->fine_rate[c] != NL_MSM_INVALID) host_msm_fail(test, "MSM4 rate", ref->type, c);
+    }
+}
+
+static void host_msm_check_subset(host_msm_test_t *test) {
+    const nl_msm_t *ref = &test->ref;
+    const nl_msm_t *sub = &test->check;
+
+    /* Every input cell is either kept with identical values or gone together with its mask bits */
+    for (uint8_t i = 0; i < ref->nsat; i++) {
+        for (uint8_t j = 0; j < ref->nsig; j++) {
+            if (!ref->cell[i][j]) continue;
+
+            const uint8_t sat_id = ref->sat_id[i];
+            const uint8_t sig_id = ref->sig_id[j];
+            const bool    kept   = ((HOST_MSM_SUBSET_SATS >> (sat_id - 1U)) & 1U) &&
+                              ((HOST_MSM_SUBSET_SIGS >> (sig_id - 1U)) & 1U);
+            const int     rc     = host_msm_cell(ref, sat_id, sig_id);
+            const int     sc     = host_msm_cell(sub, sat_id, sig_id);
+
+            if (!kept) {
+                if (sc >= 0) host_msm_fail(test, "pruned cell still present", ref->type, rc);
+                continue;
+            }
+
+            if (sc < 0) {
+                host_msm_fail(test, "kept cell missing", ref->type, rc);
+                continue;
+            }
+
+            if (sub->fine_pr[sc] != ref->fine_pr[rc] || sub->fine_cp[sc] != ref->fine_cp[rc] ||
+                sub->lock_ms[sc] != ref->lock_ms[rc] || sub->half_cycle[sc] != ref->half_cycle[rc] ||
+                sub->cnr[sc] != ref->cnr[rc] || sub->fine_rate[sc] != ref->fine_rate[rc]) {
+                host_msm_fail(test, "subset cell values differ", ref->type, rc);
+            }
+
+            const int ri = host_msm_sat(ref, sat_id);
+            const int si = host_msm_sat(sub, sat_id);
+
+            if (sub->rough_ms[si] != ref->rough_ms[ri] || sub->rough_mod[si] != ref->rough_mod[ri] ||
+                sub->ext_info[si] != ref->ext_info[ri] || sub->rough_rate[si] != ref->rough_rate[ri]) {
+                host_msm_fail(test, "subset satellite data differs", ref->type, rc);
+            }
+        }
+    }
+
+    /* No empty rows or columns left behind */
+    for (uint8_t i = 0; i < sub->nsat; i++) {
+        bool any = false;
+        for (uint8_t j = 0; j < sub->nsig; j++) any |= sub->cell[i][j];
+        if (!any) host_msm_fail(test, "empty satellite row", ref->type, -1);
+    }
+
+    for (uint8_t j = 0; j < sub->nsig; j++) {
+        bool any = false;
+        for (uint8_t i = 0; i < sub->nsat; i++) any |= sub->cell[i][j];
+        if (!any) host_msm_fail(test, "empty signal column", ref->type, -1);
+    }
+}
+
+static void host_msm_frame(host_msm_test_t *test, const uint8_t *frame, size_t len) {
+    if (nl_msm_decode(&test->ref, frame, len) != 0) {
+        return;
+    }
+
+    test->frames++;
+    test->bytes_in += len;
+
+    /* ---- Unchanged: bit exact ---- */
+    int out_len = host_msm_reencode(test, &test->ref, test->ref.msm_type);
+    if (out_len >= 0 && ((size_t)out_len != len || memcmp(test->out, frame, len) != 0)) {
+        host_msm_fail(test, "unchanged re-encode differs from the input", test->ref.type, -1);
+    }
+
+    /* ---- MSM7 to MSM4 ---- */
+    if (test->ref.msm_type == 7) {
+        out_len = host_msm_reencode(test, &test->ref, 4);
+        if (out_len >= 0) {
+            test->bytes_msm4 += out_len;
+            host_msm_check_msm4(test);
+        }
+    } else {
+        test->bytes_msm4 += len;
+    }
+
+    /* ---- Subset at the input resolution ---- */
+    memcpy(&test->work, &test->ref, sizeof(nl_msm_t));
+    nl_msm_prune(&test->work, HOST_MSM_SUBSET_SATS, HOST_MSM_SUBSET_SIGS);
+
+    out_len = host_msm_reencode(test, &test->work, test->ref.msm_type);
+    if (out_len >= 0) {
+        test->bytes_subset += out_len;
+        host_msm_check_subset(test);
+    }
+
+    if (!nl_msm_multiple(&test->ref)) {
+        test->epochs++;
+    }
+}
+
+static bool host_msm_demux_frame(void *ctx, app_gnss_frame_type_t type, const uint8_t *frame, size_t len) {
+    host_msm_test_t *test = ctx;
+
+    if (type != APP_GNSS_FRAME_RTCM3) {
+        return true;
+    }
+
+    if (!host_msm_crc_ok(frame, len)) {
+        return false;
+    }
+
+    host_msm_frame(test, frame, len);
+
+    return true;
+}
+
+/* Decoded observables against what went into the golden frame. Returns the number of failures. */
+static uint32_t host_msm_golden(const host_msm_golden_t *golden) {
+    static nl_msm_t msm;
+
+    uint32_t failures = 0;
+
+    if (!host_msm_crc_ok(golden->frame, golden->len) || nl_msm_decode(&msm, golden->frame, golden->len) != 0) {
+        fprintf(stderr, "%s: does not decode\n", golden->name);
+        return 1;
+    }
+
+    if (msm.type != golden->type || msm.msm_type != golden->type % 10U || nl_msm_station(&msm) != 1234 ||
+        nl_msm_epoch(&msm) != 345600000UL || nl_msm_multiple(&msm) || msm.ncell != golden->ncell) {
+        fprintf(stderr, "%s: header or cell count differs\n", golden->name);
+        return 1;
+    }
+
+    for (uint8_t k = 0; k < golden->ncell; k++) {
+        const host_msm_golden_cell_t *want = &golden->cells[k];
+
+        const int c = host_msm_cell(&msm, want->sat_id, want->sig_id);
+        const int i = host_msm_sat(&msm, want->sat_id);
+        if (c != k) {
+            fprintf(stderr, "%s: G%02u/%u not at cell %u\n", golden->name, want->sat_id, want->sig_id, k);
+            failures++;
+            continue;
+        }
+
+        const double rough_ms = msm.rough_ms[i] + msm.rough_mod[i] / 1024.0;
+        const double range_m  = (rough_ms + ldexp(msm.fine_pr[c], -29)) * HOST_MSM_M_PER_MS;
+
+        if (fabs(range_m - want->range_m) > golden->range_tolerance_m) {
+            fprintf(stderr, "%s: G%02u/%u range %.4f m\n", golden->name, want->sat_id, want->sig_id, range_m);
+            failures++;
+        }
+
+        if (isnan(want->phase_m)) {
+            if (msm.fine_cp[c] != NL_MSM_INVALID) {
+                fprintf(stderr, "%s: G%02u/%u invalid phase decoded\n", golden->name, want->sat_id, want->sig_id);
+                failures++;
+            }
+        } else {
+            const double phase_m = (rough_ms + ldexp(msm.fine_cp[c], -31)) * HOST_MSM_M_PER_MS;
+
+            if (msm.fine_cp[c] == NL_MSM_INVALID || fabs(phase_m - want->phase_m) > golden->phase_tolerance_m) {
+                fprintf(stderr, "%s: G%02u/%u phase %.4f m\n", golden->name, want->sat_id, want->sig_id, phase_m);
+                failures++;
+            }
+        }
+
+        if (isnan(want->rate_mps)) {
+            if (msm.rough_rate[i] != NL_MSM_INVALID || msm.fine_rate[c] != NL_MSM_INVALID) {
+                fprintf(stderr, "%s: G%02u/%u rate in MSM4\n", golden->name, want->sat_id, want->sig_id);
+                failures++;
+            }
+        } else if (msm.rough_rate[i] == NL_MSM_INVALID || msm.fine_rate[c] == NL_MSM_INVALID ||
+                   fabs(msm.rough_rate[i] + msm.fine_rate[c] / 10000.0 - want->rate_mps) > 0.00005) {
+            fprintf(stderr, "%s: G%02u/%u rate\n", golden->name, want->sat_id, want->sig_id);
+            failures++;
+        }
+
+        if (msm.lock_ms[c] != want->lock_ms || msm.half_cycle[c] != want->half_cycle ||
+            msm.cnr[c] / 16.0 != want->cnr_dbhz) {
+            fprintf(stderr, "%s: G%02u/%u lock %" PRIu32 " ms, half-cycle %u, CNR %.4f dB-Hz\n", golden->name,
+                    want->sat_id, want->sig_id, msm.lock_ms[c], msm.half_cycle[c], msm.cnr[c] / 16.0);
+            failures++;
+        }
+    }
+
+    /* The round trip on top, with a frame nl_msm did not produce */
+    static host_msm_test_t test;
+
+    memset(&test, 0U, sizeof(test));
+    test.path = golden->name;
+
+    host_msm_frame(&test, golden->frame, golden->len);
+
+    return failures + test.failures;
+}
+
+static int host_msm_test(const char *path) {
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) {
+        fprintf(stderr, "Failed to open %s.\n", path);
+
+        return -1;
+    }
+
+    nl_rawlog_reader_t reader;
+    if (nl_rawlog_reader_open(&reader, fp) != 0) {
+        fprintf(stderr, "%s is not a GNSS recording.\n", path);
+        fclose(fp);
+
+        return -1;
+    }
+
+    static host_msm_test_t  test;
+    static app_gnss_demux_t demux;
+    static uint8_t          buf[NL_RAWLOG_CHUNK_MAX];
+
+    memset(&test, 0U, sizeof(test));
+    test.path = path;
+
+    app_gnss_demux_init(&demux, host_msm_demux_frame, &test);
+
+    for (;;) {
+        uint8_t   flags;
+        const int len = nl_rawlog_reader_next(&reader, buf, &flags);
+        if (len < 0) {
+            break;
+        }
+
+        app_gnss_demux_input(&demux, buf, len);
+    }
+
+    fclose(fp);
+
+    const double epochs = test.epochs ? test.epochs : 1;
+
+    printf("{\"target\":\"msm\",\"file\":\"%s\",\"frames\":%" PRIu32 ",\"epochs\":%" PRIu32 ",\"failures\":%" PRIu32
+           ",\"bytes_per_epoch\":{\"input\":%.1f,\"msm4\":%.1f,\"subset\":%.1f}}\n",
+           path, test.frames, test.epochs, test.failures, test.bytes_in / epochs, test.bytes_msm4 / epochs,
+           test.bytes_subset / epochs);
+
+    if (test.frames == 0) {
+        fprintf(stderr, "%s: no MSM4 or MSM7 frames.\n", path);
+
+        return -1;
+    }
+
+    return (test.failures == 0) ? 0 : -1;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <RECORDING>...\n", argv[0]);
+
+        return 2;
+    }
+
+    nl_crc24q_init();
+
+    int ret = 0;
+
+    for (size_t i = 0; i < sizeof(HOST_MSM_GOLDEN) / sizeof(HOST_MSM_GOLDEN[0]); i++) {
+        const uint32_t failures = host_msm_golden(&HOST_MSM_GOLDEN[i]);
+
+        printf("{\"target\":\"msm\",\"file\":\"%s\",\"failures\":%" PRIu32 "}\n", HOST_MSM_GOLDEN[i].name,
+               failures);
+
+        if (failures != 0) {
+            ret = 1;
+        }
+    }
+
+    for (int i = 1; i < argc; i++) {
+        if (host_msm_test(argv[i]) != 0) {
+            ret = 1;
+        }
+    }
+
+    return ret;
+}
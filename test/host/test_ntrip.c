@@ -0,0 +1,310 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* nl */
+#include "rcv/nl_crc24q.h"
+
+/* App */
+#include "app/ntrip/stream.h"
+
+/*
+ * NTRIP client stream handling against a scripted caster. Each script is a full caster answer, response header and
+ * body, played through the same steps as the client: the header is collected until it parses, whatever followed it
+ * in the same read goes to the stream, and so does every later read. Every script is replayed with several read
+ * sizes, down to one byte, so chunk size lines, CRLFs and frames are split at every position. The frames passed on
+ * must be the ones the caster encoded, whole and byte for byte, and only the noise between them may be dropped.
+ */
+
+#define HOST_NTRIP_RECV_SIZE   (512) /* APP_NTRIP_CLIENT_RECV_SIZE */
+#define HOST_NTRIP_SCRIPT_MAX  (8192)
+#define HOST_NTRIP_PAYLOAD_MAX (4096)
+
+typedef struct {
+    const char *name;
+    const char *header;
+    bool        chunked; /* Body sent with the chunked transfer encoding and a zero-length terminator */
+    int         status;  /* Expected from app_ntrip_stream_response(): 1 accepted, -1 SOURCETABLE, -2 refused */
+} host_ntrip_case_t;
+
+typedef struct {
+    uint8_t  data[HOST_NTRIP_PAYLOAD_MAX];
+    size_t   len;
+    uint32_t frames;
+    uint16_t last_type;
+    uint32_t skipped;
+} host_ntrip_payload_t;
+
+typedef struct {
+    app_ntrip_stream_t   stream;
+    host_ntrip_payload_t out; /* Frames passed on, back to back */
+} host_ntrip_client_t;
+
+static const host_ntrip_case_t HOST_NTRIP_CASES[] = {
+    {"icy", "ICY 200 OK\r\n\r\n", false, 1},
+    {"http", "HTTP/1.1 200 OK\r\nNtrip-Version: Ntrip/2.0\r\nContent-Type: gnss/data\r\n\r\n", false, 1},
+    {"http_chunked",
+     "HTTP/1.1 200 OK\r\nNtrip-Version: Ntrip/2.0\r\nContent-Type: gnss/data\r\nTransfer-Encoding: chunked\r\n\r\n",
+     true, 1},
+    {"http_chunked_case", "HTTP/1.0 200 OK\r\ntransfer-encoding:  Chunked\r\nConnection: close\r\n\r\n", true, 1},
+    {"sourcetable",
+     "SOURCETABLE 200 OK\r\nServer: NTRIP Caster\r\nContent-Type: text/plain\r\n\r\n"
+     "STR;BASE;Base;RTCM 3.3;1005(10),1077(1);2;GPS;NONE;DEU;52.52;13.40;0;0;Asuna;none;B;N;9600;\r\n"
+     "ENDSOURCETABLE\r\n",
+     false, -1},
+    {"unauthorized", "HTTP/1.1 401 Unauthorized\r\nWWW-Authenticate: Basic realm=\"/BASE\"\r\n\r\n", false, -2},
+};
+
+static const size_t HOST_NTRIP_READ_SIZES[] = {1, 2, 3, 5, 7, 13, 64, HOST_NTRIP_RECV_SIZE - 1};
+
+static void host_ntrip_deliver(void *ctx, const uint8_t *frame, size_t len) {
+    host_ntrip_client_t *client = ctx;
+
+    /* One call per frame, which is what keeps PAIR commands out of it */
+    if (len < 6 || frame[0] != 0xD3 || len != ((((size_t)frame[1] & 0x03U) << 8U) | frame[2]) + 6U) {
+        client->out.skipped = UINT32_MAX;
+    }
+
+    if (client->out.len + len <= sizeof(client->out.data)) {
+        memcpy(&client->out.data[client->out.len], frame, len);
+    }
+    client->out.len += len;
+
+    client->out.frames++;
+    client->out.last_type = ((uint16_t)frame[3] << 4U) | (frame[4] >> 4U);
+}
+
+static size_t host_ntrip_frame(uint8_t *out, uint16_t type, size_t payload_len) {
+    out[0] = 0xD3;
+    out[1] = (uint8_t)(payload_len >> 8U);
+    out[2] = (uint8_t)payload_len;
+    out[3] = (uint8_t)(type >> 4U);
+    out[4] = (uint8_t)(type << 4U);
+
+    /* Preamble-looking bytes inside the payload must not resync the framing */
+    for (size_t i = 2; i < payload_len; i++) {
+        out[3 + i] = (i % 5U == 0U) ? 0xD3 : (uint8_t)(i * 7U);
+    }
+
+    const uint32_t crc = nl_crc24q(out, 3 + payload_len);
+
+    out[3 + payload_len]     = (uint8_t)(crc >> 16U);
+    out[3 + payload_len + 1] = (uint8_t)(crc >> 8U);
+    out[3 + payload_len + 2] = (uint8_t)crc;
+
+    return payload_len + 6;
+}
+
+static void host_ntrip_append(host_ntrip_payload_t *stream, host_ntrip_payload_t *frames, uint16_t type,
+                              size_t payload_len) {
+    const size_t len = host_ntrip_frame(&stream->data[stream->len], type, payload_len);
+
+    memcpy(&frames->data[frames->len], &stream->data[stream->len], len);
+    stream->len += len;
+    frames->len += len;
+
+    frames->frames++;
+    frames->last_type = type;
+}
+
+static void host_ntrip_noise(host_ntrip_payload_t *stream, host_ntrip_payload_t *frames, const char *noise,
+                             size_t len) {
+    memcpy(&stream->data[stream->len], noise, len);
+    stream->len += len;
+    frames->skipped += len;
+}
+
+/* The end of a frame whose start was missed, as when the client joins a stream mid-frame */
+static void host_ntrip_tail(host_ntrip_payload_t *stream, host_ntrip_payload_t *frames, uint16_t type,
+                            size_t payload_len, size_t offset) {
+    uint8_t frame[3 + 1023 + 3];
+
+    const size_t len = host_ntrip_frame(frame, type, payload_len);
+
+    host_ntrip_noise(stream, frames, (const char *)&frame[offset], len - offset);
+}
+
+/* Frames with noise around them, including false preambles, and what must come out of it */
+static void host_ntrip_payload(host_ntrip_payload_t *stream, host_ntrip_payload_t *frames) {
+    memset(stream, 0U, sizeof(host_ntrip_payload_t));
+    memset(frames, 0U, sizeof(host_ntrip_payload_t));
+
+    /* Starts mid-frame, the tail carries preamble bytes of its own */
+    host_ntrip_tail(stream, frames, 1074, 300, 41);
+    host_ntrip_noise(stream, frames, "\xD3\xFFnoise", 7);
+    /* Preambles with a plausible length only fail on the CRC, one reaches over the next two frames */
+    host_ntrip_noise(stream, frames, "\xD3\x03\xFF", 3);
+    host_ntrip_append(stream, frames, 1005, 19);
+    host_ntrip_append(stream, frames, 1077, 700);
+    host_ntrip_noise(stream, frames, "\x00\xD3\xD3\xFC", 4);
+    host_ntrip_noise(stream, frames, "\xD3\x00\x04", 3);
+    host_ntrip_append(stream, frames, 1230, 6);
+    host_ntrip_append(stream, frames, 1033, 0);
+    host_ntrip_append(stream, frames, 1097, 1023);
+}
+
+/* Chunk sizes vary, in both hex cases and with extensions, so size lines land everywhere */
+static size_t host_ntrip_chunk(uint8_t *out, const uint8_t *payload, size_t len) {
+    static const size_t SIZES[] = {1, 0x1A, 0x2FF, 3, 0xAB, 0x100};
+
+    size_t pos = 0;
+
+    for (size_t i = 0, n = 0; i < len; i += n) {
+        const size_t size = SIZES[(pos / 7U) % (sizeof(SIZES) / sizeof(SIZES[0]))];
+
+        n = (len - i < size) ? len - i : size;
+
+        switch (i % 3U) {
+            case 0:
+                pos += sprintf((char *)&out[pos], "%zx\r\n", n);
+                break;
+            case 1:
+                pos += sprintf((char *)&out[pos], "%zX;name=value\r\n", n);
+                break;
+            default:
+                pos += sprintf((char *)&out[pos], "00%zX \r\n", n);
+                break;
+        }
+
+        memcpy(&out[pos], &payload[i], n);
+        pos += n;
+
+        memcpy(&out[pos], "\r\n", 2);
+        pos += 2;
+    }
+
+    /* Terminator, then bytes that must never be passed on */
+    memcpy(&out[pos], "0\r\n\r\n\xD3\x00\x02\x3E\xD0\x00\x00\x00", 13);
+
+    return pos + 13;
+}
+
+/* Same steps as app_ntrip_client_request() and the session loop. Returns the number of failures. */
+static uint32_t host_ntrip_play(const host_ntrip_case_t *test, const uint8_t *script, size_t script_len,
+                                size_t read_size, const host_ntrip_payload_t *frames) {
+    static host_ntrip_client_t client;
+
+    char     header[HOST_NTRIP_RECV_SIZE];
+    size_t   received   = 0;
+    int      header_len = 0;
+    int      ended      = 0;
+    size_t   pos        = 0;
+    uint32_t failures   = 0;
+
+    memset(&client, 0U, sizeof(client));
+    app_ntrip_stream_init(&client.stream, host_ntrip_deliver, &client);
+
+    while (pos < script_len && header_len == 0) {
+        size_t n = (script_len - pos < read_size) ? script_len - pos : read_size;
+
+        if (n > sizeof(header) - 1 - received) {
+            n = sizeof(header) - 1 - received;
+        }
+
+        memcpy(&header[received], &script[pos], n);
+        received += n;
+        pos += n;
+
+        header[received] = '\0';
+        header_len       = app_ntrip_stream_response(&client.stream, header);
+    }
+
+    if ((header_len > 0 ? 1 : header_len) != test->status) {
+        fprintf(stderr, "%s/%zu: response %d, expected %d\n", test->name, read_size, header_len, test->status);
+        return 1;
+    }
+
+    if (header_len < 0) {
+        return 0;
+    }
+
+    if (header_len != (int)strlen(test->header)) {
+        fprintf(stderr, "%s/%zu: header length %d\n", test->name, read_size, header_len);
+        failures++;
+    }
+
+    if (client.stream.chunked != test->chunked) {
+        fprintf(stderr, "%s/%zu: chunked %d\n", test->name, read_size, client.stream.chunked);
+        failures++;
+    }
+
+    if (received > (size_t)header_len) {
+        ended = app_ntrip_stream_input(&client.stream, (const uint8_t *)&header[header_len], received - header_len);
+    }
+
+    while (pos < script_len && ended == 0) {
+        const size_t n = (script_len - pos < read_size) ? script_len - pos : read_size;
+
+        ended = app_ntrip_stream_input(&client.stream, &script[pos], n);
+        pos += n;
+    }
+
+    /* Only a chunked body has an end of its own, a plain one runs until the connection drops */
+    if (ended != (test->chunked ? -1 : 0)) {
+        fprintf(stderr, "%s/%zu: stream end %d\n", test->name, read_size, ended);
+        failures++;
+    }
+
+    client.out.skipped = (client.out.skipped == UINT32_MAX) ? UINT32_MAX : client.stream.skipped;
+
+    if (client.out.len != frames->len || memcmp(client.out.data, frames->data, frames->len) != 0) {
+        fprintf(stderr, "%s/%zu: frames differ, %zu bytes instead of %zu\n", test->name, read_size, client.out.len,
+                frames->len);
+        failures++;
+    }
+
+    if (client.out.frames != frames->frames || client.out.last_type != frames->last_type) {
+        fprintf(stderr, "%s/%zu: %" PRIu32 " frames, last %u\n", test->name, read_size, client.out.frames,
+                client.out.last_type);
+        failures++;
+    }
+
+    if (client.out.skipped != frames->skipped) {
+        fprintf(stderr, "%s/%zu: %" PRIu32 " bytes skipped instead of %" PRIu32 "\n", test->name, read_size,
+                client.out.skipped, frames->skipped);
+        failures++;
+    }
+
+    return failures;
+}
+
+int main(void) {
+    static host_ntrip_payload_t payload;
+    static host_ntrip_payload_t frames;
+    static uint8_t              script[HOST_NTRIP_SCRIPT_MAX];
+
+    nl_crc24q_init();
+
+    host_ntrip_payload(&payload, &frames);
+
+    uint32_t runs     = 0;
+    uint32_t failures = 0;
+
+    for (size_t c = 0; c < sizeof(HOST_NTRIP_CASES) / sizeof(HOST_NTRIP_CASES[0]); c++) {
+        const host_ntrip_case_t *test = &HOST_NTRIP_CASES[c];
+
+        size_t script_len = strlen(test->header);
+        memcpy(script, test->header, script_len);
+
+        /* Refusals carry no stream, a SOURCETABLE its table as part of the header text */
+        if (test->status == 1) {
+            if (test->chunked) {
+                script_len += host_ntrip_chunk(&script[script_len], payload.data, payload.len);
+            } else {
+                memcpy(&script[script_len], payload.data, payload.len);
+                script_len += payload.len;
+            }
+        }
+
+        for (size_t r = 0; r < sizeof(HOST_NTRIP_READ_SIZES) / sizeof(HOST_NTRIP_READ_SIZES[0]); r++) {
+            failures += host_ntrip_play(test, script, script_len, HOST_NTRIP_READ_SIZES[r], &frames);
+            runs++;
+        }
+    }
+
+    printf("{\"target\":\"ntrip\",\"cases\":%zu,\"runs\":%" PRIu32 ",\"failures\":%" PRIu32 "}\n",
+           sizeof(HOST_NTRIP_CASES) / sizeof(HOST_NTRIP_CASES[0]), runs, failures);
+
+    return (failures == 0) ? 0 : 1;
+}